@@ -239,13 +239,7 @@ void BlendApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -412,6 +406,8 @@ void BlendApp::AnimateMaterials(const GameTimer& gt)
 
 void BlendApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -497,6 +493,8 @@ void BlendApp::UpdateMainPassCB(const GameTimer& gt)
 
 void BlendApp::UpdateWaves(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWaves");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
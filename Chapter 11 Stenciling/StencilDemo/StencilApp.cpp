@@ -237,13 +237,7 @@ void StencilApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -388,16 +382,16 @@ void StencilApp::OnKeyboardInput(const GameTimer& gt)
 
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mSkullTranslation.x -= 1.0f*dt;
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mSkullTranslation.x += 1.0f*dt;
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mSkullTranslation.y += 1.0f*dt;
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mSkullTranslation.y -= 1.0f*dt;
 
 	// Don't let user move below ground plane.
@@ -450,6 +444,8 @@ void StencilApp::AnimateMaterials(const GameTimer& gt)
 
 void StencilApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
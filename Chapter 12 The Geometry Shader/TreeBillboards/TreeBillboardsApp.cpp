@@ -243,13 +243,7 @@ void TreeBillboardsApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -418,6 +412,8 @@ void TreeBillboardsApp::AnimateMaterials(const GameTimer& gt)
 
 void TreeBillboardsApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -503,6 +499,8 @@ void TreeBillboardsApp::UpdateMainPassCB(const GameTimer& gt)
 
 void TreeBillboardsApp::UpdateWaves(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWaves");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
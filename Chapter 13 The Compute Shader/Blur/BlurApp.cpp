@@ -253,13 +253,7 @@ void BlurApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -434,6 +428,8 @@ void BlurApp::AnimateMaterials(const GameTimer& gt)
 
 void BlurApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -519,6 +515,8 @@ void BlurApp::UpdateMainPassCB(const GameTimer& gt)
 
 void BlurApp::UpdateWaves(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWaves");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -623,6 +621,7 @@ void BlurApp::BuildRootSignature()
         serializedRootSig->GetBufferPointer(),
         serializedRootSig->GetBufferSize(),
         IID_PPV_ARGS(mRootSignature.GetAddressOf())));
+    mPsoCache->RegisterRootSignature(mRootSignature.Get(), serializedRootSig.Get());
 }
 
 void BlurApp::BuildPostProcessRootSignature()
@@ -663,6 +662,7 @@ void BlurApp::BuildPostProcessRootSignature()
 		serializedRootSig->GetBufferPointer(),
 		serializedRootSig->GetBufferSize(),
 		IID_PPV_ARGS(mPostProcessRootSignature.GetAddressOf())));
+	mPsoCache->RegisterRootSignature(mPostProcessRootSignature.Get(), serializedRootSig.Get());
 }
 
 void BlurApp::BuildDescriptorHeaps()
@@ -939,7 +939,7 @@ void BlurApp::BuildPSOs()
 	opaquePsoDesc.SampleDesc.Count = m4xMsaaState ? 4 : 1;
 	opaquePsoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
 	opaquePsoDesc.DSVFormat = mDepthStencilFormat;
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaquePsoDesc, IID_PPV_ARGS(&mPSOs["opaque"])));
+    mPSOs["opaque"] = mPsoCache->GetGraphics(opaquePsoDesc);
 
 	//
 	// PSO for transparent objects
@@ -960,7 +960,7 @@ void BlurApp::BuildPSOs()
 	transparencyBlendDesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
 
 	transparentPsoDesc.BlendState.RenderTarget[0] = transparencyBlendDesc;
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&transparentPsoDesc, IID_PPV_ARGS(&mPSOs["transparent"])));
+	mPSOs["transparent"] = mPsoCache->GetGraphics(transparentPsoDesc);
 
 	//
 	// PSO for alpha tested objects
@@ -973,7 +973,7 @@ void BlurApp::BuildPSOs()
 		mShaders["alphaTestedPS"]->GetBufferSize()
 	};
 	alphaTestedPsoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&alphaTestedPsoDesc, IID_PPV_ARGS(&mPSOs["alphaTested"])));
+	mPSOs["alphaTested"] = mPsoCache->GetGraphics(alphaTestedPsoDesc);
 
 	//
 	// PSO for horizontal blur
@@ -986,7 +986,7 @@ void BlurApp::BuildPSOs()
 		mShaders["horzBlurCS"]->GetBufferSize()
 	};
 	horzBlurPSO.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-	ThrowIfFailed(md3dDevice->CreateComputePipelineState(&horzBlurPSO, IID_PPV_ARGS(&mPSOs["horzBlur"])));
+	mPSOs["horzBlur"] = mPsoCache->GetCompute(horzBlurPSO);
 
 	//
 	// PSO for vertical blur
@@ -999,7 +999,7 @@ void BlurApp::BuildPSOs()
 		mShaders["vertBlurCS"]->GetBufferSize()
 	};
 	vertBlurPSO.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-	ThrowIfFailed(md3dDevice->CreateComputePipelineState(&vertBlurPSO, IID_PPV_ARGS(&mPSOs["vertBlur"])));
+	mPSOs["vertBlur"] = mPsoCache->GetCompute(vertBlurPSO);
 }
 
 void BlurApp::BuildFrameResources()
@@ -299,13 +299,7 @@ void SobelApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -503,6 +497,8 @@ void SobelApp::AnimateMaterials(const GameTimer& gt)
 
 void SobelApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -590,6 +586,8 @@ void SobelApp::UpdateMainPassCB(const GameTimer& gt)
 
 void SobelApp::UpdateWavesGPU(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWavesGPU");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -4,9 +4,10 @@
 
 #include "../../Common/d3dApp.h"
 #include "../../Common/MathHelper.h"
-#include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TexturePackBuilder.h"
+#include "../../Common/FramePacer.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -16,6 +17,7 @@ using namespace DirectX::PackedVector;
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "D3D12.lib")
 
+// Frame resources in flight at startup, and the most the '1'-'3' keys allow.
 const int gNumFrameResources = 3;
 
 // Lightweight structure stores parameters to draw a shape.  This will
@@ -32,13 +34,7 @@ struct RenderItem
 
 	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
-
-	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
+	// Index of this render item's constants in the object constant buffers of the frame.
 	UINT ObjCBIndex = -1;
 
 	Material* Mat = nullptr;
@@ -79,6 +75,7 @@ private:
 	void UpdateMainPassCB(const GameTimer& gt);
 
 	void LoadTextures();
+	void SetDiffuseMap(Material* mat, const std::string& texName);
     void BuildRootSignature();
 	void BuildDescriptorHeaps();
     void BuildShadersAndInputLayout();
@@ -97,6 +94,9 @@ private:
     FrameResource* mCurrFrameResource = nullptr;
     int mCurrFrameResourceIndex = 0;
 
+	// Hands out the frame resources and waits for the GPU when it falls behind.
+	std::unique_ptr<FramePacer> mFramePacer;
+
     UINT mCbvSrvDescriptorSize = 0;
 
     ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
@@ -106,6 +106,11 @@ private:
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
 	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
+
+	// The diffuse maps are packed into texture pages (see TexturePacker.h); the
+	// materials look their texture up by name here.
+	std::unordered_map<std::string, TexturePacker::Placement> mTexturePlacements;
+	std::vector<D3D12_SHADER_RESOURCE_VIEW_DESC> mTexturePageSrvs;
 	std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
 	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
@@ -119,6 +124,11 @@ private:
 
     PassConstants mMainPassCB;
 
+	// Per-frame data allocated from mCurrFrameResource->Uploads in Update.
+	D3D12_GPU_VIRTUAL_ADDRESS mObjectCBAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS mMaterialBufferAddress = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS mPassCBAddress = 0;
+
 	Camera mCamera;
 
     POINT mLastMousePos;
@@ -179,6 +189,7 @@ bool CameraAndDynamicIndexingApp::Initialize()
     BuildShapeGeometry();
 	BuildMaterials();
     BuildRenderItems();
+	mFramePacer = std::make_unique<FramePacer>(mGpuFence.get(), gNumFrameResources);
     BuildFrameResources();
     BuildPSOs();
 
@@ -204,19 +215,13 @@ void CameraAndDynamicIndexingApp::Update(const GameTimer& gt)
 {
     OnKeyboardInput(gt);
 
-    // Cycle through the circular frame resource array.
-    mCurrFrameResourceIndex = (mCurrFrameResourceIndex + 1) % gNumFrameResources;
+    // Cycle through the circular frame resource array.  If the GPU has not finished
+    // processing the commands of the next frame resource, this waits until it has.
+    mCurrFrameResourceIndex = mFramePacer->BeginFrame();
     mCurrFrameResource = mFrameResources[mCurrFrameResourceIndex].get();
 
-    // Has the GPU finished processing the commands of the current frame resource?
-    // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+	// The GPU is done with the data allocated the last time this frame resource was used.
+	mCurrFrameResource->Uploads->Reset();
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -255,13 +260,11 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 
 	mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
 
-	auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
+	mCommandList->SetGraphicsRootConstantBufferView(1, mPassCBAddress);
 
 	// Bind all the materials used in this scene.  For structured buffers, we can bypass the heap and 
 	// set as a root descriptor.
-	auto matBuffer = mCurrFrameResource->MaterialBuffer->Resource();
-	mCommandList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
+	mCommandList->SetGraphicsRootShaderResourceView(2, mMaterialBufferAddress);
 
 	// Bind all the textures used in this scene.  Observe
     // that we only have to specify the first descriptor in the table.  
@@ -286,12 +289,15 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 	mCurrBackBuffer = (mCurrBackBuffer + 1) % SwapChainBufferCount;
 
     // Advance the fence value to mark commands up to this fence point.
-    mCurrFrameResource->Fence = ++mCurrentFence;
+    ++mCurrentFence;
 
     // Add an instruction to the command queue to set a new fence point. 
     // Because we are on the GPU timeline, the new fence point won't be 
     // set until the GPU finishes processing all the commands prior to this Signal().
     mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+
+	// The current frame resource is free again once the GPU reaches this fence point.
+	mFramePacer->EndFrame(mCurrentFence);
 }
 
 void CameraAndDynamicIndexingApp::OnMouseDown(WPARAM btnState, int x, int y)
@@ -327,18 +333,29 @@ void CameraAndDynamicIndexingApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(10.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-10.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-10.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(10.0f*dt);
 
+	// '1'-'3' choose how many frames the CPU may get ahead of the GPU.  Fewer frames
+	// lower the latency, more frames keep the GPU busy when the CPU time varies.
+	for(int i = 1; i <= gNumFrameResources && i <= 9; ++i)
+	{
+		if(IsKeyDown('0' + i) && (int)mFramePacer->FramesInFlight() != i)
+		{
+			mFramePacer->SetFramesInFlight(i);
+			BuildFrameResources();
+		}
+	}
+
 	mCamera.UpdateViewMatrix();
 }
  
@@ -349,54 +366,51 @@ void CameraAndDynamicIndexingApp::AnimateMaterials(const GameTimer& gt)
 
 void CameraAndDynamicIndexingApp::UpdateObjectCBs(const GameTimer& gt)
 {
-	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
+	// The constants are written every frame into memory allocated for this frame, so
+	// there is no per frame resource dirty state to track.
+	UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
+	auto objectCBs = mCurrFrameResource->Uploads->AllocateConstantsArray<ObjectConstants>((UINT)mAllRitems.size());
+
 	for(auto& e : mAllRitems)
 	{
-		// Only update the cbuffer data if the constants have changed.  
-		// This needs to be tracked per frame resource.
-		if(e->NumFramesDirty > 0)
-		{
-			XMMATRIX world = XMLoadFloat4x4(&e->World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
-
-			ObjectConstants objConstants;
-			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
-			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
-			objConstants.MaterialIndex = e->Mat->MatCBIndex;
+		XMMATRIX world = XMLoadFloat4x4(&e->World);
+		XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
 
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
+		ObjectConstants objConstants;
+		XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
+		XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
+		objConstants.MaterialIndex = e->Mat->MatCBIndex;
 
-			// Next FrameResource need to be updated too.
-			e->NumFramesDirty--;
-		}
+		memcpy(objectCBs.CpuAddress + e->ObjCBIndex*objCBByteSize, &objConstants, sizeof(ObjectConstants));
 	}
+
+	mObjectCBAddress = objectCBs.GpuAddress;
 }
 
 void CameraAndDynamicIndexingApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
-	auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
+	auto materialBuffer = mCurrFrameResource->Uploads->AllocateStructured<MaterialData>((UINT)mMaterials.size());
+	MaterialData* materials = reinterpret_cast<MaterialData*>(materialBuffer.CpuAddress);
+
 	for(auto& e : mMaterials)
 	{
-		// Only update the cbuffer data if the constants have changed.  If the cbuffer
-		// data changes, it needs to be updated for each FrameResource.
 		Material* mat = e.second.get();
-		if(mat->NumFramesDirty > 0)
-		{
-			XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
-
-			MaterialData matData;
-			matData.DiffuseAlbedo = mat->DiffuseAlbedo;
-			matData.FresnelR0 = mat->FresnelR0;
-			matData.Roughness = mat->Roughness;
-			XMStoreFloat4x4(&matData.MatTransform, XMMatrixTranspose(matTransform));
-			matData.DiffuseMapIndex = mat->DiffuseSrvHeapIndex;
+		XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
 
-			currMaterialBuffer->CopyData(mat->MatCBIndex, matData);
+		MaterialData matData;
+		matData.DiffuseAlbedo = mat->DiffuseAlbedo;
+		matData.FresnelR0 = mat->FresnelR0;
+		matData.Roughness = mat->Roughness;
+		XMStoreFloat4x4(&matData.MatTransform, XMMatrixTranspose(matTransform));
+		matData.DiffuseMapIndex = mat->DiffuseSrvHeapIndex;
+		matData.DiffuseMapSlice = mat->DiffuseSrvSlice;
 
-			// Next FrameResource need to be updated too.
-			mat->NumFramesDirty--;
-		}
+		materials[mat->MatCBIndex] = matData;
 	}
+
+	mMaterialBufferAddress = materialBuffer.GpuAddress;
 }
 
 void CameraAndDynamicIndexingApp::UpdateMainPassCB(const GameTimer& gt)
@@ -430,44 +444,76 @@ void CameraAndDynamicIndexingApp::UpdateMainPassCB(const GameTimer& gt)
 	mMainPassCB.Lights[2].Direction = { 0.0f, -0.707f, -0.707f };
 	mMainPassCB.Lights[2].Strength = { 0.2f, 0.2f, 0.2f };
 
-	auto currPassCB = mCurrFrameResource->PassCB.get();
-	currPassCB->CopyData(0, mMainPassCB);
+	mPassCBAddress = mCurrFrameResource->Uploads->AllocateConstants(mMainPassCB);
 }
 
 void CameraAndDynamicIndexingApp::LoadTextures()
 {
-	auto bricksTex = std::make_unique<Texture>();
-	bricksTex->Name = "bricksTex";
-	bricksTex->Filename = L"../../Textures/bricks.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-		mCommandList.Get(), bricksTex->Filename.c_str(),
-		bricksTex->Resource, bricksTex->UploadHeap));
-
-	auto stoneTex = std::make_unique<Texture>();
-	stoneTex->Name = "stoneTex";
-	stoneTex->Filename = L"../../Textures/stone.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-		mCommandList.Get(), stoneTex->Filename.c_str(),
-		stoneTex->Resource, stoneTex->UploadHeap));
-
-	auto tileTex = std::make_unique<Texture>();
-	tileTex->Name = "tileTex";
-	tileTex->Filename = L"../../Textures/tile.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-		mCommandList.Get(), tileTex->Filename.c_str(),
-		tileTex->Resource, tileTex->UploadHeap));
-
-	auto crateTex = std::make_unique<Texture>();
-	crateTex->Name = "crateTex";
-	crateTex->Filename = L"../../Textures/WoodCrate01.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-		mCommandList.Get(), crateTex->Filename.c_str(),
-		crateTex->Resource, crateTex->UploadHeap));
-
-	mTextures[bricksTex->Name] = std::move(bricksTex);
-	mTextures[stoneTex->Name] = std::move(stoneTex);
-	mTextures[tileTex->Name] = std::move(tileTex);
-	mTextures[crateTex->Name] = std::move(crateTex);
+	std::vector<std::string> texNames =
+	{
+		"bricksTex",
+		"stoneTex",
+		"tileTex",
+		"crateTex"
+	};
+
+	std::vector<std::wstring> texFilenames =
+	{
+		L"../../Textures/bricks.dds",
+		L"../../Textures/stone.dds",
+		L"../../Textures/tile.dds",
+		L"../../Textures/WoodCrate01.dds"
+	};
+
+	// Parse every file first, then pack: the textures that share a format and size
+	// (bricks, stone and tile) become the slices of one Texture2DArray.
+	std::vector<std::unique_ptr<DirectX::DDSTextureData12>> texData;
+	std::vector<const DirectX::DDSTextureData12*> texDataPtrs;
+	TexturePacker packer;
+	for(size_t i = 0; i < texNames.size(); ++i)
+	{
+		auto data = std::make_unique<DirectX::DDSTextureData12>();
+		ThrowIfFailed(DirectX::LoadDDSTextureDataFromFile12(texFilenames[i].c_str(), *data));
+
+		TexturePacker::TextureDesc desc;
+		if(!TexturePackBuilder::Describe(*data, desc))
+			ThrowIfFailed(E_INVALIDARG);
+
+		packer.Add(desc);
+		texDataPtrs.push_back(data.get());
+		texData.push_back(std::move(data));
+	}
+
+	packer.Build();
+
+	for(UINT i = 0; i < (UINT)packer.GetPages().size(); ++i)
+	{
+		auto page = TexturePackBuilder::BuildPage(packer, i, texDataPtrs);
+
+		auto pageTex = std::make_unique<Texture>();
+		pageTex->Name = "texturePage" + std::to_string(i);
+		ThrowIfFailed(DirectX::CreateDDSTextureFromData12(md3dDevice.Get(),
+			mCommandList.Get(), page->Data, pageTex->Resource, pageTex->UploadHeap));
+
+		mTexturePageSrvs.push_back(TexturePackBuilder::GetSrvDesc(*page));
+		mTextures[pageTex->Name] = std::move(pageTex);
+	}
+
+	for(UINT i = 0; i < (UINT)texNames.size(); ++i)
+		mTexturePlacements[texNames[i]] = packer.GetPlacement(i);
+}
+
+void CameraAndDynamicIndexingApp::SetDiffuseMap(Material* mat, const std::string& texName)
+{
+	const TexturePacker::Placement& placement = mTexturePlacements[texName];
+	mat->DiffuseSrvHeapIndex = placement.Page;
+	mat->DiffuseSrvSlice = placement.Slice;
+
+	// A texture packed into an atlas only covers part of its page.
+	XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
+	XMMATRIX uvTransform = XMMatrixScaling(placement.ScaleU, placement.ScaleV, 1.0f) *
+		XMMatrixTranslation(placement.OffsetU, placement.OffsetV, 0.0f);
+	XMStoreFloat4x4(&mat->MatTransform, matTransform * uvTransform);
 }
 
 void CameraAndDynamicIndexingApp::BuildRootSignature()
@@ -527,40 +573,23 @@ void CameraAndDynamicIndexingApp::BuildDescriptorHeaps()
 	//
 	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
-	auto bricksTex = mTextures["bricksTex"]->Resource;
-	auto stoneTex = mTextures["stoneTex"]->Resource;
-	auto tileTex = mTextures["tileTex"]->Resource;
-	auto crateTex = mTextures["crateTex"]->Resource;
-
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format = bricksTex->GetDesc().Format;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = bricksTex->GetDesc().MipLevels;
-	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-	md3dDevice->CreateShaderResourceView(bricksTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvDescriptorSize);
-
-	srvDesc.Format = stoneTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = stoneTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(stoneTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvDescriptorSize);
-
-	srvDesc.Format = tileTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = tileTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(tileTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvDescriptorSize);
+	// One Texture2DArray view per texture page.  Packing needs fewer descriptors than
+	// there are textures; the rest of the table gets null views.
+	for(UINT i = 0; i < srvHeapDesc.NumDescriptors; ++i)
+	{
+		if(i < (UINT)mTexturePageSrvs.size())
+		{
+			auto pageTex = mTextures["texturePage" + std::to_string(i)]->Resource;
+			md3dDevice->CreateShaderResourceView(pageTex.Get(), &mTexturePageSrvs[i], hDescriptor);
+		}
+		else
+		{
+			md3dDevice->CreateShaderResourceView(nullptr, &mTexturePageSrvs[0], hDescriptor);
+		}
 
-	srvDesc.Format = crateTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = crateTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(crateTex.Get(), &srvDesc, hDescriptor);
+		// next descriptor
+		hDescriptor.Offset(1, mCbvSrvDescriptorSize);
+	}
 }
 
 void CameraAndDynamicIndexingApp::BuildShadersAndInputLayout()
@@ -741,7 +770,9 @@ void CameraAndDynamicIndexingApp::BuildPSOs()
 
 void CameraAndDynamicIndexingApp::BuildFrameResources()
 {
-    for(int i = 0; i < gNumFrameResources; ++i)
+	// Called again when the number of frames in flight changes, after the GPU is idle.
+	mFrameResources.clear();
+    for(UINT i = 0; i < mFramePacer->FramesInFlight(); ++i)
     {
         mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
             1, (UINT)mAllRitems.size(), (UINT)mMaterials.size()));
@@ -753,7 +784,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto bricks0 = std::make_unique<Material>();
 	bricks0->Name = "bricks0";
 	bricks0->MatCBIndex = 0;
-	bricks0->DiffuseSrvHeapIndex = 0;
+	SetDiffuseMap(bricks0.get(), "bricksTex");
 	bricks0->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
     bricks0->FresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
     bricks0->Roughness = 0.1f;
@@ -761,7 +792,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto stone0 = std::make_unique<Material>();
 	stone0->Name = "stone0";
 	stone0->MatCBIndex = 1;
-	stone0->DiffuseSrvHeapIndex = 1;
+	SetDiffuseMap(stone0.get(), "stoneTex");
 	stone0->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
     stone0->FresnelR0 = XMFLOAT3(0.05f, 0.05f, 0.05f);
     stone0->Roughness = 0.3f;
@@ -769,7 +800,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto tile0 = std::make_unique<Material>();
 	tile0->Name = "tile0";
 	tile0->MatCBIndex = 2;
-	tile0->DiffuseSrvHeapIndex = 2;
+	SetDiffuseMap(tile0.get(), "tileTex");
 	tile0->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
     tile0->FresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
     tile0->Roughness = 0.3f;
@@ -777,7 +808,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto crate0 = std::make_unique<Material>();
 	crate0->Name = "crate0";
 	crate0->MatCBIndex = 3;
-	crate0->DiffuseSrvHeapIndex = 3;
+	SetDiffuseMap(crate0.get(), "crateTex");
 	crate0->DiffuseAlbedo = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
     crate0->FresnelR0 = XMFLOAT3(0.05f, 0.05f, 0.05f);
     crate0->Roughness = 0.2f;
@@ -883,8 +914,6 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 void CameraAndDynamicIndexingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
 {
     UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
- 
-	auto objectCB = mCurrFrameResource->ObjectCB->Resource();
 
     // For each render item...
     for(size_t i = 0; i < ritems.size(); ++i)
@@ -895,7 +924,7 @@ void CameraAndDynamicIndexingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmd
         cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
         cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
 
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex*objCBByteSize;
+        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = mObjectCBAddress + ri->ObjCBIndex*objCBByteSize;
 
 		// CD3DX12_GPU_DESCRIPTOR_HANDLE tex(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 		// tex.Offset(ri->Mat->DiffuseSrvHeapIndex, mCbvSrvDescriptorSize);
@@ -6,9 +6,13 @@ FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCo
         D3D12_COMMAND_LIST_TYPE_DIRECT,
 		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
 
-    PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
-	MaterialBuffer = std::make_unique<UploadBuffer<MaterialData>>(device, materialCount, false);
-    ObjectCB = std::make_unique<UploadBuffer<ObjectConstants>>(device, objectCount, true);
+    // Sized for the initial scene; the allocator grows if a frame needs more.
+    UINT64 uploadSize =
+        UINT64(d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants))) * passCount +
+        UINT64(d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants))) * objectCount +
+        UINT64(sizeof(MaterialData)) * materialCount + 16;
+
+    Uploads = std::make_unique<LinearUploadAllocator>(device, uploadSize);
 }
 
 FrameResource::~FrameResource()
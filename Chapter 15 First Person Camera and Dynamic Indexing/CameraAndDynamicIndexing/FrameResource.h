@@ -2,7 +2,7 @@
 
 #include "../../Common/d3dUtil.h"
 #include "../../Common/MathHelper.h"
-#include "../../Common/UploadBuffer.h"
+#include "../../Common/LinearUploadAllocator.h"
 
 struct ObjectConstants
 {
@@ -50,7 +50,7 @@ struct MaterialData
 	DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
 
 	UINT DiffuseMapIndex = 0;
-	UINT MaterialPad0;
+	UINT DiffuseMapSlice = 0;
 	UINT MaterialPad1;
 	UINT MaterialPad2;
 };
@@ -78,13 +78,8 @@ public:
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> CmdListAlloc;
 
     // We cannot update a cbuffer until the GPU is done processing the commands
-    // that reference it.  So each frame needs their own cbuffers.
-    std::unique_ptr<UploadBuffer<PassConstants>> PassCB = nullptr;
-    std::unique_ptr<UploadBuffer<ObjectConstants>> ObjectCB = nullptr;
-
-	std::unique_ptr<UploadBuffer<MaterialData>> MaterialBuffer = nullptr;
-
-    // Fence value to mark commands up to this fence point.  This lets us
-    // check if these frame resources are still in use by the GPU.
-    UINT64 Fence = 0;
+    // that reference it.  So each frame needs their own cbuffers.  The pass, object
+    // and material data are allocated from it each frame; reset it once the frame
+    // pacer hands this frame resource out again.
+    std::unique_ptr<LinearUploadAllocator> Uploads = nullptr;
 };
\ No newline at end of file
@@ -25,7 +25,7 @@ struct MaterialData
 	float    Roughness;
 	float4x4 MatTransform;
 	uint     DiffuseMapIndex;
-	uint     MatPad0;
+	uint     DiffuseMapSlice;
 	uint     MatPad1;
 	uint     MatPad2;
 };
@@ -33,7 +33,9 @@ struct MaterialData
 
 // An array of textures, which is only supported in shader model 5.1+.  Unlike Texture2DArray, the textures
 // in this array can be different sizes and formats, making it more flexible than texture arrays.
-Texture2D gDiffuseMap[4] : register(t0);
+// Each element is a texture page: the textures that share a format and size are packed into the
+// slices of one Texture2DArray, and a texture of its own is an array of one slice.
+Texture2DArray gDiffuseMap[4] : register(t0);
 
 // Put in space1, so the texture array does not overlap with these resources.  
 // The texture array will occupy registers t0, t1, ..., t3 in space0. 
@@ -131,9 +133,10 @@ float4 PS(VertexOut pin) : SV_Target
 	float3 fresnelR0 = matData.FresnelR0;
 	float  roughness = matData.Roughness;
 	uint diffuseTexIndex = matData.DiffuseMapIndex;
+	uint diffuseTexSlice = matData.DiffuseMapSlice;
 
 	// Dynamically look up the texture in the array.
-	diffuseAlbedo *= gDiffuseMap[diffuseTexIndex].Sample(gsamLinearWrap, pin.TexC);
+	diffuseAlbedo *= gDiffuseMap[diffuseTexIndex].Sample(gsamLinearWrap, float3(pin.TexC, diffuseTexSlice));
 	
     // Interpolating normal can unnormalize it, so renormalize it.
     pin.NormalW = normalize(pin.NormalW);
@@ -7,6 +7,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TransformStore.h"
+#include "../../Common/OcclusionCuller.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -50,6 +52,19 @@ struct RenderItem
 	BoundingBox Bounds;
 	std::vector<InstanceData> Instances;
 
+	// World, inverse-world and inverse-transpose matrices of each instance.  This
+	// is the authoritative copy of the instance world matrices.
+	TransformStore InstanceTransforms;
+
+	// Camera frustum in the local space of each instance, cached so that it is only
+	// re-transformed when the camera or the instance moves.
+	std::vector<BoundingFrustum> LocalFrusta;
+	std::vector<UINT> LocalFrustaVersion;
+
+	// Local space box used to rasterize an instance as an occluder.  It must lie
+	// inside the mesh, so it is smaller than Bounds.
+	BoundingBox OccluderBounds;
+
     // DrawIndexedInstanced parameters.
     UINT IndexCount = 0;
 	UINT InstanceCount = 0;
@@ -124,9 +139,22 @@ private:
 	UINT mInstanceCount = 0;
 
 	bool mFrustumCullingEnabled = true;
+	bool mOcclusionCullingEnabled = true;
+
+	// Number of nearest frustum-visible instances rasterized as occluders each frame.
+	UINT mMaxOccluders = 16;
+
+	OcclusionCuller mOcclusionCuller;
+
+	// Local space box inside the skull mesh, computed when the mesh is loaded.
+	BoundingBox mSkullOccluderBounds;
 
 	BoundingFrustum mCamFrustum;
 
+	// View matrix the cached local-space frusta were built with.
+	XMFLOAT4X4 mLocalFrustaView = MathHelper::Identity4x4();
+	bool mLocalFrustaDirty = true;
+
     PassConstants mMainPassCB;
 
 	Camera mCamera;
@@ -210,6 +238,7 @@ void InstancingAndCullingApp::OnResize()
 	mCamera.SetLens(0.25f*MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
 
 	BoundingFrustum::CreateFromMatrix(mCamFrustum, mCamera.GetProj());
+	mLocalFrustaDirty = true;
 }
 
 void InstancingAndCullingApp::Update(const GameTimer& gt)
@@ -222,13 +251,7 @@ void InstancingAndCullingApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateInstanceData(gt);
@@ -337,24 +360,30 @@ void InstancingAndCullingApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(20.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-20.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-20.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(20.0f*dt);
 
-	if(GetAsyncKeyState('1') & 0x8000)
+	if(IsKeyDown('1'))
 		mFrustumCullingEnabled = true;
 
-	if(GetAsyncKeyState('2') & 0x8000)
+	if(IsKeyDown('2'))
 		mFrustumCullingEnabled = false;
 
+	if(IsKeyDown('3'))
+		mOcclusionCullingEnabled = true;
+
+	if(IsKeyDown('4'))
+		mOcclusionCullingEnabled = false;
+
 	mCamera.UpdateViewMatrix();
 }
  
@@ -365,41 +394,107 @@ void InstancingAndCullingApp::AnimateMaterials(const GameTimer& gt)
 
 void InstancingAndCullingApp::UpdateInstanceData(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateInstanceData");
+
 	XMMATRIX view = mCamera.GetView();
 	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
 
+	XMFLOAT4X4 viewProj;
+	XMStoreFloat4x4(&viewProj, XMMatrixMultiply(view, mCamera.GetProj()));
+
+	// The cached local-space frusta are all stale if the camera moved.
+	XMFLOAT4X4 view4x4f = mCamera.GetView4x4f();
+	if(memcmp(&view4x4f, &mLocalFrustaView, sizeof(XMFLOAT4X4)) != 0)
+	{
+		mLocalFrustaView = view4x4f;
+		mLocalFrustaDirty = true;
+	}
+
+	// Transform the camera frustum from view space to world space once; each instance
+	// then only needs its (precomputed) inverse world matrix.
+	BoundingFrustum worldSpaceFrustum;
+	mCamFrustum.Transform(worldSpaceFrustum, invView);
+
+	XMVECTOR eyePos = mCamera.GetPosition();
+
 	auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
 	for(auto& e : mAllRitems)
 	{
 		const auto& instanceData = e->Instances;
+		auto& transforms = e->InstanceTransforms;
 
-		int visibleInstanceCount = 0;
+		// Only recomputes the inverses of the instances that moved.
+		transforms.Update();
 
-		for(UINT i = 0; i < (UINT)instanceData.size(); ++i)
-		{
-			XMMATRIX world = XMLoadFloat4x4(&instanceData[i].World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&instanceData[i].TexTransform);
+		e->LocalFrusta.resize(transforms.Size());
+		e->LocalFrustaVersion.resize(transforms.Size(), (UINT)-1);
 
-			XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(world), world);
+		// Instances that pass the frustum test.
+		std::vector<UINT> frustumVisible;
+		frustumVisible.reserve(instanceData.size());
 
-			// View space to the object's local space.
-			XMMATRIX viewToLocal = XMMatrixMultiply(invView, invWorld);
- 
-			// Transform the camera frustum from view space to the object's local space.
-			BoundingFrustum localSpaceFrustum;
-			mCamFrustum.Transform(localSpaceFrustum, viewToLocal);
+		for(UINT i = 0; i < (UINT)instanceData.size(); ++i)
+		{
+			// Transform the camera frustum from world space to the object's local space.
+			BoundingFrustum& localSpaceFrustum = e->LocalFrusta[i];
+			if(mLocalFrustaDirty || e->LocalFrustaVersion[i] != transforms.Version(i))
+			{
+				worldSpaceFrustum.Transform(localSpaceFrustum, transforms.GetInvWorld(i));
+				e->LocalFrustaVersion[i] = transforms.Version(i);
+			}
 
 			// Perform the box/frustum intersection test in local space.
 			if((localSpaceFrustum.Contains(e->Bounds) != DirectX::DISJOINT) || (mFrustumCullingEnabled==false))
+				frustumVisible.push_back(i);
+		}
+
+		if(mOcclusionCullingEnabled)
+		{
+			mOcclusionCuller.BeginFrame(viewProj);
+
+			// Use the instances nearest to the camera as occluders.
+			std::vector<std::pair<float, UINT>> occluders;
+			occluders.reserve(frustumVisible.size());
+			for(UINT i : frustumVisible)
 			{
-				InstanceData data;
-				XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
-				XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
-				data.MaterialIndex = instanceData[i].MaterialIndex;
+				XMVECTOR pos = transforms.GetWorld(i).r[3];
+				float distSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(pos, eyePos)));
+				occluders.push_back(std::make_pair(distSq, i));
+			}
 
-				// Write the instance data to structured buffer for the visible objects.
-				currInstanceBuffer->CopyData(visibleInstanceCount++, data);
+			UINT occluderCount = std::min(mMaxOccluders, (UINT)occluders.size());
+			std::partial_sort(occluders.begin(), occluders.begin() + occluderCount, occluders.end());
+
+			for(UINT k = 0; k < occluderCount; ++k)
+			{
+				UINT i = occluders[k].second;
+				mOcclusionCuller.RasterizeOccluderBox(
+					e->OccluderBounds.Center, e->OccluderBounds.Extents, transforms.World4x4f(i));
 			}
+
+			mOcclusionCuller.BuildHiZ();
+		}
+
+		int visibleInstanceCount = 0;
+
+		for(UINT i : frustumVisible)
+		{
+			if(mOcclusionCullingEnabled &&
+			   !mOcclusionCuller.IsVisible(e->Bounds.Center, e->Bounds.Extents, transforms.World4x4f(i)))
+			{
+				continue;
+			}
+
+			XMMATRIX world = transforms.GetWorld(i);
+			XMMATRIX texTransform = XMLoadFloat4x4(&instanceData[i].TexTransform);
+
+			InstanceData data;
+			XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
+			data.MaterialIndex = instanceData[i].MaterialIndex;
+
+			// Write the instance data to structured buffer for the visible objects.
+			currInstanceBuffer->CopyData(visibleInstanceCount++, data);
 		}
 
 		e->InstanceCount = visibleInstanceCount;
@@ -409,8 +504,12 @@ void InstancingAndCullingApp::UpdateInstanceData(const GameTimer& gt)
 		outs << L"Instancing and Culling Demo" <<
 			L"    " << e->InstanceCount <<
 			L" objects visible out of " << e->Instances.size();
+		if(mOcclusionCullingEnabled)
+			outs << L" (" << mOcclusionCuller.NumOccluded() << L" occluded)";
 		mMainWndCaption = outs.str();
 	}
+
+	mLocalFrustaDirty = false;
 }
 
 void InstancingAndCullingApp::UpdateMaterialBuffer(const GameTimer& gt)
@@ -739,6 +838,16 @@ void InstancingAndCullingApp::BuildSkullGeometry()
 
 	fin.close();
 
+	// The skull does not fill its bounding box, so occlude with a box found inside
+	// the mesh.  If there is none, the skull never occludes.
+	static_assert(sizeof(std::int32_t) == sizeof(OcclusionCuller::uint32), "index size");
+	mSkullOccluderBounds.Center = bounds.Center;
+	mSkullOccluderBounds.Extents = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	OcclusionCuller::ComputeInteriorBox(
+		&vertices[0].Pos, sizeof(Vertex), (UINT)vertices.size(),
+		reinterpret_cast<const OcclusionCuller::uint32*>(indices.data()), (UINT)indices.size(),
+		mSkullOccluderBounds.Center, mSkullOccluderBounds.Extents);
+
 	//
 	// Pack the indices of all the meshes into one index buffer.
 	//
@@ -902,6 +1011,8 @@ void InstancingAndCullingApp::BuildRenderItems()
 	skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
 	skullRitem->Bounds = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
+	skullRitem->OccluderBounds = mSkullOccluderBounds;
+
 	// Generate instance data.
 	const int n = 5;
 	mInstanceCount = n*n*n;
@@ -938,6 +1049,10 @@ void InstancingAndCullingApp::BuildRenderItems()
 		}
 	}
 
+	skullRitem->InstanceTransforms.Reserve(mInstanceCount);
+	for(UINT i = 0; i < mInstanceCount; ++i)
+		skullRitem->InstanceTransforms.Add(skullRitem->Instances[i].World);
+
 
 	mAllRitems.push_back(std::move(skullRitem));
 	
@@ -7,6 +7,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TransformStore.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -29,10 +30,10 @@ struct RenderItem
 
 	BoundingBox Bounds;
  
-    // World matrix of the shape that describes the object's local space
-    // relative to the world space, which defines the position, orientation,
-    // and scale of the object in the world.
-    XMFLOAT4X4 World = MathHelper::Identity4x4();
+    // Index into the TransformStore holding the world matrix of the shape that
+    // describes the object's local space relative to the world space, which defines
+    // the position, orientation, and scale of the object in the world.
+    UINT TransformIndex = 0;
 
 	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
@@ -129,6 +130,9 @@ private:
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+	// World matrices of the render items along with their cached inverses.
+	TransformStore mTransforms;
+
 	RenderItem* mPickedRitem = nullptr;
 
     PassConstants mMainPassCB;
@@ -227,15 +231,10 @@ void PickingApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
+	mTransforms.Update();
 	UpdateObjectCBs(gt);
 	UpdateMaterialBuffer(gt);
 	UpdateMainPassCB(gt);
@@ -354,16 +353,16 @@ void PickingApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(10.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-10.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-10.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(10.0f*dt);
 
 	mCamera.UpdateViewMatrix();
@@ -376,6 +375,8 @@ void PickingApp::AnimateMaterials(const GameTimer& gt)
 
 void PickingApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -383,7 +384,7 @@ void PickingApp::UpdateObjectCBs(const GameTimer& gt)
 		// This needs to be tracked per frame resource.
 		if(e->NumFramesDirty > 0)
 		{
-			XMMATRIX world = XMLoadFloat4x4(&e->World);
+			XMMATRIX world = mTransforms.GetWorld(e->TransformIndex);
 			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
 
 			ObjectConstants objConstants;
@@ -750,7 +751,9 @@ void PickingApp::BuildMaterials()
 void PickingApp::BuildRenderItems()
 {
 	auto carRitem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&carRitem->World, XMMatrixScaling(1.0f, 1.0f, 1.0f)*XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+	XMFLOAT4X4 carWorld;
+	XMStoreFloat4x4(&carWorld, XMMatrixScaling(1.0f, 1.0f, 1.0f)*XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+	carRitem->TransformIndex = mTransforms.Add(carWorld);
 	XMStoreFloat4x4(&carRitem->TexTransform, XMMatrixScaling(1.0f, 1.0f, 1.0f));
 	carRitem->ObjCBIndex = 0;
 	carRitem->Mat = mMaterials["gray0"].get();
@@ -763,7 +766,7 @@ void PickingApp::BuildRenderItems()
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(carRitem.get());
 
 	auto pickedRitem = std::make_unique<RenderItem>();
-	pickedRitem->World = MathHelper::Identity4x4();
+	pickedRitem->TransformIndex = mTransforms.Add(MathHelper::Identity4x4());
 	pickedRitem->TexTransform = MathHelper::Identity4x4();
 	pickedRitem->ObjCBIndex = 1;
 	pickedRitem->Mat = mMaterials["highlight0"].get();
@@ -877,12 +880,15 @@ void PickingApp::Pick(int sx, int sy)
 	float vy = (-2.0f*sy / mClientHeight + 1.0f) / P(1, 1);
 
 	// Ray definition in view space.
-	XMVECTOR rayOrigin = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	XMVECTOR rayDir = XMVectorSet(vx, vy, 1.0f, 0.0f);
+	XMVECTOR rayOriginV = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+	XMVECTOR rayDirV = XMVectorSet(vx, vy, 1.0f, 0.0f);
 	
 	XMMATRIX V = mCamera.GetView();
 	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(V), V);
 
+	// Make sure the cached inverse world matrices are current.
+	mTransforms.Update();
+
 	// Assume nothing is picked to start, so the picked render-item is invisible.
 	mPickedRitem->Visible = false;
 
@@ -896,14 +902,13 @@ void PickingApp::Pick(int sx, int sy)
 		if(ri->Visible == false)
 			continue;
 
-		XMMATRIX W = XMLoadFloat4x4(&ri->World);
-		XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(W), W);
+		XMMATRIX invWorld = mTransforms.GetInvWorld(ri->TransformIndex);
 
 		// Tranform ray to vi space of Mesh.
 		XMMATRIX toLocal = XMMatrixMultiply(invView, invWorld);
 
-		rayOrigin = XMVector3TransformCoord(rayOrigin, toLocal);
-		rayDir = XMVector3TransformNormal(rayDir, toLocal);
+		XMVECTOR rayOrigin = XMVector3TransformCoord(rayOriginV, toLocal);
+		XMVECTOR rayDir = XMVector3TransformNormal(rayDirV, toLocal);
 
 		// Make the ray direction unit length for the intersection tests.
 		rayDir = XMVector3Normalize(rayDir);
@@ -951,7 +956,7 @@ void PickingApp::Pick(int sx, int sy)
 						mPickedRitem->BaseVertexLocation = 0;
 
 						// Picked render item needs same world matrix as object picked.
-						mPickedRitem->World = ri->World;
+						mTransforms.SetWorld(mPickedRitem->TransformIndex, mTransforms.World4x4f(ri->TransformIndex));
 						mPickedRitem->NumFramesDirty = gNumFrameResources;
 
 						// Offset to the picked triangle in the mesh index buffer.
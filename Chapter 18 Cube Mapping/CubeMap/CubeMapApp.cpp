@@ -7,6 +7,13 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/DirtyTracker.h"
+#include "../../Common/DrawList.h"
+#include "../../Common/CommandStateCache.h"
+#include "../../Common/InstanceBatcher.h"
+#include "../../Common/UploadRing.h"
+#include "../../Common/MipStreamer.h"
+#include "../../Common/TextureStreamingDevice.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -32,13 +39,9 @@ struct RenderItem
 
 	XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
 
-	// Dirty flag indicating the object data has changed and we need to update the constant buffer.
-	// Because we have an object cbuffer for each FrameResource, we have to apply the
-	// update to each FrameResource.  Thus, when we modify obect data we should set 
-	// NumFramesDirty = gNumFrameResources so that each frame resource gets the update.
-	int NumFramesDirty = gNumFrameResources;
-
 	// Index into GPU constant buffer corresponding to the ObjectCB for this render item.
+	// When we modify object data we call mObjectCBDirty.MarkDirty(ObjCBIndex) and
+	// mInstanceSlots.MarkDirty(ObjCBIndex) so that each frame resource gets the update.
 	UINT ObjCBIndex = -1;
 
 	Material* Mat = nullptr;
@@ -84,6 +87,9 @@ private:
 	void UpdateObjectCBs(const GameTimer& gt);
 	void UpdateMaterialBuffer(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
+	void BuildDrawList();
+	void BuildInstanceBatches();
+	void UploadInstances();
 
 	void LoadTextures();
     void BuildRootSignature();
@@ -95,7 +101,7 @@ private:
     void BuildFrameResources();
     void BuildMaterials();
     void BuildRenderItems();
-    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
+    void DrawRenderItems(ID3D12GraphicsCommandList* cmdList);
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 
@@ -127,6 +133,52 @@ private:
 
 	UINT mSkyTexHeapIndex = 0;
 
+	// The sky cube map is streamed: only its coarsest mips are loaded at startup and
+	// the finer ones are brought in as the view needs them.  Its SRV alternates
+	// between two heap slots, so mSkyTexHeapIndex is refreshed every frame.
+	std::unique_ptr<DirectX::DDSTextureData12> mSkyTextureData;
+	UINT64 mSkyFaceSize = 0;
+	UINT mSkyStreamId = 0;
+
+	std::unique_ptr<UploadRing> mUploadRing;
+	std::unique_ptr<TextureStreamingDevice> mTextureStreaming;
+	std::unique_ptr<MipStreamer> mMipStreamer;
+
+	// Per frame resource lists of the object constants and materials that need to be
+	// rewritten, indexed by ObjCBIndex and MatCBIndex.
+	DirtyTracker mObjectCBDirty{ gNumFrameResources };
+	DirtyTracker mMaterialDirty{ gNumFrameResources };
+
+	std::vector<RenderItem*> mRitemsByObjCBIndex;
+	std::vector<Material*> mMaterialsByMatCBIndex;
+
+	// Scratch space so that each dirty run is written with one copy.
+	std::vector<BYTE> mObjectCBStaging;
+	std::vector<MaterialData> mMaterialStaging;
+
+	// Render items of all layers sorted by state and depth.  The entries of the draw
+	// list index into mDrawItems.
+	DrawList mDrawList;
+	std::vector<RenderItem*> mDrawItems;
+	DrawIdTable<ID3D12PipelineState> mPsoIds;
+	DrawIdTable<MeshGeometry> mGeometryIds;
+
+	// PSO used to draw each render layer.
+	ID3D12PipelineState* mLayerPSOs[(int)RenderLayer::Count] = { nullptr };
+
+	// Items of the instanced layers that share geometry and PSO are merged into one
+	// instanced draw.  The sky is a single item drawn with its own shader, so it
+	// keeps using the object constant buffer.
+	bool mInstancedLayer[(int)RenderLayer::Count] = { true, false };
+	InstanceBatcher mBatcher;
+	std::vector<InstanceData> mInstanceStaging;
+
+	// The instance buffer of each frame resource is only rewritten where it is out of
+	// date.  Items are identified by ObjCBIndex; mInstanceObjCBIndices holds the item of
+	// each instance in batch order.
+	InstanceSlotTracker mInstanceSlots{ gNumFrameResources };
+	std::vector<UINT> mInstanceObjCBIndices;
+
     PassConstants mMainPassCB;
 
 	Camera mCamera;
@@ -164,6 +216,9 @@ CubeMapApp::CubeMapApp(HINSTANCE hInstance)
 
 CubeMapApp::~CubeMapApp()
 {
+    // The streamed textures are released with the app, so the GPU must be done.
+    if(md3dDevice != nullptr)
+        FlushCommandQueue();
 }
 
 bool CubeMapApp::Initialize()
@@ -179,6 +234,8 @@ bool CubeMapApp::Initialize()
     mCbvSrvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
 	mCamera.SetPosition(0.0f, 2.0f, -15.0f);
+
+	mUploadRing = std::make_unique<UploadRing>(md3dDevice.Get(), 8 * 1024 * 1024);
  
 	LoadTextures();
     BuildRootSignature();
@@ -199,6 +256,9 @@ bool CubeMapApp::Initialize()
     // Wait until initialization is complete.
     FlushCommandQueue();
 
+    mUploadRing->FinishFrame(mCurrentFence);
+    mUploadRing->ReleaseCompleted(mFence->GetCompletedValue());
+
     return true;
 }
  
@@ -219,18 +279,23 @@ void CubeMapApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
+
+	UINT64 completedFence = mFence->GetCompletedValue();
+	mUploadRing->ReleaseCompleted(completedFence);
+	mTextureStreaming->ReleaseCompleted(completedFence, *mMipStreamer);
+
+	// The sky fills the view and a cube face spans 90 degrees, so one face covers
+	// mClientHeight / tan(fovY/2) pixels vertically.
+	float skyFacePixels = mClientHeight / tanf(0.5f*mCamera.GetFovY());
+	mMipStreamer->RequestMip(mSkyStreamId, MipStreamer::ComputeRequestedMip((float)mSkyFaceSize, skyFacePixels));
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
 	UpdateMaterialBuffer(gt);
 	UpdateMainPassCB(gt);
+	BuildDrawList();
+	BuildInstanceBatches();
 }
 
 void CubeMapApp::Draw(const GameTimer& gt)
@@ -245,6 +310,11 @@ void CubeMapApp::Draw(const GameTimer& gt)
     // Reusing the command list reuses memory.
     ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque"].Get()));
 
+	// Record this frame's mip loads and evictions ahead of the draws that sample them.
+	mTextureStreaming->SetCommandList(mCommandList.Get());
+	mMipStreamer->Update(mCurrentFence + 1);
+	mSkyTexHeapIndex = mTextureStreaming->SrvHeapIndex(mSkyStreamId);
+
     mCommandList->RSSetViewports(1, &mScreenViewport);
     mCommandList->RSSetScissorRects(1, &mScissorRect);
 
@@ -286,10 +356,8 @@ void CubeMapApp::Draw(const GameTimer& gt)
     // The root signature knows how many descriptors are expected in the table.
 	mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
-
-	mCommandList->SetPipelineState(mPSOs["sky"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
+	// Draws the opaque items and then the sky, switching PSOs as needed.
+    DrawRenderItems(mCommandList.Get());
 
     // Indicate a state transition on the resource usage.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -313,6 +381,9 @@ void CubeMapApp::Draw(const GameTimer& gt)
     // Because we are on the GPU timeline, the new fence point won't be 
     // set until the GPU finishes processing all the commands prior to this Signal().
     mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+
+    mUploadRing->FinishFrame(mCurrentFence);
+    mTextureStreaming->FinishFrame(mCurrentFence);
 }
 
 void CubeMapApp::OnMouseDown(WPARAM btnState, int x, int y)
@@ -348,16 +419,16 @@ void CubeMapApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(10.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-10.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-10.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(10.0f*dt);
 
 	mCamera.UpdateViewMatrix();
@@ -370,54 +441,60 @@ void CubeMapApp::AnimateMaterials(const GameTimer& gt)
 
 void CubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
-	for(auto& e : mAllRitems)
+
+	// Only the render items whose constants have changed are visited, and each run of
+	// consecutive dirty items is written in one go.  The run is built with the 256 byte
+	// stride of the constant buffer so that it is a single contiguous copy.
+	const UINT stride = currObjectCB->ElementByteSize();
+	mObjectCBDirty.ConsumeDirtyRanges(mCurrFrameResourceIndex, [&](UINT first, UINT count)
 	{
-		// Only update the cbuffer data if the constants have changed.  
-		// This needs to be tracked per frame resource.
-		if(e->NumFramesDirty > 0)
+		mObjectCBStaging.resize(count*stride);
+		for(UINT i = 0; i < count; ++i)
 		{
+			RenderItem* e = mRitemsByObjCBIndex[first + i];
+
 			XMMATRIX world = XMLoadFloat4x4(&e->World);
 			XMMATRIX texTransform = XMLoadFloat4x4(&e->TexTransform);
 
-			ObjectConstants objConstants;
+			ObjectConstants& objConstants = *reinterpret_cast<ObjectConstants*>(&mObjectCBStaging[i*stride]);
 			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
 			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
 			objConstants.MaterialIndex = e->Mat->MatCBIndex;
-
-			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
-
-			// Next FrameResource need to be updated too.
-			e->NumFramesDirty--;
 		}
-	}
+
+		currObjectCB->CopyPaddedRange(first, mObjectCBStaging.data(), count);
+	});
 }
 
 void CubeMapApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
 	auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
-	for(auto& e : mMaterials)
+
+	// Only update the buffer data if the constants have changed.  If the buffer
+	// data changes, it needs to be updated for each FrameResource, which the
+	// DirtyTracker takes care of.
+	mMaterialDirty.ConsumeDirtyRanges(mCurrFrameResourceIndex, [&](UINT first, UINT count)
 	{
-		// Only update the cbuffer data if the constants have changed.  If the cbuffer
-		// data changes, it needs to be updated for each FrameResource.
-		Material* mat = e.second.get();
-		if(mat->NumFramesDirty > 0)
+		mMaterialStaging.resize(count);
+		for(UINT i = 0; i < count; ++i)
 		{
+			Material* mat = mMaterialsByMatCBIndex[first + i];
+
 			XMMATRIX matTransform = XMLoadFloat4x4(&mat->MatTransform);
 
-			MaterialData matData;
+			MaterialData& matData = mMaterialStaging[i];
 			matData.DiffuseAlbedo = mat->DiffuseAlbedo;
 			matData.FresnelR0 = mat->FresnelR0;
 			matData.Roughness = mat->Roughness;
 			XMStoreFloat4x4(&matData.MatTransform, XMMatrixTranspose(matTransform));
 			matData.DiffuseMapIndex = mat->DiffuseSrvHeapIndex;
-
-			currMaterialBuffer->CopyData(mat->MatCBIndex, matData);
-
-			// Next FrameResource need to be updated too.
-			mat->NumFramesDirty--;
 		}
-	}
+
+		currMaterialBuffer->CopyRange(first, mMaterialStaging.data(), count);
+	});
 }
 
 void CubeMapApp::UpdateMainPassCB(const GameTimer& gt)
@@ -455,22 +532,115 @@ void CubeMapApp::UpdateMainPassCB(const GameTimer& gt)
 	currPassCB->CopyData(0, mMainPassCB);
 }
 
+void CubeMapApp::BuildDrawList()
+{
+	XMMATRIX view = mCamera.GetView();
+
+	// Used to normalize the view depth for the sort key.
+	const float farZ = mCamera.GetFarZ();
+
+	mDrawList.Clear();
+	mDrawItems.clear();
+
+	for(int layer = 0; layer < (int)RenderLayer::Count; ++layer)
+	{
+		UINT psoId = mPsoIds.GetId(mLayerPSOs[layer]);
+
+		for(auto ri : mRitemLayer[layer])
+		{
+			// View depth of the object origin.
+			XMMATRIX world = XMLoadFloat4x4(&ri->World);
+			XMVECTOR posV = XMVector3TransformCoord(world.r[3], view);
+			float depth = XMVectorGetZ(posV) / farZ;
+
+			UINT64 key = DrawList::MakeKey(layer, psoId, ri->Mat->MatCBIndex, mGeometryIds.GetId(ri->Geo), depth);
+
+			mDrawList.Add(key, (UINT)mDrawItems.size());
+			mDrawItems.push_back(ri);
+		}
+	}
+
+	// Groups items by state and orders opaque items front-to-back within a group.
+	mDrawList.Sort();
+}
+
+void CubeMapApp::BuildInstanceBatches()
+{
+	mBatcher.Clear();
+
+	// The draw list is sorted, so the batches and the instances within each batch
+	// keep the state and front-to-back order.
+	for(const DrawList::Entry& e : mDrawList.Entries())
+	{
+		UINT layer = DrawList::LayerFromKey(e.Key);
+		if(!mInstancedLayer[layer])
+			continue;
+
+		RenderItem* ri = mDrawItems[e.Item];
+
+		InstanceBatcher::Key key;
+		key.Geometry = ri->Geo;
+		key.State = mLayerPSOs[layer];
+		key.Layer = layer;
+		key.Topology = ri->PrimitiveType;
+		key.IndexCount = ri->IndexCount;
+		key.StartIndexLocation = ri->StartIndexLocation;
+		key.BaseVertexLocation = ri->BaseVertexLocation;
+
+		mBatcher.Add(key, e.Item);
+	}
+
+	mBatcher.Build();
+
+	UploadInstances();
+}
+
+void CubeMapApp::UploadInstances()
+{
+	auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
+
+	// The instances are in batch order, which follows the depth order and changes as
+	// the camera moves.  Only the slots whose item changed or moved are rewritten, and
+	// each run of consecutive such slots is written in one go.
+	const auto& items = mBatcher.InstanceItems();
+	mInstanceObjCBIndices.resize(items.size());
+	for(size_t i = 0; i < items.size(); ++i)
+		mInstanceObjCBIndices[i] = mDrawItems[items[i]]->ObjCBIndex;
+
+	mInstanceSlots.ConsumeStaleRuns(mCurrFrameResourceIndex, mInstanceObjCBIndices, [&](UINT first, UINT count)
+	{
+		mInstanceStaging.resize(count);
+		for(UINT i = 0; i < count; ++i)
+		{
+			RenderItem* ri = mDrawItems[items[first + i]];
+
+			XMMATRIX world = XMLoadFloat4x4(&ri->World);
+			XMMATRIX texTransform = XMLoadFloat4x4(&ri->TexTransform);
+
+			InstanceData& data = mInstanceStaging[i];
+			XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
+			data.MaterialIndex = ri->Mat->MatCBIndex;
+		}
+
+		currInstanceBuffer->CopyRange((int)first, mInstanceStaging.data(), (int)count);
+	});
+}
+
 void CubeMapApp::LoadTextures()
 {
     std::vector<std::string> texNames =
     {
         "bricksDiffuseMap",
         "tileDiffuseMap",
-        "defaultDiffuseMap",
-        "skyCubeMap"
+        "defaultDiffuseMap"
     };
 
     std::vector<std::wstring> texFilenames =
     {
         L"../../Textures/bricks2.dds",
         L"../../Textures/tile.dds",
-        L"../../Textures/white1x1.dds",
-        L"../../Textures/grasscube1024.dds"
+        L"../../Textures/white1x1.dds"
     };
 
     for (int i = 0; i < (int)texNames.size(); ++i)
@@ -484,6 +654,12 @@ void CubeMapApp::LoadTextures()
 
         mTextures[texMap->Name] = std::move(texMap);
     }
+
+    // Only parsed here; BuildDescriptorHeaps creates it with its coarsest mips.
+    mSkyTextureData = std::make_unique<DirectX::DDSTextureData12>();
+    ThrowIfFailed(DirectX::LoadDDSTextureDataFromFile12(L"../../Textures/grasscube1024.dds",
+        *mSkyTextureData));
+    mSkyFaceSize = mSkyTextureData->Desc.Width;
 }
 
 void CubeMapApp::BuildRootSignature()
@@ -495,7 +671,7 @@ void CubeMapApp::BuildRootSignature()
 	texTable1.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 5, 1, 0);
 
     // Root parameter can be a table, root descriptor or root constants.
-    CD3DX12_ROOT_PARAMETER slotRootParameter[5];
+    CD3DX12_ROOT_PARAMETER slotRootParameter[6];
 
 	// Perfomance TIP: Order from most frequent to least frequent.
     slotRootParameter[0].InitAsConstantBufferView(0);
@@ -503,12 +679,13 @@ void CubeMapApp::BuildRootSignature()
     slotRootParameter[2].InitAsShaderResourceView(0, 1);
 	slotRootParameter[3].InitAsDescriptorTable(1, &texTable0, D3D12_SHADER_VISIBILITY_PIXEL);
 	slotRootParameter[4].InitAsDescriptorTable(1, &texTable1, D3D12_SHADER_VISIBILITY_PIXEL);
+	slotRootParameter[5].InitAsShaderResourceView(1, 1);
 
 
 	auto staticSamplers = GetStaticSamplers();
 
     // A root signature is an array of root parameters.
-	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(5, slotRootParameter,
+	CD3DX12_ROOT_SIGNATURE_DESC rootSigDesc(6, slotRootParameter,
 		(UINT)staticSamplers.size(), staticSamplers.data(),
 		D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
@@ -550,7 +727,6 @@ void CubeMapApp::BuildDescriptorHeaps()
 	auto bricksTex = mTextures["bricksDiffuseMap"]->Resource;
 	auto tileTex = mTextures["tileDiffuseMap"]->Resource;
 	auto whiteTex = mTextures["defaultDiffuseMap"]->Resource;
-	auto skyTex = mTextures["skyCubeMap"]->Resource;
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
@@ -575,17 +751,22 @@ void CubeMapApp::BuildDescriptorHeaps()
 	srvDesc.Texture2D.MipLevels = whiteTex->GetDesc().MipLevels;
 	md3dDevice->CreateShaderResourceView(whiteTex.Get(), &srvDesc, hDescriptor);
 
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvDescriptorSize);
+	// The sky cube map view alternates between descriptors 3 and 4.  Start with its
+	// four coarsest mips and let the streamer stay within 64 MB.
+	const UINT skyBaseMips = 4;
+	UINT skyNumMips = mSkyTextureData->Desc.MipLevels;
+	UINT skyFirstMip = skyNumMips > skyBaseMips ? skyNumMips - skyBaseMips : 0;
+
+	mTextureStreaming = std::make_unique<TextureStreamingDevice>(md3dDevice.Get(),
+		mSrvDescriptorHeap.Get(), mCbvSrvDescriptorSize, mUploadRing.get());
+	mSkyStreamId = mTextureStreaming->AddTexture(mCommandList.Get(),
+		std::move(mSkyTextureData), skyFirstMip, 3, 4);
 
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-	srvDesc.TextureCube.MostDetailedMip = 0;
-	srvDesc.TextureCube.MipLevels = skyTex->GetDesc().MipLevels;
-	srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-	srvDesc.Format = skyTex->GetDesc().Format;
-	md3dDevice->CreateShaderResourceView(skyTex.Get(), &srvDesc, hDescriptor);
+	mMipStreamer = std::make_unique<MipStreamer>(mTextureStreaming.get(), 64 * 1024 * 1024);
+	mMipStreamer->AddTexture(mTextureStreaming->MipSizes(mSkyStreamId),
+		skyNumMips - mTextureStreaming->FirstMip(mSkyStreamId));
 	
-	mSkyTexHeapIndex = 3;
+	mSkyTexHeapIndex = mTextureStreaming->SrvHeapIndex(mSkyStreamId);
 }
 
 void CubeMapApp::BuildShadersAndInputLayout()
@@ -596,8 +777,14 @@ void CubeMapApp::BuildShadersAndInputLayout()
 		NULL, NULL
 	};
 
-	mShaders["standardVS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "VS", "vs_5_1");
-	mShaders["opaquePS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "PS", "ps_5_1");
+	const D3D_SHADER_MACRO instancedDefines[] =
+	{
+		"INSTANCED", "1",
+		NULL, NULL
+	};
+
+	mShaders["standardVS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", instancedDefines, "VS", "vs_5_1");
+	mShaders["opaquePS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", instancedDefines, "PS", "ps_5_1");
 	
 	mShaders["skyVS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "VS", "vs_5_1");
 	mShaders["skyPS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "PS", "ps_5_1");
@@ -884,6 +1071,9 @@ void CubeMapApp::BuildPSOs()
 	};
 	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&skyPsoDesc, IID_PPV_ARGS(&mPSOs["sky"])));
 
+	mLayerPSOs[(int)RenderLayer::Opaque] = mPSOs["opaque"].Get();
+	mLayerPSOs[(int)RenderLayer::Sky] = mPSOs["sky"].Get();
+
 }
 
 void CubeMapApp::BuildFrameResources()
@@ -893,6 +1083,19 @@ void CubeMapApp::BuildFrameResources()
         mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
             1, (UINT)mAllRitems.size(), (UINT)mMaterials.size()));
     }
+
+	// Everything starts out dirty so that each frame resource gets the initial data.
+	mRitemsByObjCBIndex.resize(mAllRitems.size());
+	for(auto& e : mAllRitems)
+		mRitemsByObjCBIndex[e->ObjCBIndex] = e.get();
+
+	mMaterialsByMatCBIndex.resize(mMaterials.size());
+	for(auto& e : mMaterials)
+		mMaterialsByMatCBIndex[e.second->MatCBIndex] = e.second.get();
+
+	mObjectCBDirty.Resize((UINT)mRitemsByObjCBIndex.size());
+	mInstanceSlots.Resize((UINT)mRitemsByObjCBIndex.size());
+	mMaterialDirty.Resize((UINT)mMaterialsByMatCBIndex.size());
 }
 
 void CubeMapApp::BuildMaterials()
@@ -1069,27 +1272,65 @@ void CubeMapApp::BuildRenderItems()
 	}
 }
 
-void CubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
+void CubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList)
 {
     UINT objCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
  
 	auto objectCB = mCurrFrameResource->ObjectCB->Resource();
+	auto instanceBuffer = mCurrFrameResource->InstanceBuffer->Resource();
 
-    // For each render item...
-    for(size_t i = 0; i < ritems.size(); ++i)
-    {
-        auto ri = ritems[i];
+	// Only issue the binds whose value differs from what is already bound.
+	CommandStateCache<ID3D12GraphicsCommandList> state(cmdList);
 
-        cmdList->IASetVertexBuffers(0, 1, &ri->Geo->VertexBufferView());
-        cmdList->IASetIndexBuffer(&ri->Geo->IndexBufferView());
-        cmdList->IASetPrimitiveTopology(ri->PrimitiveType);
+	const auto& entries = mDrawList.Entries();
+	const auto& instanceItems = mBatcher.InstanceItems();
 
-        D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex*objCBByteSize;
+	size_t entry = 0;
+	for(UINT layer = 0; layer < (UINT)RenderLayer::Count; ++layer)
+	{
+		// One instanced draw per batch of this layer.
+		for(const auto& batch : mBatcher.Batches())
+		{
+			if(batch.BatchKey.Layer != layer)
+				continue;
 
-		cmdList->SetGraphicsRootConstantBufferView(0, objCBAddress);
+			// All the items of the batch share geometry and state, so take them from the first.
+			auto ri = mDrawItems[instanceItems[batch.FirstInstance]];
 
-        cmdList->DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
-    }
+			state.SetPipelineState(mLayerPSOs[layer]);
+			state.SetVertexBuffer(ri->Geo->VertexBufferView());
+			state.SetIndexBuffer(ri->Geo->IndexBufferView());
+			state.SetPrimitiveTopology(ri->PrimitiveType);
+
+			// Point the instance buffer at the first instance of the batch.
+			D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = instanceBuffer->GetGPUVirtualAddress() +
+				batch.FirstInstance*sizeof(InstanceData);
+
+			state.SetGraphicsRootShaderResourceView(5, instanceAddress);
+
+			state.DrawIndexedInstanced(ri->IndexCount, batch.InstanceCount, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+		}
+
+		// The draw list is sorted by layer, so the remaining items of this layer come next.
+		for(; entry < entries.size() && DrawList::LayerFromKey(entries[entry].Key) == layer; ++entry)
+		{
+			if(mInstancedLayer[layer])
+				continue;
+
+			auto ri = mDrawItems[entries[entry].Item];
+
+			state.SetPipelineState(mLayerPSOs[layer]);
+			state.SetVertexBuffer(ri->Geo->VertexBufferView());
+			state.SetIndexBuffer(ri->Geo->IndexBufferView());
+			state.SetPrimitiveTopology(ri->PrimitiveType);
+
+			D3D12_GPU_VIRTUAL_ADDRESS objCBAddress = objectCB->GetGPUVirtualAddress() + ri->ObjCBIndex*objCBByteSize;
+
+			state.SetGraphicsRootConstantBufferView(0, objCBAddress);
+
+			state.DrawIndexedInstanced(ri->IndexCount, 1, ri->StartIndexLocation, ri->BaseVertexLocation, 0);
+		}
+	}
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> CubeMapApp::GetStaticSamplers()
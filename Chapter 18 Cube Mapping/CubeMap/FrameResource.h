@@ -14,6 +14,17 @@ struct ObjectConstants
 	UINT     ObjPad2;
 };
 
+// Per-instance data of an instanced batch; same layout as ObjectConstants.
+struct InstanceData
+{
+	DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
+	DirectX::XMFLOAT4X4 TexTransform = MathHelper::Identity4x4();
+	UINT MaterialIndex;
+	UINT InstancePad0;
+	UINT InstancePad1;
+	UINT InstancePad2;
+};
+
 struct PassConstants
 {
     DirectX::XMFLOAT4X4 View = MathHelper::Identity4x4();
@@ -84,6 +95,9 @@ public:
 
 	std::unique_ptr<UploadBuffer<MaterialData>> MaterialBuffer = nullptr;
 
+	// Per-object data of the instanced batches, one element per object.
+	std::unique_ptr<UploadBuffer<InstanceData>> InstanceBuffer = nullptr;
+
     // Fence value to mark commands up to this fence point.  This lets us
     // check if these frame resources are still in use by the GPU.
     UINT64 Fence = 0;
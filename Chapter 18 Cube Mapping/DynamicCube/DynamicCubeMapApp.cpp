@@ -7,6 +7,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/D3DFrameGraph.h"
 #include "FrameResource.h"
 #include "CubeRenderTarget.h"
 
@@ -94,7 +95,7 @@ private:
 	void LoadTextures();
     void BuildRootSignature();
 	void BuildDescriptorHeaps();
-	void BuildCubeDepthStencil();
+	void BuildFrameGraph();
     void BuildShadersAndInputLayout();
 	void BuildSkullGeometry();
     void BuildShapeGeometry();
@@ -104,6 +105,7 @@ private:
     void BuildRenderItems();
     void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
 	void DrawSceneToCubeMap();
+	void DrawMainPass();
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
 	void BuildCubeFaceCamera(float x, float y, float z);
@@ -118,8 +120,6 @@ private:
 
 	ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
 
-	ComPtr<ID3D12Resource> mCubeDepthStencilBuffer;
-
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
 	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
@@ -142,6 +142,11 @@ private:
 	std::unique_ptr<CubeRenderTarget> mDynamicCubeMap = nullptr;
 	CD3DX12_CPU_DESCRIPTOR_HANDLE mCubeDSV;
 
+	// The cube map pass and the main pass.  The cube depth buffer is only used by the
+	// cube map pass, so it is a transient resource of the graph.
+	std::unique_ptr<D3DFrameGraph> mFrameGraph;
+	D3DFrameGraph::ResourceId mBackBufferResource = 0;
+
     PassConstants mMainPassCB;
 
 	Camera mCamera;
@@ -202,7 +207,7 @@ bool DynamicCubeMapApp::Initialize()
 	LoadTextures();
     BuildRootSignature();
 	BuildDescriptorHeaps();
-	BuildCubeDepthStencil();
+	BuildFrameGraph();
     BuildShadersAndInputLayout();
 	BuildSkullGeometry();
     BuildShapeGeometry();
@@ -276,13 +281,7 @@ void DynamicCubeMapApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
 
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
@@ -326,44 +325,9 @@ void DynamicCubeMapApp::Draw(const GameTimer& gt)
 	// The root signature knows how many descriptors are expected in the table.
 	mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
-	DrawSceneToCubeMap();
- 
-    mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
-
-    // Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
-
-    // Clear the back buffer and depth buffer.
-    mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
-
-    // Specify the buffers we are going to render to.
-    mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
-
-	auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
-
-
-	// Use the dynamic cube map for the dynamic reflectors layer.
-	CD3DX12_GPU_DESCRIPTOR_HANDLE dynamicTexDescriptor(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-	dynamicTexDescriptor.Offset(mSkyTexHeapIndex + 1, mCbvSrvUavDescriptorSize);
-	mCommandList->SetGraphicsRootDescriptorTable(3, dynamicTexDescriptor);
-
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors]);
-
-	// Use the static "background" cube map for the other objects (including the sky)
-	mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
-
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
-
-	mCommandList->SetPipelineState(mPSOs["sky"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
-
-    // Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+	// Records the cube map pass and the main pass, and the transitions between them.
+	mFrameGraph->SetResource(mBackBufferResource, CurrentBackBuffer());
+	mFrameGraph->Record(mCommandList.Get());
 
     // Done recording commands.
     ThrowIfFailed(mCommandList->Close());
@@ -418,16 +382,16 @@ void DynamicCubeMapApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(10.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-10.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-10.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(10.0f*dt);
 
 	mCamera.UpdateViewMatrix();
@@ -440,6 +404,8 @@ void DynamicCubeMapApp::AnimateMaterials(const GameTimer& gt)
 
 void DynamicCubeMapApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -709,9 +675,16 @@ void DynamicCubeMapApp::BuildDescriptorHeaps()
 		cubeRtvHandles);
 }
 
-void DynamicCubeMapApp::BuildCubeDepthStencil()
+void DynamicCubeMapApp::BuildFrameGraph()
 {
-	// Create the depth/stencil buffer and view.
+	mFrameGraph = std::make_unique<D3DFrameGraph>(md3dDevice.Get());
+	auto& graph = mFrameGraph->Graph();
+
+	auto cubeMap = mFrameGraph->Import("cubeMap", mDynamicCubeMap->Resource(), D3D12_RESOURCE_STATE_GENERIC_READ);
+	mBackBufferResource = mFrameGraph->Import("backBuffer", nullptr, D3D12_RESOURCE_STATE_PRESENT);
+	graph.MarkOutput(mBackBufferResource);
+
+	// The depth/stencil buffer of the cube map pass.
 	D3D12_RESOURCE_DESC depthStencilDesc;
 	depthStencilDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
 	depthStencilDesc.Alignment = 0;
@@ -729,20 +702,31 @@ void DynamicCubeMapApp::BuildCubeDepthStencil()
 	optClear.Format = mDepthStencilFormat;
 	optClear.DepthStencil.Depth = 1.0f;
 	optClear.DepthStencil.Stencil = 0;
-	ThrowIfFailed(md3dDevice->CreateCommittedResource(
-		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-		D3D12_HEAP_FLAG_NONE,
-		&depthStencilDesc,
-		D3D12_RESOURCE_STATE_COMMON,
-		&optClear,
-		IID_PPV_ARGS(mCubeDepthStencilBuffer.GetAddressOf())));
+	auto cubeDepthStencil = mFrameGraph->CreateTexture("cubeDepthStencil", depthStencilDesc, &optClear);
+
+	auto cubePass = mFrameGraph->AddPass("cubeMap", [this](ID3D12GraphicsCommandList*)
+	{
+		DrawSceneToCubeMap();
+	});
+	graph.Write(cubePass, cubeMap, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	graph.Write(cubePass, cubeDepthStencil, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+	auto mainPass = mFrameGraph->AddPass("main", [this](ID3D12GraphicsCommandList*)
+	{
+		DrawMainPass();
+	});
+	graph.Read(mainPass, cubeMap, D3D12_RESOURCE_STATE_GENERIC_READ);
+	graph.Write(mainPass, mBackBufferResource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+	// Places the cube depth buffer; it is created in DEPTH_WRITE, its only state.
+	mFrameGraph->Compile();
 
 	// Create descriptor to mip level 0 of entire resource using the format of the resource.
-	md3dDevice->CreateDepthStencilView(mCubeDepthStencilBuffer.Get(), nullptr, mCubeDSV);
+	md3dDevice->CreateDepthStencilView(mFrameGraph->Resource(cubeDepthStencil), nullptr, mCubeDSV);
 
-	// Transition the resource from its initial state to be used as a depth buffer.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mCubeDepthStencilBuffer.Get(),
-		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+#if defined(DEBUG) || defined(_DEBUG)
+	OutputDebugStringA(mFrameGraph->DumpSchedule().c_str());
+#endif
 }
 
 void DynamicCubeMapApp::BuildShadersAndInputLayout()
@@ -1265,15 +1249,44 @@ void DynamicCubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, cons
     }
 }
 
+void DynamicCubeMapApp::DrawMainPass()
+{
+    mCommandList->RSSetViewports(1, &mScreenViewport);
+    mCommandList->RSSetScissorRects(1, &mScissorRect);
+
+    // Clear the back buffer and depth buffer.
+    mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
+    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+
+    // Specify the buffers we are going to render to.
+    mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+
+	auto passCB = mCurrFrameResource->PassCB->Resource();
+	mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
+
+	// Use the dynamic cube map for the dynamic reflectors layer.
+	CD3DX12_GPU_DESCRIPTOR_HANDLE dynamicTexDescriptor(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	dynamicTexDescriptor.Offset(mSkyTexHeapIndex + 1, mCbvSrvUavDescriptorSize);
+	mCommandList->SetGraphicsRootDescriptorTable(3, dynamicTexDescriptor);
+
+	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors]);
+
+	// Use the static "background" cube map for the other objects (including the sky)
+	CD3DX12_GPU_DESCRIPTOR_HANDLE skyTexDescriptor(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+	skyTexDescriptor.Offset(mSkyTexHeapIndex, mCbvSrvUavDescriptorSize);
+	mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
+
+	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+
+	mCommandList->SetPipelineState(mPSOs["sky"].Get());
+	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
+}
+
 void DynamicCubeMapApp::DrawSceneToCubeMap()
 {
 	mCommandList->RSSetViewports(1, &mDynamicCubeMap->Viewport());
 	mCommandList->RSSetScissorRects(1, &mDynamicCubeMap->ScissorRect());
 
-	// Change to RENDER_TARGET.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mDynamicCubeMap->Resource(),
-		D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET));
-
 	UINT passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
 
 	// For each cube map face.
@@ -1299,10 +1312,6 @@ void DynamicCubeMapApp::DrawSceneToCubeMap()
 
 		mCommandList->SetPipelineState(mPSOs["opaque"].Get());
 	}
-
-	// Change back to GENERIC_READ so we can read the texture in a shader.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mDynamicCubeMap->Resource(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
 }
 
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> DynamicCubeMapApp::GetStaticSamplers()
@@ -1,10 +1,14 @@
 #include "FrameResource.h"
 
-FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount)
+FrameResource::FrameResource(ID3D12Device* device, UINT passCount, UINT objectCount, UINT materialCount, UINT threadCount)
 {
-    ThrowIfFailed(device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-		IID_PPV_ARGS(CmdListAlloc.GetAddressOf())));
+    CmdListAllocs.resize(threadCount);
+    for(auto& cmdListAlloc : CmdListAllocs)
+    {
+        ThrowIfFailed(device->CreateCommandAllocator(
+            D3D12_COMMAND_LIST_TYPE_DIRECT,
+            IID_PPV_ARGS(cmdListAlloc.GetAddressOf())));
+    }
 
     PassCB = std::make_unique<UploadBuffer<PassConstants>>(device, passCount, true);
     SsaoCB = std::make_unique<UploadBuffer<SsaoConstants>>(device, 1, true);
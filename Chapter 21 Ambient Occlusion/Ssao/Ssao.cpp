@@ -81,6 +81,11 @@ ID3D12Resource* Ssao::AmbientMap()
     return mAmbientMap0.Get();
 }
 
+ID3D12Resource* Ssao::AmbientMap1()
+{
+    return mAmbientMap1.Get();
+}
+
 CD3DX12_CPU_DESCRIPTOR_HANDLE Ssao::NormalMapRtv()const
 {
     return mhNormalMapCpuRtv;
@@ -186,19 +191,10 @@ void Ssao::OnResize(UINT newWidth, UINT newHeight)
     }
 }
 
-void Ssao::ComputeSsao(
-    ID3D12GraphicsCommandList* cmdList,
-    FrameResource* currFrame, 
-    int blurCount)
+void Ssao::DrawAmbientMap(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame)
 {
 	cmdList->RSSetViewports(1, &mViewport);
     cmdList->RSSetScissorRects(1, &mScissorRect);
-
-	// We compute the initial SSAO to AmbientMap0.
-
-    // Change to RENDER_TARGET.
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mAmbientMap0.Get(),
-        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET));
   
 	float clearValue[] = {1.0f, 1.0f, 1.0f, 1.0f};
     cmdList->ClearRenderTargetView(mhAmbientMap0CpuRtv, clearValue, 0, nullptr);
@@ -224,61 +220,38 @@ void Ssao::ComputeSsao(
     cmdList->IASetIndexBuffer(nullptr);
     cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(6, 1, 0, 0);
-   
-	// Change back to GENERIC_READ so we can read the texture in a shader.
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mAmbientMap0.Get(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
-
-    BlurAmbientMap(cmdList, currFrame, blurCount);
 }
  
-void Ssao::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame, int blurCount)
+void Ssao::DrawBlur(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame, bool horzBlur)
 {
+	CD3DX12_GPU_DESCRIPTOR_HANDLE inputSrv;
+	CD3DX12_CPU_DESCRIPTOR_HANDLE outputRtv;
+
+	cmdList->RSSetViewports(1, &mViewport);
+    cmdList->RSSetScissorRects(1, &mScissorRect);
+
     cmdList->SetPipelineState(mBlurPso);
 
     auto ssaoCBAddress = currFrame->SsaoCB->Resource()->GetGPUVirtualAddress();
     cmdList->SetGraphicsRootConstantBufferView(0, ssaoCBAddress);
- 
-    for(int i = 0; i < blurCount; ++i)
-    {
-        BlurAmbientMap(cmdList, true);
-        BlurAmbientMap(cmdList, false);
-    }
-}
-
-void Ssao::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, bool horzBlur)
-{
-	ID3D12Resource* output = nullptr;
-	CD3DX12_GPU_DESCRIPTOR_HANDLE inputSrv;
-	CD3DX12_CPU_DESCRIPTOR_HANDLE outputRtv;
 	
-	// Ping-pong the two ambient map textures as we apply
-	// horizontal and vertical blur passes.
 	if(horzBlur == true)
 	{
-		output = mAmbientMap1.Get();
 		inputSrv = mhAmbientMap0GpuSrv;
 		outputRtv = mhAmbientMap1CpuRtv;
         cmdList->SetGraphicsRoot32BitConstant(1, 1, 0);
 	}
 	else
 	{
-		output = mAmbientMap0.Get();
 		inputSrv = mhAmbientMap1GpuSrv;
 		outputRtv = mhAmbientMap0CpuRtv;
         cmdList->SetGraphicsRoot32BitConstant(1, 0, 0);
 	}
- 
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(output,
-        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
 	float clearValue[] = { 1.0f, 1.0f, 1.0f, 1.0f };
     cmdList->ClearRenderTargetView(outputRtv, clearValue, 0, nullptr);
  
     cmdList->OMSetRenderTargets(1, &outputRtv, true, nullptr);
-	
-    // Normal/depth map still bound.
-
 
     // Bind the normal and depth maps.
     cmdList->SetGraphicsRootDescriptorTable(2, mhNormalMapGpuSrv);
@@ -291,9 +264,6 @@ void Ssao::BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, bool horzBlur)
     cmdList->IASetIndexBuffer(nullptr);
     cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	cmdList->DrawInstanced(6, 1, 0, 0);
-   
-    cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(output,
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
 }
  
 void Ssao::BuildResources()
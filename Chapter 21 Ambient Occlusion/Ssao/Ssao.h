@@ -36,6 +36,9 @@ public:
 
 	ID3D12Resource* NormalMap();
 	ID3D12Resource* AmbientMap();
+
+    // Intermediate map of the blur passes.
+    ID3D12Resource* AmbientMap1();
 	
     CD3DX12_CPU_DESCRIPTOR_HANDLE NormalMapRtv()const;
 	CD3DX12_GPU_DESCRIPTOR_HANDLE NormalMapSrv()const;
@@ -60,25 +63,20 @@ public:
   
     ///<summary>
     /// Changes the render target to the Ambient render target and draws a fullscreen
-    /// quad to kick off the pixel shader to compute the AmbientMap.  We still keep the
-    /// main depth buffer binded to the pipeline, but depth buffer read/writes
-    /// are disabled, as we do not need the depth buffer computing the Ambient map.
+    /// quad to kick off the pixel shader to compute the AmbientMap.  DrawBlur then
+    /// applies one direction of an edge preserving blur, which smooths out the noise
+    /// caused by only taking a few random samples per pixel.
+    ///
+    /// The caller schedules the resource barriers (SsaoApp does it with a frame graph).
+    /// DrawAmbientMap writes AmbientMap; a horizontal blur reads AmbientMap and
+    /// writes AmbientMap1, a vertical blur the reverse.  Both read the normal and
+    /// depth maps.
     ///</summary>
-	void ComputeSsao(
-        ID3D12GraphicsCommandList* cmdList, 
-        FrameResource* currFrame, 
-        int blurCount);
+    void DrawAmbientMap(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame);
+    void DrawBlur(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame, bool horzBlur);
  
 
 private:
- 
-    ///<summary>
-    /// Blurs the ambient map to smooth out the noise caused by only taking a
-    /// few random samples per pixel.  We use an edge preserving blur so that 
-    /// we do not blur across discontinuities--we want edges to remain edges.
-    ///</summary>
-    void BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, FrameResource* currFrame, int blurCount);
-	void BlurAmbientMap(ID3D12GraphicsCommandList* cmdList, bool horzBlur);
 
     void BuildResources();
     void BuildRandomVectorTexture(ID3D12GraphicsCommandList* cmdList);
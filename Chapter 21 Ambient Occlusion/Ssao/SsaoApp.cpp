@@ -7,6 +7,13 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/AsyncTextureLoader.h"
+#include "../../Common/UploadRing.h"
+#include "../../Common/ShaderBuildGraph.h"
+#include "../../Common/DescriptorAllocator.h"
+#include "../../Common/ParallelRecorder.h"
+#include "../../Common/D3DFrameGraph.h"
+#include "../../Common/GpuProfiler.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 #include "Ssao.h"
@@ -97,15 +104,22 @@ private:
     void BuildShapeGeometry();
     void BuildSkullGeometry();
     void BuildPSOs();
+	void BuildPSO(const std::string& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+		const std::string& vs, const std::string& ps);
     void BuildFrameResources();
+    void BuildPasses();
+    void BuildFrameGraph();
+    void UpdateFrameGraphResources();
+    ParallelRecorder::PassId AddPass(const std::string& name,
+        std::function<void(ID3D12GraphicsCommandList*)> record);
     void BuildMaterials();
     void BuildRenderItems();
     void DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems);
-    void DrawSceneToShadowMap();
-	void DrawNormalsAndDepth();
+    void DrawSceneToShadowMap(ID3D12GraphicsCommandList* cmdList);
+	void DrawNormalsAndDepth(ID3D12GraphicsCommandList* cmdList);
+	void DrawMainPass(ID3D12GraphicsCommandList* cmdList);
 
-    CD3DX12_CPU_DESCRIPTOR_HANDLE GetCpuSrv(int index)const;
-    CD3DX12_GPU_DESCRIPTOR_HANDLE GetGpuSrv(int index)const;
+    void BuildSceneSrvs();
     CD3DX12_CPU_DESCRIPTOR_HANDLE GetDsv(int index)const;
     CD3DX12_CPU_DESCRIPTOR_HANDLE GetRtv(int index)const;
 
@@ -120,12 +134,17 @@ private:
     ComPtr<ID3D12RootSignature> mRootSignature = nullptr;
     ComPtr<ID3D12RootSignature> mSsaoRootSignature = nullptr;
 
-	ComPtr<ID3D12DescriptorHeap> mSrvDescriptorHeap = nullptr;
+	// Shader visible SRV heap.  Textures and the views owned by ShadowMap and Ssao are
+	// persistent; the sky/shadow/ambient table of the main pass is written every frame.
+	std::unique_ptr<DescriptorAllocator> mSrvAllocator;
 
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
 	std::unordered_map<std::string, std::unique_ptr<Material>> mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> mTextures;
-	std::unordered_map<std::string, ComPtr<ID3DBlob>> mShaders;
+	// The shaders compile on mShaderBuild while the rest of the scene is built, and each
+	// PSO is created as soon as its shaders are ready.  Both go away after Initialize.
+	std::unique_ptr<ShaderBuildGraph> mShaderBuild;
+	std::unordered_map<std::string, ShaderBuildGraph::ShaderFuture> mShaders;
 	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> mPSOs;
 
     std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
@@ -136,16 +155,41 @@ private:
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
-	UINT mSkyTexHeapIndex = 0;
-    UINT mShadowMapHeapIndex = 0;
-    UINT mSsaoHeapIndexStart = 0;
-    UINT mSsaoAmbientMapIndex = 0;
-
-    UINT mNullCubeSrvIndex = 0;
-    UINT mNullTexSrvIndex1 = 0;
-    UINT mNullTexSrvIndex2 = 0;
-
-    CD3DX12_GPU_DESCRIPTOR_HANDLE mNullSrv;
+    // gTextureMaps[10], indexed by Material::DiffuseSrvHeapIndex/NormalSrvHeapIndex.
+    DescriptorRange mTextureSrvs;
+    DescriptorRange mShadowMapSrv;
+    DescriptorRange mSsaoSrvs;
+
+    // Null cube and 2D views bound to the scene table during the shadow pass.
+    DescriptorRange mNullSrvs;
+
+    // The main pass scene table: sky cube map, shadow map and ambient map.
+    DescriptorRange mSceneSrvs;
+    D3D12_SHADER_RESOURCE_VIEW_DESC mSkySrvDesc = {};
+
+    // One command list per pass, recorded on the worker threads of mPassRecorder
+    // with the allocators of the current frame resource.
+    std::vector<ComPtr<ID3D12GraphicsCommandList>> mPassCmdLists;
+    std::vector<ID3D12CommandList*> mSubmitCmdLists;
+    std::unique_ptr<ParallelRecorder> mPassRecorder;
+
+    // Declares what each pass reads and writes, and records the barriers between them.
+    std::unique_ptr<D3DFrameGraph> mFrameGraph;
+
+    // Times each pass on the GPU.  The queries are resolved on mResolveCmdList, which
+    // is submitted after the passes.
+    std::unique_ptr<GpuProfiler> mGpuProfiler;
+    ComPtr<ID3D12GraphicsCommandList> mResolveCmdList;
+    D3DFrameGraph::ResourceId mShadowMapResource = 0;
+    D3DFrameGraph::ResourceId mNormalMapResource = 0;
+    D3DFrameGraph::ResourceId mAmbientMap0Resource = 0;
+    D3DFrameGraph::ResourceId mAmbientMap1Resource = 0;
+    D3DFrameGraph::ResourceId mDepthResource = 0;
+    D3DFrameGraph::ResourceId mBackBufferResource = 0;
+    D3DFrameGraph::PassId mShadowPass = 0;
+    D3DFrameGraph::PassId mNormalsPass = 0;
+    std::vector<D3DFrameGraph::PassId> mSsaoPasses;
+    D3DFrameGraph::PassId mMainPass = 0;
 
     PassConstants mMainPassCB;  // index 0 of pass cbuffer.
     PassConstants mShadowPassCB;// index 1 of pass cbuffer.
@@ -156,6 +200,9 @@ private:
 
     std::unique_ptr<Ssao> mSsao;
 
+    // Staging memory for all texture and geometry uploads.
+    std::unique_ptr<UploadRing> mUploadRing;
+
     DirectX::BoundingSphere mSceneBounds;
 
     float mLightNearZ = 0.0f;
@@ -234,17 +281,30 @@ bool SsaoApp::Initialize()
         mCommandList.Get(),
         mClientWidth, mClientHeight);
 
+    mUploadRing = std::make_unique<UploadRing>(md3dDevice.Get(), 32 * 1024 * 1024);
+
+    // There are only a handful of passes to record, so more threads would sit idle.
+    UINT numRecordThreads = std::thread::hardware_concurrency();
+    if(numRecordThreads == 0 || numRecordThreads > 4)
+        numRecordThreads = 4;
+    mPassRecorder = std::make_unique<ParallelRecorder>(numRecordThreads);
+
+    mGpuProfiler = std::make_unique<GpuProfiler>(md3dDevice.Get(), mCommandQueue.Get(),
+        mProfiler, gNumFrameResources);
+
+    BuildShadersAndInputLayout();
 	LoadTextures();
     BuildRootSignature();
     BuildSsaoRootSignature();
 	BuildDescriptorHeaps();
-    BuildShadersAndInputLayout();
     BuildShapeGeometry();
     BuildSkullGeometry();
 	BuildMaterials();
     BuildRenderItems();
     BuildFrameResources();
     BuildPSOs();
+    BuildFrameGraph();
+    BuildPasses();
 
     mSsao->SetPSOs(mPSOs["ssao"].Get(), mPSOs["ssaoBlur"].Get());
 
@@ -256,6 +316,10 @@ bool SsaoApp::Initialize()
     // Wait until initialization is complete.
     FlushCommandQueue();
 
+    // The initialization uploads have been consumed.
+    mUploadRing->FinishFrame(mCurrentFence);
+    mUploadRing->ReleaseCompleted(mFence->GetCompletedValue());
+
     return true;
 }
 
@@ -292,7 +356,15 @@ void SsaoApp::OnResize()
 
         // Resources changed, so need to rebuild descriptors.
         mSsao->RebuildDescriptors(mDepthStencilBuffer.Get());
+
+        // The scene table views the new ambient map.  D3DApp::OnResize flushed the
+        // queue, so no frame in flight still reads the old views.
+        if(mSceneSrvs.IsValid())
+            BuildSceneSrvs();
     }
+
+    if(mFrameGraph != nullptr)
+        UpdateFrameGraphResources();
 }
 
 void SsaoApp::Update(const GameTimer& gt)
@@ -305,13 +377,11 @@ void SsaoApp::Update(const GameTimer& gt)
 
     // Has the GPU finished processing the commands of the current frame resource?
     // If not, wait until the GPU has completed commands up to this fence point.
-    if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-    {
-        HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-        WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-    }
+    WaitForFence(mCurrFrameResource->Fence);
+
+    mUploadRing->ReleaseCompleted(mFence->GetCompletedValue());
+    mSrvAllocator->ReleaseCompleted(mFence->GetCompletedValue());
+    mGpuProfiler->BeginFrame(mCurrFrameResourceIndex);
 
     //
     // Animate the lights (and hence shadows).
@@ -338,119 +408,27 @@ void SsaoApp::Update(const GameTimer& gt)
 
 void SsaoApp::Draw(const GameTimer& gt)
 {
-    auto cmdListAlloc = mCurrFrameResource->CmdListAlloc;
-
     // Reuse the memory associated with command recording.
     // We can only reset when the associated command lists have finished execution on the GPU.
-    ThrowIfFailed(cmdListAlloc->Reset());
-
-    // A command list can be reset after it has been added to the command queue via ExecuteCommandList.
-    // Reusing the command list reuses memory.
-    ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque"].Get()));
-
-    ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvDescriptorHeap.Get() };
-    mCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
-
-    mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
-
-	//
-	// Shadow map pass.
-	//
-
-    // Bind all the materials used in this scene.  For structured buffers, we can bypass the heap and 
-    // set as a root descriptor.
-    auto matBuffer = mCurrFrameResource->MaterialBuffer->Resource();
-    mCommandList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
-	
-    // Bind null SRV for shadow map pass.
-    mCommandList->SetGraphicsRootDescriptorTable(3, mNullSrv);	 
+    for(auto& cmdListAlloc : mCurrFrameResource->CmdListAllocs)
+        ThrowIfFailed(cmdListAlloc->Reset());
 
-    // Bind all the textures used in this scene.  Observe
-    // that we only have to specify the first descriptor in the table.  
-    // The root signature knows how many descriptors are expected in the table.
-    mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
+    mFrameGraph->SetResource(mBackBufferResource, CurrentBackBuffer());
 
-    DrawSceneToShadowMap();
+    // Record the passes in parallel, each into its own command list.
+    mSubmitCmdLists.clear();
+    for(ParallelRecorder::PassId pass : mPassRecorder->Record())
+        mSubmitCmdLists.push_back(mPassCmdLists[pass].Get());
 
-	//
-	// Normal/depth pass.
-	//
-	
-	DrawNormalsAndDepth();
-	
-	//
-	// Compute SSAO.
-	// 
-	
-    mCommandList->SetGraphicsRootSignature(mSsaoRootSignature.Get());
-    mSsao->ComputeSsao(mCommandList.Get(), mCurrFrameResource, 3);
-	
-	//
-	// Main rendering pass.
-	//
-	
-    mCommandList->SetGraphicsRootSignature(mRootSignature.Get());
-
-    // Rebind state whenever graphics root signature changes.
-
-    // Bind all the materials used in this scene.  For structured buffers, we can bypass the heap and 
-    // set as a root descriptor.
-    matBuffer = mCurrFrameResource->MaterialBuffer->Resource();
-    mCommandList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
+    // The recorder is done with the allocators, so the first one records the resolve
+    // of the pass timings.
+    ThrowIfFailed(mResolveCmdList->Reset(mCurrFrameResource->CmdListAllocs[0].Get(), nullptr));
+    mGpuProfiler->EndFrame(mResolveCmdList.Get());
+    ThrowIfFailed(mResolveCmdList->Close());
+    mSubmitCmdLists.push_back(mResolveCmdList.Get());
 
-
-    mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
-
-    // Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
-
-    // Clear the back buffer.
-    mCommandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-
-    // WE ALREADY WROTE THE DEPTH INFO TO THE DEPTH BUFFER IN DrawNormalsAndDepth,
-    // SO DO NOT CLEAR DEPTH.
-
-    // Specify the buffers we are going to render to.
-    mCommandList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
-
-	// Bind all the textures used in this scene.  Observe
-    // that we only have to specify the first descriptor in the table.  
-    // The root signature knows how many descriptors are expected in the table.
-    mCommandList->SetGraphicsRootDescriptorTable(4, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-	
-    auto passCB = mCurrFrameResource->PassCB->Resource();
-	mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
-
-    // Bind the sky cube map.  For our demos, we just use one "world" cube map representing the environment
-    // from far away, so all objects will use the same cube map and we only need to set it once per-frame.  
-    // If we wanted to use "local" cube maps, we would have to change them per-object, or dynamically
-    // index into an array of cube maps.
-
-    CD3DX12_GPU_DESCRIPTOR_HANDLE skyTexDescriptor(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-    skyTexDescriptor.Offset(mSkyTexHeapIndex, mCbvSrvUavDescriptorSize);
-    mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
-
-    mCommandList->SetPipelineState(mPSOs["opaque"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
-
-    mCommandList->SetPipelineState(mPSOs["debug"].Get());
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Debug]);
-
-	mCommandList->SetPipelineState(mPSOs["sky"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
-
-    // Indicate a state transition on the resource usage.
-	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
-		D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
-
-    // Done recording commands.
-    ThrowIfFailed(mCommandList->Close());
-
-    // Add the command list to the queue for execution.
-    ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
-    mCommandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
+    // Add the command lists to the queue for execution, in dependency order.
+    mCommandQueue->ExecuteCommandLists((UINT)mSubmitCmdLists.size(), mSubmitCmdLists.data());
 
     // Swap the back and front buffers
     ThrowIfFailed(mSwapChain->Present(0, 0));
@@ -463,6 +441,10 @@ void SsaoApp::Draw(const GameTimer& gt)
     // Because we are on the GPU timeline, the new fence point won't be 
     // set until the GPU finishes processing all the commands prior to this Signal().
     mCommandQueue->Signal(mFence.Get(), mCurrentFence);
+
+    // Uploads and transient descriptors of this frame are done once the GPU reaches this fence.
+    mUploadRing->FinishFrame(mCurrentFence);
+    mSrvAllocator->FinishFrame(mCurrentFence);
 }
 
 void SsaoApp::OnMouseDown(WPARAM btnState, int x, int y)
@@ -498,16 +480,16 @@ void SsaoApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState('W') & 0x8000)
+	if(IsKeyDown('W'))
 		mCamera.Walk(10.0f*dt);
 
-	if(GetAsyncKeyState('S') & 0x8000)
+	if(IsKeyDown('S'))
 		mCamera.Walk(-10.0f*dt);
 
-	if(GetAsyncKeyState('A') & 0x8000)
+	if(IsKeyDown('A'))
 		mCamera.Strafe(-10.0f*dt);
 
-	if(GetAsyncKeyState('D') & 0x8000)
+	if(IsKeyDown('D'))
 		mCamera.Strafe(10.0f*dt);
 
 	mCamera.UpdateViewMatrix();
@@ -520,6 +502,8 @@ void SsaoApp::AnimateMaterials(const GameTimer& gt)
 
 void SsaoApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -747,14 +731,24 @@ void SsaoApp::LoadTextures()
         L"../../Textures/sunsetcube1024.dds"
     };
 	
+	// Read and parse all the files on worker threads up front; only the resource
+	// creation and upload recording below is serialized on this thread.  tile.dds and
+	// bricks2_nmap.dds are stored without mips, so the workers also build their chains.
+	AsyncTextureLoader loader;
+	TextureProcessor::Options processing;
+	std::vector<std::future<AsyncTextureLoader::LoadResult>> loads;
+	for(const auto& filename : texFilenames)
+		loads.push_back(loader.Load(filename, processing));
+
 	for(int i = 0; i < (int)texNames.size(); ++i)
 	{
+		AsyncTextureLoader::LoadResult result = loads[i].get();
+		ThrowIfFailed(result.Status);
+
 		auto texMap = std::make_unique<Texture>();
 		texMap->Name = texNames[i];
 		texMap->Filename = texFilenames[i];
-		ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(md3dDevice.Get(),
-			mCommandList.Get(), texMap->Filename.c_str(),
-			texMap->Resource, texMap->UploadHeap));
+		texMap->Resource = mUploadRing->CreateTexture(mCommandList.Get(), *result.Data);
 			
 		mTextures[texMap->Name] = std::move(texMap);
 	}		
@@ -803,6 +797,7 @@ void SsaoApp::BuildRootSignature()
         serializedRootSig->GetBufferPointer(),
         serializedRootSig->GetBufferSize(),
         IID_PPV_ARGS(mRootSignature.GetAddressOf())));
+    mPsoCache->RegisterRootSignature(mRootSignature.Get(), serializedRootSig.Get());
 }
 
 void SsaoApp::BuildSsaoRootSignature()
@@ -881,24 +876,27 @@ void SsaoApp::BuildSsaoRootSignature()
         serializedRootSig->GetBufferPointer(),
         serializedRootSig->GetBufferSize(),
         IID_PPV_ARGS(mSsaoRootSignature.GetAddressOf())));
+    mPsoCache->RegisterRootSignature(mSsaoRootSignature.Get(), serializedRootSig.Get());
 }
 
 void SsaoApp::BuildDescriptorHeaps()
 {
 	//
-	// Create the SRV heap.
+	// Create the SRV heap.  Every view lives as long as the demo, so it has no
+	// transient part.
 	//
-	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-	srvHeapDesc.NumDescriptors = 18;
-	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvDescriptorHeap)));
+	mSrvAllocator = std::make_unique<DescriptorAllocator>(md3dDevice.Get(),
+		D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 32, 0);
+
+	mTextureSrvs = mSrvAllocator->AllocatePersistent(10);
+	mShadowMapSrv = mSrvAllocator->AllocatePersistent(1);
+	mSsaoSrvs = mSrvAllocator->AllocatePersistent(5);
+	mNullSrvs = mSrvAllocator->AllocatePersistent(3);
+	mSceneSrvs = mSrvAllocator->AllocatePersistent(3);
 
 	//
 	// Fill out the heap with actual descriptors.
 	//
-	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
 	std::vector<ComPtr<ID3D12Resource>> tex2DList = 
 	{
 		mTextures["bricksDiffuseMap"]->Resource,
@@ -921,55 +919,65 @@ void SsaoApp::BuildDescriptorHeaps()
 	{
 		srvDesc.Format = tex2DList[i]->GetDesc().Format;
 		srvDesc.Texture2D.MipLevels = tex2DList[i]->GetDesc().MipLevels;
-		md3dDevice->CreateShaderResourceView(tex2DList[i].Get(), &srvDesc, hDescriptor);
-
-		// next descriptor
-		hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
+		md3dDevice->CreateShaderResourceView(tex2DList[i].Get(), &srvDesc, mTextureSrvs.Cpu(i));
 	}
-	
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-	srvDesc.TextureCube.MostDetailedMip = 0;
-	srvDesc.TextureCube.MipLevels = skyCubeMap->GetDesc().MipLevels;
-	srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
-	srvDesc.Format = skyCubeMap->GetDesc().Format;
-	md3dDevice->CreateShaderResourceView(skyCubeMap.Get(), &srvDesc, hDescriptor);
-	
-	mSkyTexHeapIndex = (UINT)tex2DList.size();
-    mShadowMapHeapIndex = mSkyTexHeapIndex + 1;
-    mSsaoHeapIndexStart = mShadowMapHeapIndex + 1;
-    mSsaoAmbientMapIndex = mSsaoHeapIndexStart + 3;
-    mNullCubeSrvIndex = mSsaoHeapIndexStart + 5;
-    mNullTexSrvIndex1 = mNullCubeSrvIndex + 1;
-    mNullTexSrvIndex2 = mNullTexSrvIndex1 + 1;
 
-    auto nullSrv = GetCpuSrv(mNullCubeSrvIndex);
-    mNullSrv = GetGpuSrv(mNullCubeSrvIndex);
+	// The sky view goes into the scene table, see BuildSceneSrvs.
+	mSkySrvDesc = srvDesc;
+	mSkySrvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+	mSkySrvDesc.TextureCube.MostDetailedMip = 0;
+	mSkySrvDesc.TextureCube.MipLevels = skyCubeMap->GetDesc().MipLevels;
+	mSkySrvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+	mSkySrvDesc.Format = skyCubeMap->GetDesc().Format;
 
-    md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, nullSrv);
-    nullSrv.Offset(1, mCbvSrvUavDescriptorSize);
+    md3dDevice->CreateShaderResourceView(nullptr, &mSkySrvDesc, mNullSrvs.Cpu(0));
 
     srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
     srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     srvDesc.Texture2D.MostDetailedMip = 0;
     srvDesc.Texture2D.MipLevels = 1;
     srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-    md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, nullSrv);
+    md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, mNullSrvs.Cpu(1));
+    md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, mNullSrvs.Cpu(2));
 
-    nullSrv.Offset(1, mCbvSrvUavDescriptorSize);
-    md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, nullSrv);
+    // Unused texture slots still need a valid view.
+    for(UINT i = (UINT)tex2DList.size(); i < mTextureSrvs.Count; ++i)
+        md3dDevice->CreateShaderResourceView(nullptr, &srvDesc, mTextureSrvs.Cpu(i));
 
     mShadowMap->BuildDescriptors(
-        GetCpuSrv(mShadowMapHeapIndex),
-        GetGpuSrv(mShadowMapHeapIndex),
+        mShadowMapSrv.Cpu(),
+        mShadowMapSrv.Gpu(),
         GetDsv(1));
 
     mSsao->BuildDescriptors(
         mDepthStencilBuffer.Get(),
-        GetCpuSrv(mSsaoHeapIndexStart),
-        GetGpuSrv(mSsaoHeapIndexStart),
+        mSsaoSrvs.Cpu(),
+        mSsaoSrvs.Gpu(),
         GetRtv(SwapChainBufferCount),
         mCbvSrvUavDescriptorSize,
         mRtvDescriptorSize);
+
+    BuildSceneSrvs();
+}
+
+void SsaoApp::BuildSceneSrvs()
+{
+    // t0 sky cube map, t1 shadow map, t2 ambient map.  Only the ambient map is ever
+    // recreated, by Ssao::OnResize, and OnResize then writes the table again.
+    md3dDevice->CreateShaderResourceView(mTextures["skyCubeMap"]->Resource.Get(), &mSkySrvDesc, mSceneSrvs.Cpu(0));
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = 1;
+    srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+
+    srvDesc.Format = DXGI_FORMAT_R24_UNORM_X8_TYPELESS;
+    md3dDevice->CreateShaderResourceView(mShadowMap->Resource(), &srvDesc, mSceneSrvs.Cpu(1));
+
+    srvDesc.Format = Ssao::AmbientMapFormat;
+    md3dDevice->CreateShaderResourceView(mSsao->AmbientMap(), &srvDesc, mSceneSrvs.Cpu(2));
 }
 
 void SsaoApp::BuildShadersAndInputLayout()
@@ -980,27 +988,29 @@ void SsaoApp::BuildShadersAndInputLayout()
 		NULL, NULL
 	};
 
-	mShaders["standardVS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "VS", "vs_5_1");
-	mShaders["opaquePS"] = d3dUtil::CompileShader(L"Shaders\\Default.hlsl", nullptr, "PS", "ps_5_1");
+	mShaderBuild = std::make_unique<ShaderBuildGraph>(&d3dUtil::GetShaderCache());
 
-    mShaders["shadowVS"] = d3dUtil::CompileShader(L"Shaders\\Shadows.hlsl", nullptr, "VS", "vs_5_1");
-    mShaders["shadowOpaquePS"] = d3dUtil::CompileShader(L"Shaders\\Shadows.hlsl", nullptr, "PS", "ps_5_1");
-    mShaders["shadowAlphaTestedPS"] = d3dUtil::CompileShader(L"Shaders\\Shadows.hlsl", alphaTestDefines, "PS", "ps_5_1");
+	mShaders["standardVS"] = mShaderBuild->AddShader("standardVS", d3dUtil::MakeShaderRequest(L"Shaders\\Default.hlsl", nullptr, "VS", "vs_5_1"));
+	mShaders["opaquePS"] = mShaderBuild->AddShader("opaquePS", d3dUtil::MakeShaderRequest(L"Shaders\\Default.hlsl", nullptr, "PS", "ps_5_1"));
+
+    mShaders["shadowVS"] = mShaderBuild->AddShader("shadowVS", d3dUtil::MakeShaderRequest(L"Shaders\\Shadows.hlsl", nullptr, "VS", "vs_5_1"));
+    mShaders["shadowOpaquePS"] = mShaderBuild->AddShader("shadowOpaquePS", d3dUtil::MakeShaderRequest(L"Shaders\\Shadows.hlsl", nullptr, "PS", "ps_5_1"));
+    mShaders["shadowAlphaTestedPS"] = mShaderBuild->AddShader("shadowAlphaTestedPS", d3dUtil::MakeShaderRequest(L"Shaders\\Shadows.hlsl", alphaTestDefines, "PS", "ps_5_1"));
 	
-    mShaders["debugVS"] = d3dUtil::CompileShader(L"Shaders\\ShadowDebug.hlsl", nullptr, "VS", "vs_5_1");
-    mShaders["debugPS"] = d3dUtil::CompileShader(L"Shaders\\ShadowDebug.hlsl", nullptr, "PS", "ps_5_1");
+    mShaders["debugVS"] = mShaderBuild->AddShader("debugVS", d3dUtil::MakeShaderRequest(L"Shaders\\ShadowDebug.hlsl", nullptr, "VS", "vs_5_1"));
+    mShaders["debugPS"] = mShaderBuild->AddShader("debugPS", d3dUtil::MakeShaderRequest(L"Shaders\\ShadowDebug.hlsl", nullptr, "PS", "ps_5_1"));
 
-    mShaders["drawNormalsVS"] = d3dUtil::CompileShader(L"Shaders\\DrawNormals.hlsl", nullptr, "VS", "vs_5_1");
-    mShaders["drawNormalsPS"] = d3dUtil::CompileShader(L"Shaders\\DrawNormals.hlsl", nullptr, "PS", "ps_5_1");
+    mShaders["drawNormalsVS"] = mShaderBuild->AddShader("drawNormalsVS", d3dUtil::MakeShaderRequest(L"Shaders\\DrawNormals.hlsl", nullptr, "VS", "vs_5_1"));
+    mShaders["drawNormalsPS"] = mShaderBuild->AddShader("drawNormalsPS", d3dUtil::MakeShaderRequest(L"Shaders\\DrawNormals.hlsl", nullptr, "PS", "ps_5_1"));
 
-    mShaders["ssaoVS"] = d3dUtil::CompileShader(L"Shaders\\Ssao.hlsl", nullptr, "VS", "vs_5_1");
-    mShaders["ssaoPS"] = d3dUtil::CompileShader(L"Shaders\\Ssao.hlsl", nullptr, "PS", "ps_5_1");
+    mShaders["ssaoVS"] = mShaderBuild->AddShader("ssaoVS", d3dUtil::MakeShaderRequest(L"Shaders\\Ssao.hlsl", nullptr, "VS", "vs_5_1"));
+    mShaders["ssaoPS"] = mShaderBuild->AddShader("ssaoPS", d3dUtil::MakeShaderRequest(L"Shaders\\Ssao.hlsl", nullptr, "PS", "ps_5_1"));
 
-    mShaders["ssaoBlurVS"] = d3dUtil::CompileShader(L"Shaders\\SsaoBlur.hlsl", nullptr, "VS", "vs_5_1");
-    mShaders["ssaoBlurPS"] = d3dUtil::CompileShader(L"Shaders\\SsaoBlur.hlsl", nullptr, "PS", "ps_5_1");
+    mShaders["ssaoBlurVS"] = mShaderBuild->AddShader("ssaoBlurVS", d3dUtil::MakeShaderRequest(L"Shaders\\SsaoBlur.hlsl", nullptr, "VS", "vs_5_1"));
+    mShaders["ssaoBlurPS"] = mShaderBuild->AddShader("ssaoBlurPS", d3dUtil::MakeShaderRequest(L"Shaders\\SsaoBlur.hlsl", nullptr, "PS", "ps_5_1"));
 
-	mShaders["skyVS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "VS", "vs_5_1");
-	mShaders["skyPS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "PS", "ps_5_1");
+	mShaders["skyVS"] = mShaderBuild->AddShader("skyVS", d3dUtil::MakeShaderRequest(L"Shaders\\Sky.hlsl", nullptr, "VS", "vs_5_1"));
+	mShaders["skyPS"] = mShaderBuild->AddShader("skyPS", d3dUtil::MakeShaderRequest(L"Shaders\\Sky.hlsl", nullptr, "PS", "ps_5_1"));
 
     mInputLayout =
     {
@@ -1138,11 +1148,11 @@ void SsaoApp::BuildShapeGeometry()
 	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
 	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+	geo->VertexBufferGPU = mUploadRing->CreateDefaultBuffer(mCommandList.Get(),
+		vertices.data(), vbByteSize);
 
-	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-		mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+	geo->IndexBufferGPU = mUploadRing->CreateDefaultBuffer(mCommandList.Get(),
+		indices.data(), ibByteSize);
 
 	geo->VertexByteStride = sizeof(Vertex);
 	geo->VertexBufferByteSize = vbByteSize;
@@ -1248,11 +1258,11 @@ void SsaoApp::BuildSkullGeometry()
     ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
     CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
-    geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+    geo->VertexBufferGPU = mUploadRing->CreateDefaultBuffer(mCommandList.Get(),
+        vertices.data(), vbByteSize);
 
-    geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-        mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+    geo->IndexBufferGPU = mUploadRing->CreateDefaultBuffer(mCommandList.Get(),
+        indices.data(), ibByteSize);
 
     geo->VertexByteStride = sizeof(Vertex);
     geo->VertexBufferByteSize = vbByteSize;
@@ -1278,16 +1288,6 @@ void SsaoApp::BuildPSOs()
     ZeroMemory(&basePsoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
     basePsoDesc.InputLayout = { mInputLayout.data(), (UINT)mInputLayout.size() };
     basePsoDesc.pRootSignature = mRootSignature.Get();
-    basePsoDesc.VS =
-	{ 
-		reinterpret_cast<BYTE*>(mShaders["standardVS"]->GetBufferPointer()), 
-		mShaders["standardVS"]->GetBufferSize()
-	};
-    basePsoDesc.PS =
-	{ 
-		reinterpret_cast<BYTE*>(mShaders["opaquePS"]->GetBufferPointer()),
-		mShaders["opaquePS"]->GetBufferSize()
-	};
     basePsoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     basePsoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
     basePsoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -1306,7 +1306,7 @@ void SsaoApp::BuildPSOs()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC opaquePsoDesc = basePsoDesc;
     opaquePsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_EQUAL;
     opaquePsoDesc.DepthStencilState.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ZERO;
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&opaquePsoDesc, IID_PPV_ARGS(&mPSOs["opaque"])));
+    BuildPSO("opaque", opaquePsoDesc, "standardVS", "opaquePS");
 
     //
     // PSO for shadow map pass.
@@ -1316,58 +1316,28 @@ void SsaoApp::BuildPSOs()
     smapPsoDesc.RasterizerState.DepthBiasClamp = 0.0f;
     smapPsoDesc.RasterizerState.SlopeScaledDepthBias = 1.0f;
     smapPsoDesc.pRootSignature = mRootSignature.Get();
-    smapPsoDesc.VS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["shadowVS"]->GetBufferPointer()),
-        mShaders["shadowVS"]->GetBufferSize()
-    };
-    smapPsoDesc.PS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["shadowOpaquePS"]->GetBufferPointer()),
-        mShaders["shadowOpaquePS"]->GetBufferSize()
-    };
     
     // Shadow map pass does not have a render target.
     smapPsoDesc.RTVFormats[0] = DXGI_FORMAT_UNKNOWN;
     smapPsoDesc.NumRenderTargets = 0;
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&smapPsoDesc, IID_PPV_ARGS(&mPSOs["shadow_opaque"])));
+    BuildPSO("shadow_opaque", smapPsoDesc, "shadowVS", "shadowOpaquePS");
 
     //
     // PSO for debug layer.
     //
     D3D12_GRAPHICS_PIPELINE_STATE_DESC debugPsoDesc = basePsoDesc;
     debugPsoDesc.pRootSignature = mRootSignature.Get();
-    debugPsoDesc.VS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["debugVS"]->GetBufferPointer()),
-        mShaders["debugVS"]->GetBufferSize()
-    };
-    debugPsoDesc.PS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["debugPS"]->GetBufferPointer()),
-        mShaders["debugPS"]->GetBufferSize()
-    };
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&debugPsoDesc, IID_PPV_ARGS(&mPSOs["debug"])));
+    BuildPSO("debug", debugPsoDesc, "debugVS", "debugPS");
 
     //
     // PSO for drawing normals.
     //
     D3D12_GRAPHICS_PIPELINE_STATE_DESC drawNormalsPsoDesc = basePsoDesc;
-    drawNormalsPsoDesc.VS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["drawNormalsVS"]->GetBufferPointer()),
-        mShaders["drawNormalsVS"]->GetBufferSize()
-    };
-    drawNormalsPsoDesc.PS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["drawNormalsPS"]->GetBufferPointer()),
-        mShaders["drawNormalsPS"]->GetBufferSize()
-    };
     drawNormalsPsoDesc.RTVFormats[0] = Ssao::NormalMapFormat;
     drawNormalsPsoDesc.SampleDesc.Count = 1;
     drawNormalsPsoDesc.SampleDesc.Quality = 0;
     drawNormalsPsoDesc.DSVFormat = mDepthStencilFormat;
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&drawNormalsPsoDesc, IID_PPV_ARGS(&mPSOs["drawNormals"])));
+    BuildPSO("drawNormals", drawNormalsPsoDesc, "drawNormalsVS", "drawNormalsPS");
 
     //
     // PSO for SSAO.
@@ -1375,16 +1345,6 @@ void SsaoApp::BuildPSOs()
     D3D12_GRAPHICS_PIPELINE_STATE_DESC ssaoPsoDesc = basePsoDesc;
     ssaoPsoDesc.InputLayout = { nullptr, 0 };
     ssaoPsoDesc.pRootSignature = mSsaoRootSignature.Get();
-    ssaoPsoDesc.VS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["ssaoVS"]->GetBufferPointer()),
-        mShaders["ssaoVS"]->GetBufferSize()
-    };
-    ssaoPsoDesc.PS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["ssaoPS"]->GetBufferPointer()),
-        mShaders["ssaoPS"]->GetBufferSize()
-    };
 
     // SSAO effect does not need the depth buffer.
     ssaoPsoDesc.DepthStencilState.DepthEnable = false;
@@ -1393,23 +1353,13 @@ void SsaoApp::BuildPSOs()
     ssaoPsoDesc.SampleDesc.Count = 1;
     ssaoPsoDesc.SampleDesc.Quality = 0;
     ssaoPsoDesc.DSVFormat = DXGI_FORMAT_UNKNOWN;
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&ssaoPsoDesc, IID_PPV_ARGS(&mPSOs["ssao"])));
+    BuildPSO("ssao", ssaoPsoDesc, "ssaoVS", "ssaoPS");
 
     //
     // PSO for SSAO blur.
     //
     D3D12_GRAPHICS_PIPELINE_STATE_DESC ssaoBlurPsoDesc = ssaoPsoDesc;
-    ssaoBlurPsoDesc.VS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["ssaoBlurVS"]->GetBufferPointer()),
-        mShaders["ssaoBlurVS"]->GetBufferSize()
-    };
-    ssaoBlurPsoDesc.PS =
-    {
-        reinterpret_cast<BYTE*>(mShaders["ssaoBlurPS"]->GetBufferPointer()),
-        mShaders["ssaoBlurPS"]->GetBufferSize()
-    };
-    ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&ssaoBlurPsoDesc, IID_PPV_ARGS(&mPSOs["ssaoBlur"])));
+    BuildPSO("ssaoBlur", ssaoBlurPsoDesc, "ssaoBlurVS", "ssaoBlurPS");
 
 	//
 	// PSO for sky.
@@ -1424,18 +1374,29 @@ void SsaoApp::BuildPSOs()
 	// fail the depth test if the depth buffer was cleared to 1.
 	skyPsoDesc.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_LESS_EQUAL;
 	skyPsoDesc.pRootSignature = mRootSignature.Get();
-	skyPsoDesc.VS =
-	{
-		reinterpret_cast<BYTE*>(mShaders["skyVS"]->GetBufferPointer()),
-		mShaders["skyVS"]->GetBufferSize()
-	};
-	skyPsoDesc.PS =
-	{
-		reinterpret_cast<BYTE*>(mShaders["skyPS"]->GetBufferPointer()),
-		mShaders["skyPS"]->GetBufferSize()
-	};
-	ThrowIfFailed(md3dDevice->CreateGraphicsPipelineState(&skyPsoDesc, IID_PPV_ARGS(&mPSOs["sky"])));
+	BuildPSO("sky", skyPsoDesc, "skyVS", "skyPS");
 
+	// Wait for the PSOs; the shaders are not needed after that.
+	mShaderBuild->Wait();
+	mShaderBuild = nullptr;
+	mShaders.clear();
+}
+
+void SsaoApp::BuildPSO(const std::string& name, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+	const std::string& vs, const std::string& ps)
+{
+	// The map entry is created here, on the main thread; the task only writes to it.
+	ComPtr<ID3D12PipelineState>* pso = &mPSOs[name];
+	ShaderBuildGraph::ShaderFuture vsFuture = mShaders[vs];
+	ShaderBuildGraph::ShaderFuture psFuture = mShaders[ps];
+
+	mShaderBuild->AddTask({ vs, ps }, [this, desc, vsFuture, psFuture, pso]()
+	{
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = desc;
+		psoDesc.VS = d3dUtil::ToShaderBytecode(*vsFuture.get());
+		psoDesc.PS = d3dUtil::ToShaderBytecode(*psFuture.get());
+		*pso = mPsoCache->GetGraphics(psoDesc);
+	});
 }
 
 void SsaoApp::BuildFrameResources()
@@ -1443,8 +1404,200 @@ void SsaoApp::BuildFrameResources()
     for(int i = 0; i < gNumFrameResources; ++i)
     {
         mFrameResources.push_back(std::make_unique<FrameResource>(md3dDevice.Get(),
-            2, (UINT)mAllRitems.size(), (UINT)mMaterials.size()));
+            2, (UINT)mAllRitems.size(), (UINT)mMaterials.size(), mPassRecorder->NumThreads()));
+    }
+}
+
+void SsaoApp::BuildFrameGraph()
+{
+    mFrameGraph = std::make_unique<D3DFrameGraph>(md3dDevice.Get());
+    auto& graph = mFrameGraph->Graph();
+
+    // The maps are owned by ShadowMap and Ssao and rest in GENERIC_READ between frames.
+    mShadowMapResource = mFrameGraph->Import("shadowMap", nullptr, D3D12_RESOURCE_STATE_GENERIC_READ);
+    mNormalMapResource = mFrameGraph->Import("normalMap", nullptr, D3D12_RESOURCE_STATE_GENERIC_READ);
+    mAmbientMap0Resource = mFrameGraph->Import("ambientMap0", nullptr, D3D12_RESOURCE_STATE_GENERIC_READ);
+    mAmbientMap1Resource = mFrameGraph->Import("ambientMap1", nullptr, D3D12_RESOURCE_STATE_GENERIC_READ);
+    mDepthResource = mFrameGraph->Import("depthStencil", nullptr, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    mBackBufferResource = mFrameGraph->Import("backBuffer", nullptr, D3D12_RESOURCE_STATE_PRESENT);
+    graph.MarkOutput(mBackBufferResource);
+    UpdateFrameGraphResources();
+
+    // Every pass may start a fresh command list, so each one binds the root signature
+    // and the scene resources it uses.
+    auto bindScene = [this](ID3D12GraphicsCommandList* cmdList, D3D12_GPU_DESCRIPTOR_HANDLE sceneTable)
+    {
+        cmdList->SetGraphicsRootSignature(mRootSignature.Get());
+
+        // Bind all the materials used in this scene.  For structured buffers, we can bypass the heap and 
+        // set as a root descriptor.
+        auto matBuffer = mCurrFrameResource->MaterialBuffer->Resource();
+        cmdList->SetGraphicsRootShaderResourceView(2, matBuffer->GetGPUVirtualAddress());
+
+        cmdList->SetGraphicsRootDescriptorTable(3, sceneTable);
+
+        // Bind all the textures used in this scene.  Observe
+        // that we only have to specify the first descriptor in the table.  
+        // The root signature knows how many descriptors are expected in the table.
+        cmdList->SetGraphicsRootDescriptorTable(4, mTextureSrvs.Gpu());
+    };
+
+    // The shadow and normal/depth passes bind null SRVs for the scene table.
+    mShadowPass = mFrameGraph->AddPass("shadow", [this, bindScene](ID3D12GraphicsCommandList* cmdList)
+    {
+        bindScene(cmdList, mNullSrvs.Gpu());
+        DrawSceneToShadowMap(cmdList);
+    });
+    graph.Write(mShadowPass, mShadowMapResource, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+    mNormalsPass = mFrameGraph->AddPass("normalsAndDepth", [this, bindScene](ID3D12GraphicsCommandList* cmdList)
+    {
+        bindScene(cmdList, mNullSrvs.Gpu());
+        DrawNormalsAndDepth(cmdList);
+    });
+    graph.Write(mNormalsPass, mNormalMapResource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    graph.Write(mNormalsPass, mDepthResource, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+
+    // SSAO and the blur sample the depth buffer, through the normal/depth map table.
+    const auto depthRead = D3D12_RESOURCE_STATE_DEPTH_READ | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+    auto ssao = mFrameGraph->AddPass("ssao", [this](ID3D12GraphicsCommandList* cmdList)
+    {
+        mSsao->DrawAmbientMap(cmdList, mCurrFrameResource);
+    });
+    graph.Read(ssao, mNormalMapResource, D3D12_RESOURCE_STATE_GENERIC_READ);
+    graph.Read(ssao, mDepthResource, depthRead);
+    graph.Write(ssao, mAmbientMap0Resource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    mSsaoPasses.push_back(ssao);
+
+    // Ping-pong the two ambient maps with horizontal and vertical blur passes.
+    const int blurCount = 3;
+    for(int i = 0; i < 2*blurCount; ++i)
+    {
+        bool horzBlur = i % 2 == 0;
+        auto input = horzBlur ? mAmbientMap0Resource : mAmbientMap1Resource;
+        auto output = horzBlur ? mAmbientMap1Resource : mAmbientMap0Resource;
+
+        auto blur = mFrameGraph->AddPass(horzBlur ? "ssaoBlurH" : "ssaoBlurV",
+            [this, horzBlur](ID3D12GraphicsCommandList* cmdList)
+        {
+            mSsao->DrawBlur(cmdList, mCurrFrameResource, horzBlur);
+        });
+        graph.Read(blur, mNormalMapResource, D3D12_RESOURCE_STATE_GENERIC_READ);
+        graph.Read(blur, mDepthResource, depthRead);
+        graph.Read(blur, input, D3D12_RESOURCE_STATE_GENERIC_READ);
+        graph.Write(blur, output, D3D12_RESOURCE_STATE_RENDER_TARGET);
+        mSsaoPasses.push_back(blur);
     }
+
+    mMainPass = mFrameGraph->AddPass("main", [this, bindScene](ID3D12GraphicsCommandList* cmdList)
+    {
+        // Bind the sky cube map.  For our demos, we just use one "world" cube map representing the environment
+        // from far away, so all objects will use the same cube map and we only need to set it once per-frame.  
+        // If we wanted to use "local" cube maps, we would have to change them per-object, or dynamically
+        // index into an array of cube maps.  The same table holds the shadow map and the ambient map.
+        bindScene(cmdList, mSceneSrvs.Gpu());
+        DrawMainPass(cmdList);
+    });
+    graph.Read(mMainPass, mShadowMapResource, D3D12_RESOURCE_STATE_GENERIC_READ);
+    graph.Read(mMainPass, mAmbientMap0Resource, D3D12_RESOURCE_STATE_GENERIC_READ);
+    graph.Write(mMainPass, mDepthResource, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    graph.Write(mMainPass, mBackBufferResource, D3D12_RESOURCE_STATE_RENDER_TARGET);
+
+    mFrameGraph->Compile();
+
+#if defined(DEBUG) || defined(_DEBUG)
+    OutputDebugStringA(mFrameGraph->DumpSchedule().c_str());
+#endif
+}
+
+void SsaoApp::UpdateFrameGraphResources()
+{
+    // OnResize recreates the depth buffer and the SSAO maps.
+    mFrameGraph->SetResource(mShadowMapResource, mShadowMap->Resource());
+    mFrameGraph->SetResource(mNormalMapResource, mSsao->NormalMap());
+    mFrameGraph->SetResource(mAmbientMap0Resource, mSsao->AmbientMap());
+    mFrameGraph->SetResource(mAmbientMap1Resource, mSsao->AmbientMap1());
+    mFrameGraph->SetResource(mDepthResource, mDepthStencilBuffer.Get());
+}
+
+void SsaoApp::BuildPasses()
+{
+    // The frame graph passes are recorded in parallel, a few to a command list.  The
+    // barriers between them are recorded with the pass that needs them, so the lists
+    // only have to be submitted in graph order.
+    auto shadow = AddPass("shadow", [this](ID3D12GraphicsCommandList* cmdList)
+    {
+        mFrameGraph->RecordPass(mShadowPass, cmdList);
+    });
+
+    auto normals = AddPass("normalsAndDepth", [this](ID3D12GraphicsCommandList* cmdList)
+    {
+        mFrameGraph->RecordPass(mNormalsPass, cmdList);
+    });
+
+    auto ssao = AddPass("ssao", [this](ID3D12GraphicsCommandList* cmdList)
+    {
+        cmdList->SetGraphicsRootSignature(mSsaoRootSignature.Get());
+        for(auto pass : mSsaoPasses)
+            mFrameGraph->RecordPass(pass, cmdList);
+    });
+
+    auto mainPass = AddPass("main", [this](ID3D12GraphicsCommandList* cmdList)
+    {
+        mFrameGraph->RecordPass(mMainPass, cmdList);
+    });
+
+    // SSAO reads the normal and depth maps, and the main pass reads the shadow map,
+    // the ambient map and the depth buffer.
+    mPassRecorder->AddDependency(ssao, normals);
+    mPassRecorder->AddDependency(mainPass, shadow);
+    mPassRecorder->AddDependency(mainPass, ssao);
+
+    ThrowIfFailed(md3dDevice->CreateCommandList(
+        0,
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        mFrameResources[0]->CmdListAllocs[0].Get(),
+        nullptr,
+        IID_PPV_ARGS(mResolveCmdList.GetAddressOf())));
+    ThrowIfFailed(mResolveCmdList->Close());
+}
+
+ParallelRecorder::PassId SsaoApp::AddPass(const std::string& name,
+    std::function<void(ID3D12GraphicsCommandList*)> record)
+{
+    ComPtr<ID3D12GraphicsCommandList> cmdList;
+    ThrowIfFailed(md3dDevice->CreateCommandList(
+        0,
+        D3D12_COMMAND_LIST_TYPE_DIRECT,
+        mFrameResources[0]->CmdListAllocs[0].Get(),
+        nullptr,
+        IID_PPV_ARGS(cmdList.GetAddressOf())));
+
+    // Start off in a closed state, Draw resets it before recording.  mDirectCmdListAlloc
+    // cannot be used here, it is recording the initialization commands.
+    ThrowIfFailed(cmdList->Close());
+    mPassCmdLists.push_back(cmdList);
+
+    ID3D12GraphicsCommandList* list = cmdList.Get();
+    const char* profileName = mProfiler.Intern(name);
+    return mPassRecorder->AddPass(name, [this, list, record, profileName](ParallelRecorder::uint32 thread)
+    {
+        PROFILE_SCOPE(mProfiler, profileName);
+
+        // Each thread has its own allocator, and records one list at a time.
+        ThrowIfFailed(list->Reset(mCurrFrameResource->CmdListAllocs[thread].Get(), nullptr));
+
+        ID3D12DescriptorHeap* descriptorHeaps[] = { mSrvAllocator->Heap() };
+        list->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+        {
+            GpuProfiler::Scope gpuScope(*mGpuProfiler, list, profileName);
+            record(list);
+        }
+
+        ThrowIfFailed(list->Close());
+    });
 }
 
 void SsaoApp::BuildMaterials()
@@ -1663,82 +1816,78 @@ void SsaoApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vec
     }
 }
 
-void SsaoApp::DrawSceneToShadowMap()
+void SsaoApp::DrawMainPass(ID3D12GraphicsCommandList* cmdList)
 {
-    mCommandList->RSSetViewports(1, &mShadowMap->Viewport());
-    mCommandList->RSSetScissorRects(1, &mShadowMap->ScissorRect());
+    cmdList->RSSetViewports(1, &mScreenViewport);
+    cmdList->RSSetScissorRects(1, &mScissorRect);
 
-    // Change to DEPTH_WRITE.
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mShadowMap->Resource(),
-        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_DEPTH_WRITE));
+    // Clear the back buffer.
+    cmdList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
+
+    // WE ALREADY WROTE THE DEPTH INFO TO THE DEPTH BUFFER IN DrawNormalsAndDepth,
+    // SO DO NOT CLEAR DEPTH.
+
+    // Specify the buffers we are going to render to.
+    cmdList->OMSetRenderTargets(1, &CurrentBackBufferView(), true, &DepthStencilView());
+
+    auto passCB = mCurrFrameResource->PassCB->Resource();
+	cmdList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
+
+    cmdList->SetPipelineState(mPSOs.at("opaque").Get());
+    DrawRenderItems(cmdList, mRitemLayer[(int)RenderLayer::Opaque]);
+
+    cmdList->SetPipelineState(mPSOs.at("debug").Get());
+    DrawRenderItems(cmdList, mRitemLayer[(int)RenderLayer::Debug]);
+
+	cmdList->SetPipelineState(mPSOs.at("sky").Get());
+	DrawRenderItems(cmdList, mRitemLayer[(int)RenderLayer::Sky]);
+}
+
+void SsaoApp::DrawSceneToShadowMap(ID3D12GraphicsCommandList* cmdList)
+{
+    cmdList->RSSetViewports(1, &mShadowMap->Viewport());
+    cmdList->RSSetScissorRects(1, &mShadowMap->ScissorRect());
 
     // Clear the back buffer and depth buffer.
-    mCommandList->ClearDepthStencilView(mShadowMap->Dsv(), 
+    cmdList->ClearDepthStencilView(mShadowMap->Dsv(), 
         D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
     // Specify the buffers we are going to render to.
-    mCommandList->OMSetRenderTargets(0, nullptr, false, &mShadowMap->Dsv());
+    cmdList->OMSetRenderTargets(0, nullptr, false, &mShadowMap->Dsv());
 
     // Bind the pass constant buffer for the shadow map pass.
     UINT passCBByteSize = d3dUtil::CalcConstantBufferByteSize(sizeof(PassConstants));
     auto passCB = mCurrFrameResource->PassCB->Resource();
     D3D12_GPU_VIRTUAL_ADDRESS passCBAddress = passCB->GetGPUVirtualAddress() + 1*passCBByteSize;
-    mCommandList->SetGraphicsRootConstantBufferView(1, passCBAddress);
-
-    mCommandList->SetPipelineState(mPSOs["shadow_opaque"].Get());
+    cmdList->SetGraphicsRootConstantBufferView(1, passCBAddress);
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    cmdList->SetPipelineState(mPSOs.at("shadow_opaque").Get());
 
-    // Change back to GENERIC_READ so we can read the texture in a shader.
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mShadowMap->Resource(),
-        D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_GENERIC_READ));
+    DrawRenderItems(cmdList, mRitemLayer[(int)RenderLayer::Opaque]);
 }
  
-void SsaoApp::DrawNormalsAndDepth()
+void SsaoApp::DrawNormalsAndDepth(ID3D12GraphicsCommandList* cmdList)
 {
-	mCommandList->RSSetViewports(1, &mScreenViewport);
-    mCommandList->RSSetScissorRects(1, &mScissorRect);
+	cmdList->RSSetViewports(1, &mScreenViewport);
+    cmdList->RSSetScissorRects(1, &mScissorRect);
 
-	auto normalMap = mSsao->NormalMap();
 	auto normalMapRtv = mSsao->NormalMapRtv();
 	
-    // Change to RENDER_TARGET.
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(normalMap,
-        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_RENDER_TARGET));
-
 	// Clear the screen normal map and depth buffer.
 	float clearValue[] = {0.0f, 0.0f, 1.0f, 0.0f};
-    mCommandList->ClearRenderTargetView(normalMapRtv, clearValue, 0, nullptr);
-    mCommandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+    cmdList->ClearRenderTargetView(normalMapRtv, clearValue, 0, nullptr);
+    cmdList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
 	// Specify the buffers we are going to render to.
-    mCommandList->OMSetRenderTargets(1, &normalMapRtv, true, &DepthStencilView());
+    cmdList->OMSetRenderTargets(1, &normalMapRtv, true, &DepthStencilView());
 
     // Bind the constant buffer for this pass.
     auto passCB = mCurrFrameResource->PassCB->Resource();
-    mCommandList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
-
-    mCommandList->SetPipelineState(mPSOs["drawNormals"].Get());
+    cmdList->SetGraphicsRootConstantBufferView(1, passCB->GetGPUVirtualAddress());
 
-    DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+    cmdList->SetPipelineState(mPSOs.at("drawNormals").Get());
 
-    // Change back to GENERIC_READ so we can read the texture in a shader.
-    mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(normalMap,
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
-}
-
-CD3DX12_CPU_DESCRIPTOR_HANDLE SsaoApp::GetCpuSrv(int index)const
-{
-    auto srv = CD3DX12_CPU_DESCRIPTOR_HANDLE(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-    srv.Offset(index, mCbvSrvUavDescriptorSize);
-    return srv;
-}
-
-CD3DX12_GPU_DESCRIPTOR_HANDLE SsaoApp::GetGpuSrv(int index)const
-{
-    auto srv = CD3DX12_GPU_DESCRIPTOR_HANDLE(mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
-    srv.Offset(index, mCbvSrvUavDescriptorSize);
-    return srv;
+    DrawRenderItems(cmdList, mRitemLayer[(int)RenderLayer::Opaque]);
 }
 
 CD3DX12_CPU_DESCRIPTOR_HANDLE SsaoApp::GetDsv(int index)const
@@ -117,6 +117,9 @@ private:
 
 	std::unique_ptr<Waves> mWaves;
 
+	// CPU copy of the wave vertices, uploaded in one bulk copy each frame.
+	std::vector<Vertex> mWavesVertices;
+
     PassConstants mMainPassCB;
 
     bool mIsWireframe = false;
@@ -219,13 +222,7 @@ void LandAndWavesApp::Update(const GameTimer& gt)
 
 	// Has the GPU finished processing the commands of the current frame resource?
 	// If not, wait until the GPU has completed commands up to this fence point.
-	if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-		ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	WaitForFence(mCurrFrameResource->Fence);
 
 	UpdateObjectCBs(gt);
 	UpdateMainPassCB(gt);
@@ -344,7 +341,7 @@ void LandAndWavesApp::OnMouseMove(WPARAM btnState, int x, int y)
 
 void LandAndWavesApp::OnKeyboardInput(const GameTimer& gt)
 {
-    if(GetAsyncKeyState('1') & 0x8000)
+    if(IsKeyDown('1'))
         mIsWireframe = true;
     else
         mIsWireframe = false;
@@ -368,6 +365,8 @@ void LandAndWavesApp::UpdateCamera(const GameTimer& gt)
 
 void LandAndWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -418,6 +417,8 @@ void LandAndWavesApp::UpdateMainPassCB(const GameTimer& gt)
 
 void LandAndWavesApp::UpdateWaves(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWaves");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
@@ -437,16 +438,18 @@ void LandAndWavesApp::UpdateWaves(const GameTimer& gt)
 
 	// Update the wave vertex buffer with the new solution.
 	auto currWavesVB = mCurrFrameResource->WavesVB.get();
+	mWavesVertices.resize(mWaves->VertexCount());
 	for(int i = 0; i < mWaves->VertexCount(); ++i)
 	{
-		Vertex v;
+		Vertex& v = mWavesVertices[i];
 
 		v.Pos = mWaves->Position(i);
         v.Color = XMFLOAT4(DirectX::Colors::Blue);
-
-		currWavesVB->CopyData(i, v);
 	}
 
+	// The upload heap is write-combined memory; write it in one streaming pass.
+	currWavesVB->CopyRange(0, mWavesVertices.data(), (int)mWavesVertices.size());
+
 	// Set the dynamic VB of the wave renderitem to the current frame VB.
 	mWavesRitem->Geo->VertexBufferGPU = currWavesVB->Resource();
 }
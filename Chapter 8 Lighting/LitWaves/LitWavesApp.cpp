@@ -233,13 +233,7 @@ void LitWavesApp::Update(const GameTimer& gt)
 
 	// Has the GPU finished processing the commands of the current frame resource?
 	// If not, wait until the GPU has completed commands up to this fence point.
-	if(mCurrFrameResource->Fence != 0 && mFence->GetCompletedValue() < mCurrFrameResource->Fence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-		ThrowIfFailed(mFence->SetEventOnCompletion(mCurrFrameResource->Fence, eventHandle));
-		WaitForSingleObject(eventHandle, INFINITE);
-		CloseHandle(eventHandle);
-	}
+	WaitForFence(mCurrFrameResource->Fence);
 
 	UpdateObjectCBs(gt);
 	UpdateMaterialCBs(gt);
@@ -353,16 +347,16 @@ void LitWavesApp::OnKeyboardInput(const GameTimer& gt)
 {
 	const float dt = gt.DeltaTime();
 
-	if(GetAsyncKeyState(VK_LEFT) & 0x8000)
+	if(IsKeyDown(VK_LEFT))
 		mSunTheta -= 1.0f*dt;
 
-	if(GetAsyncKeyState(VK_RIGHT) & 0x8000)
+	if(IsKeyDown(VK_RIGHT))
 		mSunTheta += 1.0f*dt;
 
-	if(GetAsyncKeyState(VK_UP) & 0x8000)
+	if(IsKeyDown(VK_UP))
 		mSunPhi -= 1.0f*dt;
 
-	if(GetAsyncKeyState(VK_DOWN) & 0x8000)
+	if(IsKeyDown(VK_DOWN))
 		mSunPhi += 1.0f*dt;
 
 	mSunPhi = MathHelper::Clamp(mSunPhi, 0.1f, XM_PIDIV2);
@@ -386,6 +380,8 @@ void LitWavesApp::UpdateCamera(const GameTimer& gt)
 
 void LitWavesApp::UpdateObjectCBs(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+
 	auto currObjectCB = mCurrFrameResource->ObjectCB.get();
 	for(auto& e : mAllRitems)
 	{
@@ -468,6 +464,8 @@ void LitWavesApp::UpdateMainPassCB(const GameTimer& gt)
 
 void LitWavesApp::UpdateWaves(const GameTimer& gt)
 {
+	PROFILE_SCOPE(mProfiler, "UpdateWaves");
+
 	// Every quarter second, generate a random wave.
 	static float t_base = 0.0f;
 	if((mTimer.TotalTime() - t_base) >= 0.25f)
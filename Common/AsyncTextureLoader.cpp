@@ -0,0 +1,167 @@
+//***************************************************************************************
+// AsyncTextureLoader.cpp
+//***************************************************************************************
+
+#include "AsyncTextureLoader.h"
+
+AsyncTextureLoader::AsyncTextureLoader(UINT numThreads)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0)
+		numThreads = 1;
+
+	mThreads.reserve(numThreads);
+	for(UINT i = 0; i < numThreads; ++i)
+		mThreads.emplace_back(&AsyncTextureLoader::WorkerMain, this);
+}
+
+AsyncTextureLoader::~AsyncTextureLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mJobReady.notify_all();
+
+	for(auto& t : mThreads)
+		t.join();
+}
+
+std::future<AsyncTextureLoader::LoadResult> AsyncTextureLoader::Load(const std::wstring& filename, size_t maxsize)
+{
+	// std::function needs a copyable target, so the promise is shared.
+	auto promise = std::make_shared<std::promise<LoadResult>>();
+	std::future<LoadResult> future = promise->get_future();
+
+	Enqueue([promise, filename, maxsize]()
+	{
+		// An exception is rethrown by future::get on the thread that waits for the result.
+		try
+		{
+			promise->set_value(LoadFile(filename, maxsize));
+		}
+		catch(...)
+		{
+			promise->set_exception(std::current_exception());
+		}
+	});
+
+	return future;
+}
+
+std::future<AsyncTextureLoader::LoadResult> AsyncTextureLoader::Load(const std::wstring& filename,
+	const TextureProcessor::Options& processing, size_t maxsize)
+{
+	auto promise = std::make_shared<std::promise<LoadResult>>();
+	std::future<LoadResult> future = promise->get_future();
+
+	Enqueue([promise, filename, processing, maxsize]()
+	{
+		try
+		{
+			promise->set_value(LoadFile(filename, maxsize, &processing));
+		}
+		catch(...)
+		{
+			promise->set_exception(std::current_exception());
+		}
+	});
+
+	return future;
+}
+
+void AsyncTextureLoader::Load(const std::wstring& filename, Callback onLoaded, size_t maxsize)
+{
+	Enqueue([onLoaded, filename, maxsize]()
+	{
+		LoadResult result = LoadFile(filename, maxsize);
+		onLoaded(result);
+	});
+}
+
+void AsyncTextureLoader::Wait()
+{
+	std::exception_ptr error;
+
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mIdle.wait(lock, [this]() { return mJobs.empty() && mNumBusy == 0; });
+		std::swap(error, mError);
+	}
+
+	if(error)
+		std::rethrow_exception(error);
+}
+
+UINT AsyncTextureLoader::NumThreads()const
+{
+	return (UINT)mThreads.size();
+}
+
+AsyncTextureLoader::LoadResult AsyncTextureLoader::LoadFile(const std::wstring& filename, size_t maxsize,
+	const TextureProcessor::Options* processing)
+{
+	LoadResult result;
+	result.Filename = filename;
+	result.Data = std::make_unique<DirectX::DDSTextureData12>();
+	result.Status = DirectX::LoadDDSTextureDataFromFile12(filename.c_str(), *result.Data, maxsize);
+
+	if(FAILED(result.Status))
+		result.Data = nullptr;
+	else if(processing != nullptr)
+		TextureProcessor::Process(*result.Data, result.Storage, *processing);
+
+	return result;
+}
+
+void AsyncTextureLoader::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.push_back(std::move(job));
+	}
+	mJobReady.notify_one();
+}
+
+void AsyncTextureLoader::WorkerMain()
+{
+	for(;;)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobReady.wait(lock, [this]() { return mQuit || !mJobs.empty(); });
+
+			// Drain the queue before quitting so no future is left without a value.
+			if(mJobs.empty())
+				return;
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+			mNumBusy++;
+		}
+
+		// An exception escaping a worker would terminate the process; keep the first
+		// one for Wait to rethrow.
+		std::exception_ptr error;
+		try
+		{
+			job();
+		}
+		catch(...)
+		{
+			error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if(error && !mError)
+				mError = error;
+			mNumBusy--;
+			if(mJobs.empty() && mNumBusy == 0)
+				mIdle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,94 @@
+//***************************************************************************************
+// AsyncTextureLoader.h
+//
+// Loads DDS files on a pool of worker threads.  Each job maps the file, validates the
+// header and computes the subresource layout (LoadDDSTextureDataFromFile12), so the
+// file I/O and CPU work of many textures overlap.  Only the device work, i.e.
+// CreateDDSTextureFromData12, is left to the thread recording the command list:
+//
+//   AsyncTextureLoader loader;
+//   auto bricks = loader.Load(L"../../Textures/bricks.dds");
+//   auto stone = loader.Load(L"../../Textures/stone.dds");
+//   ...
+//   auto result = bricks.get();
+//   ThrowIfFailed(result.Status);
+//   ThrowIfFailed(CreateDDSTextureFromData12(device, cmdList, *result.Data, tex, upload));
+//
+// Loads given TextureProcessor options also build the missing mips of the texture on
+// the worker (see TextureProcessor.h).
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSTextureLoader.h"
+#include "TextureProcessor.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AsyncTextureLoader
+{
+public:
+	struct LoadResult
+	{
+		std::wstring Filename;
+		HRESULT Status = E_FAIL;
+
+		// Null if Status is a failure code.
+		std::unique_ptr<DirectX::DDSTextureData12> Data;
+
+		// Texels of a processed texture, which Data points into instead of the file.
+		std::vector<std::uint8_t> Storage;
+	};
+
+	using Callback = std::function<void(LoadResult& result)>;
+
+	// 0 uses one thread per hardware thread.
+	explicit AsyncTextureLoader(UINT numThreads = 0);
+	AsyncTextureLoader(const AsyncTextureLoader& rhs) = delete;
+	AsyncTextureLoader& operator=(const AsyncTextureLoader& rhs) = delete;
+
+	// Finishes the queued jobs before returning.
+	~AsyncTextureLoader();
+
+	std::future<LoadResult> Load(const std::wstring& filename, size_t maxsize = 0);
+	std::future<LoadResult> Load(const std::wstring& filename, const TextureProcessor::Options& processing,
+		size_t maxsize = 0);
+
+	// onLoaded is called on a worker thread, so it must not record into a command list
+	// owned by another thread.  If it throws, Wait rethrows the exception.
+	void Load(const std::wstring& filename, Callback onLoaded, size_t maxsize = 0);
+
+	// Blocks until every queued job has finished, then rethrows the first exception a
+	// callback threw since the last Wait.  Failures of the future overload of Load are
+	// rethrown by future::get instead.
+	void Wait();
+
+	UINT NumThreads()const;
+
+private:
+	static LoadResult LoadFile(const std::wstring& filename, size_t maxsize,
+		const TextureProcessor::Options* processing = nullptr);
+
+	void Enqueue(std::function<void()> job);
+	void WorkerMain();
+
+private:
+	std::vector<std::thread> mThreads;
+
+	std::mutex mMutex;
+	std::condition_variable mJobReady;
+	std::condition_variable mIdle;
+	std::deque<std::function<void()>> mJobs;
+	UINT mNumBusy = 0;
+	bool mQuit = false;
+
+	std::exception_ptr mError;
+};
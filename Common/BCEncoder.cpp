@@ -0,0 +1,932 @@
+//***************************************************************************************
+// BCEncoder.cpp
+//***************************************************************************************
+
+#include "BCEncoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BC_ENCODER_SSE2 1
+#endif
+
+namespace
+{
+	using uint8 = BCEncoder::uint8;
+	using uint32 = BCEncoder::uint32;
+	using uint64 = std::uint64_t;
+
+	// Pixels of a block as floats, for the endpoint fitting.
+	typedef float BlockPoints[16][4];
+
+	const uint32 BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float Clamp255(float x)
+	{
+		return x < 0.0f ? 0.0f : (x > 255.0f ? 255.0f : x);
+	}
+
+	// Fits a line through the points along their principal axis and returns the
+	// extreme points of the projections on it.
+	void FitLine(const BlockPoints& p, int numChannels, float e0[4], float e1[4])
+	{
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for(int i = 0; i < 16; ++i)
+			for(int c = 0; c < numChannels; ++c)
+				mean[c] += p[i][c];
+		for(int c = 0; c < numChannels; ++c)
+			mean[c] /= 16.0f;
+
+		float cov[4][4] = {};
+		for(int i = 0; i < 16; ++i)
+		{
+			for(int a = 0; a < numChannels; ++a)
+				for(int b = 0; b < numChannels; ++b)
+					cov[a][b] += (p[i][a] - mean[a]) * (p[i][b] - mean[b]);
+		}
+
+		// Power iteration for the dominant eigenvector.
+		float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for(int iter = 0; iter < 8; ++iter)
+		{
+			float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float maxAbs = 0.0f;
+			for(int a = 0; a < numChannels; ++a)
+			{
+				for(int b = 0; b < numChannels; ++b)
+					v[a] += cov[a][b] * axis[b];
+				maxAbs = std::max(maxAbs, std::fabs(v[a]));
+			}
+
+			if(maxAbs < 1e-6f)
+				break;
+
+			for(int a = 0; a < numChannels; ++a)
+				axis[a] = v[a] / maxAbs;
+		}
+
+		float lengthSq = 0.0f;
+		for(int c = 0; c < numChannels; ++c)
+			lengthSq += axis[c] * axis[c];
+
+		float tMin = 0.0f;
+		float tMax = 0.0f;
+		for(int i = 0; i < 16; ++i)
+		{
+			float t = 0.0f;
+			for(int c = 0; c < numChannels; ++c)
+				t += (p[i][c] - mean[c]) * axis[c];
+			t /= lengthSq;
+
+			tMin = std::min(tMin, t);
+			tMax = std::max(tMax, t);
+		}
+
+		for(int c = 0; c < 4; ++c)
+		{
+			e0[c] = c < numChannels ? Clamp255(mean[c] + axis[c] * tMax) : 255.0f;
+			e1[c] = c < numChannels ? Clamp255(mean[c] + axis[c] * tMin) : 255.0f;
+		}
+	}
+
+	// Endpoints minimizing the squared error of the points to lerp(e0, e1, w[i]).
+	bool LeastSquares(const BlockPoints& p, const float w[16], int numChannels, float e0[4], float e1[4])
+	{
+		float a = 0.0f, b = 0.0f, c = 0.0f;
+		float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for(int i = 0; i < 16; ++i)
+		{
+			float u = 1.0f - w[i];
+			a += u * u;
+			b += u * w[i];
+			c += w[i] * w[i];
+			for(int ch = 0; ch < numChannels; ++ch)
+			{
+				x0[ch] += u * p[i][ch];
+				x1[ch] += w[i] * p[i][ch];
+			}
+		}
+
+		float det = a * c - b * b;
+		if(std::fabs(det) < 1e-6f)
+			return false;
+
+		for(int ch = 0; ch < numChannels; ++ch)
+		{
+			e0[ch] = Clamp255((c * x0[ch] - b * x1[ch]) / det);
+			e1[ch] = Clamp255((a * x1[ch] - b * x0[ch]) / det);
+		}
+		return true;
+	}
+
+	void LoadPoints(const uint8 rgba[64], BlockPoints& p)
+	{
+		for(int i = 0; i < 16; ++i)
+			for(int c = 0; c < 4; ++c)
+				p[i][c] = rgba[i * 4 + c];
+	}
+
+#if defined(BC_ENCODER_SSE2)
+	//
+	// The index searches, which are most of the encoding time, compare every pixel
+	// of a block with every palette entry; SSE2 does four (or sixteen) pixels at a
+	// time.  Both paths pick the same indices.
+	//
+
+	__m128i Select(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// The pixels of a block as 16 bit lanes, four pixels per register: (r, g) pairs
+	// in RG and (b, a) pairs in BA, which is the layout _mm_madd_epi16 sums.
+	struct PixelLanes
+	{
+		__m128i RG[4];
+		__m128i BA[4];
+	};
+
+	void LoadPixelLanes(const uint8 rgba[64], bool withAlpha, PixelLanes& lanes)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i alphaMask = _mm_set1_epi32(withAlpha ? -1 : 0xffff);
+		for(int g = 0; g < 4; ++g)
+		{
+			// Words rg0 ba0 rg1 ba1 rg2 ba2 rg3 ba3 to rg0 rg1 rg2 rg3 ba0 ba1 ba2 ba3.
+			__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16 * g));
+			px = _mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 1, 2, 0));
+			px = _mm_shufflehi_epi16(px, _MM_SHUFFLE(3, 1, 2, 0));
+			px = _mm_shuffle_epi32(px, _MM_SHUFFLE(3, 1, 2, 0));
+
+			lanes.RG[g] = _mm_unpacklo_epi8(px, zero);
+			lanes.BA[g] = _mm_and_si128(_mm_unpackhi_epi8(px, zero), alphaMask);
+		}
+	}
+
+	// A palette entry in the layout of PixelLanes.
+	void SetEntry(uint32 r, uint32 g, uint32 b, uint32 a, __m128i& rg, __m128i& ba)
+	{
+		rg = _mm_set1_epi32((int)(r | (g << 16)));
+		ba = _mm_set1_epi32((int)(b | (a << 16)));
+	}
+
+	// Stores the index of the nearest entry to each pixel, by squared distance, and
+	// returns the sum of the distances.  Ties go to the lower index.
+	uint32 NearestEntries(const PixelLanes& lanes, const __m128i* paletteRG, const __m128i* paletteBA,
+		uint32 numEntries, uint32 indices[16])
+	{
+		__m128i total = _mm_setzero_si128();
+		for(int g = 0; g < 4; ++g)
+		{
+			__m128i best = _mm_set1_epi32(std::numeric_limits<int>::max());
+			__m128i bestIndex = _mm_setzero_si128();
+			for(uint32 j = 0; j < numEntries; ++j)
+			{
+				__m128i dRG = _mm_sub_epi16(lanes.RG[g], paletteRG[j]);
+				__m128i dBA = _mm_sub_epi16(lanes.BA[g], paletteBA[j]);
+				__m128i error = _mm_add_epi32(_mm_madd_epi16(dRG, dRG), _mm_madd_epi16(dBA, dBA));
+
+				__m128i closer = _mm_cmplt_epi32(error, best);
+				best = Select(closer, error, best);
+				bestIndex = Select(closer, _mm_set1_epi32((int)j), bestIndex);
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indices + 4 * g), bestIndex);
+			total = _mm_add_epi32(total, best);
+		}
+
+		total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+		total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+		return (uint32)_mm_cvtsi128_si32(total);
+	}
+
+	// One channel of the 16 pixels, a byte each.
+	__m128i LoadChannel(const uint8 rgba[64], int channel)
+	{
+		const __m128i shift = _mm_cvtsi32_si128(8 * channel);
+		const __m128i mask = _mm_set1_epi32(0xff);
+
+		__m128i v[4];
+		for(int g = 0; g < 4; ++g)
+		{
+			__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgba + 16 * g));
+			v[g] = _mm_and_si128(_mm_srl_epi32(px, shift), mask);
+		}
+
+		return _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+	}
+
+	__m128i AbsDiff(__m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+	}
+#endif
+
+	//
+	// BC1 color block.
+	//
+
+	uint32 Pack565(const float e[3])
+	{
+		uint32 r = (uint32)(e[0] * 31.0f / 255.0f + 0.5f);
+		uint32 g = (uint32)(e[1] * 63.0f / 255.0f + 0.5f);
+		uint32 b = (uint32)(e[2] * 31.0f / 255.0f + 0.5f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	void Unpack565(uint32 c, int rgb[3])
+	{
+		int r = (c >> 11) & 31;
+		int g = (c >> 5) & 63;
+		int b = c & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	void ColorPalette(uint32 c0, uint32 c1, bool fourColor, int palette[4][3])
+	{
+		Unpack565(c0, palette[0]);
+		Unpack565(c1, palette[1]);
+		for(int ch = 0; ch < 3; ++ch)
+		{
+			if(fourColor || c0 > c1)
+			{
+				palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+				palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+			}
+			else
+			{
+				palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+				palette[3][ch] = 0;
+			}
+		}
+	}
+
+	// Returns the squared error of the block.
+	uint32 ColorIndices(const uint8 rgba[64], const int palette[4][3], uint32 numColors, uint32 indices[16])
+	{
+#if defined(BC_ENCODER_SSE2)
+		PixelLanes lanes;
+		LoadPixelLanes(rgba, false, lanes);
+
+		__m128i paletteRG[4], paletteBA[4];
+		for(uint32 j = 0; j < numColors; ++j)
+			SetEntry(palette[j][0], palette[j][1], palette[j][2], 0, paletteRG[j], paletteBA[j]);
+
+		return NearestEntries(lanes, paletteRG, paletteBA, numColors, indices);
+#else
+		uint32 totalError = 0;
+		for(int i = 0; i < 16; ++i)
+		{
+			uint32 bestError = ~0u;
+			for(uint32 j = 0; j < numColors; ++j)
+			{
+				int dr = rgba[i * 4 + 0] - palette[j][0];
+				int dg = rgba[i * 4 + 1] - palette[j][1];
+				int db = rgba[i * 4 + 2] - palette[j][2];
+				uint32 error = (uint32)(dr * dr + dg * dg + db * db);
+				if(error < bestError)
+				{
+					bestError = error;
+					indices[i] = j;
+				}
+			}
+			totalError += bestError;
+		}
+		return totalError;
+#endif
+	}
+
+	void EncodeColorBlock(const uint8 rgba[64], uint8* block)
+	{
+		BlockPoints p;
+		LoadPoints(rgba, p);
+
+		float e0[4], e1[4];
+		FitLine(p, 3, e0, e1);
+
+		uint32 bestC0 = 0, bestC1 = 0;
+		uint32 bestIndices[16] = {};
+		uint32 bestError = ~0u;
+
+		// Fit, then refine the endpoints once from the chosen indices.
+		for(int iter = 0; iter < 2; ++iter)
+		{
+			uint32 c0 = Pack565(e0);
+			uint32 c1 = Pack565(e1);
+
+			// c0 > c1 selects the four color mode.
+			if(c0 < c1)
+				std::swap(c0, c1);
+
+			uint32 indices[16] = {};
+			uint32 error = 0;
+			int palette[4][3];
+			ColorPalette(c0, c1, true, palette);
+			error = ColorIndices(rgba, palette, c0 == c1 ? 1 : 4, indices);
+
+			if(error < bestError)
+			{
+				bestError = error;
+				bestC0 = c0;
+				bestC1 = c1;
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+
+			if(c0 == c1)
+				break;
+
+			const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			float w[16];
+			for(int i = 0; i < 16; ++i)
+				w[i] = weights[indices[i]];
+
+			if(!LeastSquares(p, w, 3, e0, e1))
+				break;
+		}
+
+		uint32 packedIndices = 0;
+		for(int i = 0; i < 16; ++i)
+			packedIndices |= bestIndices[i] << (2 * i);
+
+		block[0] = (uint8)(bestC0 & 0xff);
+		block[1] = (uint8)(bestC0 >> 8);
+		block[2] = (uint8)(bestC1 & 0xff);
+		block[3] = (uint8)(bestC1 >> 8);
+		for(int i = 0; i < 4; ++i)
+			block[4 + i] = (uint8)(packedIndices >> (8 * i));
+	}
+
+	void DecodeColorBlock(const uint8* block, bool fourColor, uint8 rgba[64])
+	{
+		uint32 c0 = block[0] | (block[1] << 8);
+		uint32 c1 = block[2] | (block[3] << 8);
+		uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32)block[7] << 24);
+
+		int palette[4][3];
+		ColorPalette(c0, c1, fourColor, palette);
+
+		bool transparentBlack = !fourColor && c0 <= c1;
+		for(int i = 0; i < 16; ++i)
+		{
+			uint32 j = (indices >> (2 * i)) & 3;
+			rgba[i * 4 + 0] = (uint8)palette[j][0];
+			rgba[i * 4 + 1] = (uint8)palette[j][1];
+			rgba[i * 4 + 2] = (uint8)palette[j][2];
+			rgba[i * 4 + 3] = (transparentBlack && j == 3) ? 0 : 255;
+		}
+	}
+
+	//
+	// BC4 single channel block, used for BC3 alpha and both BC5 channels.
+	//
+
+	void SinglePalette(uint32 v0, uint32 v1, uint32 palette[8])
+	{
+		palette[0] = v0;
+		palette[1] = v1;
+		if(v0 > v1)
+		{
+			for(uint32 i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * v0 + i * v1) / 7;
+		}
+		else
+		{
+			for(uint32 i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * v0 + i * v1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void EncodeSingleBlock(const uint8 rgba[64], int channel, uint8* block)
+	{
+		uint32 v0 = 0;
+		uint32 v1 = 255;
+		for(int i = 0; i < 16; ++i)
+		{
+			v0 = std::max<uint32>(v0, rgba[i * 4 + channel]);
+			v1 = std::min<uint32>(v1, rgba[i * 4 + channel]);
+		}
+
+		uint64 packedIndices = 0;
+		if(v0 != v1)
+		{
+			// v0 > v1: eight levels between the extremes.
+			uint32 palette[8];
+			SinglePalette(v0, v1, palette);
+
+#if defined(BC_ENCODER_SSE2)
+			// Unsigned bytes compare as signed ones with the top bit flipped.
+			const __m128i bias = _mm_set1_epi8((char)0x80);
+			__m128i values = LoadChannel(rgba, channel);
+			__m128i best = AbsDiff(values, _mm_set1_epi8((char)palette[0]));
+			__m128i bestIndex = _mm_setzero_si128();
+			for(uint32 j = 1; j < 8; ++j)
+			{
+				__m128i error = AbsDiff(values, _mm_set1_epi8((char)palette[j]));
+				__m128i closer = _mm_cmplt_epi8(_mm_xor_si128(error, bias), _mm_xor_si128(best, bias));
+				best = _mm_min_epu8(error, best);
+				bestIndex = Select(closer, _mm_set1_epi8((char)j), bestIndex);
+			}
+
+			uint8 indices[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indices), bestIndex);
+			for(int i = 0; i < 16; ++i)
+				packedIndices |= (uint64)indices[i] << (3 * i);
+#else
+			for(int i = 0; i < 16; ++i)
+			{
+				int value = rgba[i * 4 + channel];
+				uint32 best = 0;
+				int bestError = 256;
+				for(uint32 j = 0; j < 8; ++j)
+				{
+					int error = std::abs(value - (int)palette[j]);
+					if(error < bestError)
+					{
+						bestError = error;
+						best = j;
+					}
+				}
+				packedIndices |= (uint64)best << (3 * i);
+			}
+#endif
+		}
+
+		block[0] = (uint8)v0;
+		block[1] = (uint8)v1;
+		for(int i = 0; i < 6; ++i)
+			block[2 + i] = (uint8)(packedIndices >> (8 * i));
+	}
+
+	void DecodeSingleBlock(const uint8* block, int channel, uint8 rgba[64])
+	{
+		uint32 palette[8];
+		SinglePalette(block[0], block[1], palette);
+
+		uint64 indices = 0;
+		for(int i = 0; i < 6; ++i)
+			indices |= (uint64)block[2 + i] << (8 * i);
+
+		for(int i = 0; i < 16; ++i)
+			rgba[i * 4 + channel] = (uint8)palette[(indices >> (3 * i)) & 7];
+	}
+
+	//
+	// BC7 mode 6: RGBA endpoints with 7 bits per channel plus a p-bit per endpoint,
+	// and 4 bit indices.
+	//
+
+	struct BitWriter
+	{
+		uint64 Bits[2] = { 0, 0 };
+		uint32 Pos = 0;
+
+		void Write(uint32 value, uint32 count)
+		{
+			for(uint32 i = 0; i < count; ++i, ++Pos)
+				Bits[Pos / 64] |= (uint64)((value >> i) & 1) << (Pos % 64);
+		}
+	};
+
+	struct BitReader
+	{
+		uint64 Bits[2] = { 0, 0 };
+		uint32 Pos = 0;
+
+		uint32 Read(uint32 count)
+		{
+			uint32 value = 0;
+			for(uint32 i = 0; i < count; ++i, ++Pos)
+				value |= (uint32)((Bits[Pos / 64] >> (Pos % 64)) & 1) << i;
+			return value;
+		}
+	};
+
+	// Picks the p-bit that represents the endpoint best; endpoint[c] = q[c] << 1 | pbit.
+	void QuantizeBC7Endpoint(const float e[4], uint32 q[4], uint32& pbit)
+	{
+		float bestError = std::numeric_limits<float>::max();
+		for(uint32 p = 0; p < 2; ++p)
+		{
+			uint32 candidate[4];
+			float error = 0.0f;
+			for(int c = 0; c < 4; ++c)
+			{
+				float v = std::floor((e[c] - p) * 0.5f + 0.5f);
+				candidate[c] = (uint32)std::min(std::max(v, 0.0f), 127.0f);
+
+				float d = (float)((candidate[c] << 1) | p) - e[c];
+				error += d * d;
+			}
+
+			if(error < bestError)
+			{
+				bestError = error;
+				pbit = p;
+				std::memcpy(q, candidate, sizeof(candidate));
+			}
+		}
+	}
+
+	void BC7Palette(const uint32 q0[4], uint32 p0, const uint32 q1[4], uint32 p1, uint32 palette[16][4])
+	{
+		for(int c = 0; c < 4; ++c)
+		{
+			uint32 v0 = (q0[c] << 1) | p0;
+			uint32 v1 = (q1[c] << 1) | p1;
+			for(int j = 0; j < 16; ++j)
+				palette[j][c] = ((64 - BC7Weights[j]) * v0 + BC7Weights[j] * v1 + 32) >> 6;
+		}
+	}
+
+	// Returns the squared error of the block.
+	uint64 BC7Indices(const uint8 rgba[64], const uint32 palette[16][4], uint32 indices[16])
+	{
+#if defined(BC_ENCODER_SSE2)
+		PixelLanes lanes;
+		LoadPixelLanes(rgba, true, lanes);
+
+		__m128i paletteRG[16], paletteBA[16];
+		for(uint32 j = 0; j < 16; ++j)
+			SetEntry(palette[j][0], palette[j][1], palette[j][2], palette[j][3], paletteRG[j], paletteBA[j]);
+
+		return NearestEntries(lanes, paletteRG, paletteBA, 16, indices);
+#else
+		uint64 error = 0;
+		for(int i = 0; i < 16; ++i)
+		{
+			uint32 pixelError = ~0u;
+			for(uint32 j = 0; j < 16; ++j)
+			{
+				uint32 e = 0;
+				for(int c = 0; c < 4; ++c)
+				{
+					int d = rgba[i * 4 + c] - (int)palette[j][c];
+					e += (uint32)(d * d);
+				}
+				if(e < pixelError)
+				{
+					pixelError = e;
+					indices[i] = j;
+				}
+			}
+			error += pixelError;
+		}
+		return error;
+#endif
+	}
+
+	void EncodeBC7Block(const uint8 rgba[64], uint8* block)
+	{
+		BlockPoints p;
+		LoadPoints(rgba, p);
+
+		float e0[4], e1[4];
+		FitLine(p, 4, e0, e1);
+
+		uint32 bestQ0[4] = {}, bestQ1[4] = {};
+		uint32 bestP0 = 0, bestP1 = 0;
+		uint32 bestIndices[16] = {};
+		uint64 bestError = ~uint64(0);
+
+		for(int iter = 0; iter < 2; ++iter)
+		{
+			uint32 q0[4], q1[4], p0 = 0, p1 = 0;
+			QuantizeBC7Endpoint(e0, q0, p0);
+			QuantizeBC7Endpoint(e1, q1, p1);
+
+			uint32 palette[16][4];
+			BC7Palette(q0, p0, q1, p1, palette);
+
+			uint32 indices[16];
+			uint64 error = BC7Indices(rgba, palette, indices);
+
+			if(error < bestError)
+			{
+				bestError = error;
+				std::memcpy(bestQ0, q0, sizeof(q0));
+				std::memcpy(bestQ1, q1, sizeof(q1));
+				bestP0 = p0;
+				bestP1 = p1;
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+
+			float w[16];
+			for(int i = 0; i < 16; ++i)
+				w[i] = BC7Weights[indices[i]] / 64.0f;
+
+			if(!LeastSquares(p, w, 4, e0, e1))
+				break;
+		}
+
+		// The top bit of the first index is implied zero.
+		if(bestIndices[0] & 8)
+		{
+			std::swap(bestQ0, bestQ1);
+			std::swap(bestP0, bestP1);
+			for(int i = 0; i < 16; ++i)
+				bestIndices[i] = 15 - bestIndices[i];
+		}
+
+		BitWriter bits;
+		bits.Write(1 << 6, 7); // mode 6
+		for(int c = 0; c < 4; ++c)
+		{
+			bits.Write(bestQ0[c], 7);
+			bits.Write(bestQ1[c], 7);
+		}
+		bits.Write(bestP0, 1);
+		bits.Write(bestP1, 1);
+		bits.Write(bestIndices[0], 3);
+		for(int i = 1; i < 16; ++i)
+			bits.Write(bestIndices[i], 4);
+
+		for(int i = 0; i < 16; ++i)
+			block[i] = (uint8)(bits.Bits[i / 8] >> (8 * (i % 8)));
+	}
+
+	void DecodeBC7Block(const uint8* block, uint8 rgba[64])
+	{
+		BitReader bits;
+		for(int i = 0; i < 16; ++i)
+			bits.Bits[i / 8] |= (uint64)block[i] << (8 * (i % 8));
+
+		if(bits.Read(7) != (1 << 6))
+		{
+			std::memset(rgba, 0, 64);
+			return;
+		}
+
+		uint32 q0[4], q1[4];
+		for(int c = 0; c < 4; ++c)
+		{
+			q0[c] = bits.Read(7);
+			q1[c] = bits.Read(7);
+		}
+		uint32 p0 = bits.Read(1);
+		uint32 p1 = bits.Read(1);
+
+		uint32 palette[16][4];
+		BC7Palette(q0, p0, q1, p1, palette);
+
+		for(int i = 0; i < 16; ++i)
+		{
+			uint32 j = bits.Read(i == 0 ? 3 : 4);
+			for(int c = 0; c < 4; ++c)
+				rgba[i * 4 + c] = (uint8)palette[j][c];
+		}
+	}
+
+	void LoadBlock(const BCEncoder::Image& image, uint32 bx, uint32 by, uint8 rgba[64])
+	{
+		for(uint32 y = 0; y < 4; ++y)
+		{
+			uint32 sy = std::min(by * 4 + y, image.Height - 1);
+			const uint8* row = image.Pixels + (std::size_t)sy * image.RowPitch;
+			for(uint32 x = 0; x < 4; ++x)
+			{
+				uint32 sx = std::min(bx * 4 + x, image.Width - 1);
+				std::memcpy(&rgba[(y * 4 + x) * 4], row + sx * 4, 4);
+			}
+		}
+	}
+}
+
+BCEncoder::BCEncoder(uint32 numThreads)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0)
+		numThreads = 1;
+
+	mNumThreads = numThreads;
+}
+
+std::vector<BCEncoder::uint8> BCEncoder::Compress(Format format, const Image& image)const
+{
+	std::vector<uint8> result(CompressedSize(format, image.Width, image.Height));
+
+	uint32 numBlockRows = (image.Height + 3) / 4;
+	uint32 numThreads = std::min(mNumThreads, numBlockRows);
+
+	// Contiguous ranges of block rows; the calling thread takes the first one.
+	std::vector<std::thread> threads;
+	uint32 rowsPerThread = (numBlockRows + numThreads - 1) / std::max(numThreads, 1u);
+	for(uint32 t = 1; t < numThreads; ++t)
+	{
+		uint32 firstRow = t * rowsPerThread;
+		if(firstRow >= numBlockRows)
+			break;
+
+		uint32 numRows = std::min(rowsPerThread, numBlockRows - firstRow);
+		threads.emplace_back(&BCEncoder::CompressRows, this, format, std::cref(image),
+			result.data(), firstRow, numRows);
+	}
+
+	CompressRows(format, image, result.data(), 0, std::min(rowsPerThread, numBlockRows));
+
+	for(auto& t : threads)
+		t.join();
+
+	return result;
+}
+
+BCEncoder::uint32 BCEncoder::NumThreads()const
+{
+	return mNumThreads;
+}
+
+void BCEncoder::EncodeBlock(Format format, const uint8 rgba[64], uint8* block)
+{
+	switch(format)
+	{
+	case Format::BC1:
+		EncodeColorBlock(rgba, block);
+		break;
+	case Format::BC3:
+		EncodeSingleBlock(rgba, 3, block);
+		EncodeColorBlock(rgba, block + 8);
+		break;
+	case Format::BC5:
+		EncodeSingleBlock(rgba, 0, block);
+		EncodeSingleBlock(rgba, 1, block + 8);
+		break;
+	case Format::BC7:
+		EncodeBC7Block(rgba, block);
+		break;
+	}
+}
+
+void BCEncoder::DecodeBlock(Format format, const uint8* block, uint8 rgba[64])
+{
+	switch(format)
+	{
+	case Format::BC1:
+		DecodeColorBlock(block, false, rgba);
+		break;
+	case Format::BC3:
+		DecodeColorBlock(block + 8, true, rgba);
+		DecodeSingleBlock(block, 3, rgba);
+		break;
+	case Format::BC5:
+		DecodeSingleBlock(block, 0, rgba);
+		DecodeSingleBlock(block + 8, 1, rgba);
+		for(int i = 0; i < 16; ++i)
+		{
+			rgba[i * 4 + 2] = 0;
+			rgba[i * 4 + 3] = 255;
+		}
+		break;
+	case Format::BC7:
+		DecodeBC7Block(block, rgba);
+		break;
+	}
+}
+
+std::vector<BCEncoder::uint8> BCEncoder::Decompress(Format format, const uint8* blocks, uint32 width, uint32 height)
+{
+	std::vector<uint8> pixels((std::size_t)width * height * 4);
+
+	uint32 numBlocksWide = (width + 3) / 4;
+	uint32 numBlocksHigh = (height + 3) / 4;
+	uint32 blockBytes = BlockBytes(format);
+
+	for(uint32 by = 0; by < numBlocksHigh; ++by)
+	{
+		for(uint32 bx = 0; bx < numBlocksWide; ++bx)
+		{
+			uint8 rgba[64];
+			DecodeBlock(format, blocks + ((std::size_t)by * numBlocksWide + bx) * blockBytes, rgba);
+
+			for(uint32 y = 0; y < 4 && by * 4 + y < height; ++y)
+			{
+				for(uint32 x = 0; x < 4 && bx * 4 + x < width; ++x)
+				{
+					std::memcpy(&pixels[((std::size_t)(by * 4 + y) * width + bx * 4 + x) * 4],
+						&rgba[(y * 4 + x) * 4], 4);
+				}
+			}
+		}
+	}
+
+	return pixels;
+}
+
+BCEncoder::uint32 BCEncoder::BlockBytes(Format format)
+{
+	return format == Format::BC1 ? 8 : 16;
+}
+
+BCEncoder::uint32 BCEncoder::DxgiFormat(Format format)
+{
+	switch(format)
+	{
+	case Format::BC1: return 71; // DXGI_FORMAT_BC1_UNORM
+	case Format::BC3: return 77; // DXGI_FORMAT_BC3_UNORM
+	case Format::BC5: return 83; // DXGI_FORMAT_BC5_UNORM
+	case Format::BC7: return 98; // DXGI_FORMAT_BC7_UNORM
+	}
+	return 0;
+}
+
+std::size_t BCEncoder::CompressedSize(Format format, uint32 width, uint32 height)
+{
+	return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * BlockBytes(format);
+}
+
+double BCEncoder::ComputePSNR(const Image& a, const Image& b, uint32 numChannels)
+{
+	uint32 width = std::min(a.Width, b.Width);
+	uint32 height = std::min(a.Height, b.Height);
+	numChannels = std::min(numChannels, 4u);
+
+	double sumSq = 0.0;
+	for(uint32 y = 0; y < height; ++y)
+	{
+		const uint8* rowA = a.Pixels + (std::size_t)y * a.RowPitch;
+		const uint8* rowB = b.Pixels + (std::size_t)y * b.RowPitch;
+		for(uint32 x = 0; x < width; ++x)
+		{
+			for(uint32 c = 0; c < numChannels; ++c)
+			{
+				double d = (double)rowA[x * 4 + c] - rowB[x * 4 + c];
+				sumSq += d * d;
+			}
+		}
+	}
+
+	double mse = sumSq / ((double)width * height * numChannels);
+	if(mse == 0.0)
+		return std::numeric_limits<double>::infinity();
+
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+std::vector<BCEncoder::uint8> BCEncoder::WriteDDS(Format format, uint32 width, uint32 height,
+	const std::vector<std::vector<uint8>>& mips)
+{
+	const uint32 DDS_MAGIC = 0x20534444; // "DDS "
+	const uint32 DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+	const uint32 DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	const uint32 DDPF_FOURCC = 0x4;
+	const uint32 DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+	const uint32 FOURCC_DX10 = 0x30315844; // "DX10"
+	const uint32 TEXTURE2D = 3;
+
+	uint32 numMips = (uint32)mips.size();
+
+	// Magic, DDS_HEADER (31 DWORDs) and DDS_HEADER_DXT10 (5 DWORDs).
+	uint32 header[1 + 31 + 5] = {};
+	header[0] = DDS_MAGIC;
+	header[1] = 124;
+	header[2] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE |
+		(numMips > 1 ? DDSD_MIPMAPCOUNT : 0);
+	header[3] = height;
+	header[4] = width;
+	header[5] = numMips > 0 ? (uint32)mips[0].size() : 0;
+	header[7] = numMips;
+	header[19] = 32;
+	header[20] = DDPF_FOURCC;
+	header[21] = FOURCC_DX10;
+	header[27] = DDSCAPS_TEXTURE | (numMips > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+	header[32] = DxgiFormat(format);
+	header[33] = TEXTURE2D;
+	header[35] = 1; // arraySize
+
+	std::vector<uint8> file(sizeof(header));
+	for(std::size_t i = 0; i < sizeof(header) / sizeof(uint32); ++i)
+	{
+		for(int b = 0; b < 4; ++b)
+			file[i * 4 + b] = (uint8)(header[i] >> (8 * b));
+	}
+
+	for(const auto& mip : mips)
+		file.insert(file.end(), mip.begin(), mip.end());
+
+	return file;
+}
+
+void BCEncoder::CompressRows(Format format, const Image& image, uint8* out,
+	uint32 firstRow, uint32 numRows)const
+{
+	uint32 numBlocksWide = (image.Width + 3) / 4;
+	uint32 blockBytes = BlockBytes(format);
+
+	for(uint32 by = firstRow; by < firstRow + numRows; ++by)
+	{
+		for(uint32 bx = 0; bx < numBlocksWide; ++bx)
+		{
+			uint8 rgba[64];
+			LoadBlock(image, bx, by, rgba);
+			EncodeBlock(format, rgba, out + ((std::size_t)by * numBlocksWide + bx) * blockBytes);
+		}
+	}
+}
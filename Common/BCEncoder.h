@@ -0,0 +1,85 @@
+//***************************************************************************************
+// BCEncoder.h
+//
+// Compresses RGBA8 images into the block compressed formats, so that generated or
+// imported textures take 4-8x less memory and upload bandwidth:
+//
+//   BC1 - RGB, 4 bits per texel (alpha ignored).
+//   BC3 - RGBA, 8 bits per texel; BC1 colors plus a BC4 alpha block.
+//   BC5 - two channels (R and G, e.g. tangent space normal maps), 8 bits per texel.
+//   BC7 - RGBA, 8 bits per texel, written as mode 6 blocks (one subset, 16 levels),
+//         which is the best single mode for smooth color data.
+//
+// Endpoints are fitted along the principal axis of each block and refined with a
+// least squares pass.  The blocks of an image are compressed on several threads.
+// WriteDDS packages the result in a file DDSTextureLoader accepts, and
+// Decompress/ComputePSNR measure the quality of an encoding.
+//
+// The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class BCEncoder
+{
+public:
+
+	using uint8 = std::uint8_t;
+	using uint32 = std::uint32_t;
+
+	enum class Format
+	{
+		BC1,
+		BC3,
+		BC5,
+		BC7
+	};
+
+	// RGBA8 pixels, RowPitch bytes apart.  Width and height need not be multiples of
+	// four; the edge blocks repeat the last row and column.
+	struct Image
+	{
+		const uint8* Pixels = nullptr;
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 RowPitch = 0;
+	};
+
+	// numThreads == 0 uses one thread per hardware thread.
+	explicit BCEncoder(uint32 numThreads = 0);
+
+	// Returns the blocks of the image, row by row.
+	std::vector<uint8> Compress(Format format, const Image& image)const;
+
+	uint32 NumThreads()const;
+
+	static void EncodeBlock(Format format, const uint8 rgba[64], uint8* block);
+
+	// Only decodes BC7 mode 6, which is all EncodeBlock writes.
+	static void DecodeBlock(Format format, const uint8* block, uint8 rgba[64]);
+
+	// Returns tightly packed RGBA8 pixels.
+	static std::vector<uint8> Decompress(Format format, const uint8* blocks, uint32 width, uint32 height);
+
+	static uint32 BlockBytes(Format format);
+	static uint32 DxgiFormat(Format format);
+	static std::size_t CompressedSize(Format format, uint32 width, uint32 height);
+
+	// Peak signal to noise ratio over the first numChannels channels, in dB; infinite
+	// for identical images.
+	static double ComputePSNR(const Image& a, const Image& b, uint32 numChannels = 4);
+
+	// Builds a DDS file (with the "DX10" header) from the compressed mips, finest first.
+	static std::vector<uint8> WriteDDS(Format format, uint32 width, uint32 height,
+		const std::vector<std::vector<uint8>>& mips);
+
+private:
+	void CompressRows(Format format, const Image& image, uint8* out,
+		uint32 firstRow, uint32 numRows)const;
+
+private:
+	uint32 mNumThreads = 1;
+};
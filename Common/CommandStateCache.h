@@ -0,0 +1,206 @@
+//***************************************************************************************
+// CommandStateCache.h
+//
+// Thin wrapper over a command list that remembers the last bound pipeline state,
+// input assembler state and root arguments, and only forwards a bind call when the
+// value actually changes.  Combined with a sorted DrawList this removes most of the
+// redundant binds issued when drawing render items one by one.
+//
+// The command list type is a template parameter, and the bind arguments are only
+// read by field name (BufferLocation, SizeInBytes, ...), so the class has no Direct3D
+// dependencies.  A recording command list can stand in for ID3D12GraphicsCommandList
+// together with structs that have the fields of the D3D12 views.
+//***************************************************************************************
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+template<typename CmdList>
+class CommandStateCache
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	static const uint32 MaxRootParameters = 16;
+
+	explicit CommandStateCache(CmdList* cmdList) :
+		mCmdList(cmdList)
+	{
+		Invalidate();
+	}
+
+	CommandStateCache(const CommandStateCache& rhs) = delete;
+	CommandStateCache& operator=(const CommandStateCache& rhs) = delete;
+
+	CmdList* GetCommandList()const
+	{
+		return mCmdList;
+	}
+
+	// Forget the cached state.  Call after binding state on the command list directly,
+	// e.g. after changing the root signature.
+	void Invalidate()
+	{
+		mPso = nullptr;
+		mHasVertexBuffer = false;
+		mHasIndexBuffer = false;
+		mHasTopology = false;
+
+		for(uint32 i = 0; i < MaxRootParameters; ++i)
+			mRootArgs[i] = uint64(-1);
+	}
+
+	template<typename PipelineState>
+	void SetPipelineState(PipelineState* pso)
+	{
+		if(pso == mPso)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mPso = pso;
+		mCmdList->SetPipelineState(pso);
+		mNumIssued++;
+	}
+
+	template<typename VertexBufferView>
+	void SetVertexBuffer(const VertexBufferView& vbv)
+	{
+		if(mHasVertexBuffer &&
+		   vbv.BufferLocation == mVertexBuffer.BufferLocation &&
+		   vbv.SizeInBytes == mVertexBuffer.SizeInBytes &&
+		   vbv.StrideInBytes == mVertexBuffer.StrideOrFormat)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mVertexBuffer = { vbv.BufferLocation, vbv.SizeInBytes, vbv.StrideInBytes };
+		mHasVertexBuffer = true;
+		mCmdList->IASetVertexBuffers(0, 1, &vbv);
+		mNumIssued++;
+	}
+
+	template<typename IndexBufferView>
+	void SetIndexBuffer(const IndexBufferView& ibv)
+	{
+		if(mHasIndexBuffer &&
+		   ibv.BufferLocation == mIndexBuffer.BufferLocation &&
+		   ibv.SizeInBytes == mIndexBuffer.SizeInBytes &&
+		   (uint32)ibv.Format == mIndexBuffer.StrideOrFormat)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mIndexBuffer = { ibv.BufferLocation, ibv.SizeInBytes, (uint32)ibv.Format };
+		mHasIndexBuffer = true;
+		mCmdList->IASetIndexBuffer(&ibv);
+		mNumIssued++;
+	}
+
+	template<typename PrimitiveTopology>
+	void SetPrimitiveTopology(PrimitiveTopology topology)
+	{
+		if(mHasTopology && (uint32)topology == mTopology)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mTopology = (uint32)topology;
+		mHasTopology = true;
+		mCmdList->IASetPrimitiveTopology(topology);
+		mNumIssued++;
+	}
+
+	void SetGraphicsRootConstantBufferView(uint32 rootParameterIndex, uint64 address)
+	{
+		assert(rootParameterIndex < MaxRootParameters);
+		if(mRootArgs[rootParameterIndex] == address)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mRootArgs[rootParameterIndex] = address;
+		mCmdList->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+		mNumIssued++;
+	}
+
+	void SetGraphicsRootShaderResourceView(uint32 rootParameterIndex, uint64 address)
+	{
+		assert(rootParameterIndex < MaxRootParameters);
+		if(mRootArgs[rootParameterIndex] == address)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mRootArgs[rootParameterIndex] = address;
+		mCmdList->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+		mNumIssued++;
+	}
+
+	template<typename DescriptorHandle>
+	void SetGraphicsRootDescriptorTable(uint32 rootParameterIndex, DescriptorHandle baseDescriptor)
+	{
+		assert(rootParameterIndex < MaxRootParameters);
+		if(mRootArgs[rootParameterIndex] == baseDescriptor.ptr)
+		{
+			mNumSkipped++;
+			return;
+		}
+
+		mRootArgs[rootParameterIndex] = baseDescriptor.ptr;
+		mCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex, baseDescriptor);
+		mNumIssued++;
+	}
+
+	void DrawIndexedInstanced(uint32 indexCountPerInstance, uint32 instanceCount,
+		uint32 startIndexLocation, std::int32_t baseVertexLocation, uint32 startInstanceLocation)
+	{
+		mCmdList->DrawIndexedInstanced(indexCountPerInstance, instanceCount,
+			startIndexLocation, baseVertexLocation, startInstanceLocation);
+		mNumDraws++;
+	}
+
+	// Statistics.
+	uint32 NumIssued()const { return mNumIssued; }
+	uint32 NumSkipped()const { return mNumSkipped; }
+	uint32 NumDraws()const { return mNumDraws; }
+
+private:
+	struct BufferView
+	{
+		uint64 BufferLocation;
+		uint32 SizeInBytes;
+
+		// Stride of a vertex buffer, format of an index buffer.
+		uint32 StrideOrFormat;
+	};
+
+	CmdList* mCmdList = nullptr;
+
+	const void* mPso = nullptr;
+
+	BufferView mVertexBuffer;
+	BufferView mIndexBuffer;
+	bool mHasVertexBuffer = false;
+	bool mHasIndexBuffer = false;
+
+	uint32 mTopology = 0;
+	bool mHasTopology = false;
+
+	// GPU virtual address or descriptor handle last bound to each root parameter.
+	uint64 mRootArgs[MaxRootParameters];
+
+	uint32 mNumIssued = 0;
+	uint32 mNumSkipped = 0;
+	uint32 mNumDraws = 0;
+};
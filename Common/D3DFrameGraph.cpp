@@ -0,0 +1,204 @@
+//***************************************************************************************
+// D3DFrameGraph.cpp
+//***************************************************************************************
+
+#include "D3DFrameGraph.h"
+#include <sstream>
+
+using Microsoft::WRL::ComPtr;
+
+D3DFrameGraph::D3DFrameGraph(ID3D12Device* device) :
+	mDevice(device)
+{
+}
+
+FrameGraph& D3DFrameGraph::Graph()
+{
+	return mGraph;
+}
+
+const FrameGraph& D3DFrameGraph::Graph()const
+{
+	return mGraph;
+}
+
+D3DFrameGraph::ResourceId D3DFrameGraph::Import(const std::string& name, ID3D12Resource* resource,
+	D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState)
+{
+	ResourceId id = mGraph.Import(name, initialState, finalState);
+	mResources.push_back(resource);
+	mTextureDescs.push_back({});
+	return id;
+}
+
+D3DFrameGraph::ResourceId D3DFrameGraph::Import(const std::string& name, ID3D12Resource* resource,
+	D3D12_RESOURCE_STATES state)
+{
+	return Import(name, resource, state, state);
+}
+
+D3DFrameGraph::ResourceId D3DFrameGraph::CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+	const D3D12_CLEAR_VALUE* optimizedClearValue)
+{
+	assert(desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL));
+
+	D3D12_RESOURCE_ALLOCATION_INFO info = mDevice->GetResourceAllocationInfo(0, 1, &desc);
+	ResourceId id = mGraph.CreateTransient(name, info.SizeInBytes, info.Alignment);
+
+	TextureDesc textureDesc = {};
+	textureDesc.Desc = desc;
+	textureDesc.HasClearValue = optimizedClearValue != nullptr;
+	if(optimizedClearValue != nullptr)
+		textureDesc.ClearValue = *optimizedClearValue;
+
+	mResources.push_back(nullptr);
+	mTextureDescs.push_back(textureDesc);
+	return id;
+}
+
+D3DFrameGraph::PassId D3DFrameGraph::AddPass(const std::string& name, RecordFunc record, bool sideEffects)
+{
+	PassId id = mGraph.AddPass(name, sideEffects);
+	mPasses.push_back(std::move(record));
+	return id;
+}
+
+void D3DFrameGraph::Compile()
+{
+	mGraph.Compile();
+
+	for(ResourceId id = 0; id < mGraph.NumResources(); ++id)
+	{
+		if(mGraph.IsTransient(id))
+			mResources[id] = nullptr;
+	}
+	mHeap = nullptr;
+
+	if(mGraph.HeapSize() == 0)
+		return;
+
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.Properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	heapDesc.Alignment = mGraph.HeapAlignment() > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT ?
+		D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	heapDesc.SizeInBytes = (mGraph.HeapSize() + heapDesc.Alignment - 1) / heapDesc.Alignment * heapDesc.Alignment;
+	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	ThrowIfFailed(mDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+
+	for(ResourceId id = 0; id < mGraph.NumResources(); ++id)
+	{
+		if(!mGraph.IsTransient(id) || !mGraph.IsUsed(id))
+			continue;
+
+		const TextureDesc& texture = mTextureDescs[id];
+		ThrowIfFailed(mDevice->CreatePlacedResource(
+			mHeap.Get(),
+			mGraph.HeapOffset(id),
+			&texture.Desc,
+			(D3D12_RESOURCE_STATES)mGraph.StartState(id),
+			texture.HasClearValue ? &texture.ClearValue : nullptr,
+			IID_PPV_ARGS(&mResources[id])));
+	}
+}
+
+void D3DFrameGraph::SetResource(ResourceId id, ID3D12Resource* resource)
+{
+	assert(!mGraph.IsTransient(id));
+	mResources[id] = resource;
+}
+
+ID3D12Resource* D3DFrameGraph::Resource(ResourceId id)const
+{
+	return mResources[id].Get();
+}
+
+void D3DFrameGraph::RecordPass(PassId pass, ID3D12GraphicsCommandList* cmdList)
+{
+	if(mGraph.IsCulled(pass))
+		return;
+
+	RecordBarriers(cmdList, mGraph.BarriersBefore(pass));
+	mPasses[pass](cmdList);
+	RecordBarriers(cmdList, mGraph.BarriersAfter(pass));
+}
+
+void D3DFrameGraph::Record(ID3D12GraphicsCommandList* cmdList)
+{
+	for(PassId pass : mGraph.LivePasses())
+		RecordPass(pass, cmdList);
+}
+
+void D3DFrameGraph::RecordBarriers(ID3D12GraphicsCommandList* cmdList, const std::vector<FrameGraph::Barrier>& barriers)
+{
+	if(barriers.empty())
+		return;
+
+	// A pass rarely needs more than a handful of barriers.
+	const std::size_t MaxBatch = 16;
+	D3D12_RESOURCE_BARRIER batch[MaxBatch];
+	UINT count = 0;
+
+	for(const auto& barrier : barriers)
+	{
+		if(barrier.Kind == FrameGraph::Barrier::Type::Aliasing)
+		{
+			batch[count++] = CD3DX12_RESOURCE_BARRIER::Aliasing(
+				mResources[barrier.AliasBefore].Get(), mResources[barrier.Resource].Get());
+		}
+		else
+		{
+			batch[count++] = CD3DX12_RESOURCE_BARRIER::Transition(mResources[barrier.Resource].Get(),
+				(D3D12_RESOURCE_STATES)barrier.Before, (D3D12_RESOURCE_STATES)barrier.After);
+		}
+
+		if(count == MaxBatch)
+		{
+			cmdList->ResourceBarrier(count, batch);
+			count = 0;
+		}
+	}
+
+	if(count > 0)
+		cmdList->ResourceBarrier(count, batch);
+}
+
+std::string D3DFrameGraph::DumpSchedule()const
+{
+	std::ostringstream ss;
+	mGraph.Dump(ss, [](FrameGraph::State state) { return StateName((D3D12_RESOURCE_STATES)state); });
+	return ss.str();
+}
+
+std::string D3DFrameGraph::StateName(D3D12_RESOURCE_STATES state)
+{
+	if(state == D3D12_RESOURCE_STATE_COMMON)
+		return "COMMON";
+	if(state == D3D12_RESOURCE_STATE_GENERIC_READ)
+		return "GENERIC_READ";
+
+	static const std::pair<D3D12_RESOURCE_STATES, const char*> names[] =
+	{
+		{ D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER, "VERTEX_AND_CONSTANT_BUFFER" },
+		{ D3D12_RESOURCE_STATE_INDEX_BUFFER, "INDEX_BUFFER" },
+		{ D3D12_RESOURCE_STATE_RENDER_TARGET, "RENDER_TARGET" },
+		{ D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "UNORDERED_ACCESS" },
+		{ D3D12_RESOURCE_STATE_DEPTH_WRITE, "DEPTH_WRITE" },
+		{ D3D12_RESOURCE_STATE_DEPTH_READ, "DEPTH_READ" },
+		{ D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, "NON_PIXEL_SHADER_RESOURCE" },
+		{ D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, "PIXEL_SHADER_RESOURCE" },
+		{ D3D12_RESOURCE_STATE_STREAM_OUT, "STREAM_OUT" },
+		{ D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT, "INDIRECT_ARGUMENT" },
+		{ D3D12_RESOURCE_STATE_COPY_DEST, "COPY_DEST" },
+		{ D3D12_RESOURCE_STATE_COPY_SOURCE, "COPY_SOURCE" },
+		{ D3D12_RESOURCE_STATE_RESOLVE_DEST, "RESOLVE_DEST" },
+		{ D3D12_RESOURCE_STATE_RESOLVE_SOURCE, "RESOLVE_SOURCE" },
+	};
+
+	std::string name;
+	for(const auto& n : names)
+	{
+		if(state & n.first)
+			name += name.empty() ? n.second : std::string("|") + n.second;
+	}
+	return name;
+}
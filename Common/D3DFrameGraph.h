@@ -0,0 +1,95 @@
+//***************************************************************************************
+// D3DFrameGraph.h
+//
+// Runs a FrameGraph on Direct3D 12: imported resources are the app's own, transient
+// textures are placed resources in one heap created by Compile, and each pass is
+// recorded with the barriers the graph derived for it, batched into one
+// ResourceBarrier call before and one after the pass.
+//
+//   D3DFrameGraph frameGraph(md3dDevice.Get());
+//   auto backBuffer = frameGraph.Import("backBuffer", nullptr, D3D12_RESOURCE_STATE_PRESENT);
+//   auto pass = frameGraph.AddPass("main", [&](ID3D12GraphicsCommandList* cmdList) { ... });
+//   frameGraph.Graph().Write(pass, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+//   frameGraph.Graph().MarkOutput(backBuffer);
+//   frameGraph.Compile();
+//   ...
+//   frameGraph.SetResource(backBuffer, CurrentBackBuffer());
+//   frameGraph.Record(mCommandList.Get());
+//
+// Passes can also be recorded one by one with RecordPass, e.g. into several command
+// lists on different threads, as long as the lists are submitted in graph order.
+//
+// Transient textures are limited to render targets and depth buffers, so the heap
+// works on resource heap tier 1.  Compile replaces them, so views of them must be
+// created again after it, and the GPU must be done with the old ones.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FrameGraph.h"
+
+class D3DFrameGraph
+{
+public:
+	typedef FrameGraph::ResourceId ResourceId;
+	typedef FrameGraph::PassId PassId;
+	typedef std::function<void(ID3D12GraphicsCommandList*)> RecordFunc;
+
+	explicit D3DFrameGraph(ID3D12Device* device);
+	D3DFrameGraph(const D3DFrameGraph& rhs) = delete;
+	D3DFrameGraph& operator=(const D3DFrameGraph& rhs) = delete;
+
+	// Reads and writes are declared on the graph directly.
+	FrameGraph& Graph();
+	const FrameGraph& Graph()const;
+
+	// resource may be null and set later, e.g. the current back buffer each frame.
+	ResourceId Import(const std::string& name, ID3D12Resource* resource,
+		D3D12_RESOURCE_STATES initialState, D3D12_RESOURCE_STATES finalState);
+	ResourceId Import(const std::string& name, ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+
+	// desc must allow render target or depth stencil use.
+	ResourceId CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc,
+		const D3D12_CLEAR_VALUE* optimizedClearValue = nullptr);
+
+	PassId AddPass(const std::string& name, RecordFunc record, bool sideEffects = false);
+
+	// Compiles the graph and places the transient textures in a new heap.
+	void Compile();
+
+	void SetResource(ResourceId id, ID3D12Resource* resource);
+	ID3D12Resource* Resource(ResourceId id)const;
+
+	// Records one pass with its barriers.  Culled passes record nothing.
+	void RecordPass(PassId pass, ID3D12GraphicsCommandList* cmdList);
+
+	// Records every live pass in order.
+	void Record(ID3D12GraphicsCommandList* cmdList);
+
+	// The compiled schedule with state names, for debugging.
+	std::string DumpSchedule()const;
+
+	static std::string StateName(D3D12_RESOURCE_STATES state);
+
+private:
+	struct TextureDesc
+	{
+		D3D12_RESOURCE_DESC Desc;
+		bool HasClearValue;
+		D3D12_CLEAR_VALUE ClearValue;
+	};
+
+	void RecordBarriers(ID3D12GraphicsCommandList* cmdList, const std::vector<FrameGraph::Barrier>& barriers);
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+	FrameGraph mGraph;
+
+	// Indexed by ResourceId and PassId.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mResources;
+	std::vector<TextureDesc> mTextureDescs;
+	std::vector<RecordFunc> mPasses;
+
+	Microsoft::WRL::ComPtr<ID3D12Heap> mHeap;
+};
@@ -269,6 +269,95 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
 }
 
 
+//--------------------------------------------------------------------------------------
+// Validates the magic number and headers of a DDS file held in memory, and returns
+// pointers into that memory.  Nothing is copied, so this works directly on a file
+// mapping.
+//--------------------------------------------------------------------------------------
+static HRESULT ParseDDSData( _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+                             _In_ size_t ddsDataSize,
+                             const DDS_HEADER** header,
+                             const uint8_t** bitData,
+                             size_t* bitSize
+                           )
+{
+    if (!header || !bitData || !bitSize)
+    {
+        return E_POINTER;
+    }
+
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (!ddsData || ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
+    {
+        return E_FAIL;
+    }
+
+    // DDS files always start with the same magic number ("DDS ")
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        return E_FAIL;
+    }
+
+    auto hdr = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
+
+    // Verify header to validate DDS file
+    if (hdr->size != sizeof(DDS_HEADER) ||
+        hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return E_FAIL;
+    }
+
+    // Check for DX10 extension
+    bool bDXT10Header = false;
+    if ((hdr->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC( 'D', 'X', '1', '0' ) == hdr->ddspf.fourCC))
+    {
+        // Must be long enough for both headers and magic value
+        if (ddsDataSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
+        {
+            return E_FAIL;
+        }
+
+        bDXT10Header = true;
+    }
+
+    // setup the pointers in the process request
+    *header = hdr;
+    ptrdiff_t offset = sizeof( uint32_t ) + sizeof( DDS_HEADER )
+                       + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
+    *bitData = ddsData + offset;
+    *bitSize = ddsDataSize - offset;
+
+    return S_OK;
+}
+
+//--------------------------------------------------------------------------------------
+// Maps the file instead of reading it into a heap copy.  The header and bit data
+// pointers point into the mapping and stay valid while ddsFile is open.
+//--------------------------------------------------------------------------------------
+static HRESULT LoadTextureDataFromMappedFile( _In_z_ const wchar_t* fileName,
+                                              MappedFile& ddsFile,
+                                              const DDS_HEADER** header,
+                                              const uint8_t** bitData,
+                                              size_t* bitSize
+                                            )
+{
+    if (!ddsFile.Open( fileName ))
+    {
+        return HRESULT_FROM_WIN32( ddsFile.LastError() );
+    }
+
+    // File is too big for 32-bit allocation, so reject read
+    if (ddsFile.Size() > UINT32_MAX)
+    {
+        return E_FAIL;
+    }
+
+    return ParseDDSData( ddsFile.Data(), ddsFile.Size(), header, bitData, bitSize );
+}
+
+
 //--------------------------------------------------------------------------------------
 // Return the BPP for a particular format
 //--------------------------------------------------------------------------------------
@@ -551,6 +640,65 @@ static void GetSurfaceInfo( _In_ size_t width,
 }
 
 
+//--------------------------------------------------------------------------------------
+// Get the alignment of a placed subresource footprint in texels.  Returns false for
+// planar formats, which need one footprint per plane.
+//--------------------------------------------------------------------------------------
+static bool GetFootprintAlignment( _In_ DXGI_FORMAT fmt,
+                                   _Out_ size_t* alignWidth,
+                                   _Out_ size_t* alignHeight )
+{
+    *alignWidth = 1;
+    *alignHeight = 1;
+
+    switch (fmt)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        *alignWidth = 4;
+        *alignHeight = 4;
+        return true;
+
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_YUY2:
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        *alignWidth = 2;
+        return true;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+    case DXGI_FORMAT_NV11:
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+
 //--------------------------------------------------------------------------------------
 #define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
 
@@ -1230,91 +1378,71 @@ static HRESULT CreateD3DResources( _In_ ID3D11Device* d3dDevice,
 static HRESULT CreateD3DResources12(
 	ID3D12Device* device,
 	ID3D12GraphicsCommandList* cmdList,
-	_In_ uint32_t resDim,
-	_In_ size_t width,
-	_In_ size_t height,
-	_In_ size_t depth,
-	_In_ size_t mipCount,
-	_In_ size_t arraySize,
-	_In_ DXGI_FORMAT format,
-	_In_ bool forceSRGB,
-	_In_ bool isCubeMap,
-	_In_reads_opt_(mipCount*arraySize) D3D12_SUBRESOURCE_DATA* initData,
+	const DDSTextureData12& data,
 	ComPtr<ID3D12Resource>& texture,
 	ComPtr<ID3D12Resource>& textureUploadHeap
 	)
 {
-	if (device == nullptr)
+	if (device == nullptr || cmdList == nullptr)
 		return E_POINTER;
 
-	if (forceSRGB)
-		format = MakeSRGB(format);
+	if (data.Subresources.empty())
+		return E_INVALIDARG;
 
-	HRESULT hr = E_FAIL;
-	switch (resDim)
+	HRESULT hr = device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&data.Desc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&texture)
+		);
+
+	if (FAILED(hr))
 	{
-	case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+		texture = nullptr;
+		return hr;
+	}
+
+	const UINT numSubresources = (UINT)data.Subresources.size();
+	const bool hasFootprints = !data.Footprints.empty();
+	const UINT64 uploadBufferSize = hasFootprints ? data.UploadBufferSize :
+		GetRequiredIntermediateSize(texture.Get(), 0, numSubresources);
+
+	hr = device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&textureUploadHeap));
+	if (FAILED(hr))
 	{
-		D3D12_RESOURCE_DESC texDesc;
-		ZeroMemory(&texDesc, sizeof(D3D12_RESOURCE_DESC));
-		texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		texDesc.Alignment = 0;
-		texDesc.Width = width;
-		texDesc.Height = (uint32_t)height;
-		texDesc.DepthOrArraySize = (depth > 1) ? (uint16_t)depth : (uint16_t)arraySize;
-		texDesc.MipLevels = (uint16_t)mipCount;
-		texDesc.Format = format;
-		texDesc.SampleDesc.Count = 1;
-		texDesc.SampleDesc.Quality = 0;
-		texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-		texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
-		hr = device->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-			D3D12_HEAP_FLAG_NONE,
-			&texDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(&texture)
-			);
-
-		if (FAILED(hr))
-		{
-			texture = nullptr;
-			return hr;
-		}
-		else
-		{
-			const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
-			const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, num2DSubresources);
-
-			hr = device->CreateCommittedResource(
-				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
-				D3D12_HEAP_FLAG_NONE,
-				&CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize),
-				D3D12_RESOURCE_STATE_GENERIC_READ,
-				nullptr,
-				IID_PPV_ARGS(&textureUploadHeap));
-			if (FAILED(hr))
-			{
-				texture = nullptr;
-				return hr;
-			}
-			else
-			{
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+		texture = nullptr;
+		return hr;
+	}
 
-				// Use Heap-allocating UpdateSubresources implementation for variable number of subresources (which is the case for textures).
-				UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, 0, num2DSubresources, initData);
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
 
-				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
-					D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
-			}
-		}
-	} break;
+	if (hasFootprints)
+	{
+		// Footprints were computed when the file was parsed, so no device query or
+		// heap allocation is needed here.
+		UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, numSubresources,
+			data.UploadBufferSize, data.Footprints.data(), data.NumRows.data(),
+			data.RowSizesInBytes.data(), data.Subresources.data());
+	}
+	else
+	{
+		// Use Heap-allocating UpdateSubresources implementation for variable number of subresources (which is the case for textures).
+		UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, 0, numSubresources,
+			const_cast<D3D12_SUBRESOURCE_DATA*>(data.Subresources.data()));
 	}
 
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
 	return hr;
 }
 
@@ -1669,16 +1797,46 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D11Device* d3dDevice,
     return hr;
 }
 
-static HRESULT CreateTextureFromDDS12(
-	_In_ ID3D12Device* device,
-	_In_opt_ ID3D12GraphicsCommandList* cmdList,
+//--------------------------------------------------------------------------------------
+static DDS_ALPHA_MODE GetAlphaMode( _In_ const DDS_HEADER* header )
+{
+    if ( header->ddspf.flags & DDS_FOURCC )
+    {
+        if ( MAKEFOURCC( 'D', 'X', '1', '0' ) == header->ddspf.fourCC )
+        {
+            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>( (const char*)header + sizeof(DDS_HEADER) );
+            auto mode = static_cast<DDS_ALPHA_MODE>( d3d10ext->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK );
+            switch( mode )
+            {
+            case DDS_ALPHA_MODE_STRAIGHT:
+            case DDS_ALPHA_MODE_PREMULTIPLIED:
+            case DDS_ALPHA_MODE_OPAQUE:
+            case DDS_ALPHA_MODE_CUSTOM:
+                return mode;
+            }
+        }
+        else if ( ( MAKEFOURCC( 'D', 'X', 'T', '2' ) == header->ddspf.fourCC )
+                  || ( MAKEFOURCC( 'D', 'X', 'T', '4' ) == header->ddspf.fourCC ) )
+        {
+            return DDS_ALPHA_MODE_PREMULTIPLIED;
+        }
+    }
+
+    return DDS_ALPHA_MODE_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Validates the header and fills in everything needed to create and upload the
+// texture.  Does not touch the device, so it is safe to call from any thread.
+//--------------------------------------------------------------------------------------
+static HRESULT PrepareTextureFromDDS12(
 	_In_ const DDS_HEADER* header,
 	_In_reads_bytes_(bitSize) const uint8_t* bitData,
 	_In_ size_t bitSize,
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
-	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	DDSTextureData12& data)
 {
 	HRESULT hr = S_OK;
 
@@ -1835,15 +1993,7 @@ static HRESULT CreateTextureFromDDS12(
 		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 	}
 
-	// Create the texture
-	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
-		new (std::nothrow) D3D12_SUBRESOURCE_DATA[mipCount * arraySize]
-		);
-
-	if (!initData)
-	{
-		return E_OUTOFMEMORY;
-	}
+	data.Subresources.resize(mipCount * arraySize);
 
 	size_t skipMip = 0;
 	size_t twidth = 0;
@@ -1852,55 +2002,93 @@ static HRESULT CreateTextureFromDDS12(
 
 	hr = FillInitData12(
 		width, height, depth, mipCount, arraySize, format, maxsize, bitSize, bitData,
-		twidth, theight, tdepth, skipMip, initData.get()
+		twidth, theight, tdepth, skipMip, data.Subresources.data()
 		);
 
-	if (SUCCEEDED(hr))
+	if (FAILED(hr))
 	{
-		hr = CreateD3DResources12(
-			device, cmdList,
-			resDim, twidth, theight, tdepth,
-			mipCount - skipMip,
-			arraySize,
-			format,
-			false, // forceSRGB
-			isCubeMap,
-			initData.get(),
-			texture, 
-			textureUploadHeap);
+		return hr;
 	}
 
-	return hr;
-}
+	mipCount -= skipMip;
+	data.Subresources.resize(mipCount * arraySize);
 
-//--------------------------------------------------------------------------------------
-static DDS_ALPHA_MODE GetAlphaMode( _In_ const DDS_HEADER* header )
-{
-    if ( header->ddspf.flags & DDS_FOURCC )
-    {
-        if ( MAKEFOURCC( 'D', 'X', '1', '0' ) == header->ddspf.fourCC )
-        {
-            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>( (const char*)header + sizeof(DDS_HEADER) );
-            auto mode = static_cast<DDS_ALPHA_MODE>( d3d10ext->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK );
-            switch( mode )
-            {
-            case DDS_ALPHA_MODE_STRAIGHT:
-            case DDS_ALPHA_MODE_PREMULTIPLIED:
-            case DDS_ALPHA_MODE_OPAQUE:
-            case DDS_ALPHA_MODE_CUSTOM:
-                return mode;
-            }
-        }
-        else if ( ( MAKEFOURCC( 'D', 'X', 'T', '2' ) == header->ddspf.fourCC )
-                  || ( MAKEFOURCC( 'D', 'X', 'T', '4' ) == header->ddspf.fourCC ) )
-        {
-            return DDS_ALPHA_MODE_PREMULTIPLIED;
-        }
-    }
+	if (forceSRGB)
+		format = MakeSRGB(format);
 
-    return DDS_ALPHA_MODE_UNKNOWN;
-}
+	D3D12_RESOURCE_DESC& texDesc = data.Desc;
+	ZeroMemory(&texDesc, sizeof(D3D12_RESOURCE_DESC));
+	texDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(resDim);
+	texDesc.Alignment = 0;
+	texDesc.Width = twidth;
+	texDesc.Height = (uint32_t)theight;
+	texDesc.DepthOrArraySize = (tdepth > 1) ? (uint16_t)tdepth : (uint16_t)arraySize;
+	texDesc.MipLevels = (uint16_t)mipCount;
+	texDesc.Format = format;
+	texDesc.SampleDesc.Count = 1;
+	texDesc.SampleDesc.Quality = 0;
+	texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	data.IsCubeMap = isCubeMap;
+	data.AlphaMode = GetAlphaMode(header);
+
+	// Lay out the subresources in an upload buffer the same way GetCopyableFootprints
+	// would, so the footprints do not have to be queried from the device later.
+	data.Footprints.clear();
+	data.NumRows.clear();
+	data.RowSizesInBytes.clear();
+	data.UploadBufferSize = 0;
+
+	size_t alignWidth = 1;
+	size_t alignHeight = 1;
+	if (GetFootprintAlignment(format, &alignWidth, &alignHeight))
+	{
+		data.Footprints.resize(data.Subresources.size());
+		data.NumRows.resize(data.Subresources.size());
+		data.RowSizesInBytes.resize(data.Subresources.size());
+
+		UINT64 offset = 0;
+		size_t index = 0;
+		for (size_t j = 0; j < arraySize; j++)
+		{
+			size_t w = twidth;
+			size_t h = theight;
+			size_t d = tdepth;
+			for (size_t i = 0; i < mipCount; i++)
+			{
+				size_t NumBytes = 0;
+				size_t RowBytes = 0;
+				size_t NumRows = 0;
+				GetSurfaceInfo(w, h, format, &NumBytes, &RowBytes, &NumRows);
+
+				offset = (offset + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~UINT64(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+
+				D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = data.Footprints[index];
+				layout.Offset = offset;
+				layout.Footprint.Format = format;
+				layout.Footprint.Width = (UINT)((w + alignWidth - 1) / alignWidth * alignWidth);
+				layout.Footprint.Height = (UINT)((h + alignHeight - 1) / alignHeight * alignHeight);
+				layout.Footprint.Depth = (UINT)d;
+				layout.Footprint.RowPitch = (UINT)((RowBytes + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) & ~size_t(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1));
+
+				data.NumRows[index] = (UINT)NumRows;
+				data.RowSizesInBytes[index] = RowBytes;
 
+				offset += UINT64(layout.Footprint.RowPitch) * NumRows * d;
+				++index;
+
+				w = std::max<size_t>(w >> 1, 1);
+				h = std::max<size_t>(h >> 1, 1);
+				d = std::max<size_t>(d >> 1, 1);
+			}
+		}
+
+		data.UploadBufferSize = offset;
+	}
+
+	return hr;
+}
 
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
@@ -1937,57 +2125,162 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		return E_INVALIDARG;
 	}
 
-	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
-	if (dwMagicNumber != DDS_MAGIC)
+	DDSTextureData12 data;
+	HRESULT hr = LoadDDSTextureDataFromMemory12(ddsData, ddsDataSize, data, maxsize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	hr = CreateDDSTextureFromData12(device, cmdList, data, texture, textureUploadHeap);
+
+	if (SUCCEEDED(hr))
+	{
+		if (alphaMode)
+			(*alphaMode) = data.AlphaMode;
+	}
+
+	return hr;
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::LoadDDSTextureDataFromMemory12(
+	const uint8_t* ddsData,
+	size_t ddsDataSize,
+	DDSTextureData12& data,
+	size_t maxsize
+	)
+{
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	HRESULT hr = ParseDDSData(ddsData, ddsDataSize, &header, &bitData, &bitSize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	return PrepareTextureFromDDS12(header, bitData, bitSize, maxsize, false, data);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::LoadDDSTextureDataFromFile12(
+	const wchar_t* szFileName,
+	DDSTextureData12& data,
+	size_t maxsize
+	)
+{
+	if (!szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	// The subresource data points straight into the file mapping, so the only copy
+	// made is the one UpdateSubresources does into the upload heap.  data keeps the
+	// mapping open until then.
+	HRESULT hr = LoadTextureDataFromMappedFile(szFileName, data.File, &header, &bitData, &bitSize);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	return PrepareTextureFromDDS12(header, bitData, bitSize, maxsize, false, data);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromData12(
+	ID3D12Device* device,
+	ID3D12GraphicsCommandList* cmdList,
+	const DDSTextureData12& data,
+	ComPtr<ID3D12Resource>& texture,
+	ComPtr<ID3D12Resource>& textureUploadHeap
+	)
+{
+	if (texture)
+	{
+		texture = nullptr;
+	}
+	if (textureUploadHeap)
+	{
+		textureUploadHeap = nullptr;
+	}
+
+	if (!device || !cmdList)
 	{
-		return E_FAIL;
+		return E_INVALIDARG;
 	}
 
-	auto header = reinterpret_cast<const DDS_HEADER*>(ddsData + sizeof(uint32_t));
+	return CreateD3DResources12(device, cmdList, data, texture, textureUploadHeap);
+}
 
-	// Verify header to validate DDS file
-	if (header->size != sizeof(DDS_HEADER) ||
-		header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromData12(
+	ID3D12Device* device,
+	ID3D12GraphicsCommandList* cmdList,
+	const DDSTextureData12& data,
+	ComPtr<ID3D12Resource>& texture,
+	ID3D12Resource* uploadBuffer,
+	UINT64 uploadOffset
+	)
+{
+	if (texture)
 	{
-		return E_FAIL;
+		texture = nullptr;
 	}
 
-	// Check for DX10 extension
-	bool bDXT10Header = false;
-	if ((header->ddspf.flags & DDS_FOURCC) &&
-		(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+	if (!device || !cmdList || !uploadBuffer || data.Subresources.empty())
 	{
-		// Must be long enough for both headers and magic value
-		if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
-		{
-			return E_FAIL;
-		}
+		return E_INVALIDARG;
+	}
+
+	if (data.Footprints.empty())
+	{
+		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+	}
 
-		bDXT10Header = true;
+	if (uploadOffset % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT != 0 ||
+		uploadBuffer->GetDesc().Width < uploadOffset + data.UploadBufferSize)
+	{
+		return E_INVALIDARG;
 	}
 
-	ptrdiff_t offset = sizeof(uint32_t)
-		+ sizeof(DDS_HEADER)
-		+ (bDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
-
-	HRESULT hr = CreateTextureFromDDS12(
-		device,
-		cmdList,
-		header,
-		ddsData + offset,
-		ddsDataSize - offset,
-		maxsize,
-		false,
-		texture,
-		textureUploadHeap
+	HRESULT hr = device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&data.Desc,
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(&texture)
 		);
 
-	if (SUCCEEDED(hr))
+	if (FAILED(hr))
 	{
-		if (alphaMode)
-			(*alphaMode) = GetAlphaMode(header);
+		texture = nullptr;
+		return hr;
+	}
+
+	// The footprints are relative to the start of the upload range.
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(data.Footprints);
+	for (auto& layout : layouts)
+	{
+		layout.Offset += uploadOffset;
 	}
 
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+
+	UpdateSubresources(cmdList, texture.Get(), uploadBuffer, 0, (UINT)data.Subresources.size(),
+		data.UploadBufferSize, layouts.data(), data.NumRows.data(),
+		data.RowSizesInBytes.data(), data.Subresources.data());
+
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
 	return hr;
 }
 
@@ -2160,19 +2453,14 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return E_INVALIDARG;
 	}
 
-	DDS_HEADER* header = nullptr;
-	uint8_t* bitData = nullptr;
-	size_t bitSize = 0;
-
-	std::unique_ptr<uint8_t[]> ddsData;
-	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
+	DDSTextureData12 data;
+	HRESULT hr = LoadDDSTextureDataFromFile12(szFileName, data, maxsize);
 	if (FAILED(hr))
 	{
 		return hr;
 	}
 
-	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+	hr = CreateDDSTextureFromData12(device, cmdList, data, texture, textureUploadHeap);
 
 	if (SUCCEEDED(hr))
 	{
@@ -2222,7 +2510,7 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 #endif
 */
 		if (alphaMode)
-			*alphaMode = GetAlphaMode(header);
+			*alphaMode = data.AlphaMode;
 	}
 
 	return hr;
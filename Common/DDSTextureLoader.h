@@ -25,6 +25,8 @@
 #include <wrl.h>
 #include <d3d11_1.h>
 #include "d3dx12.h"
+#include <vector>
+#include "MappedFile.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4005)
@@ -55,6 +57,29 @@ namespace DirectX
         DDS_ALPHA_MODE_CUSTOM        = 4,
     };
 
+    // Everything needed to create and upload a Direct3D 12 texture from a DDS file.
+    // Filling it in does not touch the device, so files can be loaded and parsed on
+    // worker threads (see AsyncTextureLoader.h) and only CreateDDSTextureFromData12
+    // has to run on the thread recording the command list.
+    struct DDSTextureData12
+    {
+        D3D12_RESOURCE_DESC Desc;
+        bool IsCubeMap = false;
+        DDS_ALPHA_MODE AlphaMode = DDS_ALPHA_MODE_UNKNOWN;
+
+        // Points into File, or into the caller's memory for LoadDDSTextureDataFromMemory12.
+        std::vector<D3D12_SUBRESOURCE_DATA> Subresources;
+
+        // Layout of the subresources in the upload buffer.  Empty for planar formats,
+        // in which case the layout is queried from the device.
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Footprints;
+        std::vector<UINT> NumRows;
+        std::vector<UINT64> RowSizesInBytes;
+        UINT64 UploadBufferSize = 0;
+
+        MappedFile File;
+    };
+
     // Standard version
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -83,6 +108,36 @@ namespace DirectX
                                       _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
                                     );
 
+	HRESULT LoadDDSTextureDataFromMemory12(_In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                                   _In_ size_t ddsDataSize,
+		                                   _Out_ DDSTextureData12& data,
+		                                   _In_ size_t maxsize = 0
+		                                   );
+
+	HRESULT LoadDDSTextureDataFromFile12(_In_z_ const wchar_t* szFileName,
+		                                 _Out_ DDSTextureData12& data,
+		                                 _In_ size_t maxsize = 0
+		                                 );
+
+	HRESULT CreateDDSTextureFromData12(_In_ ID3D12Device* device,
+		                               _In_ ID3D12GraphicsCommandList* cmdList,
+		                               _In_ const DDSTextureData12& data,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap
+		                               );
+
+	// Records the upload through caller owned upload memory (for example a ring, see
+	// UploadRing.h) instead of creating an upload heap.  uploadBuffer must have
+	// data.UploadBufferSize bytes available at uploadOffset, which must be a multiple
+	// of D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT.  Fails for planar formats.
+	HRESULT CreateDDSTextureFromData12(_In_ ID3D12Device* device,
+		                               _In_ ID3D12GraphicsCommandList* cmdList,
+		                               _In_ const DDSTextureData12& data,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                               _In_ ID3D12Resource* uploadBuffer,
+		                               _In_ UINT64 uploadOffset
+		                               );
+
 	HRESULT CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		                               _In_ ID3D12GraphicsCommandList* cmdList,
 		                               _In_z_ const wchar_t* szFileName,
@@ -0,0 +1,94 @@
+//***************************************************************************************
+// DescriptorAllocator.cpp
+//***************************************************************************************
+
+#include "DescriptorAllocator.h"
+
+DescriptorAllocator::DescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+	UINT numPersistent, UINT numTransient) :
+	mNumPersistent(numPersistent),
+	mPersistent(numPersistent),
+	mTransient(numTransient)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+	heapDesc.NumDescriptors = numPersistent + numTransient;
+	heapDesc.Type = type;
+	heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+	ThrowIfFailed(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&mHeap)));
+
+	mDescriptorSize = device->GetDescriptorHandleIncrementSize(type);
+}
+
+ID3D12DescriptorHeap* DescriptorAllocator::Heap()const
+{
+	return mHeap.Get();
+}
+
+UINT DescriptorAllocator::DescriptorSize()const
+{
+	return mDescriptorSize;
+}
+
+DescriptorRange DescriptorAllocator::AllocatePersistent(UINT count)
+{
+	UINT index = mPersistent.Allocate(count);
+	if(index == FreeListAllocator::InvalidOffset)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	return MakeRange(index, count);
+}
+
+void DescriptorAllocator::FreePersistent(DescriptorRange& range, UINT64 fenceValue)
+{
+	if(!range.IsValid())
+		return;
+
+	if(fenceValue == 0)
+		mPersistent.Free(range.Index, range.Count);
+	else
+		mPersistent.Free(range.Index, range.Count, fenceValue);
+
+	range = DescriptorRange();
+}
+
+DescriptorRange DescriptorAllocator::AllocateTransient(UINT count)
+{
+	UINT64 offset = mTransient.Allocate(count);
+	if(offset == RingAllocator::InvalidOffset)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	// The transient part of the heap follows the persistent one.
+	return MakeRange(mNumPersistent + (UINT)offset, count);
+}
+
+void DescriptorAllocator::FinishFrame(UINT64 fenceValue)
+{
+	mTransient.FinishFrame(fenceValue);
+}
+
+void DescriptorAllocator::ReleaseCompleted(UINT64 completedFenceValue)
+{
+	mTransient.ReleaseCompleted(completedFenceValue);
+	mPersistent.ReleaseCompleted(completedFenceValue);
+}
+
+UINT DescriptorAllocator::NumPersistentUsed()const
+{
+	return mPersistent.UsedSize();
+}
+
+UINT DescriptorAllocator::NumTransientUsed()const
+{
+	return (UINT)mTransient.UsedSize();
+}
+
+DescriptorRange DescriptorAllocator::MakeRange(UINT index, UINT count)const
+{
+	DescriptorRange range;
+	range.Index = index;
+	range.Count = count;
+	range.DescriptorSize = mDescriptorSize;
+	range.CpuStart = CD3DX12_CPU_DESCRIPTOR_HANDLE(mHeap->GetCPUDescriptorHandleForHeapStart(), (INT)index, mDescriptorSize);
+	range.GpuStart = CD3DX12_GPU_DESCRIPTOR_HANDLE(mHeap->GetGPUDescriptorHandleForHeapStart(), (INT)index, mDescriptorSize);
+	return range;
+}
@@ -0,0 +1,96 @@
+//***************************************************************************************
+// DescriptorAllocator.h
+//
+// Hands out descriptors from one shader visible heap, in place of descriptor indices
+// fixed when the heap is built.  The heap is split in two parts:
+//
+//   - persistent descriptors, e.g. the SRV of a texture, live until they are freed
+//     and come from a FreeListAllocator,
+//   - transient descriptors are written every frame and come from a RingAllocator;
+//     they are reclaimed once the fence value passed to FinishFrame completes:
+//
+//   auto textures = srvAllocator.AllocatePersistent(10);
+//   md3dDevice->CreateShaderResourceView(tex, &srvDesc, textures.Cpu(i));
+//   ...
+//   auto table = srvAllocator.AllocateTransient(3);
+//   ... create or copy the views, then SetGraphicsRootDescriptorTable(n, table.Gpu()) ...
+//   mCommandQueue->Signal(mFence.Get(), ++mCurrentFence);
+//   srvAllocator.FinishFrame(mCurrentFence);
+//   ...
+//   srvAllocator.ReleaseCompleted(mFence->GetCompletedValue());
+//
+// Descriptors can therefore be created and recycled at runtime without rebuilding
+// the heap.  Running out of space throws.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FreeListAllocator.h"
+#include "RingAllocator.h"
+
+// A contiguous range of descriptors, usable as a descriptor table.
+struct DescriptorRange
+{
+	UINT Index = 0;
+	UINT Count = 0;
+
+	D3D12_CPU_DESCRIPTOR_HANDLE CpuStart = {};
+	D3D12_GPU_DESCRIPTOR_HANDLE GpuStart = {};
+	UINT DescriptorSize = 0;
+
+	bool IsValid()const { return Count != 0; }
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE Cpu(UINT i = 0)const
+	{
+		return CD3DX12_CPU_DESCRIPTOR_HANDLE(CpuStart, (INT)i, DescriptorSize);
+	}
+
+	CD3DX12_GPU_DESCRIPTOR_HANDLE Gpu(UINT i = 0)const
+	{
+		return CD3DX12_GPU_DESCRIPTOR_HANDLE(GpuStart, (INT)i, DescriptorSize);
+	}
+};
+
+class DescriptorAllocator
+{
+public:
+	// type is CBV_SRV_UAV or SAMPLER, the heap types that can be shader visible.
+	DescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type,
+		UINT numPersistent, UINT numTransient);
+	DescriptorAllocator(const DescriptorAllocator& rhs) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator& rhs) = delete;
+
+	ID3D12DescriptorHeap* Heap()const;
+	UINT DescriptorSize()const;
+
+	DescriptorRange AllocatePersistent(UINT count);
+
+	// The range may still be used by command lists in flight, so it is only reused
+	// once fenceValue is complete.  Pass 0 if the GPU no longer uses it.
+	void FreePersistent(DescriptorRange& range, UINT64 fenceValue);
+
+	// Valid until the fence value of the frame completes.
+	DescriptorRange AllocateTransient(UINT count);
+
+	// Transient descriptors allocated since the last call are reclaimed once
+	// fenceValue completes.
+	void FinishFrame(UINT64 fenceValue);
+
+	// Reclaims transient frames and freed persistent ranges whose fence completed.
+	void ReleaseCompleted(UINT64 completedFenceValue);
+
+	UINT NumPersistentUsed()const;
+	UINT NumTransientUsed()const;
+
+private:
+	DescriptorRange MakeRange(UINT index, UINT count)const;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> mHeap;
+	UINT mDescriptorSize = 0;
+	UINT mNumPersistent = 0;
+
+	FreeListAllocator mPersistent;
+	RingAllocator mTransient;
+};
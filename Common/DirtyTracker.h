@@ -0,0 +1,125 @@
+//***************************************************************************************
+// DirtyTracker.h
+//
+// Tracks, per frame resource, which elements of a constant/structured buffer need to
+// be rewritten.  Instead of walking every object each frame to check a NumFramesDirty
+// counter, each frame resource keeps a list of the dirty element indices, so clean
+// elements cost nothing and contiguous dirty elements can be written as one range.
+//***************************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+class DirtyTracker
+{
+public:
+	DirtyTracker(int numFrameResources, unsigned int elementCount = 0) :
+		mFrames(numFrameResources)
+	{
+		Resize(elementCount);
+	}
+
+	DirtyTracker(const DirtyTracker& rhs) = delete;
+	DirtyTracker& operator=(const DirtyTracker& rhs) = delete;
+
+	unsigned int ElementCount()const
+	{
+		return mElementCount;
+	}
+
+	// Newly added elements start out dirty in every frame resource.
+	void Resize(unsigned int elementCount)
+	{
+		unsigned int oldCount = mElementCount;
+		mElementCount = elementCount;
+
+		for(auto& frame : mFrames)
+		{
+			frame.Dirty.resize(elementCount, false);
+
+			// Drop indices that no longer exist.
+			frame.DirtyList.erase(
+				std::remove_if(frame.DirtyList.begin(), frame.DirtyList.end(),
+					[elementCount](unsigned int i) { return i >= elementCount; }),
+				frame.DirtyList.end());
+		}
+
+		for(unsigned int i = oldCount; i < elementCount; ++i)
+			MarkDirty(i);
+	}
+
+	// Because we have a buffer for each FrameResource, a modified element has to be
+	// rewritten in each of them.
+	void MarkDirty(unsigned int index)
+	{
+		assert(index < mElementCount);
+
+		for(auto& frame : mFrames)
+		{
+			if(!frame.Dirty[index])
+			{
+				frame.Dirty[index] = true;
+				frame.DirtyList.push_back(index);
+			}
+		}
+	}
+
+	void MarkAllDirty()
+	{
+		for(unsigned int i = 0; i < mElementCount; ++i)
+			MarkDirty(i);
+	}
+
+	bool IsDirty(int frameIndex, unsigned int index)const
+	{
+		return mFrames[frameIndex].Dirty[index];
+	}
+
+	unsigned int DirtyCount(int frameIndex)const
+	{
+		return (unsigned int)mFrames[frameIndex].DirtyList.size();
+	}
+
+	// Calls fn(firstIndex, count) for each run of consecutive dirty elements of the
+	// given frame resource, in increasing index order, and marks them clean.
+	template<typename Fn>
+	void ConsumeDirtyRanges(int frameIndex, Fn&& fn)
+	{
+		FrameState& frame = mFrames[frameIndex];
+		if(frame.DirtyList.empty())
+			return;
+
+		std::sort(frame.DirtyList.begin(), frame.DirtyList.end());
+
+		size_t i = 0;
+		while(i < frame.DirtyList.size())
+		{
+			unsigned int first = frame.DirtyList[i];
+			unsigned int count = 1;
+			while(i + count < frame.DirtyList.size() && frame.DirtyList[i + count] == first + count)
+				++count;
+
+			fn(first, count);
+
+			for(unsigned int k = 0; k < count; ++k)
+				frame.Dirty[first + k] = false;
+
+			i += count;
+		}
+
+		frame.DirtyList.clear();
+	}
+
+private:
+	struct FrameState
+	{
+		std::vector<bool> Dirty;
+		std::vector<unsigned int> DirtyList;
+	};
+
+	std::vector<FrameState> mFrames;
+	unsigned int mElementCount = 0;
+};
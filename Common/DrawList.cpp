@@ -0,0 +1,118 @@
+//***************************************************************************************
+// DrawList.cpp
+//***************************************************************************************
+
+#include "DrawList.h"
+#include <algorithm>
+
+namespace
+{
+	DrawList::uint64 Field(DrawList::uint32 value, DrawList::uint32 bits)
+	{
+		return (DrawList::uint64)(value & ((1u << bits) - 1));
+	}
+
+	DrawList::uint32 QuantizeDepth(float depth)
+	{
+		const float maxValue = (float)((1u << DrawList::DepthBits) - 1);
+
+		depth = std::min(std::max(depth, 0.0f), 1.0f);
+		return (DrawList::uint32)(depth*maxValue);
+	}
+}
+
+DrawList::uint64 DrawList::MakeKey(uint32 layer, uint32 pso, uint32 material, uint32 geometry, float depth)
+{
+	uint64 key = Field(layer, LayerBits);
+	key = (key << PsoBits)      | Field(pso, PsoBits);
+	key = (key << MaterialBits) | Field(material, MaterialBits);
+	key = (key << GeometryBits) | Field(geometry, GeometryBits);
+	key = (key << DepthBits)    | Field(QuantizeDepth(depth), DepthBits);
+
+	return key;
+}
+
+DrawList::uint64 DrawList::MakeBackToFrontKey(uint32 layer, uint32 pso, uint32 material, uint32 geometry, float depth)
+{
+	// Farthest first, then by state.
+	uint32 invDepth = ((1u << DepthBits) - 1) - QuantizeDepth(depth);
+
+	uint64 key = Field(layer, LayerBits);
+	key = (key << DepthBits)    | Field(invDepth, DepthBits);
+	key = (key << PsoBits)      | Field(pso, PsoBits);
+	key = (key << MaterialBits) | Field(material, MaterialBits);
+	key = (key << GeometryBits) | Field(geometry, GeometryBits);
+
+	return key;
+}
+
+DrawList::uint32 DrawList::LayerFromKey(uint64 key)
+{
+	return (uint32)(key >> (64 - LayerBits));
+}
+
+void DrawList::Clear()
+{
+	mEntries.clear();
+}
+
+void DrawList::Reserve(size_t count)
+{
+	mEntries.reserve(count);
+	mScratch.reserve(count);
+}
+
+void DrawList::Add(uint64 key, uint32 item)
+{
+	mEntries.push_back({ key, item });
+}
+
+void DrawList::Sort()
+{
+	const size_t n = mEntries.size();
+	if(n < 2)
+		return;
+
+	mScratch.resize(n);
+
+	// Least significant digit radix sort, 8 bits per pass.  Passes where every key
+	// has the same digit (common for the unused/high fields) are skipped.
+	Entry* src = mEntries.data();
+	Entry* dst = mScratch.data();
+
+	for(uint32 shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = { 0 };
+		for(size_t i = 0; i < n; ++i)
+			counts[(src[i].Key >> shift) & 0xff]++;
+
+		if(counts[(src[0].Key >> shift) & 0xff] == n)
+			continue;
+
+		size_t offset = 0;
+		for(size_t& c : counts)
+		{
+			size_t count = c;
+			c = offset;
+			offset += count;
+		}
+
+		for(size_t i = 0; i < n; ++i)
+			dst[counts[(src[i].Key >> shift) & 0xff]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if(src != mEntries.data())
+		std::copy(src, src + n, mEntries.data());
+}
+
+const std::vector<DrawList::Entry>& DrawList::Entries()const
+{
+	return mEntries;
+}
+
+size_t DrawList::Size()const
+{
+	return mEntries.size();
+}
@@ -0,0 +1,94 @@
+//***************************************************************************************
+// DrawList.h
+//
+// Builds a list of draws ordered by 64-bit sort keys, so that draws sharing the same
+// state end up next to each other and state changes are only issued when the state
+// actually changes (see CommandStateCache.h).  Opaque draws within a state group are
+// ordered front-to-back to help early-Z; layers that need blending can be ordered
+// back-to-front instead.
+//
+// Key layout, from the most significant bit:
+//
+//   | layer (4) | pso (10) | material (12) | geometry (14) | depth (24) |
+//
+// For back-to-front keys the depth is inverted and moved right after the layer, so
+// that the depth order wins over the state order.
+//
+// The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class DrawList
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	struct Entry
+	{
+		uint64 Key;
+
+		// Client defined; usually an index into an array of render items.
+		uint32 Item;
+	};
+
+	static const uint32 LayerBits    = 4;
+	static const uint32 PsoBits      = 10;
+	static const uint32 MaterialBits = 12;
+	static const uint32 GeometryBits = 14;
+	static const uint32 DepthBits    = 24;
+
+	// depth is a normalized view depth in [0, 1]; values outside are clamped.  The
+	// ids are truncated to the width of their field.
+	static uint64 MakeKey(uint32 layer, uint32 pso, uint32 material, uint32 geometry, float depth);
+	static uint64 MakeBackToFrontKey(uint32 layer, uint32 pso, uint32 material, uint32 geometry, float depth);
+
+	static uint32 LayerFromKey(uint64 key);
+
+	void Clear();
+	void Reserve(size_t count);
+	void Add(uint64 key, uint32 item);
+
+	// Radix sorts the entries by key (stable).
+	void Sort();
+
+	const std::vector<Entry>& Entries()const;
+	size_t Size()const;
+
+private:
+	std::vector<Entry> mEntries;
+	std::vector<Entry> mScratch;
+};
+
+// Hands out small consecutive ids for pointers (PSOs, geometries, ...), so that they
+// fit in a sort key field.
+template<typename T>
+class DrawIdTable
+{
+public:
+	std::uint32_t GetId(const T* p)
+	{
+		auto it = mIds.find(p);
+		if(it != mIds.end())
+			return it->second;
+
+		std::uint32_t id = (std::uint32_t)mIds.size();
+		mIds[p] = id;
+		return id;
+	}
+
+	void Clear()
+	{
+		mIds.clear();
+	}
+
+private:
+	std::unordered_map<const T*, std::uint32_t> mIds;
+};
@@ -0,0 +1,424 @@
+//***************************************************************************************
+// FrameGraph.cpp
+//***************************************************************************************
+
+#include "FrameGraph.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	FrameGraph::uint64 AlignUp(FrameGraph::uint64 value, FrameGraph::uint64 alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// The states one live pass needs, one entry per resource in the order the pass
+	// declared them.
+	typedef std::vector<std::pair<FrameGraph::ResourceId, FrameGraph::State>> PassStates;
+}
+
+FrameGraph::ResourceId FrameGraph::Import(const std::string& name, State initialState, State finalState)
+{
+	Resource resource;
+	resource.Name = name;
+	resource.InitialState = initialState;
+	resource.FinalState = finalState;
+	mResources.push_back(resource);
+	return (ResourceId)mResources.size() - 1;
+}
+
+FrameGraph::ResourceId FrameGraph::Import(const std::string& name, State state)
+{
+	return Import(name, state, state);
+}
+
+FrameGraph::ResourceId FrameGraph::CreateTransient(const std::string& name, uint64 size, uint64 alignment)
+{
+	if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+		throw std::invalid_argument("FrameGraph: alignment of " + name + " is not a power of two");
+
+	Resource resource;
+	resource.Name = name;
+	resource.Transient = true;
+	resource.Size = size;
+	resource.Alignment = alignment;
+	mResources.push_back(resource);
+	return (ResourceId)mResources.size() - 1;
+}
+
+void FrameGraph::MarkOutput(ResourceId resource)
+{
+	mResources.at(resource).Output = true;
+}
+
+FrameGraph::PassId FrameGraph::AddPass(const std::string& name, bool sideEffects)
+{
+	Pass pass;
+	pass.Name = name;
+	pass.SideEffects = sideEffects;
+	mPasses.push_back(pass);
+	return (PassId)mPasses.size() - 1;
+}
+
+void FrameGraph::Read(PassId pass, ResourceId resource, State state)
+{
+	mResources.at(resource);
+	mPasses.at(pass).Accesses.push_back({ resource, state, false });
+}
+
+void FrameGraph::Write(PassId pass, ResourceId resource, State state)
+{
+	mResources.at(resource);
+	mPasses.at(pass).Accesses.push_back({ resource, state, true });
+}
+
+void FrameGraph::Compile()
+{
+	CullPasses();
+	PlaceTransients();
+	BuildBarriers();
+}
+
+bool FrameGraph::IsCulled(PassId pass)const
+{
+	return mPasses[pass].Culled;
+}
+
+const std::vector<FrameGraph::PassId>& FrameGraph::LivePasses()const
+{
+	return mLivePasses;
+}
+
+const std::vector<FrameGraph::Barrier>& FrameGraph::BarriersBefore(PassId pass)const
+{
+	return mPasses[pass].Before;
+}
+
+const std::vector<FrameGraph::Barrier>& FrameGraph::BarriersAfter(PassId pass)const
+{
+	return mPasses[pass].After;
+}
+
+bool FrameGraph::IsTransient(ResourceId resource)const
+{
+	return mResources[resource].Transient;
+}
+
+bool FrameGraph::IsUsed(ResourceId resource)const
+{
+	return mResources[resource].FirstUse != Invalid;
+}
+
+FrameGraph::uint64 FrameGraph::HeapOffset(ResourceId resource)const
+{
+	return mResources[resource].Offset;
+}
+
+FrameGraph::uint64 FrameGraph::HeapSize()const
+{
+	return mHeapSize;
+}
+
+FrameGraph::uint64 FrameGraph::HeapAlignment()const
+{
+	return mHeapAlignment;
+}
+
+FrameGraph::State FrameGraph::StartState(ResourceId resource)const
+{
+	return mResources[resource].StartState;
+}
+
+const std::string& FrameGraph::ResourceName(ResourceId resource)const
+{
+	return mResources[resource].Name;
+}
+
+const std::string& FrameGraph::PassName(PassId pass)const
+{
+	return mPasses[pass].Name;
+}
+
+FrameGraph::uint32 FrameGraph::NumResources()const
+{
+	return (uint32)mResources.size();
+}
+
+FrameGraph::uint32 FrameGraph::NumPasses()const
+{
+	return (uint32)mPasses.size();
+}
+
+void FrameGraph::CullPasses()
+{
+	// Walk the passes backwards: a pass is needed if it has side effects or writes a
+	// resource that an output or a later needed pass reads.
+	std::vector<bool> needed(mResources.size());
+	for(std::size_t i = 0; i < mResources.size(); ++i)
+		needed[i] = mResources[i].Output;
+
+	for(std::size_t i = mPasses.size(); i-- > 0;)
+	{
+		Pass& pass = mPasses[i];
+
+		bool live = pass.SideEffects;
+		for(const Access& access : pass.Accesses)
+			live = live || (access.Write && needed[access.Resource]);
+
+		pass.Culled = !live;
+		if(live)
+		{
+			for(const Access& access : pass.Accesses)
+			{
+				if(!access.Write)
+					needed[access.Resource] = true;
+			}
+		}
+	}
+
+	mLivePasses.clear();
+	for(PassId i = 0; i < (PassId)mPasses.size(); ++i)
+	{
+		if(!mPasses[i].Culled)
+			mLivePasses.push_back(i);
+	}
+}
+
+void FrameGraph::PlaceTransients()
+{
+	for(Resource& resource : mResources)
+	{
+		resource.FirstUse = Invalid;
+		resource.LastUse = Invalid;
+		resource.StartState = resource.InitialState;
+		resource.Offset = 0;
+	}
+
+	// Lifetimes, and the state a transient resource is left in at the end of a frame.
+	for(uint32 i = 0; i < (uint32)mLivePasses.size(); ++i)
+	{
+		for(const Access& access : mPasses[mLivePasses[i]].Accesses)
+		{
+			Resource& resource = mResources[access.Resource];
+			if(resource.LastUse != i)
+			{
+				if(resource.FirstUse == Invalid)
+					resource.FirstUse = i;
+				resource.LastUse = i;
+				if(resource.Transient)
+					resource.StartState = 0;
+			}
+			if(resource.Transient)
+				resource.StartState |= access.Required;
+		}
+	}
+
+	// Largest first; each resource takes the lowest offset that does not overlap the
+	// memory of a resource placed before it whose lifetime overlaps its own.
+	std::vector<ResourceId> order;
+	for(ResourceId i = 0; i < (ResourceId)mResources.size(); ++i)
+	{
+		if(mResources[i].Transient && IsUsed(i))
+			order.push_back(i);
+	}
+	std::stable_sort(order.begin(), order.end(), [this](ResourceId a, ResourceId b)
+	{
+		return mResources[a].Size > mResources[b].Size;
+	});
+
+	mHeapSize = 0;
+	mHeapAlignment = 1;
+
+	std::vector<ResourceId> placed;
+	for(ResourceId id : order)
+	{
+		Resource& resource = mResources[id];
+
+		std::vector<ResourceId> live;
+		for(ResourceId other : placed)
+		{
+			const Resource& o = mResources[other];
+			if(o.FirstUse <= resource.LastUse && resource.FirstUse <= o.LastUse)
+				live.push_back(other);
+		}
+
+		std::vector<uint64> candidates(1, 0);
+		for(ResourceId other : live)
+			candidates.push_back(AlignUp(mResources[other].Offset + mResources[other].Size, resource.Alignment));
+		std::sort(candidates.begin(), candidates.end());
+
+		for(uint64 offset : candidates)
+		{
+			bool fits = true;
+			for(ResourceId other : live)
+			{
+				const Resource& o = mResources[other];
+				fits = fits && (offset + resource.Size <= o.Offset || o.Offset + o.Size <= offset);
+			}
+
+			if(fits)
+			{
+				resource.Offset = offset;
+				break;
+			}
+		}
+
+		placed.push_back(id);
+		mHeapSize = std::max(mHeapSize, resource.Offset + resource.Size);
+		mHeapAlignment = std::max(mHeapAlignment, resource.Alignment);
+	}
+}
+
+void FrameGraph::BuildBarriers()
+{
+	std::vector<State> state(mResources.size());
+	for(std::size_t i = 0; i < mResources.size(); ++i)
+		state[i] = mResources[i].StartState;
+
+	for(Pass& pass : mPasses)
+	{
+		pass.Before.clear();
+		pass.After.clear();
+	}
+
+	for(uint32 i = 0; i < (uint32)mLivePasses.size(); ++i)
+	{
+		Pass& pass = mPasses[mLivePasses[i]];
+
+		PassStates passStates;
+		for(const Access& access : pass.Accesses)
+		{
+			auto it = std::find_if(passStates.begin(), passStates.end(),
+				[&](const PassStates::value_type& s) { return s.first == access.Resource; });
+			if(it == passStates.end())
+				passStates.push_back({ access.Resource, access.Required });
+			else
+				it->second |= access.Required;
+		}
+
+		// A transient resource that shares memory takes it over from the resource
+		// that used it last: earlier in this frame, or else at the end of the last one.
+		for(const auto& s : passStates)
+		{
+			const Resource& resource = mResources[s.first];
+			if(!resource.Transient || resource.FirstUse != i)
+				continue;
+
+			ResourceId before = Invalid;
+			bool beforeThisFrame = false;
+			for(ResourceId other = 0; other < (ResourceId)mResources.size(); ++other)
+			{
+				const Resource& o = mResources[other];
+				if(other == s.first || !o.Transient || !IsUsed(other) || !Overlap(resource, o))
+					continue;
+
+				bool thisFrame = o.LastUse < i;
+				if(before == Invalid || (thisFrame && !beforeThisFrame) ||
+				   (thisFrame == beforeThisFrame && o.LastUse > mResources[before].LastUse))
+				{
+					before = other;
+					beforeThisFrame = thisFrame;
+				}
+			}
+
+			if(before != Invalid)
+			{
+				Barrier barrier;
+				barrier.Kind = Barrier::Type::Aliasing;
+				barrier.Resource = s.first;
+				barrier.AliasBefore = before;
+				pass.Before.push_back(barrier);
+			}
+		}
+
+		for(const auto& s : passStates)
+		{
+			if(state[s.first] == s.second)
+				continue;
+
+			Barrier barrier;
+			barrier.Resource = s.first;
+			barrier.Before = state[s.first];
+			barrier.After = s.second;
+			pass.Before.push_back(barrier);
+
+			state[s.first] = s.second;
+		}
+
+		// Imported resources go back to their final state after their last use.
+		for(const auto& s : passStates)
+		{
+			const Resource& resource = mResources[s.first];
+			if(resource.Transient || resource.LastUse != i || state[s.first] == resource.FinalState)
+				continue;
+
+			Barrier barrier;
+			barrier.Resource = s.first;
+			barrier.Before = state[s.first];
+			barrier.After = resource.FinalState;
+			pass.After.push_back(barrier);
+
+			state[s.first] = resource.FinalState;
+		}
+	}
+}
+
+bool FrameGraph::Overlap(const Resource& a, const Resource& b)const
+{
+	return a.Offset < b.Offset + b.Size && b.Offset < a.Offset + a.Size;
+}
+
+void FrameGraph::Dump(std::ostream& out, const std::function<std::string(State)>& stateName)const
+{
+	auto name = [&](State state)
+	{
+		if(stateName)
+			return stateName(state);
+
+		std::ostringstream ss;
+		ss << "0x" << std::hex << state;
+		return ss.str();
+	};
+
+	auto dumpBarriers = [&](const char* when, const std::vector<Barrier>& barriers)
+	{
+		for(const Barrier& barrier : barriers)
+		{
+			out << "    " << when << ": ";
+			if(barrier.Kind == Barrier::Type::Aliasing)
+				out << "alias " << mResources[barrier.AliasBefore].Name << " -> " << mResources[barrier.Resource].Name;
+			else
+				out << mResources[barrier.Resource].Name << " " << name(barrier.Before) << " -> " << name(barrier.After);
+			out << "\n";
+		}
+	};
+
+	out << "FrameGraph: " << mLivePasses.size() << " of " << mPasses.size() << " passes, heap "
+		<< mHeapSize << " bytes\n";
+
+	for(PassId i = 0; i < (PassId)mPasses.size(); ++i)
+	{
+		const Pass& pass = mPasses[i];
+		out << "  pass " << i << " " << pass.Name << (pass.Culled ? " (culled)" : "") << "\n";
+		dumpBarriers("before", pass.Before);
+		dumpBarriers("after", pass.After);
+	}
+
+	for(const Resource& resource : mResources)
+	{
+		if(!resource.Transient)
+			continue;
+
+		out << "  transient " << resource.Name;
+		if(resource.FirstUse == Invalid)
+			out << " unused\n";
+		else
+		{
+			out << " offset " << resource.Offset << " size " << resource.Size << " passes "
+				<< mLivePasses[resource.FirstUse] << "-" << mLivePasses[resource.LastUse] << "\n";
+		}
+	}
+}
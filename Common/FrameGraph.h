@@ -0,0 +1,176 @@
+//***************************************************************************************
+// FrameGraph.h
+//
+// Describes a frame as passes that read and write resources, and compiles that
+// description into what the passes would otherwise do by hand:
+//
+//   - passes whose results are never used are culled,
+//   - the resource state transitions each pass needs are derived and batched, one
+//     list before the pass and one after it,
+//   - transient resources, which only live for part of the frame, are given offsets
+//     in one heap so that resources whose lifetimes do not overlap share memory,
+//     with the aliasing barriers that requires.
+//
+//   FrameGraph graph;
+//   auto normals = graph.CreateTransient("normalMap", size, alignment);
+//   auto backBuffer = graph.Import("backBuffer", D3D12_RESOURCE_STATE_PRESENT);
+//   graph.MarkOutput(backBuffer);
+//
+//   auto drawNormals = graph.AddPass("drawNormals");
+//   graph.Write(drawNormals, normals, D3D12_RESOURCE_STATE_RENDER_TARGET);
+//   auto lighting = graph.AddPass("lighting");
+//   graph.Read(lighting, normals, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+//   graph.Write(lighting, backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+//
+//   graph.Compile();
+//   graph.Dump(std::cout);
+//
+// Passes run in the order they were added.  Imported resources are in their initial
+// state when the frame starts and are returned to their final state after their last
+// use.  A transient resource starts every frame in the state of its last use, which
+// is also the state to create it in.  Its contents are undefined on first use, so the
+// first pass that uses it must clear or fully overwrite it.
+//
+// States are D3D12_RESOURCE_STATES values, kept as integers so the graph compiles and
+// can be exercised without Direct3D; see D3DFrameGraph.h for the part that creates
+// the resources and records the barriers.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class FrameGraph
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	typedef uint32 ResourceId;
+	typedef uint32 PassId;
+	typedef uint32 State;
+
+	static const uint32 Invalid = ~uint32(0);
+
+	struct Barrier
+	{
+		enum class Type { Transition, Aliasing };
+
+		Type Kind = Type::Transition;
+		ResourceId Resource = Invalid;
+
+		// Transition.
+		State Before = 0;
+		State After = 0;
+
+		// Aliasing: the resource that used the memory before Resource.
+		ResourceId AliasBefore = Invalid;
+	};
+
+	ResourceId Import(const std::string& name, State initialState, State finalState);
+	ResourceId Import(const std::string& name, State state);
+
+	// size and alignment are the allocation requirements of the resource, e.g. from
+	// ID3D12Device::GetResourceAllocationInfo.
+	ResourceId CreateTransient(const std::string& name, uint64 size, uint64 alignment);
+
+	// The passes that produce an output are never culled.
+	void MarkOutput(ResourceId resource);
+
+	// sideEffects keeps the pass even if nothing reads what it writes.
+	PassId AddPass(const std::string& name, bool sideEffects = false);
+
+	// The states a pass needs for one resource are combined, e.g. a read as
+	// PIXEL_SHADER_RESOURCE and one as NON_PIXEL_SHADER_RESOURCE.
+	void Read(PassId pass, ResourceId resource, State state);
+	void Write(PassId pass, ResourceId resource, State state);
+
+	// Recomputes the culling, barriers and heap layout.  Call again after changing
+	// the graph or the size of a transient resource.
+	void Compile();
+
+	bool IsCulled(PassId pass)const;
+	const std::vector<PassId>& LivePasses()const;
+
+	const std::vector<Barrier>& BarriersBefore(PassId pass)const;
+	const std::vector<Barrier>& BarriersAfter(PassId pass)const;
+
+	bool IsTransient(ResourceId resource)const;
+
+	// False for transient resources no live pass uses; those are not placed.
+	bool IsUsed(ResourceId resource)const;
+
+	// Offset of a transient resource in the heap.
+	uint64 HeapOffset(ResourceId resource)const;
+	uint64 HeapSize()const;
+	uint64 HeapAlignment()const;
+
+	// State of the resource when the frame starts.
+	State StartState(ResourceId resource)const;
+
+	const std::string& ResourceName(ResourceId resource)const;
+	const std::string& PassName(PassId pass)const;
+	uint32 NumResources()const;
+	uint32 NumPasses()const;
+
+	// Writes the compiled schedule: live and culled passes, their barriers and the
+	// heap layout.  stateName formats states; by default they are printed in hex.
+	void Dump(std::ostream& out, const std::function<std::string(State)>& stateName = nullptr)const;
+
+private:
+	struct Access
+	{
+		ResourceId Resource;
+		State Required;
+		bool Write;
+	};
+
+	struct Pass
+	{
+		std::string Name;
+		bool SideEffects = false;
+		std::vector<Access> Accesses;
+
+		// Compiled.
+		bool Culled = false;
+		std::vector<Barrier> Before;
+		std::vector<Barrier> After;
+	};
+
+	struct Resource
+	{
+		std::string Name;
+		bool Transient = false;
+		bool Output = false;
+		State InitialState = 0;
+		State FinalState = 0;
+		uint64 Size = 0;
+		uint64 Alignment = 1;
+
+		// Compiled.  FirstUse/LastUse index mLivePasses.
+		uint32 FirstUse = Invalid;
+		uint32 LastUse = Invalid;
+		State StartState = 0;
+		uint64 Offset = 0;
+	};
+
+	void CullPasses();
+	void PlaceTransients();
+	void BuildBarriers();
+
+	// Memory ranges of two placed transient resources intersect.
+	bool Overlap(const Resource& a, const Resource& b)const;
+
+private:
+	std::vector<Pass> mPasses;
+	std::vector<Resource> mResources;
+
+	std::vector<PassId> mLivePasses;
+	uint64 mHeapSize = 0;
+	uint64 mHeapAlignment = 1;
+};
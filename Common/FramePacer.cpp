@@ -0,0 +1,82 @@
+//***************************************************************************************
+// FramePacer.cpp
+//***************************************************************************************
+
+#include "FramePacer.h"
+#include <cassert>
+#include <chrono>
+
+FramePacer::FramePacer(Fence* fence, uint32 framesInFlight) :
+	mFence(fence)
+{
+	assert(fence != nullptr);
+	SetFramesInFlight(framesInFlight);
+}
+
+FramePacer::uint32 FramePacer::BeginFrame()
+{
+	mCurrIndex = (mCurrIndex + 1) % (uint32)mFrameFences.size();
+	mStats.NumFrames++;
+	mStats.LastWaitMs = 0.0;
+
+	uint64 fenceValue = mFrameFences[mCurrIndex];
+	if(fenceValue != 0 && mFence->GetCompletedValue() < fenceValue)
+	{
+		auto start = std::chrono::steady_clock::now();
+		mFence->Wait(fenceValue);
+		auto end = std::chrono::steady_clock::now();
+
+		double waitMs = std::chrono::duration<double, std::milli>(end - start).count();
+		mStats.NumWaits++;
+		mStats.LastWaitMs = waitMs;
+		mStats.TotalWaitMs += waitMs;
+		if(waitMs > mStats.MaxWaitMs)
+			mStats.MaxWaitMs = waitMs;
+	}
+
+	return mCurrIndex;
+}
+
+void FramePacer::EndFrame(uint64 fenceValue)
+{
+	mFrameFences[mCurrIndex] = fenceValue;
+	mLastSubmitted = fenceValue;
+}
+
+void FramePacer::WaitIdle()
+{
+	if(mLastSubmitted != 0 && mFence->GetCompletedValue() < mLastSubmitted)
+		mFence->Wait(mLastSubmitted);
+}
+
+void FramePacer::SetFramesInFlight(uint32 framesInFlight)
+{
+	assert(framesInFlight > 0);
+
+	WaitIdle();
+
+	mFrameFences.assign(framesInFlight, 0);
+
+	// BeginFrame advances first.
+	mCurrIndex = framesInFlight - 1;
+}
+
+FramePacer::uint32 FramePacer::FramesInFlight()const
+{
+	return (uint32)mFrameFences.size();
+}
+
+FramePacer::uint32 FramePacer::CurrentIndex()const
+{
+	return mCurrIndex;
+}
+
+const FramePacer::Stats& FramePacer::GetStats()const
+{
+	return mStats;
+}
+
+void FramePacer::ResetStats()
+{
+	mStats = Stats();
+}
@@ -0,0 +1,84 @@
+//***************************************************************************************
+// FramePacer.h
+//
+// Paces the CPU against the GPU for a ring of frame resources whose size is chosen
+// at runtime.  BeginFrame() moves to the next frame resource and, if the GPU has not
+// finished the frame that last used it, blocks until it has.  EndFrame() records the
+// fence value the GPU signals once the frame is done:
+//
+//   mCurrFrameResourceIndex = mFramePacer->BeginFrame();
+//   ... record and submit the frame ...
+//   mCommandQueue->Signal(mFence.Get(), ++mCurrentFence);
+//   mFramePacer->EndFrame(mCurrentFence);
+//
+// The time spent blocked is measured, which tells whether the CPU or the GPU is the
+// bottleneck.  The fence is an interface: GpuFence.h implements it over an
+// ID3D12Fence and MockFence.h over a simulated queue, so the pacing logic can be
+// exercised without a device.
+//
+// The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class FramePacer
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	class Fence
+	{
+	public:
+		virtual ~Fence() = default;
+
+		virtual uint64 GetCompletedValue()const = 0;
+
+		// Blocks until the fence reaches value.
+		virtual void Wait(uint64 value) = 0;
+	};
+
+	struct Stats
+	{
+		uint64 NumFrames = 0;
+		uint64 NumWaits = 0;      // frames that had to wait for the GPU
+		double LastWaitMs = 0.0;  // wait of the last frame, 0 if it did not wait
+		double TotalWaitMs = 0.0;
+		double MaxWaitMs = 0.0;
+	};
+
+	FramePacer(Fence* fence, uint32 framesInFlight);
+
+	// Returns the index of the frame resource to use, once the GPU is done with it.
+	uint32 BeginFrame();
+
+	// The GPU is done with the current frame once the fence reaches fenceValue.
+	void EndFrame(uint64 fenceValue);
+
+	// Waits for every frame submitted so far.
+	void WaitIdle();
+
+	// Waits for the GPU and changes the number of frame resources.  The next
+	// BeginFrame returns 0.
+	void SetFramesInFlight(uint32 framesInFlight);
+
+	uint32 FramesInFlight()const;
+	uint32 CurrentIndex()const;
+
+	const Stats& GetStats()const;
+	void ResetStats();
+
+private:
+	Fence* mFence = nullptr;
+
+	// Fence value of the last frame that used each frame resource.
+	std::vector<uint64> mFrameFences;
+	uint32 mCurrIndex = 0;
+	uint64 mLastSubmitted = 0;
+
+	Stats mStats;
+};
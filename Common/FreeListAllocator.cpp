@@ -0,0 +1,122 @@
+//***************************************************************************************
+// FreeListAllocator.cpp
+//***************************************************************************************
+
+#include "FreeListAllocator.h"
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(uint32 capacity)
+{
+	Reset(capacity);
+}
+
+void FreeListAllocator::Reset(uint32 capacity)
+{
+	mCapacity = capacity;
+	mUsed = 0;
+	mFreeRanges.clear();
+	mPendingFrees.clear();
+
+	if(capacity > 0)
+		mFreeRanges[0] = capacity;
+}
+
+FreeListAllocator::uint32 FreeListAllocator::Allocate(uint32 size)
+{
+	if(size == 0)
+		return InvalidOffset;
+
+	for(auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it)
+	{
+		if(it->second < size)
+			continue;
+
+		uint32 offset = it->first;
+		uint32 remaining = it->second - size;
+		mFreeRanges.erase(it);
+		if(remaining > 0)
+			mFreeRanges[offset + size] = remaining;
+
+		mUsed += size;
+		return offset;
+	}
+
+	return InvalidOffset;
+}
+
+void FreeListAllocator::Free(uint32 offset, uint32 size)
+{
+	assert(size > 0 && offset + size <= mCapacity && size <= mUsed);
+	mUsed -= size;
+
+	auto next = mFreeRanges.lower_bound(offset);
+	assert(next == mFreeRanges.end() || offset + size <= next->first);
+
+	// Merge with the range that ends where this one starts.
+	if(next != mFreeRanges.begin())
+	{
+		auto prev = std::prev(next);
+		assert(prev->first + prev->second <= offset);
+		if(prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			mFreeRanges.erase(prev);
+		}
+	}
+
+	// Merge with the range that starts where this one ends.
+	if(next != mFreeRanges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		mFreeRanges.erase(next);
+	}
+
+	mFreeRanges[offset] = size;
+}
+
+void FreeListAllocator::Free(uint32 offset, uint32 size, uint64 fenceValue)
+{
+	mPendingFrees.push_back({ offset, size, fenceValue });
+}
+
+void FreeListAllocator::ReleaseCompleted(uint64 completedFenceValue)
+{
+	for(auto it = mPendingFrees.begin(); it != mPendingFrees.end();)
+	{
+		if(it->FenceValue <= completedFenceValue)
+		{
+			Free(it->Offset, it->Size);
+			it = mPendingFrees.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+FreeListAllocator::uint32 FreeListAllocator::Capacity()const
+{
+	return mCapacity;
+}
+
+FreeListAllocator::uint32 FreeListAllocator::UsedSize()const
+{
+	return mUsed;
+}
+
+FreeListAllocator::uint32 FreeListAllocator::LargestFreeRange()const
+{
+	uint32 largest = 0;
+	for(const auto& range : mFreeRanges)
+	{
+		if(range.second > largest)
+			largest = range.second;
+	}
+	return largest;
+}
+
+FreeListAllocator::uint32 FreeListAllocator::NumFreeRanges()const
+{
+	return (uint32)mFreeRanges.size();
+}
@@ -0,0 +1,73 @@
+//***************************************************************************************
+// FreeListAllocator.h
+//
+// Sub-allocates ranges from a fixed size range in any order, e.g. descriptors that
+// live as long as the resource they describe.  Free ranges are kept sorted by
+// offset and merged with their neighbors, and allocations take the first range
+// that fits.
+//
+// A range still referenced by command lists in flight is freed with a fence value
+// and only becomes available again once ReleaseCompleted sees that value.
+//
+// Only offsets are handed out; see DescriptorAllocator.h.  The class has no
+// Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+
+class FreeListAllocator
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	static const uint32 InvalidOffset = ~uint32(0);
+
+	explicit FreeListAllocator(uint32 capacity = 0);
+
+	// Drops every allocation, including the ones waiting for a fence.
+	void Reset(uint32 capacity);
+
+	// Returns InvalidOffset if there is no contiguous free range large enough.
+	uint32 Allocate(uint32 size);
+
+	// Frees the range now.  offset and size must be those of one allocation.
+	void Free(uint32 offset, uint32 size);
+
+	// Frees the range once fenceValue is complete.
+	void Free(uint32 offset, uint32 size, uint64 fenceValue);
+
+	// Frees the ranges whose fence value is <= completedFenceValue.
+	void ReleaseCompleted(uint64 completedFenceValue);
+
+	uint32 Capacity()const;
+
+	// Allocated size, including the ranges waiting for a fence.
+	uint32 UsedSize()const;
+
+	// Size of the largest range Allocate can return right now.
+	uint32 LargestFreeRange()const;
+
+	uint32 NumFreeRanges()const;
+
+private:
+	struct PendingFree
+	{
+		uint32 Offset;
+		uint32 Size;
+		uint64 FenceValue;
+	};
+
+	uint32 mCapacity = 0;
+	uint32 mUsed = 0;
+
+	// Offset -> size of each free range.
+	std::map<uint32, uint32> mFreeRanges;
+
+	std::deque<PendingFree> mPendingFrees;
+};
@@ -2,26 +2,58 @@
 // GameTimer.cpp by Frank Luna (C) 2011 All Rights Reserved.
 //***************************************************************************************
 
-#include <windows.h>
 #include "GameTimer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+namespace
+{
+	const double NsPerSecond = 1e9;
+	const double NsPerMs = 1e6;
+
+	// Nearest rank percentile of sorted values.
+	std::int64_t Percentile(const std::vector<std::int64_t>& sorted, double p)
+	{
+		std::size_t rank = (std::size_t)std::ceil(p * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+}
 
 GameTimer::GameTimer()
-: mSecondsPerCount(0.0), mDeltaTime(-1.0), mBaseTime(0), 
-  mPausedTime(0), mPrevTime(0), mCurrTime(0), mStopped(false)
+: mDeltaTime(-1), mSmoothedDeltaTime(0.0), mSmoothing(0.0f),
+  mBaseTime(), mPausedTime(0), mStopTime(), mPrevTime(), mCurrTime(), mStopped(false),
+  mTargetFrameTime(0), mSpinTime(0), mNumFrameTimes(0), mNextFrameTime(0)
 {
-	__int64 countsPerSec;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&countsPerSec);
-	mSecondsPerCount = 1.0 / (double)countsPerSec;
+	SetHistorySize(512);
 }
 
 // Returns the total time elapsed since Reset() was called, NOT counting any
 // time when the clock is stopped.
 float GameTimer::TotalTime()const
+{
+	return (float)(TotalTimeNs() / NsPerSecond);
+}
+
+float GameTimer::DeltaTime()const
+{
+	return (float)(mDeltaTime / NsPerSecond);
+}
+
+float GameTimer::SmoothedDeltaTime()const
+{
+	return mSmoothing > 0.0f ? (float)(mSmoothedDeltaTime / NsPerSecond) : DeltaTime();
+}
+
+std::int64_t GameTimer::TotalTimeNs()const
 {
 	// If we are stopped, do not count the time that has passed since we stopped.
-	// Moreover, if we previously already had a pause, the distance 
+	// Moreover, if we previously already had a pause, the distance
 	// mStopTime - mBaseTime includes paused time, which we do not want to count.
-	// To correct this, we can subtract the paused time from mStopTime:  
+	// To correct this, we can subtract the paused time from mStopTime:
 	//
 	//                     |<--paused time-->|
 	// ----*---------------*-----------------*------------*------------*------> time
@@ -29,59 +61,63 @@ float GameTimer::TotalTime()const
 
 	if( mStopped )
 	{
-		return (float)(((mStopTime - mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return duration_cast<nanoseconds>((mStopTime - mPausedTime) - mBaseTime).count();
 	}
 
 	// The distance mCurrTime - mBaseTime includes paused time,
-	// which we do not want to count.  To correct this, we can subtract 
-	// the paused time from mCurrTime:  
+	// which we do not want to count.  To correct this, we can subtract
+	// the paused time from mCurrTime:
 	//
-	//  (mCurrTime - mPausedTime) - mBaseTime 
+	//  (mCurrTime - mPausedTime) - mBaseTime
 	//
 	//                     |<--paused time-->|
 	// ----*---------------*-----------------*------------*------> time
 	//  mBaseTime       mStopTime        startTime     mCurrTime
-	
+
 	else
 	{
-		return (float)(((mCurrTime-mPausedTime)-mBaseTime)*mSecondsPerCount);
+		return duration_cast<nanoseconds>((mCurrTime - mPausedTime) - mBaseTime).count();
 	}
 }
 
-float GameTimer::DeltaTime()const
+std::int64_t GameTimer::DeltaTimeNs()const
 {
-	return (float)mDeltaTime;
+	return mDeltaTime;
 }
 
 void GameTimer::Reset()
 {
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
+	Clock::time_point currTime = Clock::now();
 
 	mBaseTime = currTime;
 	mPrevTime = currTime;
-	mStopTime = 0;
+	mCurrTime = currTime;
+	mPausedTime = Clock::duration(0);
+	mStopTime = Clock::time_point();
 	mStopped  = false;
+	mSmoothedDeltaTime = 0.0;
+
+	// Frame times from before the reset, e.g. of loading, do not count.
+	mNumFrameTimes = 0;
+	mNextFrameTime = 0;
 }
 
 void GameTimer::Start()
 {
-	__int64 startTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&startTime);
-
+	Clock::time_point startTime = Clock::now();
 
 	// Accumulate the time elapsed between stop and start pairs.
 	//
 	//                     |<-------d------->|
 	// ----*---------------*-----------------*------------> time
-	//  mBaseTime       mStopTime        startTime     
+	//  mBaseTime       mStopTime        startTime
 
 	if( mStopped )
 	{
-		mPausedTime += (startTime - mStopTime);	
+		mPausedTime += (startTime - mStopTime);
 
 		mPrevTime = startTime;
-		mStopTime = 0;
+		mStopTime = Clock::time_point();
 		mStopped  = false;
 	}
 }
@@ -90,10 +126,7 @@ void GameTimer::Stop()
 {
 	if( !mStopped )
 	{
-		__int64 currTime;
-		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-
-		mStopTime = currTime;
+		mStopTime = Clock::now();
 		mStopped  = true;
 	}
 }
@@ -102,26 +135,120 @@ void GameTimer::Tick()
 {
 	if( mStopped )
 	{
-		mDeltaTime = 0.0;
+		mDeltaTime = 0;
 		return;
 	}
 
-	__int64 currTime;
-	QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
-	mCurrTime = currTime;
+	if(mTargetFrameTime > Clock::duration(0))
+		WaitUntil(mPrevTime + mTargetFrameTime);
 
-	// Time difference between this frame and the previous.
-	mDeltaTime = (mCurrTime - mPrevTime)*mSecondsPerCount;
+	mCurrTime = Clock::now();
+
+	// Time difference between this frame and the previous.  steady_clock never goes
+	// backwards, so unlike QueryPerformanceCounter this cannot be negative.
+	mDeltaTime = duration_cast<nanoseconds>(mCurrTime - mPrevTime).count();
 
 	// Prepare for next frame.
 	mPrevTime = mCurrTime;
 
-	// Force nonnegative.  The DXSDK's CDXUTTimer mentions that if the 
-	// processor goes into a power save mode or we get shuffled to another
-	// processor, then mDeltaTime can be negative.
-	if(mDeltaTime < 0.0)
+	RecordFrameTime(mDeltaTime);
+}
+
+void GameTimer::Tick(std::int64_t deltaNs)
+{
+	if( mStopped )
+	{
+		mDeltaTime = 0;
+		return;
+	}
+
+	mDeltaTime = std::max(deltaNs, (std::int64_t)0);
+	mCurrTime = mPrevTime + duration_cast<Clock::duration>(nanoseconds(mDeltaTime));
+	mPrevTime = mCurrTime;
+
+	RecordFrameTime(mDeltaTime);
+}
+
+void GameTimer::SetSmoothing(float weight)
+{
+	mSmoothing = std::min(std::max(weight, 0.0f), 1.0f);
+	mSmoothedDeltaTime = 0.0;
+}
+
+void GameTimer::SetTargetFrameTime(double targetSeconds, double spinSeconds)
+{
+	mTargetFrameTime = duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(targetSeconds, 0.0)));
+	mSpinTime = duration_cast<Clock::duration>(std::chrono::duration<double>(std::max(spinSeconds, 0.0)));
+}
+
+void GameTimer::SetHistorySize(std::uint32_t numFrames)
+{
+	mFrameTimes.assign(std::max(numFrames, 1u), 0);
+	mNumFrameTimes = 0;
+	mNextFrameTime = 0;
+}
+
+GameTimer::FrameTimeStats GameTimer::GetFrameTimeStats()const
+{
+	FrameTimeStats stats;
+	if(mNumFrameTimes == 0)
+		return stats;
+
+	std::vector<std::int64_t> sorted(mFrameTimes.begin(), mFrameTimes.begin() + mNumFrameTimes);
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for(std::int64_t ns : sorted)
+		total += (double)ns;
+
+	stats.Count = mNumFrameTimes;
+	stats.MeanMs = total / mNumFrameTimes / NsPerMs;
+	stats.MinMs = sorted.front() / NsPerMs;
+	stats.MaxMs = sorted.back() / NsPerMs;
+	stats.P50Ms = Percentile(sorted, 0.50) / NsPerMs;
+	stats.P95Ms = Percentile(sorted, 0.95) / NsPerMs;
+	stats.P99Ms = Percentile(sorted, 0.99) / NsPerMs;
+	return stats;
+}
+
+std::vector<std::uint32_t> GameTimer::FrameTimeHistogram(double bucketMs, std::uint32_t numBuckets)const
+{
+	std::vector<std::uint32_t> buckets(numBuckets, 0);
+	if(numBuckets == 0 || bucketMs <= 0.0)
+		return buckets;
+
+	for(std::uint32_t i = 0; i < mNumFrameTimes; ++i)
 	{
-		mDeltaTime = 0.0;
+		double bucket = mFrameTimes[i] / NsPerMs / bucketMs;
+		buckets[bucket < numBuckets ? (std::uint32_t)bucket : numBuckets - 1]++;
 	}
+	return buckets;
 }
 
+void GameTimer::WaitUntil(Clock::time_point time)const
+{
+	// Sleep while the wake up can be late without missing the target, then spin.
+	for(;;)
+	{
+		Clock::duration remaining = time - Clock::now();
+		if(remaining <= mSpinTime)
+			break;
+		std::this_thread::sleep_for(remaining - mSpinTime);
+	}
+
+	while(Clock::now() < time)
+		std::this_thread::yield();
+}
+
+void GameTimer::RecordFrameTime(std::int64_t ns)
+{
+	if(mSmoothing > 0.0f)
+	{
+		mSmoothedDeltaTime = mSmoothedDeltaTime == 0.0 ? (double)ns :
+			mSmoothedDeltaTime + mSmoothing * ((double)ns - mSmoothedDeltaTime);
+	}
+
+	mFrameTimes[mNextFrameTime] = ns;
+	mNextFrameTime = (mNextFrameTime + 1) % (std::uint32_t)mFrameTimes.size();
+	mNumFrameTimes = std::min(mNumFrameTimes + 1, (std::uint32_t)mFrameTimes.size());
+}
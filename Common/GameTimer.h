@@ -1,34 +1,102 @@
 //***************************************************************************************
 // GameTimer.h by Frank Luna (C) 2011 All Rights Reserved.
+//
+// Measures frame times on std::chrono::steady_clock in nanoseconds, so it runs on any
+// platform.  Besides the delta and total time it keeps:
+//
+//   - the last frame times in a ring, with percentiles and a histogram to find spikes,
+//   - an optional smoothed delta, an exponential moving average for simulation code
+//     that should not react to a single long frame,
+//   - an optional target frame time: Tick waits until the target has passed since the
+//     last tick, sleeping for most of the wait and spinning for the rest.
 //***************************************************************************************
 
 #ifndef GAMETIMER_H
 #define GAMETIMER_H
 
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
 class GameTimer
 {
 public:
+	typedef std::chrono::steady_clock Clock;
+
+	struct FrameTimeStats
+	{
+		std::uint32_t Count = 0;
+		double MeanMs = 0.0;
+		double MinMs = 0.0;
+		double MaxMs = 0.0;
+		double P50Ms = 0.0;
+		double P95Ms = 0.0;
+		double P99Ms = 0.0;
+	};
+
 	GameTimer();
 
 	float TotalTime()const; // in seconds
 	float DeltaTime()const; // in seconds
 
+	// Smoothed delta time in seconds; DeltaTime while smoothing is off.
+	float SmoothedDeltaTime()const;
+
+	std::int64_t TotalTimeNs()const;
+	std::int64_t DeltaTimeNs()const;
+
 	void Reset(); // Call before message loop.
 	void Start(); // Call when unpaused.
 	void Stop();  // Call when paused.
 	void Tick();  // Call every frame.
 
+	// Advances by deltaNs instead of reading the clock, for headless runs and replays
+	// that must see the same times on every run.
+	void Tick(std::int64_t deltaNs);
+
+	// Weight of the newest frame in the smoothed delta, in (0, 1]; 0 turns smoothing off.
+	void SetSmoothing(float weight);
+
+	// Tick does not return before targetSeconds have passed since the previous tick;
+	// 0 turns pacing off.  The last spinSeconds of the wait are spun instead of slept,
+	// since sleeps can overshoot by a scheduler quantum.
+	void SetTargetFrameTime(double targetSeconds, double spinSeconds = 0.002);
+
+	// Number of frame times kept for FrameTimeStats and FrameTimeHistogram.  Clears
+	// the ones kept so far.
+	void SetHistorySize(std::uint32_t numFrames);
+
+	// Over the frame times in the ring; paused frames are not recorded.
+	FrameTimeStats GetFrameTimeStats()const;
+
+	// Counts of frame times in buckets of bucketMs; the last bucket also counts every
+	// longer frame.
+	std::vector<std::uint32_t> FrameTimeHistogram(double bucketMs, std::uint32_t numBuckets)const;
+
 private:
-	double mSecondsPerCount;
-	double mDeltaTime;
+	void WaitUntil(Clock::time_point time)const;
+	// Updates the smoothed delta and the ring.
+	void RecordFrameTime(std::int64_t ns);
 
-	__int64 mBaseTime;
-	__int64 mPausedTime;
-	__int64 mStopTime;
-	__int64 mPrevTime;
-	__int64 mCurrTime;
+private:
+	std::int64_t mDeltaTime;
+	double mSmoothedDeltaTime;
+	float mSmoothing;
+
+	Clock::time_point mBaseTime;
+	Clock::duration mPausedTime;
+	Clock::time_point mStopTime;
+	Clock::time_point mPrevTime;
+	Clock::time_point mCurrTime;
 
 	bool mStopped;
+
+	Clock::duration mTargetFrameTime;
+	Clock::duration mSpinTime;
+
+	std::vector<std::int64_t> mFrameTimes;
+	std::uint32_t mNumFrameTimes;
+	std::uint32_t mNextFrameTime;
 };
 
-#endif // GAMETIMER_H
\ No newline at end of file
+#endif // GAMETIMER_H
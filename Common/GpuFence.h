@@ -0,0 +1,50 @@
+//***************************************************************************************
+// GpuFence.h
+//
+// FramePacer::Fence over an ID3D12Fence.  Blocking waits reuse one event created up
+// front instead of creating and destroying an event every time.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "FramePacer.h"
+
+class GpuFence : public FramePacer::Fence
+{
+public:
+	explicit GpuFence(ID3D12Fence* fence) :
+		mFence(fence)
+	{
+		mEvent = CreateEventEx(nullptr, nullptr, 0, EVENT_ALL_ACCESS);
+		if(mEvent == nullptr)
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+	}
+
+	GpuFence(const GpuFence& rhs) = delete;
+	GpuFence& operator=(const GpuFence& rhs) = delete;
+
+	~GpuFence()
+	{
+		CloseHandle(mEvent);
+	}
+
+	virtual UINT64 GetCompletedValue()const override
+	{
+		return mFence->GetCompletedValue();
+	}
+
+	virtual void Wait(UINT64 value) override
+	{
+		if(mFence->GetCompletedValue() >= value)
+			return;
+
+		// Fire the event when the GPU hits the fence value, and wait for it.
+		ThrowIfFailed(mFence->SetEventOnCompletion(value, mEvent));
+		WaitForSingleObject(mEvent, INFINITE);
+	}
+
+private:
+	ID3D12Fence* mFence = nullptr;
+	HANDLE mEvent = nullptr;
+};
@@ -0,0 +1,130 @@
+//***************************************************************************************
+// GpuProfiler.cpp
+//***************************************************************************************
+
+#include "GpuProfiler.h"
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, ID3D12GraphicsCommandList* cmdList, const char* name) :
+	mProfiler(profiler),
+	mCmdList(cmdList),
+	mIndex(profiler.BeginScope(cmdList, name))
+{
+}
+
+GpuProfiler::Scope::~Scope()
+{
+	mProfiler.EndScope(mCmdList, mIndex);
+}
+
+GpuProfiler::GpuProfiler(ID3D12Device* device, ID3D12CommandQueue* queue, Profiler& profiler,
+	UINT numFrameResources, UINT maxScopesPerFrame) :
+	mProfiler(profiler),
+	mMaxScopes(maxScopesPerFrame),
+	mFrames(numFrameResources),
+	mNextScope(0)
+{
+	UINT numQueries = 2 * maxScopesPerFrame * numFrameResources;
+
+	D3D12_QUERY_HEAP_DESC heapDesc = {};
+	heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	heapDesc.Count = numQueries;
+	heapDesc.NodeMask = 0;
+	ThrowIfFailed(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&mQueryHeap)));
+
+	ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(numQueries * sizeof(UINT64)),
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&mReadback)));
+
+	for(auto& frame : mFrames)
+		frame.Names.resize(maxScopesPerFrame);
+
+	UINT64 cpuTimestamp = 0;
+	ThrowIfFailed(queue->GetTimestampFrequency(&mFrequency));
+	ThrowIfFailed(queue->GetClockCalibration(&mGpuBase, &cpuTimestamp));
+	mProfilerBaseNs = profiler.NowNs();
+}
+
+void GpuProfiler::BeginFrame(UINT frameResource)
+{
+	FrameQueries& frame = mFrames[frameResource];
+	ReadBack(frame, frameResource);
+
+	frame.ProfilerFrame = mProfiler.CurrentFrame();
+	frame.NumScopes = 0;
+	frame.Resolved = false;
+
+	mCurrFrame = frameResource;
+	mNextScope = 0;
+}
+
+UINT GpuProfiler::BeginScope(ID3D12GraphicsCommandList* cmdList, const char* name)
+{
+	UINT scope = mNextScope++;
+	if(scope >= mMaxScopes)
+		return InvalidScope;
+
+	mFrames[mCurrFrame].Names[scope] = name;
+	cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (mCurrFrame * mMaxScopes + scope) * 2);
+	return scope;
+}
+
+void GpuProfiler::EndScope(ID3D12GraphicsCommandList* cmdList, UINT scope)
+{
+	if(scope == InvalidScope)
+		return;
+
+	cmdList->EndQuery(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, (mCurrFrame * mMaxScopes + scope) * 2 + 1);
+}
+
+void GpuProfiler::EndFrame(ID3D12GraphicsCommandList* cmdList)
+{
+	FrameQueries& frame = mFrames[mCurrFrame];
+	frame.NumScopes = mNextScope < mMaxScopes ? (UINT)mNextScope : mMaxScopes;
+	if(frame.NumScopes == 0)
+		return;
+
+	UINT first = mCurrFrame * mMaxScopes * 2;
+	cmdList->ResolveQueryData(mQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+		first, frame.NumScopes * 2, mReadback.Get(), first * sizeof(UINT64));
+	frame.Resolved = true;
+}
+
+void GpuProfiler::ReadBack(FrameQueries& frame, UINT frameResource)
+{
+	if(!frame.Resolved)
+		return;
+
+	SIZE_T first = frameResource * mMaxScopes * 2 * sizeof(UINT64);
+	D3D12_RANGE readRange = { first, first + frame.NumScopes * 2 * sizeof(UINT64) };
+
+	UINT8* mapped = nullptr;
+	ThrowIfFailed(mReadback->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+	const UINT64* timestamps = reinterpret_cast<const UINT64*>(mapped + first);
+
+	auto toNs = [this](UINT64 timestamp)
+	{
+		// Scopes recorded before the calibration do not exist, so the difference is
+		// never negative.
+		double seconds = (double)(timestamp - mGpuBase) / (double)mFrequency;
+		return mProfilerBaseNs + (UINT64)(seconds * 1e9);
+	};
+
+	for(UINT i = 0; i < frame.NumScopes; ++i)
+	{
+		Profiler::Event event;
+		event.Name = frame.Names[i];
+		event.Kind = Profiler::Track::Gpu;
+		event.StartNs = toNs(timestamps[2 * i]);
+		event.EndNs = toNs(timestamps[2 * i + 1]);
+		mProfiler.AddEvent(frame.ProfilerFrame, event);
+	}
+
+	D3D12_RANGE writeRange = { 0, 0 };
+	mReadback->Unmap(0, &writeRange);
+
+	frame.Resolved = false;
+}
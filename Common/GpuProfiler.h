@@ -0,0 +1,95 @@
+//***************************************************************************************
+// GpuProfiler.h
+//
+// Times passes on the GPU with a pair of timestamp queries each, and hands the times
+// to a Profiler as events on its GPU track.  Each frame resource has its own range of
+// queries and of a readback buffer, so the results of a frame are read once the GPU
+// is done with its frame resource, without waiting:
+//
+//   // Update, after waiting for the fence of the current frame resource
+//   mGpuProfiler->BeginFrame(mCurrFrameResourceIndex);
+//
+//   // Draw, on any thread
+//   {
+//       GpuProfiler::Scope scope(*mGpuProfiler, cmdList, "shadow");
+//       ... record the pass ...
+//   }
+//
+//   // on a command list submitted after every scope of the frame
+//   mGpuProfiler->EndFrame(cmdList);
+//
+// GPU timestamps are converted to the profiler's clock with one calibration taken at
+// creation, so CPU and GPU events line up in the trace.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "Profiler.h"
+
+class GpuProfiler
+{
+public:
+	// Times the commands recorded between construction and destruction.
+	class Scope
+	{
+	public:
+		Scope(GpuProfiler& profiler, ID3D12GraphicsCommandList* cmdList, const char* name);
+		Scope(const Scope& rhs) = delete;
+		Scope& operator=(const Scope& rhs) = delete;
+		~Scope();
+
+	private:
+		GpuProfiler& mProfiler;
+		ID3D12GraphicsCommandList* mCmdList;
+		UINT mIndex;
+	};
+
+	GpuProfiler(ID3D12Device* device, ID3D12CommandQueue* queue, Profiler& profiler,
+		UINT numFrameResources, UINT maxScopesPerFrame = 32);
+	GpuProfiler(const GpuProfiler& rhs) = delete;
+	GpuProfiler& operator=(const GpuProfiler& rhs) = delete;
+
+	// Reads back the times the frame resource recorded when it was last used, and
+	// starts recording the current profiler frame into it.  The GPU must be done with
+	// the frame resource.
+	void BeginFrame(UINT frameResource);
+
+	// Returns the index of the scope to pass to EndScope.  Thread safe; names are
+	// not copied, see Profiler::Intern.
+	UINT BeginScope(ID3D12GraphicsCommandList* cmdList, const char* name);
+	void EndScope(ID3D12GraphicsCommandList* cmdList, UINT scope);
+
+	// Resolves the queries of the frame into the readback buffer.
+	void EndFrame(ID3D12GraphicsCommandList* cmdList);
+
+	// Scopes past maxScopesPerFrame are not timed.
+	static const UINT InvalidScope = ~0u;
+
+private:
+	struct FrameQueries
+	{
+		UINT64 ProfilerFrame = 0;
+		UINT NumScopes = 0;
+		bool Resolved = false;
+		std::vector<const char*> Names;
+	};
+
+	void ReadBack(FrameQueries& frame, UINT frameResource);
+
+private:
+	Profiler& mProfiler;
+	const UINT mMaxScopes;
+
+	Microsoft::WRL::ComPtr<ID3D12QueryHeap> mQueryHeap;
+	Microsoft::WRL::ComPtr<ID3D12Resource> mReadback;
+
+	std::vector<FrameQueries> mFrames;
+	UINT mCurrFrame = 0;
+	std::atomic<UINT> mNextScope;
+
+	// The GPU timestamp and profiler time of the calibration.
+	UINT64 mFrequency = 0;
+	UINT64 mGpuBase = 0;
+	UINT64 mProfilerBaseNs = 0;
+};
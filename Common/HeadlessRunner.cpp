@@ -0,0 +1,228 @@
+//***************************************************************************************
+// HeadlessRunner.cpp
+//***************************************************************************************
+
+#include "HeadlessRunner.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace
+{
+	const HeadlessRunner::uint32 NumKeys = 256;
+
+	// Nearest rank percentile of sorted values.
+	double Percentile(const std::vector<double>& sorted, double p)
+	{
+		std::size_t rank = (std::size_t)std::ceil(p * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+
+	bool ParseKey(const std::string& token, HeadlessRunner::uint32& key)
+	{
+		if(token.size() == 1 && !std::isdigit((unsigned char)token[0]))
+		{
+			key = (HeadlessRunner::uint32)std::toupper((unsigned char)token[0]);
+			return true;
+		}
+
+		// A quoted character, so that digits can be given as keys: '1'.
+		if(token.size() == 3 && token[0] == '\'' && token[2] == '\'')
+		{
+			key = (HeadlessRunner::uint32)std::toupper((unsigned char)token[1]);
+			return true;
+		}
+
+		std::istringstream ss(token);
+		return (ss >> key) && ss.eof() && key < NumKeys;
+	}
+
+	bool Fail(std::string* error, std::size_t line, const std::string& message)
+	{
+		if(error != nullptr)
+			*error = "line " + std::to_string(line) + ": " + message;
+		return false;
+	}
+}
+
+HeadlessRunner::HeadlessRunner(const Settings& settings) :
+	mSettings(settings),
+	mKeys(NumKeys, false)
+{
+	std::stable_sort(mSettings.Input.begin(), mSettings.Input.end(),
+		[](const InputEvent& a, const InputEvent& b) { return a.Frame < b.Frame; });
+}
+
+HeadlessRunner::Results HeadlessRunner::Run(Client& client, GameTimer& timer, Profiler* profiler)
+{
+	std::fill(mKeys.begin(), mKeys.end(), false);
+	timer.Reset();
+
+	std::vector<double> frameMs;
+	frameMs.reserve(mSettings.NumFrames);
+
+	std::size_t nextEvent = 0;
+	for(mCurrFrame = 0; mCurrFrame < mSettings.NumFrames; ++mCurrFrame)
+	{
+		double delta = mCurrFrame < mSettings.RecordedDeltas.size() ?
+			mSettings.RecordedDeltas[mCurrFrame] : mSettings.FixedDeltaSeconds;
+		timer.Tick((std::int64_t)std::llround(delta * 1e9));
+
+		if(profiler != nullptr)
+			profiler->BeginFrame();
+
+		for(; nextEvent < mSettings.Input.size() && mSettings.Input[nextEvent].Frame <= mCurrFrame; ++nextEvent)
+		{
+			const InputEvent& event = mSettings.Input[nextEvent];
+			if(event.Kind == InputEvent::Type::KeyDown || event.Kind == InputEvent::Type::KeyUp)
+				mKeys[event.Key % NumKeys] = event.Kind == InputEvent::Type::KeyDown;
+
+			client.OnInput(event);
+		}
+
+		// Only Update is measured, not the input handlers.
+		auto start = std::chrono::steady_clock::now();
+
+		if(profiler != nullptr)
+		{
+			PROFILE_SCOPE(*profiler, "Update");
+			client.Update(timer);
+		}
+		else
+			client.Update(timer);
+
+		auto end = std::chrono::steady_clock::now();
+		frameMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+
+		bool keepGoing = client.EndFrame(timer);
+
+		if(profiler != nullptr)
+			profiler->EndFrame();
+
+		if(!keepGoing)
+			break;
+	}
+
+	Results results;
+	results.NumFrames = (uint32)frameMs.size();
+	results.SimulatedSeconds = timer.TotalTimeNs() / 1e9;
+	if(frameMs.empty())
+		return results;
+
+	for(double ms : frameMs)
+		results.TotalMs += ms;
+
+	std::sort(frameMs.begin(), frameMs.end());
+	results.MeanMs = results.TotalMs / frameMs.size();
+	results.MinMs = frameMs.front();
+	results.MaxMs = frameMs.back();
+	results.P50Ms = Percentile(frameMs, 0.50);
+	results.P95Ms = Percentile(frameMs, 0.95);
+	results.P99Ms = Percentile(frameMs, 0.99);
+	return results;
+}
+
+bool HeadlessRunner::IsKeyDown(uint32 key)const
+{
+	return key < NumKeys && mKeys[key];
+}
+
+HeadlessRunner::uint32 HeadlessRunner::CurrentFrame()const
+{
+	return mCurrFrame;
+}
+
+bool HeadlessRunner::LoadInputScript(std::istream& in, std::vector<InputEvent>& events, std::string* error)
+{
+	events.clear();
+
+	std::string text;
+	for(std::size_t line = 1; std::getline(in, text); ++line)
+	{
+		std::size_t comment = text.find('#');
+		if(comment != std::string::npos)
+			text.erase(comment);
+
+		std::istringstream ss(text);
+		std::string type;
+		InputEvent event;
+		if(!(ss >> event.Frame))
+		{
+			// Blank lines and comments.
+			ss.clear();
+			if(ss >> type)
+				return Fail(error, line, "expected a frame number");
+			continue;
+		}
+
+		if(!(ss >> type))
+			return Fail(error, line, "expected an event type");
+
+		if(type == "mousedown" || type == "mouseup" || type == "mousemove")
+		{
+			event.Kind = type == "mousedown" ? InputEvent::Type::MouseDown :
+				type == "mouseup" ? InputEvent::Type::MouseUp : InputEvent::Type::MouseMove;
+			if(!(ss >> event.X >> event.Y >> event.Buttons))
+				return Fail(error, line, "expected <x> <y> <buttons>");
+		}
+		else if(type == "keydown" || type == "keyup")
+		{
+			event.Kind = type == "keydown" ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp;
+			std::string key;
+			if(!(ss >> key) || !ParseKey(key, event.Key))
+				return Fail(error, line, "expected a key");
+		}
+		else
+			return Fail(error, line, "unknown event type " + type);
+
+		std::string rest;
+		if(ss >> rest)
+			return Fail(error, line, "unexpected " + rest);
+
+		events.push_back(event);
+	}
+
+	std::stable_sort(events.begin(), events.end(),
+		[](const InputEvent& a, const InputEvent& b) { return a.Frame < b.Frame; });
+	return true;
+}
+
+bool HeadlessRunner::LoadDeltas(std::istream& in, std::vector<double>& deltas, std::string* error)
+{
+	deltas.clear();
+
+	std::string text;
+	for(std::size_t line = 1; std::getline(in, text); ++line)
+	{
+		std::istringstream ss(text);
+		double delta = 0.0;
+		if(!(ss >> delta))
+		{
+			ss.clear();
+			std::string token;
+			if(ss >> token && token[0] != '#')
+				return Fail(error, line, "expected a time step in seconds");
+			continue;
+		}
+
+		if(delta < 0.0)
+			return Fail(error, line, "negative time step");
+		deltas.push_back(delta);
+	}
+	return true;
+}
+
+void HeadlessRunner::WriteResults(std::ostream& out, const Results& results)
+{
+	char line[256];
+	std::snprintf(line, sizeof(line),
+		"%u frames, %.3f s simulated, Update %.3f ms total\n"
+		"Update ms: mean %.4f min %.4f p50 %.4f p95 %.4f p99 %.4f max %.4f\n",
+		(unsigned)results.NumFrames, results.SimulatedSeconds, results.TotalMs,
+		results.MeanMs, results.MinMs, results.P50Ms, results.P95Ms, results.P99Ms, results.MaxMs);
+	out << line;
+}
@@ -0,0 +1,138 @@
+//***************************************************************************************
+// HeadlessRunner.h
+//
+// Drives the per-frame CPU work of a demo without a window, message loop or Draw: a
+// fixed number of frames, each with a fixed or recorded time step and the input events
+// a script schedules for it, so that the update path (UpdateObjectCBs,
+// UpdateMaterialBuffer, UpdateWaves, ...) can be timed on its own:
+//
+//   HeadlessRunner::Settings settings;
+//   settings.NumFrames = 1000;
+//   settings.FixedDeltaSeconds = 1.0 / 60.0;
+//   HeadlessRunner::LoadInputScript(scriptFile, settings.Input);
+//
+//   HeadlessRunner runner(settings);
+//   HeadlessRunner::Results results = runner.Run(client, timer, &profiler);
+//   HeadlessRunner::WriteResults(std::cout, results);
+//
+// D3DApp is a Client, and runs this way when started with -headless (see d3dApp.h).
+// The runner ticks the client's own timer, so code that reads it rather than the
+// GameTimer passed to Update sees the same times.  The simulated time only advances
+// by the given steps, so two runs of the same settings see the same times whatever
+// the machine; what is measured is the wall clock time each Update takes.
+//
+// The input script has one event per line, '#' starts a comment:
+//
+//   <frame> mousedown <x> <y> <buttons>
+//   <frame> mouseup <x> <y> <buttons>
+//   <frame> mousemove <x> <y> <buttons>
+//   <frame> keydown <key>
+//   <frame> keyup <key>
+//
+// where buttons is a MK_* mask and key a letter (W), a quoted character ('1') or a
+// virtual key code (38 for VK_UP).
+//
+// The class has no Direct3D or Win32 dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "GameTimer.h"
+
+class Profiler;
+
+class HeadlessRunner
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	struct InputEvent
+	{
+		enum class Type { MouseDown, MouseUp, MouseMove, KeyDown, KeyUp };
+
+		uint32 Frame = 0;
+		Type Kind = Type::MouseMove;
+		int X = 0;
+		int Y = 0;
+		uint32 Buttons = 0;
+		uint32 Key = 0;
+	};
+
+	class Client
+	{
+	public:
+		virtual ~Client() = default;
+
+		// Called before the Update of the frame the event is scheduled for.
+		virtual void OnInput(const InputEvent& /*event*/) { }
+
+		virtual void Update(const GameTimer& gt) = 0;
+
+		// Called after Update, outside of the measured time; returning false ends the
+		// run.  A replay in a window draws here.
+		virtual bool EndFrame(const GameTimer& /*gt*/) { return true; }
+	};
+
+	struct Settings
+	{
+		uint32 NumFrames = 600;
+
+		// Used for the frames past the end of RecordedDeltas.
+		double FixedDeltaSeconds = 1.0 / 60.0;
+
+		// Time step of each frame, in seconds, e.g. captured from a windowed run.  Steps
+		// are rounded to whole nanoseconds, so a ReplayLog replays exactly.
+		std::vector<double> RecordedDeltas;
+
+		// Sorted by frame, as LoadInputScript returns them.
+		std::vector<InputEvent> Input;
+	};
+
+	struct Results
+	{
+		uint32 NumFrames = 0;
+		double SimulatedSeconds = 0.0;
+
+		// Wall clock time of Update, per frame.
+		double TotalMs = 0.0;
+		double MeanMs = 0.0;
+		double MinMs = 0.0;
+		double MaxMs = 0.0;
+		double P50Ms = 0.0;
+		double P95Ms = 0.0;
+		double P99Ms = 0.0;
+	};
+
+	explicit HeadlessRunner(const Settings& settings);
+	HeadlessRunner(const HeadlessRunner& rhs) = delete;
+	HeadlessRunner& operator=(const HeadlessRunner& rhs) = delete;
+
+	// Resets timer, then runs every frame, ticking timer by the frame's time step and
+	// passing it to the client.  With a profiler, each frame is a profiler frame and
+	// Update is timed as the "Update" marker.
+	Results Run(Client& client, GameTimer& timer, Profiler* profiler = nullptr);
+
+	// Key state set by the events delivered so far.
+	bool IsKeyDown(uint32 key)const;
+
+	// Frame being run, from 0.
+	uint32 CurrentFrame()const;
+
+	// Return false and set error on a malformed line.
+	static bool LoadInputScript(std::istream& in, std::vector<InputEvent>& events, std::string* error = nullptr);
+	static bool LoadDeltas(std::istream& in, std::vector<double>& deltas, std::string* error = nullptr);
+
+	static void WriteResults(std::ostream& out, const Results& results);
+
+private:
+	Settings mSettings;
+
+	std::vector<bool> mKeys;
+	uint32 mCurrFrame = 0;
+};
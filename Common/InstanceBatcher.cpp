@@ -0,0 +1,106 @@
+//***************************************************************************************
+// InstanceBatcher.cpp
+//***************************************************************************************
+
+#include "InstanceBatcher.h"
+#include <functional>
+
+const InstanceSlotTracker::uint32 InstanceSlotTracker::NoItem;
+
+bool InstanceBatcher::Key::operator==(const Key& rhs)const
+{
+	return Geometry == rhs.Geometry &&
+		State == rhs.State &&
+		Layer == rhs.Layer &&
+		Topology == rhs.Topology &&
+		IndexCount == rhs.IndexCount &&
+		StartIndexLocation == rhs.StartIndexLocation &&
+		BaseVertexLocation == rhs.BaseVertexLocation;
+}
+
+size_t InstanceBatcher::KeyHasher::operator()(const Key& key)const
+{
+	size_t h = std::hash<const void*>()(key.Geometry);
+
+	auto combine = [&h](size_t v)
+	{
+		h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+	};
+
+	combine(std::hash<const void*>()(key.State));
+	combine(key.Layer);
+	combine(key.Topology);
+	combine(key.IndexCount);
+	combine(key.StartIndexLocation);
+	combine((size_t)(uint32)key.BaseVertexLocation);
+
+	return h;
+}
+
+void InstanceBatcher::Clear()
+{
+	mBatchLookup.clear();
+	mPending.clear();
+	mBatches.clear();
+	mInstanceItems.clear();
+}
+
+void InstanceBatcher::Add(const Key& key, uint32 item)
+{
+	auto it = mBatchLookup.find(key);
+
+	uint32 batchIndex = 0;
+	if(it == mBatchLookup.end())
+	{
+		batchIndex = (uint32)mBatches.size();
+		mBatchLookup[key] = batchIndex;
+
+		Batch batch;
+		batch.BatchKey = key;
+		mBatches.push_back(batch);
+	}
+	else
+	{
+		batchIndex = it->second;
+	}
+
+	mBatches[batchIndex].InstanceCount++;
+	mPending.push_back({ batchIndex, item });
+}
+
+void InstanceBatcher::Build()
+{
+	// Prefix sum of the batch sizes gives each batch its range in the instance buffer.
+	uint32 offset = 0;
+	for(auto& batch : mBatches)
+	{
+		batch.FirstInstance = offset;
+		offset += batch.InstanceCount;
+	}
+
+	// Scatter the items into their batch ranges, keeping insertion order.
+	std::vector<uint32> cursor(mBatches.size());
+	for(size_t i = 0; i < mBatches.size(); ++i)
+		cursor[i] = mBatches[i].FirstInstance;
+
+	mInstanceItems.resize(offset);
+	for(const auto& p : mPending)
+		mInstanceItems[cursor[p.BatchIndex]++] = p.Item;
+
+	mPending.clear();
+}
+
+const std::vector<InstanceBatcher::Batch>& InstanceBatcher::Batches()const
+{
+	return mBatches;
+}
+
+const std::vector<InstanceBatcher::uint32>& InstanceBatcher::InstanceItems()const
+{
+	return mInstanceItems;
+}
+
+InstanceBatcher::uint32 InstanceBatcher::NumItems()const
+{
+	return (uint32)mInstanceItems.size();
+}
@@ -0,0 +1,182 @@
+//***************************************************************************************
+// InstanceBatcher.h
+//
+// Groups draws that share the same geometry, submesh and pipeline state so that each
+// group can be drawn with a single instanced draw call.  The per-object data of every
+// item is expected to be written into a structured instance buffer in the order given
+// by InstanceItems(); each batch then covers the range
+// [FirstInstance, FirstInstance + InstanceCount) of that buffer.
+//
+// Per-object state that can be fetched per instance (world matrix, material index)
+// must not be part of the key; anything that needs a different bind (PSO, vertex and
+// index buffers, topology) must be.
+//
+// Batches are emitted in the order their first item was added, and items within a
+// batch keep their insertion order, so feeding the batcher from a sorted DrawList
+// keeps the layer/state/depth ordering.
+//
+// InstanceSlotTracker keeps the instance buffer of each frame resource up to date
+// without rewriting it every frame (see below).
+//
+// The classes have no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include "DirtyTracker.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class InstanceBatcher
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	struct Key
+	{
+		// Usually the MeshGeometry and the PSO; only compared, never dereferenced.
+		const void* Geometry = nullptr;
+		const void* State = nullptr;
+
+		uint32 Layer = 0;
+		uint32 Topology = 0;
+
+		// Submesh.
+		uint32 IndexCount = 0;
+		uint32 StartIndexLocation = 0;
+		int BaseVertexLocation = 0;
+
+		bool operator==(const Key& rhs)const;
+	};
+
+	struct Batch
+	{
+		Key BatchKey;
+		uint32 FirstInstance = 0;
+		uint32 InstanceCount = 0;
+	};
+
+	void Clear();
+
+	// item is client defined, usually an index into an array of render items.
+	void Add(const Key& key, uint32 item);
+
+	// Groups the added items into batches.
+	void Build();
+
+	const std::vector<Batch>& Batches()const;
+
+	// Client items in instance buffer order.
+	const std::vector<uint32>& InstanceItems()const;
+
+	uint32 NumItems()const;
+
+private:
+	struct KeyHasher
+	{
+		size_t operator()(const Key& key)const;
+	};
+
+	struct PendingItem
+	{
+		uint32 BatchIndex;
+		uint32 Item;
+	};
+
+	std::unordered_map<Key, uint32, KeyHasher> mBatchLookup;
+	std::vector<PendingItem> mPending;
+
+	std::vector<Batch> mBatches;
+	std::vector<uint32> mInstanceItems;
+};
+
+// Remembers, for each frame resource, which item each slot of its instance buffer was
+// last written with, and which items changed since.  A slot needs writing when a
+// different item moved into it or its item changed, so with a still scene nothing is
+// written, and when the order changes only the instances that moved are.
+//
+// Items are identified by a stable id in [0, ItemCount()), such as the ObjCBIndex of
+// a render item; call MarkDirty(id) when the data of an item changes.
+class InstanceSlotTracker
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	static const uint32 NoItem = uint32(-1);
+
+	InstanceSlotTracker(int numFrameResources, uint32 itemCount = 0) :
+		mDirty(numFrameResources, itemCount),
+		mSlots(numFrameResources)
+	{
+	}
+
+	InstanceSlotTracker(const InstanceSlotTracker& rhs) = delete;
+	InstanceSlotTracker& operator=(const InstanceSlotTracker& rhs) = delete;
+
+	uint32 ItemCount()const
+	{
+		return mDirty.ElementCount();
+	}
+
+	void Resize(uint32 itemCount)
+	{
+		mDirty.Resize(itemCount);
+	}
+
+	void MarkDirty(uint32 item)
+	{
+		mDirty.MarkDirty(item);
+	}
+
+	// slotItems[i] is the id of the item that belongs in slot i of the instance buffer
+	// of the frame resource.  Calls fn(firstSlot, count) for each run of consecutive
+	// slots that need writing, and records them as written.
+	template<typename Fn>
+	void ConsumeStaleRuns(int frameIndex, const std::vector<uint32>& slotItems, Fn&& fn)
+	{
+		std::vector<uint32>& slots = mSlots[frameIndex];
+
+		// Forget the slots holding items that changed since this frame resource was written.
+		if(mDirty.DirtyCount(frameIndex) != 0)
+		{
+			for(uint32& item : slots)
+			{
+				if(item != NoItem && mDirty.IsDirty(frameIndex, item))
+					item = NoItem;
+			}
+
+			mDirty.ConsumeDirtyRanges(frameIndex, [](unsigned int, unsigned int) { });
+		}
+
+		slots.resize(slotItems.size(), NoItem);
+
+		size_t runFirst = 0;
+		bool inRun = false;
+		for(size_t i = 0; i <= slotItems.size(); ++i)
+		{
+			if(i < slotItems.size() && slots[i] != slotItems[i])
+			{
+				if(!inRun)
+					runFirst = i;
+				inRun = true;
+
+				slots[i] = slotItems[i];
+			}
+			else if(inRun)
+			{
+				fn((uint32)runFirst, (uint32)(i - runFirst));
+				inRun = false;
+			}
+		}
+	}
+
+private:
+	DirtyTracker mDirty;
+
+	// Per frame resource, the item each slot was last written with.
+	std::vector<std::vector<uint32>> mSlots;
+};
@@ -0,0 +1,106 @@
+//***************************************************************************************
+// LinearUploadAllocator.cpp
+//***************************************************************************************
+
+#include "LinearUploadAllocator.h"
+
+LinearUploadAllocator::LinearUploadAllocator(ID3D12Device* device, UINT64 pageSize) :
+	md3dDevice(device),
+	mPageSize(pageSize)
+{
+	mPages.push_back(CreatePage(pageSize));
+}
+
+LinearUploadAllocator::~LinearUploadAllocator()
+{
+	for(auto& page : mPages)
+		page.Resource->Unmap(0, nullptr);
+}
+
+void LinearUploadAllocator::Reset()
+{
+	// Replace the pages of a frame that overflowed by one page big enough for it, so
+	// the next frames fit in a single resource.
+	if(mPages.size() > 1)
+	{
+		UINT64 totalSize = 0;
+		for(auto& page : mPages)
+		{
+			totalSize += page.Size;
+			page.Resource->Unmap(0, nullptr);
+		}
+
+		mPages.clear();
+		mPages.push_back(CreatePage(totalSize));
+	}
+
+	mCurrPage = 0;
+	mOffset = 0;
+	mUsedInFullPages = 0;
+}
+
+LinearUploadAllocator::Allocation LinearUploadAllocator::Allocate(UINT64 size, UINT64 alignment)
+{
+	UINT64 offset = (mOffset + alignment - 1) & ~(alignment - 1);
+
+	if(offset + size > mPages[mCurrPage].Size)
+	{
+		// Move on to the next page, adding one if needed.  Committed resources are
+		// 64KB aligned, which covers any alignment asked for here.
+		mUsedInFullPages += mOffset;
+		mCurrPage++;
+
+		if(mCurrPage == mPages.size() || mPages[mCurrPage].Size < size)
+			mPages.insert(mPages.begin() + mCurrPage, CreatePage(size > mPageSize ? size : mPageSize));
+
+		offset = 0;
+	}
+
+	mOffset = offset + size;
+
+	const Page& page = mPages[mCurrPage];
+
+	Allocation alloc;
+	alloc.Resource = page.Resource.Get();
+	alloc.Offset = offset;
+	alloc.CpuAddress = page.MappedData + offset;
+	alloc.GpuAddress = page.Resource->GetGPUVirtualAddress() + offset;
+	return alloc;
+}
+
+UINT64 LinearUploadAllocator::UsedSize()const
+{
+	return mUsedInFullPages + mOffset;
+}
+
+UINT64 LinearUploadAllocator::Capacity()const
+{
+	UINT64 capacity = 0;
+	for(const auto& page : mPages)
+		capacity += page.Size;
+	return capacity;
+}
+
+UINT LinearUploadAllocator::NumPages()const
+{
+	return (UINT)mPages.size();
+}
+
+LinearUploadAllocator::Page LinearUploadAllocator::CreatePage(UINT64 size)
+{
+	Page page;
+	page.Size = size;
+
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&page.Resource)));
+
+	// Stays mapped for the lifetime of the page.
+	ThrowIfFailed(page.Resource->Map(0, nullptr, reinterpret_cast<void**>(&page.MappedData)));
+
+	return page;
+}
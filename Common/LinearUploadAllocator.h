@@ -0,0 +1,96 @@
+//***************************************************************************************
+// LinearUploadAllocator.h
+//
+// Per-frame bump allocator over persistently mapped upload memory.  Constants and
+// structured buffer data are written into slices handed out on demand, and bound
+// with root descriptors, instead of living in fixed size UploadBuffers:
+//
+//   passCB = frame->Uploads->AllocateConstants(mMainPassCB);
+//   cmdList->SetGraphicsRootConstantBufferView(1, passCB);
+//
+// Each FrameResource owns one and calls Reset() once its fence has passed.  When a
+// frame needs more than the current page, another page is added; Reset() then
+// merges the pages into one, so in steady state there is a single upload resource
+// per frame resource whatever the number of objects.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+
+class LinearUploadAllocator
+{
+public:
+	struct Allocation
+	{
+		ID3D12Resource* Resource = nullptr;
+		UINT64 Offset = 0;
+		BYTE* CpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+	};
+
+	LinearUploadAllocator(ID3D12Device* device, UINT64 pageSize = 64 * 1024);
+	LinearUploadAllocator(const LinearUploadAllocator& rhs) = delete;
+	LinearUploadAllocator& operator=(const LinearUploadAllocator& rhs) = delete;
+	~LinearUploadAllocator();
+
+	// Frees every allocation.  The GPU must be done with all of them.
+	void Reset();
+
+	// alignment must be a power of two.
+	Allocation Allocate(UINT64 size, UINT64 alignment);
+
+	// Copies data into a constant buffer slice (256 byte aligned and sized) and
+	// returns its address for SetGraphicsRootConstantBufferView.
+	template<typename T>
+	D3D12_GPU_VIRTUAL_ADDRESS AllocateConstants(const T& data)
+	{
+		Allocation alloc = Allocate(d3dUtil::CalcConstantBufferByteSize(sizeof(T)),
+			D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+		memcpy(alloc.CpuAddress, &data, sizeof(T));
+		return alloc.GpuAddress;
+	}
+
+	// Space for elementCount constant buffers of type T, one every
+	// CalcConstantBufferByteSize(sizeof(T)) bytes.
+	template<typename T>
+	Allocation AllocateConstantsArray(UINT elementCount)
+	{
+		return Allocate(UINT64(d3dUtil::CalcConstantBufferByteSize(sizeof(T))) * elementCount,
+			D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	}
+
+	// Space for a tightly packed StructuredBuffer<T> of elementCount elements, for
+	// SetGraphicsRootShaderResourceView.
+	template<typename T>
+	Allocation AllocateStructured(UINT elementCount)
+	{
+		return Allocate(UINT64(sizeof(T)) * elementCount, 16);
+	}
+
+	// Bytes allocated since the last Reset, and bytes of upload memory held.
+	UINT64 UsedSize()const;
+	UINT64 Capacity()const;
+	UINT NumPages()const;
+
+private:
+	struct Page
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		BYTE* MappedData = nullptr;
+		UINT64 Size = 0;
+	};
+
+	Page CreatePage(UINT64 size);
+
+private:
+	ID3D12Device* md3dDevice = nullptr;
+	UINT64 mPageSize = 0;
+
+	std::vector<Page> mPages;
+	size_t mCurrPage = 0;
+	UINT64 mOffset = 0;
+
+	// Bytes used in the pages before mCurrPage.
+	UINT64 mUsedInFullPages = 0;
+};
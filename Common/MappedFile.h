@@ -0,0 +1,228 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only memory mapping of a whole file.  Uses CreateFileMapping/MapViewOfFile on
+// Windows and mmap on POSIX systems, so file contents can be parsed in place without
+// first being read into a heap allocation.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	MappedFile(const MappedFile& rhs) = delete;
+	MappedFile& operator=(const MappedFile& rhs) = delete;
+
+	MappedFile(MappedFile&& rhs)
+	{
+		*this = std::move(rhs);
+	}
+
+	MappedFile& operator=(MappedFile&& rhs)
+	{
+		if(this != &rhs)
+		{
+			Close();
+			mData = rhs.mData;
+			mSize = rhs.mSize;
+			mError = rhs.mError;
+			rhs.mData = nullptr;
+			rhs.mSize = 0;
+		}
+		return *this;
+	}
+
+	~MappedFile()
+	{
+		Close();
+	}
+
+	// Returns false on failure; LastError() then holds the GetLastError()/errno value.
+	// Empty files cannot be mapped and are reported as failures.
+	bool Open(const wchar_t* fileName)
+	{
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+		{
+			mError = GetLastError();
+			return false;
+		}
+
+		LARGE_INTEGER fileSize = { 0 };
+		if(!GetFileSizeEx(file, &fileSize))
+		{
+			mError = GetLastError();
+			CloseHandle(file);
+			return false;
+		}
+
+		if(fileSize.QuadPart == 0)
+		{
+			mError = ERROR_HANDLE_EOF;
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(mapping == nullptr)
+		{
+			mError = GetLastError();
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		mError = view ? 0 : GetLastError();
+
+		// The view keeps the mapping alive.
+		CloseHandle(mapping);
+		CloseHandle(file);
+
+		if(view == nullptr)
+			return false;
+
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = (size_t)fileSize.QuadPart;
+		return true;
+#else
+		// POSIX paths are narrow bytes, UTF-8 in practice.  Convert explicitly rather
+		// than with wcstombs, which depends on the locale and fails on any non-ASCII
+		// character under the default "C" locale.
+		std::string path;
+		if(!ToUtf8(fileName, path))
+		{
+			mError = EILSEQ;
+			return false;
+		}
+
+		return Open(path.c_str());
+#endif
+	}
+
+#ifndef _WIN32
+	bool Open(const char* fileName)
+	{
+		Close();
+
+		int fd = open(fileName, O_RDONLY);
+		if(fd < 0)
+		{
+			mError = errno;
+			return false;
+		}
+
+		struct stat st;
+		if(fstat(fd, &st) != 0)
+		{
+			mError = errno;
+			close(fd);
+			return false;
+		}
+
+		if(st.st_size == 0)
+		{
+			mError = EINVAL;
+			close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		mError = view == MAP_FAILED ? errno : 0;
+
+		// The mapping keeps the file alive.
+		close(fd);
+
+		if(view == MAP_FAILED)
+			return false;
+
+		// We parse the file front to back.
+		madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+		mData = static_cast<const std::uint8_t*>(view);
+		mSize = (size_t)st.st_size;
+		return true;
+	}
+#endif
+
+	void Close()
+	{
+		if(mData != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(mData);
+#else
+			munmap(const_cast<std::uint8_t*>(mData), mSize);
+#endif
+		}
+
+		mData = nullptr;
+		mSize = 0;
+	}
+
+	bool IsOpen()const { return mData != nullptr; }
+	const std::uint8_t* Data()const { return mData; }
+	size_t Size()const { return mSize; }
+	unsigned long LastError()const { return mError; }
+
+private:
+#ifndef _WIN32
+	// wchar_t holds UTF-32 code points on POSIX systems.
+	static bool ToUtf8(const wchar_t* s, std::string& utf8)
+	{
+		utf8.clear();
+		for(; *s != L'\0'; ++s)
+		{
+			std::uint32_t c = (std::uint32_t)*s;
+			if(c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+				return false;
+
+			if(c < 0x80)
+				utf8 += (char)c;
+			else if(c < 0x800)
+			{
+				utf8 += (char)(0xC0 | (c >> 6));
+				utf8 += (char)(0x80 | (c & 0x3F));
+			}
+			else if(c < 0x10000)
+			{
+				utf8 += (char)(0xE0 | (c >> 12));
+				utf8 += (char)(0x80 | ((c >> 6) & 0x3F));
+				utf8 += (char)(0x80 | (c & 0x3F));
+			}
+			else
+			{
+				utf8 += (char)(0xF0 | (c >> 18));
+				utf8 += (char)(0x80 | ((c >> 12) & 0x3F));
+				utf8 += (char)(0x80 | ((c >> 6) & 0x3F));
+				utf8 += (char)(0x80 | (c & 0x3F));
+			}
+		}
+		return true;
+	}
+#endif
+
+	const std::uint8_t* mData = nullptr;
+	size_t mSize = 0;
+	unsigned long mError = 0;
+};
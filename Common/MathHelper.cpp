@@ -79,4 +79,46 @@ XMVECTOR MathHelper::RandHemisphereUnitVec3(XMVECTOR n)
 
 		return XMVector3Normalize(v);
 	}
-}
\ No newline at end of file
+}
+
+XMMATRIX MathHelper::AffineInverse(FXMMATRIX M, XMMATRIX* invTranspose)
+{
+	XMVECTOR r0 = M.r[0];
+	XMVECTOR r1 = M.r[1];
+	XMVECTOR r2 = M.r[2];
+
+	// The columns of the inverse of the upper 3x3 are the cross products of
+	// the rows divided by the determinant.
+	XMVECTOR c0 = XMVector3Cross(r1, r2);
+	XMVECTOR c1 = XMVector3Cross(r2, r0);
+	XMVECTOR c2 = XMVector3Cross(r0, r1);
+
+	XMVECTOR det = XMVector3Dot(r0, c0);
+	if(fabsf(XMVectorGetX(det)) < 1e-12f)
+	{
+		// Degenerate; let the general inverse deal with it.
+		XMVECTOR d = XMMatrixDeterminant(M);
+		XMMATRIX inv = XMMatrixInverse(&d, M);
+		if(invTranspose != nullptr)
+			*invTranspose = InverseTranspose(M);
+		return inv;
+	}
+
+	XMVECTOR invDet = XMVectorReciprocal(det);
+	c0 = XMVectorSelect(g_XMZero, XMVectorMultiply(c0, invDet), g_XMSelect1110);
+	c1 = XMVectorSelect(g_XMZero, XMVectorMultiply(c1, invDet), g_XMSelect1110);
+	c2 = XMVectorSelect(g_XMZero, XMVectorMultiply(c2, invDet), g_XMSelect1110);
+
+	// Rows c0, c1, c2 hold the inverse-transpose of the linear part.
+	XMMATRIX invT(c0, c1, c2, g_XMIdentityR3);
+	if(invTranspose != nullptr)
+		*invTranspose = invT;
+
+	XMMATRIX inv = XMMatrixTranspose(invT);
+
+	// Translation row is -t * inv(A).
+	XMVECTOR t = XMVector3TransformNormal(M.r[3], inv);
+	inv.r[3] = XMVectorSelect(g_XMIdentityR3, XMVectorNegate(t), g_XMSelect1110);
+
+	return inv;
+}
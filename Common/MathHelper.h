@@ -13,6 +13,13 @@
 class MathHelper
 {
 public:
+	// Seeds RandF and Rand, e.g. from a ReplayLog.  They use rand(), whose state the
+	// CRT keeps per thread, so seed on the thread that calls them.
+	static void SeedRand(unsigned int seed)
+	{
+		srand(seed);
+	}
+
 	// Returns random float in [0, 1).
 	static float RandF()
 	{
@@ -78,6 +85,12 @@ public:
         return DirectX::XMMatrixTranspose(DirectX::XMMatrixInverse(&det, A));
 	}
 
+	// Inverse of an affine matrix (upper 3x3 linear part plus translation row).  Much
+	// cheaper than the general XMMatrixInverse since the last column is known to be
+	// [0, 0, 0, 1]^T.  Optionally returns the inverse-transpose of the linear part
+	// (same as InverseTranspose(M)) as a by-product.
+	static DirectX::XMMATRIX AffineInverse(DirectX::FXMMATRIX M, DirectX::XMMATRIX* invTranspose = nullptr);
+
     static DirectX::XMFLOAT4X4 Identity4x4()
     {
         static DirectX::XMFLOAT4X4 I(
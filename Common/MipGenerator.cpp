@@ -0,0 +1,456 @@
+//***************************************************************************************
+// MipGenerator.cpp
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+	using uint32 = MipGenerator::uint32;
+
+	// Half width of the Kaiser filter, in destination texels, and its shape.
+	const float KaiserHalfWidth = 3.0f;
+	const float KaiserAlpha = 4.0f;
+
+	float BesselI0(float x)
+	{
+		// Power series; converges quickly for the small arguments used here.
+		float sum = 1.0f;
+		float term = 1.0f;
+		float halfX = 0.5f * x;
+		for(int k = 1; k < 20; ++k)
+		{
+			term *= (halfX / k) * (halfX / k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	float Kaiser(float t)
+	{
+		float x = t / KaiserHalfWidth;
+		if(x <= -1.0f || x >= 1.0f)
+			return 0.0f;
+
+		float sinc = 1.0f;
+		if(t != 0.0f)
+		{
+			const float pi = 3.1415926535f;
+			sinc = std::sin(pi * t) / (pi * t);
+		}
+
+		return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - x * x)) / BesselI0(KaiserAlpha);
+	}
+
+	float SrgbToLinear(float c)
+	{
+		return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float c)
+	{
+		return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+	}
+
+	std::uint8_t ToUnorm8(float c)
+	{
+		c = std::min(std::max(c, 0.0f), 1.0f);
+		return (std::uint8_t)(c * 255.0f + 0.5f);
+	}
+
+	float HalfToFloat(std::uint16_t h)
+	{
+		uint32 sign = (uint32)(h & 0x8000) << 16;
+		uint32 exponent = (h >> 10) & 0x1f;
+		uint32 mantissa = h & 0x3ff;
+
+		uint32 bits;
+		if(exponent == 0x1f)
+		{
+			bits = sign | 0x7f800000 | (mantissa << 13); // inf / nan
+		}
+		else if(exponent != 0)
+		{
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		else if(mantissa != 0)
+		{
+			// Denormal; renormalize.
+			exponent = 113;
+			while((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+		else
+		{
+			bits = sign;
+		}
+
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+
+	std::uint16_t FloatToHalf(float f)
+	{
+		uint32 bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+
+		uint32 sign = (bits >> 16) & 0x8000;
+		uint32 absBits = bits & 0x7fffffff;
+
+		if(absBits >= 0x7f800000)
+			return (std::uint16_t)(sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0));
+		if(absBits >= 0x477ff000)
+			return (std::uint16_t)(sign | 0x7bff); // clamp to the largest half
+		if(absBits < 0x38800000)
+		{
+			// Denormal or zero.
+			uint32 shift = 113 - (absBits >> 23);
+			if(shift > 24)
+				return (std::uint16_t)sign;
+			uint32 mantissa = (absBits & 0x7fffff) | 0x800000;
+			return (std::uint16_t)(sign | ((mantissa + (1u << (shift + 12))) >> (shift + 13)));
+		}
+
+		// Round to nearest even.
+		uint32 rounded = absBits + 0xfff + ((absBits >> 13) & 1);
+		return (std::uint16_t)(sign | ((rounded - 0x38000000) >> 13));
+	}
+}
+
+MipGenerator::MipGenerator(uint32 numThreads)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0)
+		numThreads = 1;
+
+	mNumThreads = numThreads;
+}
+
+void MipGenerator::Generate(Format format, const void* pixels, uint32 width, uint32 height, uint32 rowPitch,
+	Filter filter, AddressMode addressMode, uint32 maxLevels)
+{
+	assert(width > 0 && height > 0);
+
+	mFormat = format;
+	mFilter = filter;
+	mAddressMode = addressMode;
+	mChannels = format == Format::R32F ? 1 : 4;
+
+	uint32 numLevels = NumMipLevels(width, height);
+	if(maxLevels != 0)
+		numLevels = std::min(numLevels, maxLevels);
+
+	uint32 bytesPerPixel = BytesPerPixel(format);
+
+	mLevels.resize(numLevels);
+	std::size_t size = 0;
+	for(uint32 i = 0; i < numLevels; ++i)
+	{
+		Level& level = mLevels[i];
+		level.Width = std::max(width >> i, 1u);
+		level.Height = std::max(height >> i, 1u);
+		level.RowPitch = level.Width * bytesPerPixel;
+		level.Offset = size;
+		size += (std::size_t)level.RowPitch * level.Height;
+	}
+	mData.resize(size);
+
+	for(uint32 y = 0; y < height; ++y)
+	{
+		std::memcpy(mData.data() + (std::size_t)y * mLevels[0].RowPitch,
+			static_cast<const uint8*>(pixels) + (std::size_t)y * rowPitch, mLevels[0].RowPitch);
+	}
+
+	if(numLevels == 1)
+		return;
+
+	FloatImage curr;
+	FloatImage next;
+	ToFloat(pixels, rowPitch, curr);
+	curr.Width = width;
+	curr.Height = height;
+
+	for(uint32 i = 1; i < numLevels; ++i)
+	{
+		next.Width = mLevels[i].Width;
+		next.Height = mLevels[i].Height;
+		Downsample(curr, next);
+
+		FromFloat(next, mData.data() + mLevels[i].Offset, mLevels[i].RowPitch);
+		std::swap(curr, next);
+	}
+}
+
+MipGenerator::uint32 MipGenerator::NumLevels()const
+{
+	return (uint32)mLevels.size();
+}
+
+const MipGenerator::Level& MipGenerator::GetLevel(uint32 level)const
+{
+	return mLevels[level];
+}
+
+const MipGenerator::uint8* MipGenerator::GetLevelData(uint32 level)const
+{
+	return mData.data() + mLevels[level].Offset;
+}
+
+MipGenerator::uint32 MipGenerator::NumMipLevels(uint32 width, uint32 height)
+{
+	uint32 numLevels = 1;
+	uint32 size = std::max(width, height);
+	while(size > 1)
+	{
+		size >>= 1;
+		++numLevels;
+	}
+	return numLevels;
+}
+
+MipGenerator::uint32 MipGenerator::BytesPerPixel(Format format)
+{
+	switch(format)
+	{
+	case Format::RGBA8:
+	case Format::RGBA8_SRGB:
+	case Format::R32F:
+		return 4;
+	case Format::RGBA16F:
+		return 8;
+	}
+	return 0;
+}
+
+void MipGenerator::ToFloat(const void* pixels, uint32 rowPitch, FloatImage& image)const
+{
+	uint32 width = mLevels[0].Width;
+	uint32 height = mLevels[0].Height;
+	image.Texels.resize((std::size_t)width * height * mChannels);
+
+	float srgbToLinear[256];
+	for(int i = 0; i < 256; ++i)
+		srgbToLinear[i] = SrgbToLinear(i / 255.0f);
+
+	ParallelRows(height, [&](uint32 firstRow, uint32 endRow)
+	{
+		for(uint32 y = firstRow; y < endRow; ++y)
+		{
+			const uint8* src = static_cast<const uint8*>(pixels) + (std::size_t)y * rowPitch;
+			float* dst = &image.Texels[(std::size_t)y * width * mChannels];
+
+			for(uint32 x = 0; x < width; ++x)
+			{
+				switch(mFormat)
+				{
+				case Format::RGBA8:
+					for(uint32 c = 0; c < 4; ++c)
+						dst[x * 4 + c] = src[x * 4 + c] / 255.0f;
+					break;
+				case Format::RGBA8_SRGB:
+					for(uint32 c = 0; c < 3; ++c)
+						dst[x * 4 + c] = srgbToLinear[src[x * 4 + c]];
+					dst[x * 4 + 3] = src[x * 4 + 3] / 255.0f;
+					break;
+				case Format::RGBA16F:
+					for(uint32 c = 0; c < 4; ++c)
+					{
+						std::uint16_t h;
+						std::memcpy(&h, src + (x * 4 + c) * 2, sizeof(h));
+						dst[x * 4 + c] = HalfToFloat(h);
+					}
+					break;
+				case Format::R32F:
+					std::memcpy(&dst[x], src + x * 4, sizeof(float));
+					break;
+				}
+			}
+		}
+	});
+}
+
+void MipGenerator::FromFloat(const FloatImage& image, uint8* dstData, uint32 rowPitch)const
+{
+	ParallelRows(image.Height, [&](uint32 firstRow, uint32 endRow)
+	{
+		for(uint32 y = firstRow; y < endRow; ++y)
+		{
+			const float* src = &image.Texels[(std::size_t)y * image.Width * mChannels];
+			uint8* dst = dstData + (std::size_t)y * rowPitch;
+
+			for(uint32 x = 0; x < image.Width; ++x)
+			{
+				switch(mFormat)
+				{
+				case Format::RGBA8:
+					for(uint32 c = 0; c < 4; ++c)
+						dst[x * 4 + c] = ToUnorm8(src[x * 4 + c]);
+					break;
+				case Format::RGBA8_SRGB:
+					for(uint32 c = 0; c < 3; ++c)
+						dst[x * 4 + c] = ToUnorm8(LinearToSrgb(std::max(src[x * 4 + c], 0.0f)));
+					dst[x * 4 + 3] = ToUnorm8(src[x * 4 + 3]);
+					break;
+				case Format::RGBA16F:
+					for(uint32 c = 0; c < 4; ++c)
+					{
+						std::uint16_t h = FloatToHalf(src[x * 4 + c]);
+						std::memcpy(dst + (x * 4 + c) * 2, &h, sizeof(h));
+					}
+					break;
+				case Format::R32F:
+					std::memcpy(dst + x * 4, &src[x], sizeof(float));
+					break;
+				}
+			}
+		}
+	});
+}
+
+MipGenerator::Taps MipGenerator::BuildTaps(uint32 srcSize, uint32 dstSize)const
+{
+	Taps taps(dstSize);
+
+	if(srcSize == dstSize)
+	{
+		for(uint32 x = 0; x < dstSize; ++x)
+			taps[x].push_back({ x, 1.0f });
+		return taps;
+	}
+
+	// Destination texel x covers [x * scale, (x + 1) * scale) of the source, which
+	// also handles odd sizes, where the scale is a bit more than two.
+	float scale = (float)srcSize / dstSize;
+
+	auto addressOf = [&](int i)
+	{
+		if(mAddressMode == AddressMode::Wrap)
+			return (uint32)(((i % (int)srcSize) + (int)srcSize) % (int)srcSize);
+		return (uint32)std::min(std::max(i, 0), (int)srcSize - 1);
+	};
+
+	for(uint32 x = 0; x < dstSize; ++x)
+	{
+		float begin = x * scale;
+		float end = (x + 1) * scale;
+		std::vector<Tap>& t = taps[x];
+
+		if(mFilter == Filter::Box)
+		{
+			for(int i = (int)std::floor(begin); i < (int)std::ceil(end); ++i)
+			{
+				float weight = std::min(i + 1.0f, end) - std::max((float)i, begin);
+				if(weight > 0.0f)
+					t.push_back({ addressOf(i), weight / scale });
+			}
+		}
+		else
+		{
+			float center = 0.5f * (begin + end);
+			float support = KaiserHalfWidth * scale;
+
+			float sum = 0.0f;
+			for(int i = (int)std::floor(center - support); i <= (int)std::ceil(center + support); ++i)
+			{
+				float weight = Kaiser((i + 0.5f - center) / scale);
+				if(weight != 0.0f)
+				{
+					t.push_back({ addressOf(i), weight });
+					sum += weight;
+				}
+			}
+
+			for(auto& tap : t)
+				tap.Weight /= sum;
+		}
+	}
+
+	return taps;
+}
+
+void MipGenerator::Downsample(const FloatImage& src, FloatImage& dst)const
+{
+	const uint32 channels = mChannels;
+
+	Taps tapsX = BuildTaps(src.Width, dst.Width);
+	Taps tapsY = BuildTaps(src.Height, dst.Height);
+
+	// Horizontal pass into a dst.Width x src.Height image, then vertical.
+	FloatImage tmp;
+	tmp.Width = dst.Width;
+	tmp.Height = src.Height;
+	tmp.Texels.assign((std::size_t)tmp.Width * tmp.Height * channels, 0.0f);
+
+	ParallelRows(tmp.Height, [&](uint32 firstRow, uint32 endRow)
+	{
+		for(uint32 y = firstRow; y < endRow; ++y)
+		{
+			const float* srcRow = &src.Texels[(std::size_t)y * src.Width * channels];
+			float* dstRow = &tmp.Texels[(std::size_t)y * tmp.Width * channels];
+
+			for(uint32 x = 0; x < tmp.Width; ++x)
+			{
+				for(const Tap& tap : tapsX[x])
+				{
+					for(uint32 c = 0; c < channels; ++c)
+						dstRow[x * channels + c] += tap.Weight * srcRow[tap.Index * channels + c];
+				}
+			}
+		}
+	});
+
+	dst.Texels.assign((std::size_t)dst.Width * dst.Height * channels, 0.0f);
+
+	const std::size_t rowSize = (std::size_t)dst.Width * channels;
+	ParallelRows(dst.Height, [&](uint32 firstRow, uint32 endRow)
+	{
+		for(uint32 y = firstRow; y < endRow; ++y)
+		{
+			float* dstRow = &dst.Texels[y * rowSize];
+
+			// Whole rows at a time, so the inner loop runs over contiguous floats.
+			for(const Tap& tap : tapsY[y])
+			{
+				const float* srcRow = &tmp.Texels[tap.Index * rowSize];
+				for(std::size_t i = 0; i < rowSize; ++i)
+					dstRow[i] += tap.Weight * srcRow[i];
+			}
+		}
+	});
+}
+
+template<typename Func>
+void MipGenerator::ParallelRows(uint32 numRows, Func func)const
+{
+	// Small levels are not worth a thread.
+	const uint32 minRowsPerThread = 16;
+	uint32 numThreads = std::min(mNumThreads, std::max(numRows / minRowsPerThread, 1u));
+
+	uint32 rowsPerThread = (numRows + numThreads - 1) / numThreads;
+
+	std::vector<std::thread> threads;
+	for(uint32 t = 1; t < numThreads; ++t)
+	{
+		uint32 firstRow = t * rowsPerThread;
+		if(firstRow >= numRows)
+			break;
+
+		threads.emplace_back(func, firstRow, std::min(firstRow + rowsPerThread, numRows));
+	}
+
+	func(0, std::min(rowsPerThread, numRows));
+
+	for(auto& t : threads)
+		t.join();
+}
@@ -0,0 +1,131 @@
+//***************************************************************************************
+// MipGenerator.h
+//
+// Builds the mip chain of a texture created at runtime on the CPU, so generated
+// textures can be sampled with mipmapping like the ones loaded from DDS files:
+//
+//   MipGenerator mips;
+//   mips.Generate(MipGenerator::Format::RGBA8_SRGB, pixels, width, height, width * 4,
+//       MipGenerator::Filter::Kaiser);
+//   texDesc.MipLevels = (UINT16)mips.NumLevels();
+//   ...
+//   auto subresources = mips.GetSubresources<D3D12_SUBRESOURCE_DATA>();
+//   UpdateSubresources(cmdList, texture, uploadHeap, 0, 0, (UINT)subresources.size(),
+//       subresources.data());
+//
+// Filtering is done in float.  sRGB data is converted to linear first so the mips do
+// not darken, and alpha is always filtered linearly.  Each level is computed from the
+// previous one with a separable filter whose rows are split across threads.
+//
+// The class has no Direct3D dependencies; GetSubresources fills any struct with
+// pData, RowPitch and SlicePitch members.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class MipGenerator
+{
+public:
+
+	using uint8 = std::uint8_t;
+	using uint32 = std::uint32_t;
+
+	enum class Format
+	{
+		RGBA8,      // DXGI_FORMAT_R8G8B8A8_UNORM
+		RGBA8_SRGB, // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+		RGBA16F,    // DXGI_FORMAT_R16G16B16A16_FLOAT
+		R32F        // DXGI_FORMAT_R32_FLOAT
+	};
+
+	enum class Filter
+	{
+		Box,   // 2x2 average; fast, slightly blurry.
+		Kaiser // Kaiser windowed sinc; sharper, keeps more detail.
+	};
+
+	enum class AddressMode
+	{
+		Clamp,
+		Wrap   // For textures that tile.
+	};
+
+	struct Level
+	{
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 RowPitch = 0;
+		std::size_t Offset = 0;
+	};
+
+	// numThreads == 0 uses one thread per hardware thread.
+	explicit MipGenerator(uint32 numThreads = 0);
+
+	// Level 0 is a copy of the source.  maxLevels == 0 builds the chain down to 1x1.
+	void Generate(Format format, const void* pixels, uint32 width, uint32 height, uint32 rowPitch,
+		Filter filter = Filter::Box, AddressMode addressMode = AddressMode::Clamp, uint32 maxLevels = 0);
+
+	uint32 NumLevels()const;
+	const Level& GetLevel(uint32 level)const;
+	const uint8* GetLevelData(uint32 level)const;
+
+	// Subresource data for every level, finest first; valid while the generator lives
+	// and until the next Generate.
+	template<typename SubresourceData>
+	std::vector<SubresourceData> GetSubresources()const
+	{
+		std::vector<SubresourceData> subresources(mLevels.size());
+		for(std::size_t i = 0; i < mLevels.size(); ++i)
+		{
+			subresources[i].pData = mData.data() + mLevels[i].Offset;
+			subresources[i].RowPitch = mLevels[i].RowPitch;
+			subresources[i].SlicePitch = mLevels[i].RowPitch * mLevels[i].Height;
+		}
+		return subresources;
+	}
+
+	static uint32 NumMipLevels(uint32 width, uint32 height);
+	static uint32 BytesPerPixel(Format format);
+
+private:
+	// A level in float, with mChannels floats per texel.
+	struct FloatImage
+	{
+		uint32 Width = 0;
+		uint32 Height = 0;
+		std::vector<float> Texels;
+	};
+
+	void ToFloat(const void* pixels, uint32 rowPitch, FloatImage& image)const;
+	void FromFloat(const FloatImage& image, uint8* dst, uint32 rowPitch)const;
+
+	// Source texels and weights of each destination texel along one axis.
+	struct Tap
+	{
+		uint32 Index;
+		float Weight;
+	};
+	typedef std::vector<std::vector<Tap>> Taps;
+
+	Taps BuildTaps(uint32 srcSize, uint32 dstSize)const;
+	void Downsample(const FloatImage& src, FloatImage& dst)const;
+
+	// Runs func(firstRow, endRow) over [0, numRows) on the worker threads.
+	template<typename Func>
+	void ParallelRows(uint32 numRows, Func func)const;
+
+private:
+	uint32 mNumThreads = 1;
+
+	Format mFormat = Format::RGBA8;
+	Filter mFilter = Filter::Box;
+	AddressMode mAddressMode = AddressMode::Clamp;
+	uint32 mChannels = 4;
+
+	std::vector<Level> mLevels;
+	std::vector<uint8> mData;
+};
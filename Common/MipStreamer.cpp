@@ -0,0 +1,239 @@
+//***************************************************************************************
+// MipStreamer.cpp
+//***************************************************************************************
+
+#include "MipStreamer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+MipStreamer::MipStreamer(Device* device, uint64 budgetBytes, uint32 maxRequestsPerUpdate) :
+	mDevice(device),
+	mBudgetBytes(budgetBytes),
+	mMaxRequestsPerUpdate(maxRequestsPerUpdate)
+{
+	assert(device != nullptr);
+}
+
+MipStreamer::uint32 MipStreamer::AddTexture(const std::vector<uint64>& mipSizes, uint32 baseMips)
+{
+	assert(!mipSizes.empty());
+
+	TextureState t;
+	t.NumMips = (uint32)mipSizes.size();
+
+	t.TailBytes.resize(t.NumMips + 1);
+	t.TailBytes[t.NumMips] = 0;
+	for(uint32 i = t.NumMips; i > 0; --i)
+		t.TailBytes[i - 1] = t.TailBytes[i] + mipSizes[i - 1];
+
+	baseMips = std::min(std::max(baseMips, 1u), t.NumMips);
+	t.BaseFirstMip = t.NumMips - baseMips;
+	t.ResidentFirstMip = t.BaseFirstMip;
+	t.TargetFirstMip = t.BaseFirstMip;
+	t.RequestedMip = t.NumMips;
+	t.WantedFirstMip = t.BaseFirstMip;
+
+	mCommittedBytes += Bytes(t, t.BaseFirstMip);
+
+	mTextures.push_back(t);
+	return (uint32)mTextures.size() - 1;
+}
+
+void MipStreamer::RequestMip(uint32 texture, uint32 mip)
+{
+	TextureState& t = mTextures[texture];
+	t.RequestedMip = std::min(t.RequestedMip, mip);
+}
+
+void MipStreamer::Update(uint64 frame)
+{
+	mCandidates.clear();
+
+	for(uint32 i = 0; i < (uint32)mTextures.size(); ++i)
+	{
+		TextureState& t = mTextures[i];
+
+		if(t.RequestedMip < t.NumMips)
+		{
+			t.LastUsedFrame = frame;
+			t.WantedFirstMip = std::min(t.RequestedMip, t.BaseFirstMip);
+		}
+		else
+		{
+			t.WantedFirstMip = t.BaseFirstMip;
+		}
+
+		if(!t.Pending && t.WantedFirstMip < t.ResidentFirstMip)
+			mCandidates.push_back(i);
+	}
+
+	// Biggest shortfall first, so a texture that is far too blurry is not starved by
+	// ones that are only missing their top mip.
+	std::stable_sort(mCandidates.begin(), mCandidates.end(), [this](uint32 a, uint32 b)
+	{
+		const TextureState& ta = mTextures[a];
+		const TextureState& tb = mTextures[b];
+		return ta.ResidentFirstMip - ta.WantedFirstMip > tb.ResidentFirstMip - tb.WantedFirstMip;
+	});
+
+	uint32 numIssued = 0;
+	for(uint32 i : mCandidates)
+	{
+		if(numIssued == mMaxRequestsPerUpdate)
+			break;
+
+		const TextureState& t = mTextures[i];
+
+		// One mip at a time, coarse to fine, keeps each load small and the texture
+		// sharpens progressively.
+		uint32 firstMip = t.ResidentFirstMip - 1;
+		uint64 extraBytes = Bytes(t, firstMip) - Bytes(t, t.ResidentFirstMip);
+
+		if(mCommittedBytes + extraBytes > mBudgetBytes &&
+		   !MakeRoom(mCommittedBytes + extraBytes - mBudgetBytes, i))
+		{
+			mStats.NumDeferred++;
+			continue;
+		}
+
+		Issue(i, firstMip);
+		mStats.NumLoads++;
+		numIssued++;
+	}
+
+	for(auto& t : mTextures)
+		t.RequestedMip = t.NumMips;
+}
+
+void MipStreamer::OnResidencyChanged(uint32 texture, uint32 firstMip)
+{
+	TextureState& t = mTextures[texture];
+
+	// The device may not be able to honour the request exactly.
+	if(firstMip != t.TargetFirstMip)
+	{
+		mCommittedBytes -= Bytes(t, t.TargetFirstMip);
+		mCommittedBytes += Bytes(t, firstMip);
+		t.TargetFirstMip = firstMip;
+	}
+
+	t.ResidentFirstMip = firstMip;
+	t.Pending = false;
+}
+
+MipStreamer::uint32 MipStreamer::ComputeRequestedMip(float texelsAcross, float pixelsAcross)
+{
+	if(!(pixelsAcross > 0.0f))
+		return ~0u;
+
+	float ratio = texelsAcross / pixelsAcross;
+	if(ratio <= 1.0f)
+		return 0;
+
+	return (uint32)std::floor(std::log2(ratio));
+}
+
+MipStreamer::uint32 MipStreamer::NumTextures()const
+{
+	return (uint32)mTextures.size();
+}
+
+MipStreamer::uint32 MipStreamer::NumMips(uint32 texture)const
+{
+	return mTextures[texture].NumMips;
+}
+
+MipStreamer::uint32 MipStreamer::ResidentFirstMip(uint32 texture)const
+{
+	return mTextures[texture].ResidentFirstMip;
+}
+
+bool MipStreamer::IsPending(uint32 texture)const
+{
+	return mTextures[texture].Pending;
+}
+
+MipStreamer::uint64 MipStreamer::CommittedBytes()const
+{
+	return mCommittedBytes;
+}
+
+MipStreamer::uint64 MipStreamer::BudgetBytes()const
+{
+	return mBudgetBytes;
+}
+
+void MipStreamer::SetBudgetBytes(uint64 budgetBytes)
+{
+	mBudgetBytes = budgetBytes;
+}
+
+const MipStreamer::Stats& MipStreamer::GetStats()const
+{
+	return mStats;
+}
+
+MipStreamer::uint64 MipStreamer::Bytes(const TextureState& t, uint32 firstMip)const
+{
+	return t.TailBytes[std::min(firstMip, t.NumMips)];
+}
+
+void MipStreamer::Issue(uint32 texture, uint32 firstMip)
+{
+	TextureState& t = mTextures[texture];
+
+	mCommittedBytes -= Bytes(t, t.TargetFirstMip);
+	mCommittedBytes += Bytes(t, firstMip);
+	t.TargetFirstMip = firstMip;
+	t.Pending = true;
+
+	// May call OnResidencyChanged right away.
+	mDevice->SetResidentMips(texture, firstMip);
+}
+
+bool MipStreamer::MakeRoom(uint64 bytes, uint32 exclude)
+{
+	struct Victim
+	{
+		uint32 Texture;
+		uint64 LastUsedFrame;
+		uint64 FreedBytes;
+	};
+
+	// Only detail beyond what was asked for this frame can go; the textures used
+	// least recently go first.
+	std::vector<Victim> victims;
+	for(uint32 i = 0; i < (uint32)mTextures.size(); ++i)
+	{
+		const TextureState& t = mTextures[i];
+		if(i == exclude || t.Pending || t.ResidentFirstMip >= t.WantedFirstMip)
+			continue;
+
+		victims.push_back({ i, t.LastUsedFrame, Bytes(t, t.ResidentFirstMip) - Bytes(t, t.WantedFirstMip) });
+	}
+
+	std::sort(victims.begin(), victims.end(), [](const Victim& a, const Victim& b)
+	{
+		if(a.LastUsedFrame != b.LastUsedFrame)
+			return a.LastUsedFrame < b.LastUsedFrame;
+		return a.FreedBytes > b.FreedBytes;
+	});
+
+	size_t count = 0;
+	uint64 freed = 0;
+	while(count < victims.size() && freed < bytes)
+		freed += victims[count++].FreedBytes;
+
+	// Do not throw detail away if it does not make enough room anyway.
+	if(freed < bytes)
+		return false;
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		Issue(victims[i].Texture, mTextures[victims[i].Texture].WantedFirstMip);
+		mStats.NumEvictions++;
+	}
+
+	return true;
+}
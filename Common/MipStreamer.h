@@ -0,0 +1,121 @@
+//***************************************************************************************
+// MipStreamer.h
+//
+// Decides which mips of a set of textures should be resident.  Textures start with
+// only their coarsest mips resident.  Each frame the client reports the finest mip
+// each texture needs (RequestMip), and Update() then:
+//
+//  - streams in one finer mip at a time for the textures whose request is not met,
+//    biggest shortfall first, at most MaxRequestsPerUpdate per call;
+//  - when that would exceed the memory budget, evicts the detail nobody asked for
+//    this frame from the least recently used textures first.
+//
+// The actual work is done by a Device, which the D3D12 side implements by
+// reallocating the texture (see TextureStreamingDevice.h) and a test can implement
+// by recording the calls.  The residency change of a texture is in flight until the
+// device calls OnResidencyChanged; no new change is issued for it in the meantime.
+//
+// Mip 0 is the finest mip.  "First mip" is the finest mip that is resident, so a
+// texture with first mip f has mips [f, NumMips) resident.
+//
+// The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class MipStreamer
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	class Device
+	{
+	public:
+		virtual ~Device() = default;
+
+		// Makes mips [firstMip, NumMips) of texture resident, loading or evicting
+		// as needed.  Must eventually be followed by OnResidencyChanged.
+		virtual void SetResidentMips(uint32 texture, uint32 firstMip) = 0;
+	};
+
+	struct Stats
+	{
+		uint32 NumLoads = 0;
+		uint32 NumEvictions = 0;
+		uint32 NumDeferred = 0; // loads skipped because the budget could not be met
+	};
+
+	MipStreamer(Device* device, uint64 budgetBytes, uint32 maxRequestsPerUpdate = 4);
+
+	// mipSizes holds the size in bytes of each mip (all array slices / faces),
+	// finest first.  The coarsest baseMips mips are resident from the start and are
+	// never evicted.  Returns the texture id used by the other calls, which must
+	// match the one the device uses.
+	uint32 AddTexture(const std::vector<uint64>& mipSizes, uint32 baseMips);
+
+	// Feedback for the current frame; the finest of the mips requested for a
+	// texture since the last Update wins.
+	void RequestMip(uint32 texture, uint32 mip);
+
+	// Issues the loads and evictions for this frame.  frame must increase.
+	void Update(uint64 frame);
+
+	// Called by the device when a SetResidentMips request has completed.
+	void OnResidencyChanged(uint32 texture, uint32 firstMip);
+
+	// Finest mip a texture needs to be drawn with pixelsAcross pixels covering
+	// texelsAcross texels of its top mip.
+	static uint32 ComputeRequestedMip(float texelsAcross, float pixelsAcross);
+
+	uint32 NumTextures()const;
+	uint32 NumMips(uint32 texture)const;
+	uint32 ResidentFirstMip(uint32 texture)const;
+	bool IsPending(uint32 texture)const;
+
+	// Bytes of all textures once the changes in flight complete.
+	uint64 CommittedBytes()const;
+	uint64 BudgetBytes()const;
+	void SetBudgetBytes(uint64 budgetBytes);
+
+	const Stats& GetStats()const;
+
+private:
+	struct TextureState
+	{
+		// Bytes of mips [i, NumMips), so the size of a resident range is one lookup.
+		std::vector<uint64> TailBytes;
+		uint32 NumMips = 0;
+		uint32 BaseFirstMip = 0;
+
+		uint32 ResidentFirstMip = 0;
+		uint32 TargetFirstMip = 0;
+		bool Pending = false;
+
+		// Finest mip requested since the last Update; NumMips when unused.
+		uint32 RequestedMip = 0;
+		uint32 WantedFirstMip = 0;
+		uint64 LastUsedFrame = 0;
+	};
+
+	uint64 Bytes(const TextureState& t, uint32 firstMip)const;
+	void Issue(uint32 texture, uint32 firstMip);
+	bool MakeRoom(uint64 bytes, uint32 exclude);
+
+private:
+	Device* mDevice = nullptr;
+	uint64 mBudgetBytes = 0;
+	uint32 mMaxRequestsPerUpdate = 0;
+
+	uint64 mCommittedBytes = 0;
+	std::vector<TextureState> mTextures;
+
+	Stats mStats;
+
+	// Scratch space reused by Update.
+	std::vector<uint32> mCandidates;
+};
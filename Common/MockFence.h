@@ -0,0 +1,82 @@
+//***************************************************************************************
+// MockFence.h
+//
+// Stand-in for a command queue and its fence, for exercising FramePacer (or any
+// other fence driven logic) without a device.  Signal() queues a fence value as if
+// the GPU would reach it after the work submitted so far; the test decides when the
+// "GPU" gets there with Complete()/CompleteNext().  A Wait() on a value that has not
+// been reached completes the queue up to it, the way a blocking CPU wait ends once the
+// GPU catches up, and is counted so a test can check when the CPU would have stalled.
+//
+// The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include "FramePacer.h"
+#include <cassert>
+#include <deque>
+
+class MockFence : public FramePacer::Fence
+{
+public:
+
+	using uint64 = FramePacer::uint64;
+
+	// Queues value; values must increase.
+	void Signal(uint64 value)
+	{
+		assert(mPending.empty() ? value > mCompleted : value > mPending.back());
+		mPending.push_back(value);
+	}
+
+	// The GPU finishes the oldest signal still pending.  Returns false if there is none.
+	bool CompleteNext()
+	{
+		if(mPending.empty())
+			return false;
+
+		mCompleted = mPending.front();
+		mPending.pop_front();
+		return true;
+	}
+
+	// The GPU finishes every signal up to value.
+	void Complete(uint64 value)
+	{
+		while(!mPending.empty() && mPending.front() <= value)
+			CompleteNext();
+	}
+
+	virtual uint64 GetCompletedValue()const override
+	{
+		return mCompleted;
+	}
+
+	virtual void Wait(uint64 value) override
+	{
+		if(mCompleted >= value)
+			return;
+
+		// Waiting for a value that was never signaled would hang on a real queue.
+		assert(!mPending.empty() && mPending.back() >= value);
+
+		mNumBlockingWaits++;
+		Complete(value);
+	}
+
+	std::size_t NumPending()const
+	{
+		return mPending.size();
+	}
+
+	uint64 NumBlockingWaits()const
+	{
+		return mNumBlockingWaits;
+	}
+
+private:
+	std::deque<uint64> mPending;
+	uint64 mCompleted = 0;
+	uint64 mNumBlockingWaits = 0;
+};
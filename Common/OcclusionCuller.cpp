@@ -0,0 +1,641 @@
+//***************************************************************************************
+// OcclusionCuller.cpp
+//***************************************************************************************
+
+#include "OcclusionCuller.h"
+#include <xmmintrin.h>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// Out = A*B for row-major 4x4 matrices.
+	void MultiplyMatrix(float* out, const XMFLOAT4X4& A, const XMFLOAT4X4& B)
+	{
+		for(int i = 0; i < 4; ++i)
+		{
+			for(int j = 0; j < 4; ++j)
+			{
+				out[i*4 + j] =
+					A.m[i][0]*B.m[0][j] +
+					A.m[i][1]*B.m[1][j] +
+					A.m[i][2]*B.m[2][j] +
+					A.m[i][3]*B.m[3][j];
+			}
+		}
+	}
+
+	bool IsPowerOfTwo(std::uint32_t x)
+	{
+		return x != 0 && (x & (x - 1)) == 0;
+	}
+}
+
+OcclusionCuller::OcclusionCuller(uint32 width, uint32 height) :
+	mWidth(width), mHeight(height)
+{
+	assert(IsPowerOfTwo(width) && IsPowerOfTwo(height) && width >= 4);
+
+	uint32 w = mWidth;
+	uint32 h = mHeight;
+	while(true)
+	{
+		mHiZ.push_back(std::vector<float>(w*h, 1.0f));
+
+		if(w == 1 && h == 1)
+			break;
+
+		w = std::max(w / 2, 1u);
+		h = std::max(h / 2, 1u);
+	}
+
+	mViewProj = XMFLOAT4X4(
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+OcclusionCuller::uint32 OcclusionCuller::Width()const
+{
+	return mWidth;
+}
+
+OcclusionCuller::uint32 OcclusionCuller::Height()const
+{
+	return mHeight;
+}
+
+OcclusionCuller::uint32 OcclusionCuller::MipCount()const
+{
+	return (uint32)mHiZ.size();
+}
+
+void OcclusionCuller::BeginFrame(const XMFLOAT4X4& viewProj)
+{
+	mViewProj = viewProj;
+
+	// Clear to the far plane.
+	std::fill(mHiZ[0].begin(), mHiZ[0].end(), 1.0f);
+
+	mNumOccluderTriangles = 0;
+	mNumTested = 0;
+	mNumOccluded = 0;
+}
+
+void OcclusionCuller::RasterizeOccluder(
+	const XMFLOAT3* vertices, uint32 vertexStride,
+	const uint32* indices, uint32 indexCount,
+	const XMFLOAT4X4& world)
+{
+	float worldViewProj[16];
+	MultiplyMatrix(worldViewProj, world, mViewProj);
+
+	const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(vertices);
+
+	for(uint32 i = 0; i + 2 < indexCount; i += 3)
+	{
+		const XMFLOAT3& p0 = *reinterpret_cast<const XMFLOAT3*>(base + indices[i + 0]*vertexStride);
+		const XMFLOAT3& p1 = *reinterpret_cast<const XMFLOAT3*>(base + indices[i + 1]*vertexStride);
+		const XMFLOAT3& p2 = *reinterpret_cast<const XMFLOAT3*>(base + indices[i + 2]*vertexStride);
+
+		RasterizeTriangle(
+			TransformToScreen(p0, worldViewProj),
+			TransformToScreen(p1, worldViewProj),
+			TransformToScreen(p2, worldViewProj));
+	}
+}
+
+bool OcclusionCuller::ComputeInteriorBox(
+	const XMFLOAT3* vertices, uint32 vertexStride, uint32 vertexCount,
+	const uint32* indices, uint32 indexCount,
+	XMFLOAT3& center, XMFLOAT3& extents,
+	uint32 resolution)
+{
+	const int n = (int)resolution;
+	if(n <= 0 || vertexCount == 0 || indexCount < 3)
+		return false;
+
+	const std::uint8_t* base = reinterpret_cast<const std::uint8_t*>(vertices);
+	auto position = [&](uint32 index) -> const float*
+	{
+		return &reinterpret_cast<const XMFLOAT3*>(base + index*vertexStride)->x;
+	};
+
+	float boundsMin[3] = { +FLT_MAX, +FLT_MAX, +FLT_MAX };
+	float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	for(uint32 i = 0; i < vertexCount; ++i)
+	{
+		const float* p = position(i);
+		for(int a = 0; a < 3; ++a)
+		{
+			boundsMin[a] = std::min(boundsMin[a], p[a]);
+			boundsMax[a] = std::max(boundsMax[a], p[a]);
+		}
+	}
+
+	float cellSize[3];
+	for(int a = 0; a < 3; ++a)
+	{
+		cellSize[a] = (boundsMax[a] - boundsMin[a]) / n;
+		if(!(cellSize[a] > 0.0f))
+			return false;
+	}
+
+	auto cellIndex = [&](int a, float x)
+	{
+		return std::min(std::max((int)std::floor((x - boundsMin[a]) / cellSize[a]), 0), n - 1);
+	};
+
+	// Any point of a cell the surface does not cross is as inside as its center.  The
+	// sample points are moved off the centers so that the lines through them do not
+	// run along the edges of axis-aligned triangles, which would count twice.
+	const float sampleOffset[3] = { 0.5123f, 0.5347f, 0.4791f };
+	auto samplePoint = [&](int a, int i)
+	{
+		return boundsMin[a] + (i + sampleOffset[a])*cellSize[a];
+	};
+	auto cell = [&](int x, int y, int z)
+	{
+		return (z*n + y)*n + x;
+	};
+
+	// A cell no triangle's bounding box touches is not crossed by the surface.
+	std::vector<std::uint8_t> touched(n*n*n, 0);
+	for(uint32 t = 0; t + 2 < indexCount; t += 3)
+	{
+		const float* p[3] = { position(indices[t]), position(indices[t + 1]), position(indices[t + 2]) };
+
+		int lo[3], hi[3];
+		for(int a = 0; a < 3; ++a)
+		{
+			float margin = 1e-3f*cellSize[a];
+			lo[a] = cellIndex(a, std::min(p[0][a], std::min(p[1][a], p[2][a])) - margin);
+			hi[a] = cellIndex(a, std::max(p[0][a], std::max(p[1][a], p[2][a])) + margin);
+		}
+
+		for(int z = lo[2]; z <= hi[2]; ++z)
+			for(int y = lo[1]; y <= hi[1]; ++y)
+				for(int x = lo[0]; x <= hi[0]; ++x)
+					touched[cell(x, y, z)] = 1;
+	}
+
+	// A cell is inside if the line through its sample point along each axis crosses
+	// the surface an odd number of times before reaching it.  Requiring all three axes
+	// to agree keeps small holes in the mesh from marking outside cells solid.
+	std::vector<std::uint8_t> insideCount(n*n*n, 0);
+	for(int a = 0; a < 3; ++a)
+	{
+		const int b = (a + 1) % 3;
+		const int c = (a + 2) % 3;
+
+		// Crossings of the line through the sample points of row (i, j) of cells along a.
+		std::vector<std::vector<float>> crossings(n*n);
+		for(uint32 t = 0; t + 2 < indexCount; t += 3)
+		{
+			const float* p0 = position(indices[t]);
+			const float* p1 = position(indices[t + 1]);
+			const float* p2 = position(indices[t + 2]);
+
+			float area = (p1[b] - p0[b])*(p2[c] - p0[c]) - (p2[b] - p0[b])*(p1[c] - p0[c]);
+			if(std::fabs(area) < 1e-12f)
+				continue;
+
+			int i0 = cellIndex(b, std::min(p0[b], std::min(p1[b], p2[b])));
+			int i1 = cellIndex(b, std::max(p0[b], std::max(p1[b], p2[b])));
+			int j0 = cellIndex(c, std::min(p0[c], std::min(p1[c], p2[c])));
+			int j1 = cellIndex(c, std::max(p0[c], std::max(p1[c], p2[c])));
+
+			for(int j = j0; j <= j1; ++j)
+			{
+				float pc = samplePoint(c, j);
+				for(int i = i0; i <= i1; ++i)
+				{
+					float pb = samplePoint(b, i);
+
+					// Barycentric coordinates of the line in the projected triangle.
+					float w1 = ((pb - p0[b])*(p2[c] - p0[c]) - (p2[b] - p0[b])*(pc - p0[c])) / area;
+					float w2 = ((p1[b] - p0[b])*(pc - p0[c]) - (pb - p0[b])*(p1[c] - p0[c])) / area;
+					float w0 = 1.0f - w1 - w2;
+					if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+						continue;
+
+					crossings[j*n + i].push_back(w0*p0[a] + w1*p1[a] + w2*p2[a]);
+				}
+			}
+		}
+
+		for(int j = 0; j < n; ++j)
+		{
+			for(int i = 0; i < n; ++i)
+			{
+				std::vector<float>& row = crossings[j*n + i];
+				std::sort(row.begin(), row.end());
+
+				size_t numBefore = 0;
+				for(int k = 0; k < n; ++k)
+				{
+					float pa = samplePoint(a, k);
+					while(numBefore < row.size() && row[numBefore] < pa)
+						numBefore++;
+
+					if(numBefore % 2 == 1)
+					{
+						int coords[3];
+						coords[a] = k;
+						coords[b] = i;
+						coords[c] = j;
+						insideCount[cell(coords[0], coords[1], coords[2])]++;
+					}
+				}
+			}
+		}
+	}
+
+	// Per z slice prefix sums of the solid cells, so any rectangle can be checked
+	// in constant time.
+	const int stride = n + 1;
+	std::vector<int> prefix(n*stride*stride, 0);
+	for(int z = 0; z < n; ++z)
+	{
+		int* slice = &prefix[z*stride*stride];
+		for(int y = 0; y < n; ++y)
+		{
+			for(int x = 0; x < n; ++x)
+			{
+				int solid = (!touched[cell(x, y, z)] && insideCount[cell(x, y, z)] == 3) ? 1 : 0;
+				slice[(y + 1)*stride + x + 1] = solid +
+					slice[y*stride + x + 1] + slice[(y + 1)*stride + x] - slice[y*stride + x];
+			}
+		}
+	}
+
+	// Largest box of solid cells: for every rectangle, the longest run of slices in
+	// which the rectangle is solid.
+	int best = 0;
+	int bestLo[3] = { 0, 0, 0 };
+	int bestHi[3] = { 0, 0, 0 };
+	for(int y0 = 0; y0 < n; ++y0)
+	{
+		for(int y1 = y0; y1 < n; ++y1)
+		{
+			for(int x0 = 0; x0 < n; ++x0)
+			{
+				for(int x1 = x0; x1 < n; ++x1)
+				{
+					const int rectArea = (x1 - x0 + 1)*(y1 - y0 + 1);
+					if(rectArea*n <= best)
+						continue;
+
+					int runStart = 0;
+					for(int z = 0; z <= n; ++z)
+					{
+						bool solid = false;
+						if(z < n)
+						{
+							const int* slice = &prefix[z*stride*stride];
+							int sum = slice[(y1 + 1)*stride + x1 + 1] - slice[y0*stride + x1 + 1] -
+								slice[(y1 + 1)*stride + x0] + slice[y0*stride + x0];
+							solid = sum == rectArea;
+						}
+
+						if(solid)
+							continue;
+
+						int volume = rectArea*(z - runStart);
+						if(volume > best)
+						{
+							best = volume;
+							bestLo[0] = x0; bestLo[1] = y0; bestLo[2] = runStart;
+							bestHi[0] = x1; bestHi[1] = y1; bestHi[2] = z - 1;
+						}
+						runStart = z + 1;
+					}
+				}
+			}
+		}
+	}
+
+	if(best == 0)
+		return false;
+
+	float boxMin[3], boxMax[3];
+	for(int a = 0; a < 3; ++a)
+	{
+		boxMin[a] = boundsMin[a] + bestLo[a]*cellSize[a];
+		boxMax[a] = boundsMin[a] + (bestHi[a] + 1)*cellSize[a];
+	}
+
+	center = XMFLOAT3(0.5f*(boxMin[0] + boxMax[0]), 0.5f*(boxMin[1] + boxMax[1]), 0.5f*(boxMin[2] + boxMax[2]));
+	extents = XMFLOAT3(0.5f*(boxMax[0] - boxMin[0]), 0.5f*(boxMax[1] - boxMin[1]), 0.5f*(boxMax[2] - boxMin[2]));
+	return true;
+}
+
+void OcclusionCuller::RasterizeOccluderBox(
+	const XMFLOAT3& center,
+	const XMFLOAT3& extents,
+	const XMFLOAT4X4& world)
+{
+	XMFLOAT3 corners[8];
+	for(int i = 0; i < 8; ++i)
+	{
+		corners[i].x = center.x + ((i & 1) ? extents.x : -extents.x);
+		corners[i].y = center.y + ((i & 2) ? extents.y : -extents.y);
+		corners[i].z = center.z + ((i & 4) ? extents.z : -extents.z);
+	}
+
+	// The rasterizer is winding agnostic, so the triangle orientation does not matter.
+	static const uint32 indices[36] =
+	{
+		0, 1, 3,  0, 3, 2, // -z
+		4, 6, 7,  4, 7, 5, // +z
+		0, 4, 5,  0, 5, 1, // -y
+		2, 3, 7,  2, 7, 6, // +y
+		0, 2, 6,  0, 6, 4, // -x
+		1, 5, 7,  1, 7, 3  // +x
+	};
+
+	RasterizeOccluder(corners, sizeof(XMFLOAT3), indices, 36, world);
+}
+
+OcclusionCuller::ScreenVertex OcclusionCuller::TransformToScreen(const XMFLOAT3& p, const float* M)const
+{
+	float x = p.x*M[0] + p.y*M[4] + p.z*M[8]  + M[12];
+	float y = p.x*M[1] + p.y*M[5] + p.z*M[9]  + M[13];
+	float z = p.x*M[2] + p.y*M[6] + p.z*M[10] + M[14];
+	float w = p.x*M[3] + p.y*M[7] + p.z*M[11] + M[15];
+
+	ScreenVertex v;
+
+	// We do not clip against the near plane; such triangles are simply dropped, which
+	// only makes the occluder set smaller and therefore stays conservative.
+	v.Valid = w > 1e-5f && z >= 0.0f;
+	if(!v.Valid)
+	{
+		v.X = v.Y = v.Z = 0.0f;
+		return v;
+	}
+
+	float invW = 1.0f / w;
+
+	// NDC to screen space, with y pointing down.
+	v.X = (+x*invW*0.5f + 0.5f)*mWidth;
+	v.Y = (-y*invW*0.5f + 0.5f)*mHeight;
+	v.Z = std::min(z*invW, 1.0f);
+
+	return v;
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1In, const ScreenVertex& v2In)
+{
+	if(!v0.Valid || !v1In.Valid || !v2In.Valid)
+		return;
+
+	// Make the triangle counterclockwise in screen space so the edge functions are
+	// positive inside.
+	const ScreenVertex* pv1 = &v1In;
+	const ScreenVertex* pv2 = &v2In;
+
+	float area = (pv1->X - v0.X)*(pv2->Y - v0.Y) - (pv2->X - v0.X)*(pv1->Y - v0.Y);
+	if(area < 0.0f)
+	{
+		std::swap(pv1, pv2);
+		area = -area;
+	}
+
+	// Degenerate or smaller than a pixel fraction.
+	if(area < 1e-4f)
+		return;
+
+	const ScreenVertex& v1 = *pv1;
+	const ScreenVertex& v2 = *pv2;
+
+	// Screen space bounding box clamped to the depth buffer.
+	int minX = std::max((int)std::floor(std::min(v0.X, std::min(v1.X, v2.X))), 0);
+	int maxX = std::min((int)std::ceil(std::max(v0.X, std::max(v1.X, v2.X))), (int)mWidth - 1);
+	int minY = std::max((int)std::floor(std::min(v0.Y, std::min(v1.Y, v2.Y))), 0);
+	int maxY = std::min((int)std::ceil(std::max(v0.Y, std::max(v1.Y, v2.Y))), (int)mHeight - 1);
+
+	if(minX > maxX || minY > maxY)
+		return;
+
+	mNumOccluderTriangles++;
+
+	// Process 4 pixels at a time, so start at a multiple of 4.  The width is a
+	// multiple of 4, so we never write past the end of a row.
+	minX &= ~3;
+
+	// Edge function E_ab(p) = A*p.x + B*p.y + C, positive on the left of a->b.
+	auto edgeA = [](const ScreenVertex& a, const ScreenVertex& b) { return a.Y - b.Y; };
+	auto edgeB = [](const ScreenVertex& a, const ScreenVertex& b) { return b.X - a.X; };
+
+	float A0 = edgeA(v1, v2), B0 = edgeB(v1, v2), C0 = -(A0*v1.X + B0*v1.Y);
+	float A1 = edgeA(v2, v0), B1 = edgeB(v2, v0), C1 = -(A1*v2.X + B1*v2.Y);
+	float A2 = edgeA(v0, v1), B2 = edgeB(v0, v1), C2 = -(A2*v0.X + B2*v0.Y);
+
+	// Depth is linear in screen space:  z = z0 + (z1-z0)*E1/area + (z2-z0)*E2/area.
+	float invArea = 1.0f / area;
+	float dz1 = (v1.Z - v0.Z)*invArea;
+	float dz2 = (v2.Z - v0.Z)*invArea;
+	float zA = dz1*A1 + dz2*A2;
+	float zB = dz1*B1 + dz2*B2;
+	float zC = v0.Z + dz1*C1 + dz2*C2;
+
+	const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	__m128 a0 = _mm_set1_ps(A0);
+	__m128 a1 = _mm_set1_ps(A1);
+	__m128 a2 = _mm_set1_ps(A2);
+	__m128 za = _mm_set1_ps(zA);
+
+	float* depth = mHiZ[0].data();
+
+	for(int y = minY; y <= maxY; ++y)
+	{
+		float py = (float)y + 0.5f;
+
+		__m128 rowE0 = _mm_set1_ps(B0*py + C0);
+		__m128 rowE1 = _mm_set1_ps(B1*py + C1);
+		__m128 rowE2 = _mm_set1_ps(B2*py + C2);
+		__m128 rowZ  = _mm_set1_ps(zB*py + zC);
+
+		float* row = depth + y*mWidth;
+
+		for(int x = minX; x <= maxX; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), pixelOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), rowE0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), rowE1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), rowE2);
+
+			__m128 inside = _mm_and_ps(
+				_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+				_mm_cmpge_ps(e2, zero));
+
+			if(_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 z = _mm_add_ps(_mm_mul_ps(za, px), rowZ);
+
+			__m128 oldDepth = _mm_loadu_ps(row + x);
+			__m128 newDepth = _mm_min_ps(oldDepth, z);
+
+			_mm_storeu_ps(row + x, _mm_or_ps(
+				_mm_and_ps(inside, newDepth),
+				_mm_andnot_ps(inside, oldDepth)));
+		}
+	}
+}
+
+void OcclusionCuller::BuildHiZ()
+{
+	uint32 srcWidth = mWidth;
+	uint32 srcHeight = mHeight;
+
+	for(size_t level = 1; level < mHiZ.size(); ++level)
+	{
+		uint32 dstWidth = std::max(srcWidth / 2, 1u);
+		uint32 dstHeight = std::max(srcHeight / 2, 1u);
+
+		const float* src = mHiZ[level - 1].data();
+		float* dst = mHiZ[level].data();
+
+		for(uint32 y = 0; y < dstHeight; ++y)
+		{
+			// Handles the case where one dimension already reached 1.
+			const float* row0 = src + std::min(2*y, srcHeight - 1)*srcWidth;
+			const float* row1 = src + std::min(2*y + 1, srcHeight - 1)*srcWidth;
+
+			uint32 x = 0;
+
+			// Take the max of 2x2 blocks, producing 4 texels per iteration.
+			if(srcWidth >= 8)
+			{
+				for(; x + 4 <= dstWidth; x += 4)
+				{
+					__m128 m0 = _mm_max_ps(_mm_loadu_ps(row0 + 2*x), _mm_loadu_ps(row1 + 2*x));
+					__m128 m1 = _mm_max_ps(_mm_loadu_ps(row0 + 2*x + 4), _mm_loadu_ps(row1 + 2*x + 4));
+
+					__m128 even = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(2, 0, 2, 0));
+					__m128 odd  = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(3, 1, 3, 1));
+
+					_mm_storeu_ps(dst + y*dstWidth + x, _mm_max_ps(even, odd));
+				}
+			}
+
+			for(; x < dstWidth; ++x)
+			{
+				uint32 x0 = std::min(2*x, srcWidth - 1);
+				uint32 x1 = std::min(2*x + 1, srcWidth - 1);
+
+				dst[y*dstWidth + x] = std::max(
+					std::max(row0[x0], row0[x1]),
+					std::max(row1[x0], row1[x1]));
+			}
+		}
+
+		srcWidth = dstWidth;
+		srcHeight = dstHeight;
+	}
+}
+
+bool OcclusionCuller::IsVisible(
+	const XMFLOAT3& center,
+	const XMFLOAT3& extents,
+	const XMFLOAT4X4& world)const
+{
+	mNumTested++;
+
+	float worldViewProj[16];
+	MultiplyMatrix(worldViewProj, world, mViewProj);
+
+	float minX = +FLT_MAX, minY = +FLT_MAX, minZ = +FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+	for(int i = 0; i < 8; ++i)
+	{
+		XMFLOAT3 corner;
+		corner.x = center.x + ((i & 1) ? extents.x : -extents.x);
+		corner.y = center.y + ((i & 2) ? extents.y : -extents.y);
+		corner.z = center.z + ((i & 4) ? extents.z : -extents.z);
+
+		ScreenVertex v = TransformToScreen(corner, worldViewProj);
+
+		// The box straddles the near plane, so assume it is visible.
+		if(!v.Valid)
+			return true;
+
+		minX = std::min(minX, v.X);
+		maxX = std::max(maxX, v.X);
+		minY = std::min(minY, v.Y);
+		maxY = std::max(maxY, v.Y);
+		minZ = std::min(minZ, v.Z);
+	}
+
+	// Off screen boxes are the business of frustum culling.
+	if(maxX < 0.0f || maxY < 0.0f || minX >= (float)mWidth || minY >= (float)mHeight)
+		return true;
+
+	int x0 = std::max((int)minX, 0);
+	int y0 = std::max((int)minY, 0);
+	int x1 = std::min((int)maxX, (int)mWidth - 1);
+	int y1 = std::min((int)maxY, (int)mHeight - 1);
+
+	// Pick the level at which the box covers at most 2x2 texels.
+	uint32 level = 0;
+	int span = std::max(x1 - x0, y1 - y0);
+	while(span > 1 && level + 1 < (uint32)mHiZ.size())
+	{
+		span >>= 1;
+		level++;
+	}
+
+	uint32 levelWidth = std::max(mWidth >> level, 1u);
+	uint32 levelHeight = std::max(mHeight >> level, 1u);
+
+	x0 = std::min(x0 >> level, (int)levelWidth - 1);
+	x1 = std::min(x1 >> level, (int)levelWidth - 1);
+	y0 = std::min(y0 >> level, (int)levelHeight - 1);
+	y1 = std::min(y1 >> level, (int)levelHeight - 1);
+
+	// Farthest occluder depth over the box footprint.
+	const float* depth = mHiZ[level].data();
+	float maxDepth = 0.0f;
+	for(int y = y0; y <= y1; ++y)
+	{
+		for(int x = x0; x <= x1; ++x)
+			maxDepth = std::max(maxDepth, depth[y*levelWidth + x]);
+	}
+
+	if(minZ <= maxDepth)
+		return true;
+
+	mNumOccluded++;
+	return false;
+}
+
+const float* OcclusionCuller::Depth(uint32 mip)const
+{
+	return mHiZ[mip].data();
+}
+
+OcclusionCuller::uint32 OcclusionCuller::NumOccluderTriangles()const
+{
+	return mNumOccluderTriangles;
+}
+
+OcclusionCuller::uint32 OcclusionCuller::NumTested()const
+{
+	return mNumTested;
+}
+
+OcclusionCuller::uint32 OcclusionCuller::NumOccluded()const
+{
+	return mNumOccluded;
+}
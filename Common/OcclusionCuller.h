@@ -0,0 +1,107 @@
+//***************************************************************************************
+// OcclusionCuller.h
+//
+// CPU hierarchical-Z occlusion culling.  A low resolution software depth rasterizer
+// draws a set of occluders (meshes or boxes) into a small depth buffer, a max-depth
+// pyramid (hi-Z) is built from it, and axis-aligned bounding boxes are then tested
+// against the pyramid before the objects are submitted for drawing.
+//
+// The class has no Direct3D dependencies; it only uses DirectXMath storage types and
+// SSE intrinsics so that it can run headless.
+//
+// Conventions match the demos: row vectors (v*M), Direct3D clip space with depth in
+// [0, 1] and smaller depth values closer to the eye.  Occluders must be conservative,
+// that is, they must lie inside the object they stand in for.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXMath.h>
+#include <vector>
+
+class OcclusionCuller
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	// Width and height must be powers of two, and the width at least 4.
+	OcclusionCuller(uint32 width = 256, uint32 height = 128);
+	OcclusionCuller(const OcclusionCuller& rhs) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller& rhs) = delete;
+	~OcclusionCuller() = default;
+
+	uint32 Width()const;
+	uint32 Height()const;
+	uint32 MipCount()const;
+
+	// Clears the depth buffer to the far plane and sets the view-projection matrix
+	// used for the rest of the frame.
+	void BeginFrame(const DirectX::XMFLOAT4X4& viewProj);
+
+	// Rasterizes an indexed triangle list, given in local space, into the depth buffer.
+	void RasterizeOccluder(
+		const DirectX::XMFLOAT3* vertices, uint32 vertexStride,
+		const uint32* indices, uint32 indexCount,
+		const DirectX::XMFLOAT4X4& world);
+
+	// Finds a box that lies inside a closed triangle mesh, for use as its occluder.
+	// The mesh bounds are split into resolution^3 cells; a cell is solid if no
+	// triangle's bounding box touches it and a point in it is inside the mesh along all
+	// three axes.  Returns the largest box of solid cells, or false if there is none.
+	static bool ComputeInteriorBox(
+		const DirectX::XMFLOAT3* vertices, uint32 vertexStride, uint32 vertexCount,
+		const uint32* indices, uint32 indexCount,
+		DirectX::XMFLOAT3& center, DirectX::XMFLOAT3& extents,
+		uint32 resolution = 32);
+
+	// Rasterizes the 12 triangles of a local space box into the depth buffer.
+	void RasterizeOccluderBox(
+		const DirectX::XMFLOAT3& center,
+		const DirectX::XMFLOAT3& extents,
+		const DirectX::XMFLOAT4X4& world);
+
+	// Builds the max-depth pyramid from the depth buffer.  Call after all the
+	// occluders were rasterized and before testing.
+	void BuildHiZ();
+
+	// Returns false if the local space box is provably hidden behind the occluders.
+	bool IsVisible(
+		const DirectX::XMFLOAT3& center,
+		const DirectX::XMFLOAT3& extents,
+		const DirectX::XMFLOAT4X4& world)const;
+
+	// Depth values of the given mip level, row-major, (Width()>>mip) texels per row.
+	const float* Depth(uint32 mip = 0)const;
+
+	// Statistics since the last BeginFrame.
+	uint32 NumOccluderTriangles()const;
+	uint32 NumTested()const;
+	uint32 NumOccluded()const;
+
+private:
+	struct ScreenVertex
+	{
+		float X;
+		float Y;
+		float Z;
+		bool Valid;
+	};
+
+	ScreenVertex TransformToScreen(const DirectX::XMFLOAT3& p, const float* worldViewProj)const;
+	void RasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2);
+
+private:
+	uint32 mWidth = 0;
+	uint32 mHeight = 0;
+
+	DirectX::XMFLOAT4X4 mViewProj;
+
+	// mHiZ[0] is the full resolution depth buffer.
+	std::vector<std::vector<float>> mHiZ;
+
+	uint32 mNumOccluderTriangles = 0;
+	mutable uint32 mNumTested = 0;
+	mutable uint32 mNumOccluded = 0;
+};
@@ -0,0 +1,172 @@
+//***************************************************************************************
+// ParallelRecorder.cpp
+//***************************************************************************************
+
+#include "ParallelRecorder.h"
+#include <stdexcept>
+
+ParallelRecorder::ParallelRecorder(uint32 numThreads)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0)
+		numThreads = 1;
+
+	mThreads.reserve(numThreads);
+	for(uint32 i = 0; i < numThreads; ++i)
+		mThreads.emplace_back(&ParallelRecorder::WorkerMain, this, i);
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWorkReady.notify_all();
+
+	for(auto& t : mThreads)
+		t.join();
+}
+
+ParallelRecorder::PassId ParallelRecorder::AddPass(const std::string& name, RecordFunc record)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	PassId id = (PassId)mPasses.size();
+	mPasses.push_back({ name, std::move(record), {} });
+	mOrder.push_back(id);
+	return id;
+}
+
+void ParallelRecorder::AddDependency(PassId pass, PassId dependsOn)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	if(pass >= mPasses.size() || dependsOn >= mPasses.size())
+		throw std::out_of_range("ParallelRecorder: unknown pass");
+
+	mPasses[pass].DependsOn.push_back(dependsOn);
+	if(!SortPasses())
+	{
+		mPasses[pass].DependsOn.pop_back();
+		SortPasses();
+		throw std::logic_error("ParallelRecorder: " + mPasses[pass].Name + " and " +
+			mPasses[dependsOn].Name + " depend on each other");
+	}
+}
+
+const std::vector<ParallelRecorder::PassId>& ParallelRecorder::Record()
+{
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		mRecording = true;
+		mNextPass = 0;
+		mNumDone = 0;
+		mWorkReady.notify_all();
+
+		mWorkDone.wait(lock, [this]() { return mNumDone == (uint32)mOrder.size(); });
+		mRecording = false;
+
+		error = mError;
+		mError = nullptr;
+	}
+
+	if(error)
+		std::rethrow_exception(error);
+
+	return mOrder;
+}
+
+const std::vector<ParallelRecorder::PassId>& ParallelRecorder::SubmissionOrder()const
+{
+	return mOrder;
+}
+
+const std::string& ParallelRecorder::PassName(PassId pass)const
+{
+	return mPasses[pass].Name;
+}
+
+ParallelRecorder::uint32 ParallelRecorder::NumPasses()const
+{
+	return (uint32)mPasses.size();
+}
+
+ParallelRecorder::uint32 ParallelRecorder::NumThreads()const
+{
+	return (uint32)mThreads.size();
+}
+
+bool ParallelRecorder::SortPasses()
+{
+	// Kahn's algorithm, always taking the earliest added pass that is ready so the
+	// order only changes where a dependency requires it.
+	std::vector<uint32> numPending(mPasses.size(), 0);
+	std::vector<std::vector<PassId>> dependents(mPasses.size());
+	for(PassId i = 0; i < (PassId)mPasses.size(); ++i)
+	{
+		for(PassId dep : mPasses[i].DependsOn)
+		{
+			numPending[i]++;
+			dependents[dep].push_back(i);
+		}
+	}
+
+	std::vector<bool> emitted(mPasses.size(), false);
+	std::vector<PassId> order;
+	order.reserve(mPasses.size());
+	while(order.size() < mPasses.size())
+	{
+		PassId next = 0;
+		while(next < (PassId)mPasses.size() && (emitted[next] || numPending[next] != 0))
+			++next;
+
+		if(next == (PassId)mPasses.size())
+			return false;
+
+		emitted[next] = true;
+		order.push_back(next);
+		for(PassId dependent : dependents[next])
+			numPending[dependent]--;
+	}
+
+	mOrder = order;
+	return true;
+}
+
+void ParallelRecorder::WorkerMain(uint32 thread)
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	for(;;)
+	{
+		mWorkReady.wait(lock, [this]() { return mQuit || (mRecording && mNextPass < mOrder.size()); });
+		if(mQuit)
+			return;
+
+		// Passes are taken in submission order, so the first lists are ready first.
+		PassId pass = mOrder[mNextPass++];
+
+		RecordFunc& record = mPasses[pass].Record;
+		lock.unlock();
+
+		std::exception_ptr error;
+		try
+		{
+			record(thread);
+		}
+		catch(...)
+		{
+			error = std::current_exception();
+		}
+
+		lock.lock();
+		if(error && !mError)
+			mError = error;
+
+		if(++mNumDone == mOrder.size())
+			mWorkDone.notify_all();
+	}
+}
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// ParallelRecorder.h
+//
+// Records the passes of a frame (shadow map, normals and depth, SSAO, main pass, ...)
+// on a pool of worker threads, each into its own command list, and returns the order
+// the lists must be submitted in:
+//
+//   ParallelRecorder recorder;
+//   auto shadow = recorder.AddPass("shadow", [&](UINT thread) { ... record mPassCmdLists[0] ... });
+//   auto ssao = recorder.AddPass("ssao", [&](UINT thread) { ... });
+//   auto main = recorder.AddPass("main", [&](UINT thread) { ... });
+//   recorder.AddDependency(main, shadow);
+//   recorder.AddDependency(main, ssao);
+//   ...
+//   // every frame
+//   for(PassId pass : recorder.Record())
+//       lists.push_back(mPassCmdLists[pass].Get());
+//   mCommandQueue->ExecuteCommandLists((UINT)lists.size(), lists.data());
+//
+// Recording order does not matter to the GPU, only submission order does, so every
+// pass is recorded as soon as a thread is free.  The thread index passed to a pass
+// selects per thread state, e.g. the command allocator of that thread in the current
+// frame resource: a thread records one list at a time, so its allocator is never used
+// by two lists at once.
+//
+// Passes are set up once and recorded every frame.  The class has no Direct3D
+// dependencies, so the scheduling can be exercised with fake command lists.
+//***************************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ParallelRecorder
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	typedef uint32 PassId;
+	typedef std::function<void(uint32 thread)> RecordFunc;
+
+	// numThreads == 0 uses one thread per hardware thread.
+	explicit ParallelRecorder(uint32 numThreads = 0);
+	ParallelRecorder(const ParallelRecorder& rhs) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder& rhs) = delete;
+	~ParallelRecorder();
+
+	// Pass ids are consecutive, starting at 0, so they can index an array of
+	// command lists.
+	PassId AddPass(const std::string& name, RecordFunc record);
+
+	// pass is submitted after dependsOn.  Throws std::logic_error on a cycle.
+	void AddDependency(PassId pass, PassId dependsOn);
+
+	// Records every pass and blocks until they are done.  Returns the passes in
+	// submission order: dependencies first, otherwise in the order they were added.
+	// Rethrows the first error a pass threw, after the other passes finished.
+	const std::vector<PassId>& Record();
+
+	const std::vector<PassId>& SubmissionOrder()const;
+
+	const std::string& PassName(PassId pass)const;
+	uint32 NumPasses()const;
+	uint32 NumThreads()const;
+
+private:
+	struct Pass
+	{
+		std::string Name;
+		RecordFunc Record;
+		std::vector<PassId> DependsOn;
+	};
+
+	// Returns false if the dependencies have a cycle.
+	bool SortPasses();
+
+	void WorkerMain(uint32 thread);
+
+private:
+	std::vector<Pass> mPasses;
+	std::vector<PassId> mOrder;
+
+	std::vector<std::thread> mThreads;
+
+	std::mutex mMutex;
+	std::condition_variable mWorkReady;
+	std::condition_variable mWorkDone;
+
+	// Set while Record runs; workers take passes from mOrder in turn.
+	bool mRecording = false;
+	uint32 mNextPass = 0;
+	uint32 mNumDone = 0;
+	bool mQuit = false;
+
+	std::exception_ptr mError;
+};
@@ -0,0 +1,130 @@
+//***************************************************************************************
+// PipelineStateCache.cpp
+//***************************************************************************************
+
+#include "PipelineStateCache.h"
+
+using Microsoft::WRL::ComPtr;
+
+PipelineStateCache::PipelineStateCache(ID3D12Device* device, const std::wstring& filename) :
+	mDevice(device),
+	mFilename(filename)
+{
+	if(!mFilename.empty())
+		Load();
+}
+
+void PipelineStateCache::RegisterRootSignature(ID3D12RootSignature* rootSignature, ID3DBlob* serialized)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	mRootSignatureKeys[rootSignature] = PipelineStateHash::Bytes(serialized->GetBufferPointer(),
+		serialized->GetBufferSize(), PipelineStateHash::Seed);
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::GetGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+	bool persistent = false;
+	uint64 key = PipelineStateHash::Graphics(desc, RootSignatureKey(desc.pRootSignature, persistent));
+
+	return Get(key, persistent, desc, [this](const D3D12_GRAPHICS_PIPELINE_STATE_DESC& d, ComPtr<ID3D12PipelineState>& pso)
+	{
+		return mDevice->CreateGraphicsPipelineState(&d, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+	});
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::GetCompute(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc)
+{
+	bool persistent = false;
+	uint64 key = PipelineStateHash::Compute(desc, RootSignatureKey(desc.pRootSignature, persistent));
+
+	return Get(key, persistent, desc, [this](const D3D12_COMPUTE_PIPELINE_STATE_DESC& d, ComPtr<ID3D12PipelineState>& pso)
+	{
+		return mDevice->CreateComputePipelineState(&d, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+	});
+}
+
+void PipelineStateCache::Save()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(mFilename.empty() || !mTable.IsDirty())
+		return;
+
+	// Write a new file and swap it in, so a crash never leaves a truncated cache.
+	std::wstring tempFilename = mFilename + L".tmp";
+	uint64 version = 0;
+	bool written = false;
+	{
+		std::ofstream fout(tempFilename, std::ios::binary);
+		written = mTable.Write(fout, version);
+		fout.close();
+		written = written && !fout.fail();
+	}
+
+	if(written && MoveFileExW(tempFilename.c_str(), mFilename.c_str(), MOVEFILE_REPLACE_EXISTING))
+		mTable.MarkSaved(version);
+	else
+		DeleteFileW(tempFilename.c_str());
+}
+
+void PipelineStateCache::Clear()
+{
+	mTable.Clear();
+}
+
+PipelineStateCache::Stats PipelineStateCache::GetStats()const
+{
+	return mTable.GetStats();
+}
+
+PipelineStateCache::uint64 PipelineStateCache::RootSignatureKey(ID3D12RootSignature* rootSignature, bool& persistent)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto it = mRootSignatureKeys.find(rootSignature);
+	persistent = it != mRootSignatureKeys.end();
+	if(persistent)
+		return it->second;
+
+	// Unregistered root signatures are told apart by address; such keys only live
+	// as long as the process.
+	uint64 hash = PipelineStateHash::Bytes("unregistered", 12, PipelineStateHash::Seed);
+	return PipelineStateHash::Bytes(&rootSignature, sizeof(rootSignature), hash);
+}
+
+template<typename Desc, typename CreateFunc>
+ComPtr<ID3D12PipelineState> PipelineStateCache::Get(uint64 key, bool persistent, Desc desc, CreateFunc create)
+{
+	return mTable.Get(key, persistent, [&](const Table::Blob* stored)
+	{
+		Table::Created created;
+
+		if(stored != nullptr)
+		{
+			desc.CachedPSO = { stored->data(), stored->size() };
+			created.FromBlob = SUCCEEDED(create(desc, created.Object));
+			desc.CachedPSO = { nullptr, 0 };
+		}
+
+		if(!created.FromBlob)
+			ThrowIfFailed(create(desc, created.Object));
+
+		// Keep the compiled form of new PSOs, and replace blobs the driver rejected.
+		if(persistent && !created.FromBlob)
+		{
+			ComPtr<ID3DBlob> cachedBlob;
+			ThrowIfFailed(created.Object->GetCachedBlob(cachedBlob.GetAddressOf()));
+
+			const std::uint8_t* data = (const std::uint8_t*)cachedBlob->GetBufferPointer();
+			created.NewBlob.assign(data, data + cachedBlob->GetBufferSize());
+		}
+
+		return created;
+	});
+}
+
+void PipelineStateCache::Load()
+{
+	std::ifstream fin(mFilename, std::ios::binary);
+	if(fin)
+		mTable.Read(fin);
+}
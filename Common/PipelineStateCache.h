@@ -0,0 +1,73 @@
+//***************************************************************************************
+// PipelineStateCache.h
+//
+// Creates pipeline state objects through one cache so that:
+//
+//   - identical descriptions share one PSO, even when they come from different
+//     subsystems (the app, Ssao, BlurFilter, ...),
+//   - the driver's compiled form of each PSO is kept on disk, so the next launch
+//     creates it from that blob instead of compiling the shaders again.
+//
+// PSOs are keyed by PipelineStateHash, and the sharing and the stored blobs are kept
+// by a PipelineStateTable; this class adds the device calls and the file.  Only PSOs whose root signature has been
+// registered with its serialized form are stored on disk, because the root signature
+// object itself is different in every run.  A stored blob that the driver rejects
+// (new driver or adapter) is dropped and the PSO is created from scratch.
+//
+// The cache can be used from several threads.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "PipelineStateHash.h"
+#include "PipelineStateTable.h"
+#include <mutex>
+
+class PipelineStateCache
+{
+public:
+
+	using uint64 = std::uint64_t;
+
+	using Table = PipelineStateTable<Microsoft::WRL::ComPtr<ID3D12PipelineState>>;
+	using Stats = Table::Stats;
+
+	// An empty filename keeps nothing on disk.
+	PipelineStateCache(ID3D12Device* device, const std::wstring& filename);
+	PipelineStateCache(const PipelineStateCache& rhs) = delete;
+	PipelineStateCache& operator=(const PipelineStateCache& rhs) = delete;
+
+	// Lets the PSOs that use rootSignature be stored on disk.
+	void RegisterRootSignature(ID3D12RootSignature* rootSignature, ID3DBlob* serialized);
+
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> GetGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> GetCompute(const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc);
+
+	// Writes the file if PSOs were added since it was loaded.  On failure the old file
+	// is kept and the temporary file removed.
+	void Save();
+
+	// Releases the PSOs; the blobs are kept.
+	void Clear();
+
+	Stats GetStats()const;
+
+private:
+	// Returns the key of the root signature, and whether the PSO can go on disk.
+	uint64 RootSignatureKey(ID3D12RootSignature* rootSignature, bool& persistent)const;
+
+	template<typename Desc, typename CreateFunc>
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> Get(uint64 key, bool persistent, Desc desc, CreateFunc create);
+
+	void Load();
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> mDevice;
+	std::wstring mFilename;
+
+	mutable std::mutex mMutex;
+	std::unordered_map<ID3D12RootSignature*, uint64> mRootSignatureKeys;
+
+	Table mTable;
+};
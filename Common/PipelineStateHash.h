@@ -0,0 +1,190 @@
+//***************************************************************************************
+// PipelineStateHash.h
+//
+// Canonical hash of a pipeline state description.  Two descriptions that create the
+// same pipeline hash the same, even when they were filled in by different code:
+//
+//   - shader bytecode and input element semantic names are hashed by content, not
+//     by pointer, so recompiled or copied bytecode still matches,
+//   - every field is hashed by value, so padding bytes are ignored,
+//   - state that the pipeline ignores is skipped: the blend state of render targets
+//     1-7 without IndependentBlendEnable, the formats of unused render targets, and
+//     the stencil faces when stencil is off.
+//
+// The root signature is an object, so the caller supplies a key for it (see
+// PipelineStateCache::RegisterRootSignature).  CachedPSO is not hashed.
+//
+// The functions are templates over the description types, so they do not need the
+// Direct3D headers and can be exercised with structs that have the same fields.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+class PipelineStateHash
+{
+public:
+
+	using uint64 = std::uint64_t;
+
+	static const uint64 Seed = 14695981039346656037ull;
+
+	// 64-bit FNV-1a.
+	static uint64 Bytes(const void* data, std::size_t size, uint64 hash)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for(std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	template<typename GraphicsDesc>
+	static uint64 Graphics(const GraphicsDesc& desc, uint64 rootSignatureKey)
+	{
+		uint64 hash = Value(rootSignatureKey, Seed);
+
+		hash = Shader(desc.VS, hash);
+		hash = Shader(desc.PS, hash);
+		hash = Shader(desc.DS, hash);
+		hash = Shader(desc.HS, hash);
+		hash = Shader(desc.GS, hash);
+
+		hash = Value(desc.StreamOutput.NumEntries, hash);
+		for(unsigned i = 0; i < desc.StreamOutput.NumEntries; ++i)
+		{
+			const auto& entry = desc.StreamOutput.pSODeclaration[i];
+			hash = Value(entry.Stream, hash);
+			hash = String(entry.SemanticName, hash);
+			hash = Value(entry.SemanticIndex, hash);
+			hash = Value(entry.StartComponent, hash);
+			hash = Value(entry.ComponentCount, hash);
+			hash = Value(entry.OutputSlot, hash);
+		}
+		hash = Value(desc.StreamOutput.NumStrides, hash);
+		for(unsigned i = 0; i < desc.StreamOutput.NumStrides; ++i)
+			hash = Value(desc.StreamOutput.pBufferStrides[i], hash);
+		hash = Value(desc.StreamOutput.RasterizedStream, hash);
+
+		const auto& blend = desc.BlendState;
+		hash = Value(blend.AlphaToCoverageEnable != 0, hash);
+		hash = Value(blend.IndependentBlendEnable != 0, hash);
+		unsigned numBlendTargets = blend.IndependentBlendEnable ? 8 : 1;
+		for(unsigned i = 0; i < numBlendTargets; ++i)
+		{
+			const auto& rt = blend.RenderTarget[i];
+			hash = Value(rt.BlendEnable != 0, hash);
+			hash = Value(rt.LogicOpEnable != 0, hash);
+			hash = Value(rt.SrcBlend, hash);
+			hash = Value(rt.DestBlend, hash);
+			hash = Value(rt.BlendOp, hash);
+			hash = Value(rt.SrcBlendAlpha, hash);
+			hash = Value(rt.DestBlendAlpha, hash);
+			hash = Value(rt.BlendOpAlpha, hash);
+			hash = Value(rt.LogicOp, hash);
+			hash = Value(rt.RenderTargetWriteMask, hash);
+		}
+		hash = Value(desc.SampleMask, hash);
+
+		const auto& raster = desc.RasterizerState;
+		hash = Value(raster.FillMode, hash);
+		hash = Value(raster.CullMode, hash);
+		hash = Value(raster.FrontCounterClockwise != 0, hash);
+		hash = Value(raster.DepthBias, hash);
+		hash = Value(raster.DepthBiasClamp, hash);
+		hash = Value(raster.SlopeScaledDepthBias, hash);
+		hash = Value(raster.DepthClipEnable != 0, hash);
+		hash = Value(raster.MultisampleEnable != 0, hash);
+		hash = Value(raster.AntialiasedLineEnable != 0, hash);
+		hash = Value(raster.ForcedSampleCount, hash);
+		hash = Value(raster.ConservativeRaster, hash);
+
+		const auto& depth = desc.DepthStencilState;
+		hash = Value(depth.DepthEnable != 0, hash);
+		hash = Value(depth.DepthWriteMask, hash);
+		hash = Value(depth.DepthFunc, hash);
+		hash = Value(depth.StencilEnable != 0, hash);
+		if(depth.StencilEnable)
+		{
+			hash = Value(depth.StencilReadMask, hash);
+			hash = Value(depth.StencilWriteMask, hash);
+			hash = StencilOp(depth.FrontFace, hash);
+			hash = StencilOp(depth.BackFace, hash);
+		}
+
+		hash = Value(desc.InputLayout.NumElements, hash);
+		for(unsigned i = 0; i < desc.InputLayout.NumElements; ++i)
+		{
+			const auto& element = desc.InputLayout.pInputElementDescs[i];
+			hash = String(element.SemanticName, hash);
+			hash = Value(element.SemanticIndex, hash);
+			hash = Value(element.Format, hash);
+			hash = Value(element.InputSlot, hash);
+			hash = Value(element.AlignedByteOffset, hash);
+			hash = Value(element.InputSlotClass, hash);
+			hash = Value(element.InstanceDataStepRate, hash);
+		}
+
+		hash = Value(desc.IBStripCutValue, hash);
+		hash = Value(desc.PrimitiveTopologyType, hash);
+		hash = Value(desc.NumRenderTargets, hash);
+		for(unsigned i = 0; i < desc.NumRenderTargets && i < 8; ++i)
+			hash = Value(desc.RTVFormats[i], hash);
+		hash = Value(desc.DSVFormat, hash);
+		hash = Value(desc.SampleDesc.Count, hash);
+		hash = Value(desc.SampleDesc.Quality, hash);
+		hash = Value(desc.NodeMask, hash);
+		hash = Value(desc.Flags, hash);
+
+		return hash;
+	}
+
+	template<typename ComputeDesc>
+	static uint64 Compute(const ComputeDesc& desc, uint64 rootSignatureKey)
+	{
+		// Distinct from every graphics hash with the same root signature.
+		uint64 hash = Value('C', Seed);
+		hash = Value(rootSignatureKey, hash);
+		hash = Shader(desc.CS, hash);
+		hash = Value(desc.NodeMask, hash);
+		hash = Value(desc.Flags, hash);
+		return hash;
+	}
+
+private:
+	template<typename T>
+	static uint64 Value(const T& value, uint64 hash)
+	{
+		return Bytes(&value, sizeof(value), hash);
+	}
+
+	static uint64 String(const char* s, uint64 hash)
+	{
+		std::size_t length = s != nullptr ? std::strlen(s) : 0;
+		hash = Value(length, hash);
+		return Bytes(s, length, hash);
+	}
+
+	template<typename ShaderBytecode>
+	static uint64 Shader(const ShaderBytecode& shader, uint64 hash)
+	{
+		std::size_t length = shader.pShaderBytecode != nullptr ? shader.BytecodeLength : 0;
+		hash = Value(length, hash);
+		return Bytes(shader.pShaderBytecode, length, hash);
+	}
+
+	template<typename StencilOpDesc>
+	static uint64 StencilOp(const StencilOpDesc& op, uint64 hash)
+	{
+		hash = Value(op.StencilFailOp, hash);
+		hash = Value(op.StencilDepthFailOp, hash);
+		hash = Value(op.StencilPassOp, hash);
+		hash = Value(op.StencilFunc, hash);
+		return hash;
+	}
+};
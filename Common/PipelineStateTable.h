@@ -0,0 +1,237 @@
+//***************************************************************************************
+// PipelineStateTable.h
+//
+// The bookkeeping of PipelineStateCache, keyed by the canonical PipelineStateHash of
+// a description:
+//
+//   - one entry per key, so identical descriptions share one object,
+//   - requests for a key whose object is still being created wait for that creation
+//     instead of starting their own,
+//   - the stored compiled blobs, and the versioned file they are saved to.
+//
+// The object type and its creation are supplied by the caller, so the class has no
+// Direct3D dependencies and can be exercised with a fake object:
+//
+//   Value pso = table.Get(key, persistent, [&](const Blob* stored)
+//   {
+//       Created created;
+//       ... create from *stored if it is not null, else from scratch ...
+//       return created;
+//   });
+//
+// The table can be used from several threads.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+template<typename Value>
+class PipelineStateTable
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	using Blob = std::vector<std::uint8_t>;
+
+	struct Stats
+	{
+		uint64 Requests = 0;
+		uint64 Created = 0;     // compiled from scratch
+		uint64 FromDisk = 0;    // created from a stored blob
+		uint64 Shared = 0;      // returned an existing object
+	};
+
+	// What the create function of Get returns.
+	struct Created
+	{
+		Value Object;
+
+		// True if Object was created from the stored blob.
+		bool FromBlob = false;
+
+		// Compiled form to store for the key; empty keeps the stored blob.
+		Blob NewBlob;
+	};
+
+	PipelineStateTable() = default;
+	PipelineStateTable(const PipelineStateTable& rhs) = delete;
+	PipelineStateTable& operator=(const PipelineStateTable& rhs) = delete;
+
+	// Returns the object of key, calling create(const Blob* stored) if there is none.
+	// stored is the blob of the key if persistent and one is stored, else null.  If
+	// create throws, the exception reaches every waiting caller and a later call
+	// tries again.
+	template<typename CreateFunc>
+	Value Get(uint64 key, bool persistent, CreateFunc create)
+	{
+		std::promise<Value> promise;
+		Blob stored;
+		bool hasStored = false;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mStats.Requests++;
+
+			auto it = mObjects.find(key);
+			if(it != mObjects.end())
+			{
+				mStats.Shared++;
+				std::shared_future<Value> object = it->second;
+				lock.unlock();
+
+				// Waits if another thread is still creating the object.
+				return object.get();
+			}
+
+			mObjects[key] = promise.get_future().share();
+
+			auto blobIt = mBlobs.find(key);
+			hasStored = persistent && blobIt != mBlobs.end();
+			if(hasStored)
+				stored = blobIt->second;
+		}
+
+		try
+		{
+			Created created = create(hasStored ? &stored : nullptr);
+
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if(created.FromBlob)
+					mStats.FromDisk++;
+				else
+					mStats.Created++;
+
+				if(persistent && !created.NewBlob.empty())
+				{
+					mBlobs[key] = std::move(created.NewBlob);
+					mVersion++;
+				}
+			}
+
+			promise.set_value(created.Object);
+			return created.Object;
+		}
+		catch(...)
+		{
+			promise.set_exception(std::current_exception());
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mObjects.erase(key);
+			}
+			throw;
+		}
+	}
+
+	// Reads the blobs written by Write.  Returns false, keeping the blobs read before
+	// the error, if the data is not a complete table.
+	bool Read(std::istream& in)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		uint32 magic = 0;
+		uint32 count = 0;
+		if(!in.read((char*)&magic, sizeof(magic)) || magic != FileMagic ||
+		   !in.read((char*)&count, sizeof(count)))
+			return false;
+
+		for(uint32 i = 0; i < count; ++i)
+		{
+			uint64 key = 0;
+			uint32 size = 0;
+			if(!in.read((char*)&key, sizeof(key)) || !in.read((char*)&size, sizeof(size)))
+				return false;
+
+			// A corrupt size must not size the allocation; the blob has to fit in the rest.
+			std::streampos start = in.tellg();
+			in.seekg(0, std::ios::end);
+			std::streamoff remaining = in.tellg() - start;
+			in.seekg(start);
+			if(remaining < (std::streamoff)size)
+				return false;
+
+			Blob blob(size);
+			if(!in.read((char*)blob.data(), size))
+				return false;
+
+			mBlobs[key] = std::move(blob);
+		}
+
+		return true;
+	}
+
+	// Writes every stored blob and returns the version written, for MarkSaved.
+	bool Write(std::ostream& out, uint64& version)const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		uint32 count = (uint32)mBlobs.size();
+		out.write((const char*)&FileMagic, sizeof(FileMagic));
+		out.write((const char*)&count, sizeof(count));
+		for(const auto& blob : mBlobs)
+		{
+			uint32 size = (uint32)blob.second.size();
+			out.write((const char*)&blob.first, sizeof(blob.first));
+			out.write((const char*)&size, sizeof(size));
+			out.write((const char*)blob.second.data(), size);
+		}
+
+		version = mVersion;
+		return !out.fail();
+	}
+
+	// True if blobs were added since the version last passed to MarkSaved.
+	bool IsDirty()const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mVersion != mSavedVersion;
+	}
+
+	void MarkSaved(uint64 version)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSavedVersion = version;
+	}
+
+	// Releases the objects; the blobs are kept.
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mObjects.clear();
+	}
+
+	std::size_t NumBlobs()const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mBlobs.size();
+	}
+
+	Stats GetStats()const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mStats;
+	}
+
+private:
+	// Bump when the file layout changes.
+	static const uint32 FileMagic = 0x314f5350; // "PSO1"
+
+	mutable std::mutex mMutex;
+	std::unordered_map<uint64, std::shared_future<Value>> mObjects;
+	std::unordered_map<uint64, Blob> mBlobs;
+	uint64 mVersion = 0;
+	uint64 mSavedVersion = 0;
+	Stats mStats;
+};
+
+template<typename Value>
+const typename PipelineStateTable<Value>::uint32 PipelineStateTable<Value>::FileMagic;
@@ -0,0 +1,350 @@
+//***************************************************************************************
+// Profiler.cpp
+//***************************************************************************************
+
+#include "Profiler.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <map>
+
+namespace
+{
+	double NsToMs(Profiler::uint64 ns)
+	{
+		return (double)ns / 1000000.0;
+	}
+
+	// Microseconds with three decimals, as the trace viewer expects.
+	std::string Microseconds(Profiler::uint64 ns)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.3f", (double)ns / 1000.0);
+		return buffer;
+	}
+
+	std::string JsonString(const char* s)
+	{
+		std::string json = "\"";
+		for(; *s != '\0'; ++s)
+		{
+			unsigned char c = (unsigned char)*s;
+			if(c == '"' || c == '\\')
+			{
+				json += '\\';
+				json += (char)c;
+			}
+			else if(c < 0x20)
+			{
+				char buffer[8];
+				std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				json += buffer;
+			}
+			else
+				json += (char)c;
+		}
+		return json + "\"";
+	}
+
+	// Nearest rank percentile of sorted values.
+	double Percentile(const std::vector<double>& sorted, double p)
+	{
+		std::size_t rank = (std::size_t)std::ceil(p * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+}
+
+Profiler::CpuScope::CpuScope(Profiler& profiler, const char* name) :
+	mProfiler(profiler),
+	mName(name),
+	mFrame(0),
+	mStartNs(0),
+	mDepth(0),
+	mEnabled(profiler.IsEnabled())
+{
+	if(mEnabled)
+	{
+		mFrame = profiler.CurrentFrame();
+		mDepth = ThreadDepth()++;
+		mStartNs = profiler.NowNs();
+	}
+}
+
+Profiler::CpuScope::~CpuScope()
+{
+	if(!mEnabled)
+		return;
+
+	Event event;
+	event.Name = mName;
+	event.Kind = Track::Cpu;
+	event.StartNs = mStartNs;
+	event.EndNs = mProfiler.NowNs();
+	event.Thread = ThreadIndex();
+	event.Depth = mDepth;
+
+	--ThreadDepth();
+	mProfiler.AddEvent(mFrame, event);
+}
+
+Profiler::Profiler(uint32 framesToKeep, uint32 maxEventsPerFrame) :
+	mEpoch(std::chrono::steady_clock::now()),
+	mMaxEventsPerFrame(maxEventsPerFrame),
+	mFrames(framesToKeep),
+	mCurrFrame(0),
+	mEnabled(true)
+{
+	assert(framesToKeep > 0);
+	for(Frame& frame : mFrames)
+		frame.Events.reserve(maxEventsPerFrame);
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	mEnabled = enabled;
+}
+
+bool Profiler::IsEnabled()const
+{
+	return mEnabled;
+}
+
+Profiler::uint64 Profiler::BeginFrame()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	uint64 index = mCurrFrame + 1;
+	Frame& frame = mFrames[index % mFrames.size()];
+	frame.Index = index;
+	frame.StartNs = NowNs();
+	frame.EndNs = frame.StartNs;
+	frame.Complete = false;
+	frame.Events.clear();
+
+	mCurrFrame = index;
+	return index;
+}
+
+void Profiler::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Frame& frame = mFrames[mCurrFrame % mFrames.size()];
+	if(frame.Index == 0 || frame.Complete)
+		return;
+
+	frame.EndNs = NowNs();
+	frame.Complete = true;
+}
+
+Profiler::uint64 Profiler::CurrentFrame()const
+{
+	return mCurrFrame;
+}
+
+Profiler::uint64 Profiler::NowNs()const
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+void Profiler::AddEvent(uint64 frame, const Event& event)
+{
+	// Markers outside of any frame are not kept.
+	if(frame == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	Frame& f = mFrames[frame % mFrames.size()];
+	if(f.Index != frame)
+		return;
+
+	if(f.Events.size() >= mMaxEventsPerFrame)
+	{
+		mNumDropped++;
+		return;
+	}
+
+	f.Events.push_back(event);
+}
+
+const char* Profiler::Intern(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mNames.insert(name).first->c_str();
+}
+
+std::vector<Profiler::Stat> Profiler::Summarize()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::map<std::pair<int, std::string>, std::vector<double>> durations;
+	for(const Frame* frame : OrderedFrames())
+	{
+		if(!frame->Complete)
+			continue;
+
+		durations[{ (int)Track::Cpu, "Frame" }].push_back(NsToMs(frame->EndNs - frame->StartNs));
+		for(const Event& event : frame->Events)
+			durations[{ (int)event.Kind, event.Name }].push_back(NsToMs(event.EndNs - event.StartNs));
+	}
+
+	std::vector<Stat> stats;
+	std::vector<double> totals;
+	for(auto& d : durations)
+	{
+		std::vector<double>& ms = d.second;
+		std::sort(ms.begin(), ms.end());
+
+		double total = 0.0;
+		for(double m : ms)
+			total += m;
+
+		Stat stat;
+		stat.Kind = (Track)d.first.first;
+		stat.Name = d.first.second;
+		stat.Count = (uint32)ms.size();
+		stat.MeanMs = total / ms.size();
+		stat.P50Ms = Percentile(ms, 0.50);
+		stat.P95Ms = Percentile(ms, 0.95);
+		stat.P99Ms = Percentile(ms, 0.99);
+		stat.MaxMs = ms.back();
+		stats.push_back(stat);
+		totals.push_back(total);
+	}
+
+	std::vector<std::size_t> order(stats.size());
+	for(std::size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+	{
+		return totals[a] > totals[b];
+	});
+
+	std::vector<Stat> sorted;
+	for(std::size_t i : order)
+		sorted.push_back(stats[i]);
+	return sorted;
+}
+
+void Profiler::WriteChromeTrace(std::ostream& out)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	const int cpuPid = 1;
+	const int gpuPid = 2;
+
+	// Thread 0 of the CPU process shows the frames, the threads that recorded markers
+	// follow it.
+	out << "{\"traceEvents\":[\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << cpuPid << ",\"args\":{\"name\":\"CPU\"}},\n";
+	out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << gpuPid << ",\"args\":{\"name\":\"GPU\"}},\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << cpuPid << ",\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+
+	// A frame still being recorded has no end time yet, and its GPU events arrive
+	// later, so only complete frames are written.
+	std::set<uint32> threads;
+	for(const Frame* frame : OrderedFrames())
+	{
+		if(!frame->Complete)
+			continue;
+
+		out << ",\n{\"name\":\"Frame " << frame->Index << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":" << cpuPid
+			<< ",\"tid\":0,\"ts\":" << Microseconds(frame->StartNs)
+			<< ",\"dur\":" << Microseconds(frame->EndNs - frame->StartNs) << "}";
+
+		for(const Event& event : frame->Events)
+		{
+			bool gpu = event.Kind == Track::Gpu;
+			uint32 tid = gpu ? event.Thread : event.Thread + 1;
+			if(!gpu)
+				threads.insert(tid);
+
+			out << ",\n{\"name\":" << JsonString(event.Name) << ",\"cat\":\"" << (gpu ? "gpu" : "cpu")
+				<< "\",\"ph\":\"X\",\"pid\":" << (gpu ? gpuPid : cpuPid) << ",\"tid\":" << tid
+				<< ",\"ts\":" << Microseconds(event.StartNs)
+				<< ",\"dur\":" << Microseconds(event.EndNs - event.StartNs)
+				<< ",\"args\":{\"frame\":" << frame->Index << ",\"depth\":" << event.Depth << "}}";
+		}
+	}
+
+	for(uint32 tid : threads)
+	{
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << cpuPid << ",\"tid\":" << tid
+			<< ",\"args\":{\"name\":\"Thread " << tid - 1 << "\"}}";
+	}
+
+	out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::WriteSummary(std::ostream& out)const
+{
+	std::vector<Stat> stats = Summarize();
+
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-4s %-32s %7s %9s %9s %9s %9s %9s\n",
+		"", "marker", "count", "mean ms", "p50 ms", "p95 ms", "p99 ms", "max ms");
+	out << line;
+
+	for(const Stat& stat : stats)
+	{
+		std::snprintf(line, sizeof(line), "%-4s %-32s %7u %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+			stat.Kind == Track::Gpu ? "GPU" : "CPU", stat.Name.c_str(), (unsigned)stat.Count,
+			stat.MeanMs, stat.P50Ms, stat.P95Ms, stat.P99Ms, stat.MaxMs);
+		out << line;
+	}
+
+	uint64 dropped = NumDroppedEvents();
+	if(dropped > 0)
+		out << dropped << " events dropped, raise maxEventsPerFrame\n";
+}
+
+Profiler::uint32 Profiler::NumFrames()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	uint32 count = 0;
+	for(const Frame& frame : mFrames)
+	{
+		if(frame.Complete)
+			count++;
+	}
+	return count;
+}
+
+Profiler::uint64 Profiler::NumDroppedEvents()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mNumDropped;
+}
+
+std::vector<const Profiler::Frame*> Profiler::OrderedFrames()const
+{
+	std::vector<const Frame*> frames;
+	for(const Frame& frame : mFrames)
+	{
+		if(frame.Index != 0)
+			frames.push_back(&frame);
+	}
+
+	std::sort(frames.begin(), frames.end(), [](const Frame* a, const Frame* b)
+	{
+		return a->Index < b->Index;
+	});
+	return frames;
+}
+
+Profiler::uint32 Profiler::ThreadIndex()
+{
+	static std::atomic<uint32> nextIndex(0);
+	static thread_local uint32 index = nextIndex++;
+	return index;
+}
+
+Profiler::uint32& Profiler::ThreadDepth()
+{
+	static thread_local uint32 depth = 0;
+	return depth;
+}
@@ -0,0 +1,167 @@
+//***************************************************************************************
+// Profiler.h
+//
+// Hierarchical frame profiler.  CPU time is measured with scoped markers, GPU time is
+// handed in by GpuProfiler once the timestamps of a frame are read back, and both are
+// kept per frame in a ring of the last framesToKeep frames:
+//
+//   mProfiler.BeginFrame();
+//   {
+//       PROFILE_SCOPE(mProfiler, "Update");
+//       ...
+//       {
+//           PROFILE_SCOPE(mProfiler, "UpdateObjectCBs");
+//           ...
+//       }
+//   }
+//   mProfiler.EndFrame();
+//   ...
+//   mProfiler.WriteChromeTrace(file);   // open in chrome://tracing or ui.perfetto.dev
+//   mProfiler.WriteSummary(std::cout);  // p50/p95/p99 per marker
+//
+// Markers nest per thread and may be used from worker threads.  Event names are not
+// copied: use string literals, or Intern for names built at runtime.  Storage for each
+// frame is reserved up front, so recording does not allocate once the ring is warm;
+// events past maxEventsPerFrame are dropped and counted.
+//
+// The class has no Direct3D dependencies, so it runs and exports headlessly.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+class Profiler
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	enum class Track { Cpu, Gpu };
+
+	struct Event
+	{
+		const char* Name = nullptr;
+		Track Kind = Track::Cpu;
+
+		// Nanoseconds since the profiler was created.
+		uint64 StartNs = 0;
+		uint64 EndNs = 0;
+
+		// Small per thread index on the CPU track, 0 on the GPU track.
+		uint32 Thread = 0;
+
+		// Number of enclosing markers on the same thread.
+		uint32 Depth = 0;
+	};
+
+	struct Frame
+	{
+		uint64 Index = 0;
+		uint64 StartNs = 0;
+		uint64 EndNs = 0;
+		bool Complete = false;
+		std::vector<Event> Events;
+	};
+
+	struct Stat
+	{
+		std::string Name;
+		Track Kind = Track::Cpu;
+		uint32 Count = 0;
+		double MeanMs = 0.0;
+		double P50Ms = 0.0;
+		double P95Ms = 0.0;
+		double P99Ms = 0.0;
+		double MaxMs = 0.0;
+	};
+
+	// Times a marker from construction to destruction.
+	class CpuScope
+	{
+	public:
+		CpuScope(Profiler& profiler, const char* name);
+		CpuScope(const CpuScope& rhs) = delete;
+		CpuScope& operator=(const CpuScope& rhs) = delete;
+		~CpuScope();
+
+	private:
+		Profiler& mProfiler;
+		const char* mName;
+		uint64 mFrame;
+		uint64 mStartNs;
+		uint32 mDepth;
+		bool mEnabled;
+	};
+
+	explicit Profiler(uint32 framesToKeep = 300, uint32 maxEventsPerFrame = 512);
+	Profiler(const Profiler& rhs) = delete;
+	Profiler& operator=(const Profiler& rhs) = delete;
+
+	void SetEnabled(bool enabled);
+	bool IsEnabled()const;
+
+	// Starts a new frame in the ring, overwriting the oldest one.  Returns its index.
+	uint64 BeginFrame();
+	void EndFrame();
+
+	// Index of the frame BeginFrame last started, 0 before the first one.
+	uint64 CurrentFrame()const;
+
+	uint64 NowNs()const;
+
+	// Adds an event to a frame still in the ring; does nothing if it has been
+	// overwritten.  GPU events come in this way, some frames after their own.
+	void AddEvent(uint64 frame, const Event& event);
+
+	// Returns a copy of name that lives as long as the profiler.
+	const char* Intern(const std::string& name);
+
+	// Durations of every marker over the complete frames in the ring, plus the
+	// frame time itself as "Frame".  Sorted by total time, largest first.
+	std::vector<Stat> Summarize()const;
+
+	// Chrome trace event format: one complete ("X") event per marker of the complete
+	// frames in the ring, CPU and GPU as two processes, times in microseconds.
+	void WriteChromeTrace(std::ostream& out)const;
+
+	// Summarize as a table.
+	void WriteSummary(std::ostream& out)const;
+
+	uint32 NumFrames()const;
+	uint64 NumDroppedEvents()const;
+
+private:
+	// Frames in the ring from oldest to newest.
+	std::vector<const Frame*> OrderedFrames()const;
+
+	static uint32 ThreadIndex();
+	static uint32& ThreadDepth();
+
+private:
+	const std::chrono::steady_clock::time_point mEpoch;
+	const uint32 mMaxEventsPerFrame;
+
+	mutable std::mutex mMutex;
+	std::vector<Frame> mFrames;
+	std::atomic<uint64> mCurrFrame;
+	uint64 mNumDropped = 0;
+	std::atomic<bool> mEnabled;
+
+	std::set<std::string> mNames;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+// Times the rest of the enclosing block.
+#define PROFILE_SCOPE(profiler, name) \
+	Profiler::CpuScope PROFILE_CONCAT(profileScope, __LINE__)((profiler), (name))
@@ -0,0 +1,209 @@
+//***************************************************************************************
+// ReplayLog.cpp
+//***************************************************************************************
+
+#include "ReplayLog.h"
+#include <algorithm>
+
+namespace
+{
+	const char Magic[4] = { 'R', 'P', 'L', 'Y' };
+	const std::uint32_t Version = 1;
+
+	void WriteVarint(std::ostream& out, std::uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			out.put((char)(value | 0x80));
+			value >>= 7;
+		}
+		out.put((char)value);
+	}
+
+	// Zigzag, so small negative differences stay small.
+	void WriteSigned(std::ostream& out, std::int64_t value)
+	{
+		WriteVarint(out, ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));
+	}
+
+	bool ReadVarint(std::istream& in, std::uint64_t& value)
+	{
+		value = 0;
+		for(int shift = 0; shift < 64; shift += 7)
+		{
+			int c = in.get();
+			if(c == std::char_traits<char>::eof())
+				return false;
+
+			value |= (std::uint64_t)(c & 0x7f) << shift;
+			if((c & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	bool ReadSigned(std::istream& in, std::int64_t& value)
+	{
+		std::uint64_t zigzag = 0;
+		if(!ReadVarint(in, zigzag))
+			return false;
+
+		value = (std::int64_t)(zigzag >> 1) ^ -(std::int64_t)(zigzag & 1);
+		return true;
+	}
+
+	bool Fail(std::string* error, const char* message)
+	{
+		if(error != nullptr)
+			*error = message;
+		return false;
+	}
+}
+
+void ReplayLog::Clear()
+{
+	Seed = 0;
+	DeltasNs.clear();
+	Events.clear();
+}
+
+void ReplayLog::AddFrame(int64 deltaNs)
+{
+	DeltasNs.push_back(deltaNs);
+}
+
+void ReplayLog::AddEvent(InputEvent event)
+{
+	event.Frame = NumFrames();
+	Events.push_back(event);
+}
+
+ReplayLog::uint32 ReplayLog::NumFrames()const
+{
+	return (uint32)DeltasNs.size();
+}
+
+HeadlessRunner::Settings ReplayLog::ToSettings()const
+{
+	HeadlessRunner::Settings settings;
+	settings.NumFrames = NumFrames();
+	settings.Input = Events;
+
+	settings.RecordedDeltas.reserve(DeltasNs.size());
+	for(int64 ns : DeltasNs)
+		settings.RecordedDeltas.push_back(ns / 1e9);
+
+	return settings;
+}
+
+void ReplayLog::Save(std::ostream& out)const
+{
+	out.write(Magic, sizeof(Magic));
+	WriteVarint(out, Version);
+	WriteVarint(out, Seed);
+	WriteVarint(out, DeltasNs.size());
+	WriteVarint(out, Events.size());
+
+	// Frame times barely change from one frame to the next.
+	int64 prevDelta = 0;
+	for(int64 delta : DeltasNs)
+	{
+		WriteSigned(out, delta - prevDelta);
+		prevDelta = delta;
+	}
+
+	// Mouse moves come a few pixels at a time.
+	uint32 prevFrame = 0;
+	int prevX = 0;
+	int prevY = 0;
+	for(const InputEvent& event : Events)
+	{
+		WriteVarint(out, event.Frame - prevFrame);
+		out.put((char)event.Kind);
+
+		if(event.Kind == InputEvent::Type::KeyDown || event.Kind == InputEvent::Type::KeyUp)
+			WriteVarint(out, event.Key);
+		else
+		{
+			WriteSigned(out, (int64)event.X - prevX);
+			WriteSigned(out, (int64)event.Y - prevY);
+			WriteVarint(out, event.Buttons);
+			prevX = event.X;
+			prevY = event.Y;
+		}
+
+		prevFrame = event.Frame;
+	}
+}
+
+bool ReplayLog::Load(std::istream& in, std::string* error)
+{
+	Clear();
+
+	char magic[sizeof(Magic)];
+	if(!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), Magic))
+		return Fail(error, "not a replay log");
+
+	std::uint64_t version = 0, seed = 0, numFrames = 0, numEvents = 0;
+	if(!ReadVarint(in, version) || version != Version)
+		return Fail(error, "unsupported replay log version");
+	if(!ReadVarint(in, seed) || !ReadVarint(in, numFrames) || !ReadVarint(in, numEvents))
+		return Fail(error, "truncated header");
+	Seed = (uint32)seed;
+
+	int64 delta = 0;
+	for(std::uint64_t i = 0; i < numFrames; ++i)
+	{
+		int64 diff = 0;
+		if(!ReadSigned(in, diff))
+			return Fail(error, "truncated frame times");
+
+		delta += diff;
+		DeltasNs.push_back(delta);
+	}
+
+	uint32 frame = 0;
+	int64 x = 0;
+	int64 y = 0;
+	for(std::uint64_t i = 0; i < numEvents; ++i)
+	{
+		std::uint64_t frameDiff = 0;
+		if(!ReadVarint(in, frameDiff))
+			return Fail(error, "truncated events");
+
+		int kind = in.get();
+		if(kind == std::char_traits<char>::eof())
+			return Fail(error, "truncated events");
+		if(kind < (int)InputEvent::Type::MouseDown || kind > (int)InputEvent::Type::KeyUp)
+			return Fail(error, "bad event type");
+
+		InputEvent event;
+		frame += (uint32)frameDiff;
+		event.Frame = frame;
+		event.Kind = (InputEvent::Type)kind;
+
+		std::uint64_t value = 0;
+		if(event.Kind == InputEvent::Type::KeyDown || event.Kind == InputEvent::Type::KeyUp)
+		{
+			if(!ReadVarint(in, value))
+				return Fail(error, "truncated events");
+			event.Key = (uint32)value;
+		}
+		else
+		{
+			int64 dx = 0, dy = 0;
+			if(!ReadSigned(in, dx) || !ReadSigned(in, dy) || !ReadVarint(in, value))
+				return Fail(error, "truncated events");
+
+			x += dx;
+			y += dy;
+			event.X = (int)x;
+			event.Y = (int)y;
+			event.Buttons = (uint32)value;
+		}
+
+		Events.push_back(event);
+	}
+
+	return true;
+}
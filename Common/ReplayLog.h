@@ -0,0 +1,71 @@
+//***************************************************************************************
+// ReplayLog.h
+//
+// Everything that makes two runs of a demo differ: the time step of each frame, the
+// input events delivered before each Update and the seed of the random numbers.
+// Recorded from a windowed run and replayed through HeadlessRunner, every frame sees
+// the same times, input and random numbers, so the cost of a frame can be compared
+// across builds on the same workload:
+//
+//   // recording, every frame
+//   log.AddEvent(event);         // as the input arrives
+//   log.AddFrame(deltaNs);       // before Update
+//   ...
+//   log.Save(file);
+//
+//   // replaying
+//   log.Load(file, &error);
+//   MathHelper::SeedRand(log.Seed);
+//   HeadlessRunner runner(log.ToSettings());
+//
+// The file is a small header followed by the frames and events, with times and
+// coordinates stored as variable length differences from the previous value, so a
+// minute at 60 fps with mouse look takes a few tens of kilobytes.
+//
+// The class has no Direct3D or Win32 dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "HeadlessRunner.h"
+
+class ReplayLog
+{
+public:
+
+	using uint32 = std::uint32_t;
+	using int64 = std::int64_t;
+
+	typedef HeadlessRunner::InputEvent InputEvent;
+
+	uint32 Seed = 0;
+
+	// Time step of each frame in nanoseconds.
+	std::vector<int64> DeltasNs;
+
+	// Sorted by frame; an event of frame i is delivered before its Update.
+	std::vector<InputEvent> Events;
+
+	void Clear();
+
+	// Starts the next frame.
+	void AddFrame(int64 deltaNs);
+
+	// Adds an event to the frame AddFrame starts next.
+	void AddEvent(InputEvent event);
+
+	uint32 NumFrames()const;
+
+	// Settings that replay the log: every frame, its time steps and input.
+	HeadlessRunner::Settings ToSettings()const;
+
+	void Save(std::ostream& out)const;
+
+	// Returns false and sets error if the stream is not a valid log.
+	bool Load(std::istream& in, std::string* error = nullptr);
+};
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// RingAllocator.cpp
+//***************************************************************************************
+
+#include "RingAllocator.h"
+#include <cassert>
+
+RingAllocator::RingAllocator(uint64 capacity)
+{
+	Reset(capacity);
+}
+
+void RingAllocator::Reset(uint64 capacity)
+{
+	mCapacity = capacity;
+	mHead = 0;
+	mTail = 0;
+	mAllocated = 0;
+	mReleased = 0;
+	mFrames.clear();
+}
+
+RingAllocator::uint64 RingAllocator::Allocate(uint64 size, uint64 alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+	const uint64 used = UsedSize();
+	if(size > mCapacity || used == mCapacity)
+		return InvalidOffset;
+
+	uint64 alignedHead = (mHead + alignment - 1) & ~(alignment - 1);
+
+	if(mHead >= mTail)
+	{
+		// Free space is [head, capacity) followed by [0, tail).
+		if(alignedHead + size <= mCapacity)
+		{
+			mAllocated += alignedHead - mHead + size;
+			mHead = alignedHead + size;
+			return alignedHead;
+		}
+
+		// Skip the end of the buffer and wrap; offset 0 satisfies any alignment.
+		if(size <= mTail)
+		{
+			mAllocated += mCapacity - mHead + size;
+			mHead = size;
+			return 0;
+		}
+	}
+	else if(alignedHead + size <= mTail)
+	{
+		// Free space is [head, tail).
+		mAllocated += alignedHead - mHead + size;
+		mHead = alignedHead + size;
+		return alignedHead;
+	}
+
+	return InvalidOffset;
+}
+
+void RingAllocator::FinishFrame(uint64 fenceValue)
+{
+	// Nothing allocated since the last frame; nothing to retire.  The last marker
+	// keeps its fence, so an idle frame does not hold back its release.
+	uint64 lastAllocated = mFrames.empty() ? mReleased : mFrames.back().Allocated;
+	if(lastAllocated == mAllocated)
+		return;
+
+	mFrames.push_back({ fenceValue, mHead, mAllocated });
+}
+
+void RingAllocator::ReleaseCompleted(uint64 completedFenceValue)
+{
+	while(!mFrames.empty() && mFrames.front().FenceValue <= completedFenceValue)
+	{
+		mTail = mFrames.front().Head;
+		mReleased = mFrames.front().Allocated;
+		mFrames.pop_front();
+	}
+
+	// Start over at the beginning when everything has been retired, so the next
+	// allocations do not have to wrap.
+	if(mAllocated == mReleased)
+	{
+		mHead = 0;
+		mTail = 0;
+	}
+}
+
+RingAllocator::uint64 RingAllocator::Capacity()const
+{
+	return mCapacity;
+}
+
+RingAllocator::uint64 RingAllocator::UsedSize()const
+{
+	return mAllocated - mReleased;
+}
+
+bool RingAllocator::IsEmpty()const
+{
+	return mAllocated == mReleased;
+}
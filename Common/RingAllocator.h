@@ -0,0 +1,68 @@
+//***************************************************************************************
+// RingAllocator.h
+//
+// Sub-allocates offsets from a fixed size range in FIFO order.  Allocations made
+// between two FinishFrame calls are retired together once the GPU fence passes the
+// value given to FinishFrame, which makes it a good fit for upload memory that is
+// written by the CPU and read once by the GPU.
+//
+// Only offsets are handed out; the memory itself belongs to the client (see
+// UploadRing.h).  The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+class RingAllocator
+{
+public:
+
+	using uint64 = std::uint64_t;
+
+	static const uint64 InvalidOffset = ~uint64(0);
+
+	explicit RingAllocator(uint64 capacity = 0);
+
+	// Drops every allocation, including the ones not yet retired.
+	void Reset(uint64 capacity);
+
+	// alignment must be a power of two.  Returns InvalidOffset if there is no
+	// contiguous free range large enough.  An allocation never wraps around the end;
+	// the space skipped at the end counts as used until the allocation is retired.
+	uint64 Allocate(uint64 size, uint64 alignment = 1);
+
+	// Allocations made since the last call are retired once fenceValue is complete.
+	void FinishFrame(uint64 fenceValue);
+
+	// Reclaims the space of every frame whose fence value is <= completedFenceValue.
+	void ReleaseCompleted(uint64 completedFenceValue);
+
+	uint64 Capacity()const;
+
+	// Bytes in use, including alignment padding and space skipped when wrapping.
+	uint64 UsedSize()const;
+
+	bool IsEmpty()const;
+
+private:
+	struct FrameMarker
+	{
+		uint64 FenceValue;
+
+		// Head and total allocated bytes when the frame was finished.
+		uint64 Head;
+		uint64 Allocated;
+	};
+
+	uint64 mCapacity = 0;
+	uint64 mHead = 0;
+	uint64 mTail = 0;
+
+	// Monotonic byte counters; UsedSize() is their difference.
+	uint64 mAllocated = 0;
+	uint64 mReleased = 0;
+
+	std::deque<FrameMarker> mFrames;
+};
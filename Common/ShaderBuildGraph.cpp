@@ -0,0 +1,229 @@
+//***************************************************************************************
+// ShaderBuildGraph.cpp
+//***************************************************************************************
+
+#include "ShaderBuildGraph.h"
+#include <sstream>
+#include <stdexcept>
+
+ShaderBuildGraph::ShaderBuildGraph(ShaderCache* cache, uint32 numThreads) :
+	mCache(cache)
+{
+	if(numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if(numThreads == 0)
+		numThreads = 1;
+
+	mThreads.reserve(numThreads);
+	for(uint32 i = 0; i < numThreads; ++i)
+		mThreads.emplace_back(&ShaderBuildGraph::WorkerMain, this);
+}
+
+ShaderBuildGraph::~ShaderBuildGraph()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mJobReady.notify_all();
+
+	for(auto& t : mThreads)
+		t.join();
+}
+
+ShaderBuildGraph::ShaderFuture ShaderBuildGraph::AddShader(const std::string& name, const ShaderCache::Request& request)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::string key = RequestString(request);
+	auto it = mCompileIndices.find(key);
+	if(it != mCompileIndices.end())
+	{
+		mShaders[name] = it->second;
+		return mCompiles[it->second].Future;
+	}
+
+	std::size_t index = mCompiles.size();
+
+	// std::function needs a copyable target, so the promise is shared.
+	auto promise = std::make_shared<std::promise<std::shared_ptr<const ShaderCache::ByteCode>>>();
+
+	Compile compile;
+	compile.Future = promise->get_future().share();
+	mCompiles.push_back(compile);
+	mCompileIndices[key] = index;
+	mShaders[name] = index;
+
+	EnqueueLocked([this, promise, request, index]()
+	{
+		try
+		{
+			promise->set_value(mCache->Get(request));
+		}
+		catch(...)
+		{
+			promise->set_exception(std::current_exception());
+			SetError(std::current_exception());
+			OnCompiled(index, true);
+			return;
+		}
+		OnCompiled(index, false);
+	});
+
+	return mCompiles[index].Future;
+}
+
+void ShaderBuildGraph::AddTask(const std::vector<std::string>& shaders, std::function<void()> task)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	std::size_t index = mTasks.size();
+	mTasks.emplace_back();
+	mTasks[index].Func = std::move(task);
+
+	for(const std::string& name : shaders)
+	{
+		auto it = mShaders.find(name);
+		if(it == mShaders.end())
+			throw std::invalid_argument("ShaderBuildGraph: unknown shader " + name);
+
+		Compile& compile = mCompiles[it->second];
+		if(compile.Failed)
+			mTasks[index].Skipped = true;
+		else if(!compile.Done)
+		{
+			compile.Dependents.push_back(index);
+			mTasks[index].NumPending++;
+		}
+	}
+
+	if(mTasks[index].NumPending == 0 && !mTasks[index].Skipped)
+		EnqueueLocked([this, index]() { RunTask(index); });
+}
+
+void ShaderBuildGraph::Wait()
+{
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+		mIdle.wait(lock, [this]() { return mJobs.empty() && mNumBusy == 0; });
+
+		error = mError;
+		mError = nullptr;
+	}
+
+	if(error)
+		std::rethrow_exception(error);
+}
+
+ShaderBuildGraph::ShaderFuture ShaderBuildGraph::GetShader(const std::string& name)const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mCompiles[mShaders.at(name)].Future;
+}
+
+ShaderBuildGraph::uint32 ShaderBuildGraph::NumShaders()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return (uint32)mShaders.size();
+}
+
+ShaderBuildGraph::uint32 ShaderBuildGraph::NumCompiles()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return (uint32)mCompiles.size();
+}
+
+ShaderBuildGraph::uint32 ShaderBuildGraph::NumThreads()const
+{
+	return (uint32)mThreads.size();
+}
+
+std::string ShaderBuildGraph::RequestString(const ShaderCache::Request& request)
+{
+	// Fields are separated by a character that cannot appear in any of them.
+	std::ostringstream ss;
+	ss << request.Filename << '\n' << request.EntryPoint << '\n' << request.Target << '\n' << request.Flags;
+	for(const auto& define : request.Defines)
+		ss << '\n' << define.Name << '=' << define.Value;
+	return ss.str();
+}
+
+void ShaderBuildGraph::OnCompiled(std::size_t compile, bool failed)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	mCompiles[compile].Done = true;
+	mCompiles[compile].Failed = failed;
+
+	for(std::size_t index : mCompiles[compile].Dependents)
+	{
+		Task& task = mTasks[index];
+		task.Skipped = task.Skipped || failed;
+		if(--task.NumPending == 0 && !task.Skipped)
+			EnqueueLocked([this, index]() { RunTask(index); });
+	}
+
+	mCompiles[compile].Dependents.clear();
+}
+
+void ShaderBuildGraph::RunTask(std::size_t task)
+{
+	std::function<void()> func;
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		func = std::move(mTasks[task].Func);
+	}
+
+	try
+	{
+		func();
+	}
+	catch(...)
+	{
+		SetError(std::current_exception());
+	}
+}
+
+void ShaderBuildGraph::SetError(std::exception_ptr error)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(!mError)
+		mError = error;
+}
+
+void ShaderBuildGraph::EnqueueLocked(std::function<void()> job)
+{
+	mJobs.push_back(std::move(job));
+	mJobReady.notify_one();
+}
+
+void ShaderBuildGraph::WorkerMain()
+{
+	for(;;)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobReady.wait(lock, [this]() { return mQuit || !mJobs.empty(); });
+
+			// Drain the queue before quitting so no future is left without a value.
+			if(mJobs.empty())
+				return;
+
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+			mNumBusy++;
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mNumBusy--;
+			if(mJobs.empty() && mNumBusy == 0)
+				mIdle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,116 @@
+//***************************************************************************************
+// ShaderBuildGraph.h
+//
+// Compiles the shaders of a demo on a pool of worker threads instead of one after
+// another on the main thread, and runs the work that needs them (typically creating
+// a PSO) as soon as the shaders it depends on are ready:
+//
+//   ShaderBuildGraph build(&d3dUtil::GetShaderCache());
+//   build.AddShader("standardVS", d3dUtil::MakeShaderRequest(L"Shaders\\Default.hlsl", nullptr, "VS", "vs_5_1"));
+//   build.AddShader("opaquePS", d3dUtil::MakeShaderRequest(L"Shaders\\Default.hlsl", nullptr, "PS", "ps_5_1"));
+//   ...
+//   build.AddTask({ "standardVS", "opaquePS" }, [&]() { ... CreateGraphicsPipelineState ... });
+//   build.Wait();
+//
+// A shader starts compiling as soon as it is added.  Requests identical to one added
+// before share its compile.  Shaders go through a ShaderCache, whose compiler is an
+// interface, so the scheduling can be exercised without Direct3D.
+//***************************************************************************************
+
+#pragma once
+
+#include "ShaderCache.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class ShaderBuildGraph
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	using ShaderFuture = std::shared_future<std::shared_ptr<const ShaderCache::ByteCode>>;
+
+	// numThreads == 0 uses one thread per hardware thread.
+	explicit ShaderBuildGraph(ShaderCache* cache, uint32 numThreads = 0);
+	ShaderBuildGraph(const ShaderBuildGraph& rhs) = delete;
+	ShaderBuildGraph& operator=(const ShaderBuildGraph& rhs) = delete;
+
+	// Finishes the queued work before returning; errors are dropped.
+	~ShaderBuildGraph();
+
+	// The future holds the bytecode, or the compiler's exception.
+	ShaderFuture AddShader(const std::string& name, const ShaderCache::Request& request);
+
+	// Runs task on a worker thread once every named shader has compiled.  If one of
+	// them fails, the task is skipped.  Shaders must be added before tasks use them.
+	void AddTask(const std::vector<std::string>& shaders, std::function<void()> task);
+
+	// Blocks until every shader and task is done, then rethrows the first error.
+	void Wait();
+
+	ShaderFuture GetShader(const std::string& name)const;
+
+	uint32 NumShaders()const;
+
+	// Distinct requests, i.e. shaders that were actually sent to the cache.
+	uint32 NumCompiles()const;
+
+	uint32 NumThreads()const;
+
+private:
+	struct Compile
+	{
+		ShaderFuture Future;
+		bool Done = false;
+		bool Failed = false;
+
+		// Indices into mTasks of the tasks waiting for this compile.
+		std::vector<std::size_t> Dependents;
+	};
+
+	struct Task
+	{
+		std::function<void()> Func;
+		uint32 NumPending = 0;
+		bool Skipped = false;
+	};
+
+	static std::string RequestString(const ShaderCache::Request& request);
+
+	void OnCompiled(std::size_t compile, bool failed);
+	void RunTask(std::size_t task);
+	void SetError(std::exception_ptr error);
+
+	// Call with mMutex locked.
+	void EnqueueLocked(std::function<void()> job);
+	void WorkerMain();
+
+private:
+	ShaderCache* mCache = nullptr;
+
+	std::vector<std::thread> mThreads;
+
+	mutable std::mutex mMutex;
+	std::condition_variable mJobReady;
+	std::condition_variable mIdle;
+	std::deque<std::function<void()>> mJobs;
+	uint32 mNumBusy = 0;
+	bool mQuit = false;
+
+	std::vector<Compile> mCompiles;
+	std::unordered_map<std::string, std::size_t> mCompileIndices; // by RequestString
+	std::unordered_map<std::string, std::size_t> mShaders;        // name -> mCompiles index
+	std::vector<Task> mTasks;
+
+	std::exception_ptr mError;
+};
@@ -0,0 +1,314 @@
+//***************************************************************************************
+// ShaderCache.cpp
+//***************************************************************************************
+
+#include "ShaderCache.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	// Bump when the key or the entry layout changes.
+	const ShaderCache::uint32 EntryMagic = 0x31434853; // "SHC1"
+
+	struct EntryHeader
+	{
+		ShaderCache::uint32 Magic;
+		ShaderCache::uint32 Size;
+		ShaderCache::uint64 Key;
+		ShaderCache::uint64 Checksum;
+	};
+
+	bool ReadFileText(const std::string& filename, std::string& text)
+	{
+		std::ifstream fin(filename, std::ios::binary);
+		if(!fin)
+			return false;
+
+		std::ostringstream ss;
+		ss << fin.rdbuf();
+		text = ss.str();
+		return true;
+	}
+
+	std::string DirectoryOf(const std::string& filename)
+	{
+		std::size_t slash = filename.find_last_of("/\\");
+		return slash == std::string::npos ? std::string() : filename.substr(0, slash + 1);
+	}
+
+	// Names of the files included by an HLSL source, in order.  Preprocessor conditions
+	// are not evaluated, so a file that is only included in some permutations is hashed
+	// by all of them; that costs a recompile when it changes, never a stale result.
+	std::vector<std::string> FindIncludes(const std::string& source)
+	{
+		std::vector<std::string> includes;
+
+		std::istringstream lines(source);
+		std::string line;
+		while(std::getline(lines, line))
+		{
+			std::size_t i = line.find_first_not_of(" \t");
+			if(i == std::string::npos || line[i] != '#')
+				continue;
+
+			i = line.find_first_not_of(" \t", i + 1);
+			if(i == std::string::npos || line.compare(i, 7, "include") != 0)
+				continue;
+
+			std::size_t open = line.find_first_of("\"<", i + 7);
+			if(open == std::string::npos)
+				continue;
+
+			std::size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+			if(close != std::string::npos)
+				includes.push_back(line.substr(open + 1, close - open - 1));
+		}
+
+		return includes;
+	}
+
+	ShaderCache::uint64 HashString(const std::string& s, ShaderCache::uint64 hash)
+	{
+		// The length keeps ("ab", "c") and ("a", "bc") apart.
+		ShaderCache::uint64 size = s.size();
+		hash = ShaderCache::Hash(&size, sizeof(size), hash);
+		return ShaderCache::Hash(s.data(), s.size(), hash);
+	}
+}
+
+ShaderCache::ShaderCache(Compiler* compiler, const std::string& directory) :
+	mCompiler(compiler),
+	mDirectory(directory)
+{
+	if(!mDirectory.empty() && mDirectory.back() != '/' && mDirectory.back() != '\\')
+		mDirectory += '/';
+}
+
+std::shared_ptr<const ShaderCache::ByteCode> ShaderCache::Get(const Request& request)
+{
+	uint64 key = ComputeKey(request);
+
+	std::promise<std::shared_ptr<const ByteCode>> promise;
+	{
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		auto it = mEntries.find(key);
+		if(it != mEntries.end())
+		{
+			mStats.MemoryHits++;
+			auto entry = it->second;
+			lock.unlock();
+
+			// Waits if another thread is still compiling the shader.
+			return entry.get();
+		}
+
+		mEntries[key] = promise.get_future().share();
+	}
+
+	try
+	{
+		auto byteCode = std::make_shared<ByteCode>();
+
+		bool fromDisk = !mDirectory.empty() && ReadEntry(key, *byteCode);
+		bool written = true;
+		if(!fromDisk)
+		{
+			*byteCode = mCompiler->Compile(request);
+
+			if(!mDirectory.empty())
+				written = WriteEntry(key, *byteCode);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if(fromDisk)
+				mStats.DiskHits++;
+			else
+				mStats.Compiles++;
+			if(!written)
+				mStats.FailedWrites++;
+			if(!mDirectory.empty())
+				mDiskKeys.push_back(key);
+		}
+
+		promise.set_value(byteCode);
+		return byteCode;
+	}
+	catch(...)
+	{
+		// Let the waiting threads see the error, and let a later call try again.
+		promise.set_exception(std::current_exception());
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mEntries.erase(key);
+		}
+		throw;
+	}
+}
+
+ShaderCache::uint64 ShaderCache::ComputeKey(const Request& request)const
+{
+	uint64 hash = Hash(&EntryMagic, sizeof(EntryMagic));
+	hash = HashString(mCompiler->Version(), hash);
+
+	std::vector<std::string> visited;
+	hash = HashFile(request.Filename, hash, visited);
+
+	uint64 numDefines = request.Defines.size();
+	hash = Hash(&numDefines, sizeof(numDefines), hash);
+	for(const Define& define : request.Defines)
+	{
+		hash = HashString(define.Name, hash);
+		hash = HashString(define.Value, hash);
+	}
+
+	hash = HashString(request.EntryPoint, hash);
+	hash = HashString(request.Target, hash);
+	hash = Hash(&request.Flags, sizeof(request.Flags), hash);
+
+	return hash;
+}
+
+void ShaderCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	for(uint64 key : mDiskKeys)
+		std::remove(EntryPath(key).c_str());
+
+	mDiskKeys.clear();
+
+	// Entries still being compiled are kept; their callers hold the futures.
+	for(auto it = mEntries.begin(); it != mEntries.end();)
+	{
+		if(it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			it = mEntries.erase(it);
+		else
+			++it;
+	}
+}
+
+ShaderCache::Stats ShaderCache::GetStats()const
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mStats;
+}
+
+ShaderCache::uint64 ShaderCache::Hash(const void* data, std::size_t size, uint64 hash)
+{
+	const uint8* bytes = static_cast<const uint8*>(data);
+	for(std::size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::string ShaderCache::EntryPath(uint64 key)const
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)key);
+	return mDirectory + name;
+}
+
+bool ShaderCache::ReadEntry(uint64 key, ByteCode& byteCode)const
+{
+	std::ifstream fin(EntryPath(key), std::ios::binary | std::ios::ate);
+	if(!fin)
+		return false;
+
+	std::streamoff fileSize = fin.tellg();
+	fin.seekg(0);
+
+	// A corrupt Size is checked against the file before it sizes the allocation.
+	EntryHeader header;
+	if(!fin.read((char*)&header, sizeof(header)) ||
+	   header.Magic != EntryMagic || header.Key != key ||
+	   (std::streamoff)header.Size != fileSize - (std::streamoff)sizeof(header))
+		return false;
+
+	byteCode.resize(header.Size);
+	if(!fin.read((char*)byteCode.data(), header.Size) ||
+	   Hash(byteCode.data(), byteCode.size()) != header.Checksum)
+	{
+		byteCode.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool ShaderCache::WriteEntry(uint64 key, const ByteCode& byteCode)const
+{
+	// A name no other writer uses, so that concurrent writers of the same entry (from
+	// this or another process) never write into the same file.
+	static const uint32 processNonce = std::random_device()();
+	static std::atomic<uint32> counter(0);
+	std::ostringstream tempName;
+	tempName << EntryPath(key) << '.' << std::hex << processNonce << '.' << counter++ << ".tmp";
+	std::string tempPath = tempName.str();
+
+	EntryHeader header;
+	header.Magic = EntryMagic;
+	header.Size = (uint32)byteCode.size();
+	header.Key = key;
+	header.Checksum = Hash(byteCode.data(), byteCode.size());
+
+	{
+		std::ofstream fout(tempPath, std::ios::binary);
+		fout.write((const char*)&header, sizeof(header));
+		fout.write((const char*)byteCode.data(), byteCode.size());
+		if(!fout)
+		{
+			fout.close();
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace an existing file on Windows.  If another writer got
+	// there first it wrote the same bytecode, so its entry is kept.
+	std::string path = EntryPath(key);
+	if(std::rename(tempPath.c_str(), path.c_str()) != 0)
+	{
+		std::remove(tempPath.c_str());
+		std::ifstream existing(path, std::ios::binary);
+		return existing.good();
+	}
+
+	return true;
+}
+
+ShaderCache::uint64 ShaderCache::HashFile(const std::string& filename, uint64 hash,
+	std::vector<std::string>& visited)const
+{
+	hash = HashString(filename, hash);
+
+	if(std::find(visited.begin(), visited.end(), filename) != visited.end())
+		return hash;
+	visited.push_back(filename);
+
+	std::string source;
+	if(!ReadFileText(filename, source))
+	{
+		// Hash the missing file as empty; the compiler reports the error.
+		return Hash("", 0, hash);
+	}
+
+	hash = HashString(source, hash);
+
+	// The standard include handler looks next to the including file.
+	std::string directory = DirectoryOf(filename);
+	for(const std::string& include : FindIncludes(source))
+		hash = HashFile(directory + include, hash, visited);
+
+	return hash;
+}
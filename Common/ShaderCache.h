@@ -0,0 +1,117 @@
+//***************************************************************************************
+// ShaderCache.h
+//
+// Keeps compiled shader bytecode on disk so that a shader is compiled once, not on
+// every launch.  An entry is keyed by a hash of everything that affects the output:
+//
+//   - the source file and, transitively, every file it #includes,
+//   - the macro definitions,
+//   - the entry point, the target and the compile flags,
+//   - the compiler version.
+//
+// Editing any of them produces a new key, so stale entries are never returned; they
+// stay on disk until Clear() is called.
+//
+// The cache can be used from several threads.  Requests with the same key that
+// arrive while the shader is being compiled wait for that compile instead of
+// starting their own.  Entries are written to a temporary file and renamed, so other
+// processes never see a partial entry, and entries that fail their checksum are
+// treated as misses.
+//
+// The compiler is an interface (d3dUtil implements it over D3DCompileFromFile), and
+// the class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ShaderCache
+{
+public:
+
+	using uint8 = std::uint8_t;
+	using uint32 = std::uint32_t;
+	using uint64 = std::uint64_t;
+
+	using ByteCode = std::vector<uint8>;
+
+	struct Define
+	{
+		std::string Name;
+		std::string Value;
+	};
+
+	struct Request
+	{
+		std::string Filename;
+		std::vector<Define> Defines;
+		std::string EntryPoint;
+		std::string Target;
+		uint32 Flags = 0;
+	};
+
+	class Compiler
+	{
+	public:
+		virtual ~Compiler() = default;
+
+		// Part of every key, so that a new compiler does not reuse old bytecode.
+		virtual std::string Version()const = 0;
+
+		// Throws on failure.  May be called from several threads at once.
+		virtual ByteCode Compile(const Request& request) = 0;
+	};
+
+	struct Stats
+	{
+		uint64 MemoryHits = 0;
+		uint64 DiskHits = 0;
+		uint64 Compiles = 0;
+		uint64 FailedWrites = 0;
+	};
+
+	// The directory must exist.  An empty directory keeps the entries in memory only.
+	ShaderCache(Compiler* compiler, const std::string& directory);
+	ShaderCache(const ShaderCache& rhs) = delete;
+	ShaderCache& operator=(const ShaderCache& rhs) = delete;
+
+	// Returns the bytecode from memory, from disk, or by compiling the shader.
+	// Rethrows the compiler's exception if the shader does not compile.
+	std::shared_ptr<const ByteCode> Get(const Request& request);
+
+	// Hash of the request and the current contents of its files.
+	uint64 ComputeKey(const Request& request)const;
+
+	// Forgets the entries in memory and deletes the ones on disk.
+	void Clear();
+
+	Stats GetStats()const;
+
+	// 64-bit FNV-1a.
+	static uint64 Hash(const void* data, std::size_t size, uint64 hash = 14695981039346656037ull);
+
+private:
+	std::string EntryPath(uint64 key)const;
+
+	bool ReadEntry(uint64 key, ByteCode& byteCode)const;
+	bool WriteEntry(uint64 key, const ByteCode& byteCode)const;
+
+	// Hashes the file and the files it includes; visited guards against include cycles.
+	uint64 HashFile(const std::string& filename, uint64 hash, std::vector<std::string>& visited)const;
+
+private:
+	Compiler* mCompiler = nullptr;
+	std::string mDirectory;
+
+	mutable std::mutex mMutex;
+	std::unordered_map<uint64, std::shared_future<std::shared_ptr<const ByteCode>>> mEntries;
+	std::vector<uint64> mDiskKeys;
+	Stats mStats;
+};
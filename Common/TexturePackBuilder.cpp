@@ -0,0 +1,208 @@
+//***************************************************************************************
+// TexturePackBuilder.cpp
+//***************************************************************************************
+
+#include "TexturePackBuilder.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	UINT64 AlignUp(UINT64 value, UINT64 alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+bool TexturePackBuilder::Describe(const DDSTextureData12& data, TexturePacker::TextureDesc& desc)
+{
+	if(data.Desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D ||
+	   data.Desc.DepthOrArraySize != 1 || data.IsCubeMap || data.Footprints.empty())
+		return false;
+
+	desc.Format = (TexturePacker::uint32)data.Desc.Format;
+	desc.Width = (TexturePacker::uint32)data.Desc.Width;
+	desc.Height = data.Desc.Height;
+	desc.MipLevels = data.Desc.MipLevels;
+
+	// The footprint height is rounded up to whole blocks.
+	desc.BlockSize = data.Footprints[0].Footprint.Height / data.NumRows[0];
+
+	return true;
+}
+
+std::unique_ptr<PackedTexturePage> TexturePackBuilder::BuildPage(const TexturePacker& packer, UINT page,
+	const std::vector<const DDSTextureData12*>& textures)
+{
+	auto result = std::make_unique<PackedTexturePage>();
+
+	const TexturePacker::Page& p = packer.GetPages()[page];
+	if(p.Type == TexturePacker::PageType::Atlas)
+		BuildAtlas(packer, p, textures, *result);
+	else
+		BuildSlices(p, textures, *result);
+
+	return result;
+}
+
+D3D12_SHADER_RESOURCE_VIEW_DESC TexturePackBuilder::GetSrvDesc(const PackedTexturePage& page)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = page.Data.Desc.Format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+	srvDesc.Texture2DArray.MostDetailedMip = 0;
+	srvDesc.Texture2DArray.MipLevels = page.Data.Desc.MipLevels;
+	srvDesc.Texture2DArray.FirstArraySlice = 0;
+	srvDesc.Texture2DArray.ArraySize = page.Data.Desc.DepthOrArraySize;
+	srvDesc.Texture2DArray.PlaneSlice = 0;
+	srvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
+
+	return srvDesc;
+}
+
+void TexturePackBuilder::BuildSlices(const TexturePacker::Page& page,
+	const std::vector<const DDSTextureData12*>& textures, PackedTexturePage& result)
+{
+	const DDSTextureData12& first = *textures[page.Textures[0]];
+
+	DDSTextureData12& data = result.Data;
+	data.Desc = first.Desc;
+	data.Desc.DepthOrArraySize = (UINT16)page.Textures.size();
+	data.AlphaMode = first.AlphaMode;
+
+	// The slices are laid out one after the other, which is the subresource order
+	// of an array (slice major), so each one keeps its own data and layout.
+	UINT64 offset = 0;
+	for(TexturePacker::uint32 i : page.Textures)
+	{
+		const DDSTextureData12& t = *textures[i];
+		offset = AlignUp(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+		for(size_t k = 0; k < t.Subresources.size(); ++k)
+		{
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout = t.Footprints[k];
+			layout.Offset += offset;
+
+			data.Subresources.push_back(t.Subresources[k]);
+			data.Footprints.push_back(layout);
+			data.NumRows.push_back(t.NumRows[k]);
+			data.RowSizesInBytes.push_back(t.RowSizesInBytes[k]);
+		}
+
+		offset += t.UploadBufferSize;
+	}
+
+	data.UploadBufferSize = offset;
+}
+
+void TexturePackBuilder::BuildAtlas(const TexturePacker& packer, const TexturePacker::Page& page,
+	const std::vector<const DDSTextureData12*>& textures, PackedTexturePage& result)
+{
+	const DDSTextureData12& first = *textures[page.Textures[0]];
+	const UINT block = page.BlockSize;
+
+	UINT firstBlocksAcross = (UINT)((first.Desc.Width + block - 1) / block);
+	const UINT64 bytesPerBlock = first.RowSizesInBytes[0] / firstBlocksAcross;
+
+	DDSTextureData12& data = result.Data;
+	data.Desc = first.Desc;
+	data.Desc.Width = page.Width;
+	data.Desc.Height = page.Height;
+	data.Desc.MipLevels = (UINT16)page.MipLevels;
+	data.Desc.DepthOrArraySize = 1;
+	data.AlphaMode = first.AlphaMode;
+
+	data.Subresources.resize(page.MipLevels);
+	data.Footprints.resize(page.MipLevels);
+	data.NumRows.resize(page.MipLevels);
+	data.RowSizesInBytes.resize(page.MipLevels);
+
+	// Tightly packed pixels in Storage, aligned footprints for the upload buffer.
+	std::vector<size_t> storageOffsets(page.MipLevels);
+	size_t storageSize = 0;
+	UINT64 uploadOffset = 0;
+	for(UINT m = 0; m < page.MipLevels; ++m)
+	{
+		UINT w = std::max<UINT>(page.Width >> m, 1);
+		UINT h = std::max<UINT>(page.Height >> m, 1);
+		UINT numRows = (h + block - 1) / block;
+		UINT64 rowBytes = (w + block - 1) / block * bytesPerBlock;
+
+		storageOffsets[m] = storageSize;
+		storageSize += (size_t)(rowBytes * numRows);
+
+		uploadOffset = AlignUp(uploadOffset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = data.Footprints[m];
+		layout.Offset = uploadOffset;
+		layout.Footprint.Format = data.Desc.Format;
+		layout.Footprint.Width = (w + block - 1) / block * block;
+		layout.Footprint.Height = numRows * block;
+		layout.Footprint.Depth = 1;
+		layout.Footprint.RowPitch = (UINT)AlignUp(rowBytes, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+		data.NumRows[m] = numRows;
+		data.RowSizesInBytes[m] = rowBytes;
+		data.Subresources[m].RowPitch = (LONG_PTR)rowBytes;
+		data.Subresources[m].SlicePitch = (LONG_PTR)(rowBytes * numRows);
+
+		uploadOffset += UINT64(layout.Footprint.RowPitch) * numRows;
+	}
+	data.UploadBufferSize = uploadOffset;
+
+	// Texels the tiles do not cover stay black.
+	result.Storage.assign(storageSize, 0);
+	for(UINT m = 0; m < page.MipLevels; ++m)
+		data.Subresources[m].pData = result.Storage.data() + storageOffsets[m];
+
+	// The packer only keeps the mips in which every tile and its gutter start on a
+	// block boundary of the same mip of the atlas.
+	for(TexturePacker::uint32 i : page.Textures)
+	{
+		const DDSTextureData12& t = *textures[i];
+		const TexturePacker::Placement& p = packer.GetPlacement(i);
+
+		for(UINT m = 0; m < page.MipLevels; ++m)
+		{
+			const D3D12_SUBRESOURCE_DATA& src = t.Subresources[m];
+			const UINT64 dstRowBytes = data.RowSizesInBytes[m];
+			const size_t tileRowBytes = (size_t)t.RowSizesInBytes[m];
+			const UINT tileRows = t.NumRows[m];
+			const UINT borderBlocks = (page.Border >> m) / block;
+
+			std::uint8_t* dst = result.Storage.data() + storageOffsets[m] +
+				(p.Y >> m) / block * dstRowBytes + (p.X >> m) / block * bytesPerBlock;
+
+			for(UINT row = 0; row < tileRows; ++row)
+			{
+				std::uint8_t* dstRow = dst + row * dstRowBytes;
+				std::memcpy(dstRow,
+					static_cast<const std::uint8_t*>(src.pData) + row * src.RowPitch,
+					tileRowBytes);
+
+				// Repeat the first and last block column into the side gutters.
+				for(UINT k = 1; k <= borderBlocks; ++k)
+				{
+					std::memcpy(dstRow - k * bytesPerBlock, dstRow, (size_t)bytesPerBlock);
+					std::memcpy(dstRow + tileRowBytes + (k - 1) * bytesPerBlock,
+						dstRow + tileRowBytes - bytesPerBlock, (size_t)bytesPerBlock);
+				}
+			}
+
+			// Then the first and last block row, corners included, into the top and
+			// bottom gutters.  For block compressed formats this repeats edge blocks
+			// rather than edge texels, which still keeps the neighbours out.
+			const size_t gutterRowBytes = tileRowBytes + 2 * borderBlocks * (size_t)bytesPerBlock;
+			std::uint8_t* firstRow = dst - borderBlocks * bytesPerBlock;
+			std::uint8_t* lastRow = firstRow + (tileRows - 1) * dstRowBytes;
+			for(UINT k = 1; k <= borderBlocks; ++k)
+			{
+				std::memcpy(firstRow - k * dstRowBytes, firstRow, gutterRowBytes);
+				std::memcpy(lastRow + k * dstRowBytes, lastRow, gutterRowBytes);
+			}
+		}
+	}
+}
@@ -0,0 +1,46 @@
+//***************************************************************************************
+// TexturePackBuilder.h
+//
+// Builds the pages planned by a TexturePacker from parsed DDS files, entirely on the
+// CPU.  The result is a DDSTextureData12 that is uploaded like any other texture
+// (CreateDDSTextureFromData12 or UploadRing::CreateTexture).
+//
+// Array and single pages point into the source textures' data, so the sources must
+// stay alive until the page has been uploaded.  Atlas pages copy the tiles into
+// storage of their own and repeat each tile's edge into its gutter.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSTextureLoader.h"
+#include "TexturePacker.h"
+#include <memory>
+
+struct PackedTexturePage
+{
+	DirectX::DDSTextureData12 Data;
+
+	// Pixels of an atlas page; empty otherwise.
+	std::vector<std::uint8_t> Storage;
+};
+
+class TexturePackBuilder
+{
+public:
+	// Describes a parsed texture for TexturePacker::Add.  Only 2D textures with a single
+	// slice and a precomputed upload layout can be packed; returns false otherwise.
+	static bool Describe(const DirectX::DDSTextureData12& data, TexturePacker::TextureDesc& desc);
+
+	// textures[i] is the texture added to the packer with id i.
+	static std::unique_ptr<PackedTexturePage> BuildPage(const TexturePacker& packer, UINT page,
+		const std::vector<const DirectX::DDSTextureData12*>& textures);
+
+	// SRV for a page, as a Texture2DArray so that shaders index every page the same way.
+	static D3D12_SHADER_RESOURCE_VIEW_DESC GetSrvDesc(const PackedTexturePage& page);
+
+private:
+	static void BuildSlices(const TexturePacker::Page& page,
+		const std::vector<const DirectX::DDSTextureData12*>& textures, PackedTexturePage& result);
+	static void BuildAtlas(const TexturePacker& packer, const TexturePacker::Page& page,
+		const std::vector<const DirectX::DDSTextureData12*>& textures, PackedTexturePage& result);
+};
@@ -0,0 +1,272 @@
+//***************************************************************************************
+// TexturePacker.cpp
+//***************************************************************************************
+
+#include "TexturePacker.h"
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	TexturePacker::uint32 NextPow2(TexturePacker::uint32 x)
+	{
+		TexturePacker::uint32 p = 1;
+		while(p < x)
+			p <<= 1;
+		return p;
+	}
+
+	// Number of mips, starting with a size of x texels, in which the size halves
+	// exactly and stays a whole number of blocks.
+	TexturePacker::uint32 ExactMips(TexturePacker::uint32 x, TexturePacker::uint32 blockSize)
+	{
+		if(x % blockSize != 0)
+			return 1;
+
+		TexturePacker::uint32 n = 1;
+		for(x /= blockSize; x % 2 == 0; x /= 2)
+			++n;
+		return n;
+	}
+}
+
+TexturePacker::TexturePacker(uint32 maxAtlasSize, uint32 maxAtlasTileSize, uint32 maxArraySize,
+	uint32 atlasBorder) :
+	mMaxAtlasSize(NextPow2(maxAtlasSize)),
+	mMaxAtlasTileSize(std::min(maxAtlasTileSize, maxAtlasSize / 2)),
+	mMaxArraySize(std::max(maxArraySize, 1u)),
+	mAtlasBorder(atlasBorder)
+{
+}
+
+TexturePacker::uint32 TexturePacker::Add(const TextureDesc& desc)
+{
+	assert(desc.Width > 0 && desc.Height > 0 && desc.MipLevels > 0 && desc.BlockSize > 0);
+
+	mTextures.push_back(desc);
+	return (uint32)mTextures.size() - 1;
+}
+
+void TexturePacker::Build()
+{
+	mPages.clear();
+	mPlacements.assign(mTextures.size(), Placement());
+
+	// Atlas candidates grouped by format, in the order the formats first appear.
+	std::vector<std::vector<uint32>> atlasGroups;
+	std::vector<uint32> rest;
+	for(uint32 i = 0; i < (uint32)mTextures.size(); ++i)
+	{
+		const TextureDesc& t = mTextures[i];
+		if(!t.AllowAtlas || t.Width > mMaxAtlasTileSize || t.Height > mMaxAtlasTileSize ||
+		   NextPow2(std::max(t.Width, t.Height) + 2*AtlasBorder(t.BlockSize)) > mMaxAtlasSize)
+		{
+			rest.push_back(i);
+			continue;
+		}
+
+		auto group = std::find_if(atlasGroups.begin(), atlasGroups.end(), [&](const std::vector<uint32>& g)
+		{
+			const TextureDesc& first = mTextures[g[0]];
+			return first.Format == t.Format && first.BlockSize == t.BlockSize;
+		});
+
+		if(group == atlasGroups.end())
+			atlasGroups.push_back({ i });
+		else
+			group->push_back(i);
+	}
+
+	// A lone small texture gains nothing from an atlas.
+	for(auto it = atlasGroups.begin(); it != atlasGroups.end();)
+	{
+		if(it->size() < 2)
+		{
+			rest.push_back((*it)[0]);
+			it = atlasGroups.erase(it);
+		}
+		else
+			++it;
+	}
+	std::sort(rest.begin(), rest.end());
+
+	BuildArrays(rest);
+
+	for(const auto& g : atlasGroups)
+		BuildAtlases(g);
+}
+
+TexturePacker::uint32 TexturePacker::NumTextures()const
+{
+	return (uint32)mTextures.size();
+}
+
+const std::vector<TexturePacker::Page>& TexturePacker::GetPages()const
+{
+	return mPages;
+}
+
+const TexturePacker::Placement& TexturePacker::GetPlacement(uint32 texture)const
+{
+	return mPlacements[texture];
+}
+
+void TexturePacker::BuildAtlases(const std::vector<uint32>& textures)
+{
+	const uint32 blockSize = mTextures[textures[0]].BlockSize;
+	const uint32 border = AtlasBorder(blockSize);
+
+	auto cellSize = [&](uint32 i)
+	{
+		const TextureDesc& t = mTextures[i];
+		return NextPow2(std::max(std::max(t.Width, t.Height) + 2*border, blockSize));
+	};
+
+	// Largest cells first.  Every cell is then a power of two no larger than the
+	// ones placed before it, so the shelf cursor is always a multiple of its size.
+	std::vector<uint32> order(textures);
+	std::stable_sort(order.begin(), order.end(), [&](uint32 a, uint32 b)
+	{
+		return cellSize(a) > cellSize(b);
+	});
+
+	std::vector<uint32> tiles;
+	uint32 x = 0;
+	uint32 y = 0;
+	uint32 rowHeight = 0;
+	uint32 usedWidth = 0;
+
+	auto flush = [&]()
+	{
+		uint32 width = NextPow2(usedWidth);
+		uint32 height = NextPow2(y + rowHeight);
+
+		// Keep the mips in which every tile and the gutter still halve exactly into
+		// whole blocks.  Past that a tile's mip is rounded, no longer lines up with
+		// its scale and offset, and would overwrite the gutter.
+		uint32 mipLevels = border > 0 ? ExactMips(border, blockSize) : ~0u;
+		for(uint32 i : tiles)
+		{
+			const TextureDesc& t = mTextures[i];
+			uint32 tileMips = std::min(ExactMips(t.Width, blockSize), ExactMips(t.Height, blockSize));
+			mipLevels = std::min(mipLevels, std::min(tileMips, t.MipLevels));
+		}
+
+		AddPage(PageType::Atlas, tiles, width, height, mipLevels);
+		mPages.back().BlockSize = blockSize;
+		mPages.back().Border = border;
+
+		for(uint32 i : tiles)
+		{
+			Placement& p = mPlacements[i];
+			p.Width = mTextures[i].Width;
+			p.Height = mTextures[i].Height;
+			p.ScaleU = (float)p.Width / width;
+			p.ScaleV = (float)p.Height / height;
+			p.OffsetU = (float)p.X / width;
+			p.OffsetV = (float)p.Y / height;
+		}
+
+		tiles.clear();
+		x = y = rowHeight = usedWidth = 0;
+	};
+
+	for(uint32 i : order)
+	{
+		uint32 cell = cellSize(i);
+
+		if(x + cell > mMaxAtlasSize)
+		{
+			y += rowHeight;
+			x = 0;
+			rowHeight = 0;
+		}
+
+		if(y + cell > mMaxAtlasSize)
+			flush();
+
+		mPlacements[i].X = x + border;
+		mPlacements[i].Y = y + border;
+		tiles.push_back(i);
+
+		rowHeight = std::max(rowHeight, cell);
+		x += cell;
+		usedWidth = std::max(usedWidth, x);
+	}
+
+	if(!tiles.empty())
+		flush();
+}
+
+void TexturePacker::BuildArrays(const std::vector<uint32>& textures)
+{
+	std::vector<bool> done(mTextures.size(), false);
+
+	for(uint32 i : textures)
+	{
+		if(done[i])
+			continue;
+
+		const TextureDesc& t = mTextures[i];
+
+		std::vector<uint32> slices;
+		for(uint32 j : textures)
+		{
+			const TextureDesc& u = mTextures[j];
+			if(done[j] || u.Format != t.Format || u.Width != t.Width ||
+			   u.Height != t.Height || u.MipLevels != t.MipLevels)
+				continue;
+
+			done[j] = true;
+			slices.push_back(j);
+
+			if(slices.size() == mMaxArraySize)
+			{
+				AddPage(PageType::Array, slices, t.Width, t.Height, t.MipLevels);
+				slices.clear();
+			}
+		}
+
+		if(!slices.empty())
+		{
+			PageType type = slices.size() > 1 ? PageType::Array : PageType::Single;
+			AddPage(type, slices, t.Width, t.Height, t.MipLevels);
+		}
+	}
+}
+
+TexturePacker::uint32 TexturePacker::AtlasBorder(uint32 blockSize)const
+{
+	return (mAtlasBorder + blockSize - 1) / blockSize * blockSize;
+}
+
+void TexturePacker::AddPage(PageType type, const std::vector<uint32>& textures,
+	uint32 width, uint32 height, uint32 mipLevels)
+{
+	Page page;
+	page.Type = type;
+	page.Format = mTextures[textures[0]].Format;
+	page.Width = width;
+	page.Height = height;
+	page.MipLevels = mipLevels;
+	page.BlockSize = mTextures[textures[0]].BlockSize;
+	page.Textures = textures;
+
+	uint32 pageIndex = (uint32)mPages.size();
+	mPages.push_back(page);
+
+	for(uint32 slice = 0; slice < (uint32)textures.size(); ++slice)
+	{
+		Placement& p = mPlacements[textures[slice]];
+		p.Page = pageIndex;
+
+		if(type == PageType::Atlas)
+			continue;
+
+		p.Slice = slice;
+		p.X = 0;
+		p.Y = 0;
+		p.Width = width;
+		p.Height = height;
+	}
+}
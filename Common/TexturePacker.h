@@ -0,0 +1,119 @@
+//***************************************************************************************
+// TexturePacker.h
+//
+// Plans how a set of 2D textures is packed into fewer GPU textures:
+//
+//  - Small textures (no larger than MaxAtlasTileSize on either side) that share a
+//    format are packed into atlas pages.  Each one gets a UV scale/offset, to be
+//    concatenated into the material's MatTransform.  Only suits textures whose UVs
+//    stay in [0,1]; a tiling texture would sample its neighbours.
+//  - The remaining textures that share format, size and mip count become the slices
+//    of a Texture2DArray, so one descriptor covers all of them.
+//  - Whatever is left stays a texture of its own.
+//
+// Each atlas tile is surrounded by a gutter of border texels, which TexturePackBuilder
+// fills with the tile's edge so that filtering at the edge of the tile does not pick
+// up its neighbours.  A tile and its gutter take a cell whose size is a power of two,
+// placed at a multiple of that size.  The atlas only keeps the mips in which every
+// tile and gutter still halves exactly into whole blocks, so each mip of the atlas is
+// a copy of the same mip of its tiles and the UV scale/offset holds for all of them.
+//
+// Only the layout is computed here; TexturePackBuilder.h builds the pages from the
+// parsed DDS files.  The class has no Direct3D dependencies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class TexturePacker
+{
+public:
+
+	using uint32 = std::uint32_t;
+
+	struct TextureDesc
+	{
+		uint32 Format = 0;      // Only compared for equality (a DXGI_FORMAT).
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 MipLevels = 1;
+		uint32 BlockSize = 1;   // 4 for block compressed formats.
+		bool AllowAtlas = true; // false for textures sampled outside [0,1].
+	};
+
+	enum class PageType
+	{
+		Single,
+		Array,
+		Atlas
+	};
+
+	struct Page
+	{
+		PageType Type = PageType::Single;
+		uint32 Format = 0;
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 MipLevels = 1;
+		uint32 BlockSize = 1;
+
+		// Gutter around each atlas tile, in texels of mip 0; 0 otherwise.
+		uint32 Border = 0;
+
+		// Slice order for arrays; one entry per tile for atlases.
+		std::vector<uint32> Textures;
+	};
+
+	struct Placement
+	{
+		uint32 Page = 0;
+		uint32 Slice = 0;
+
+		// Texel rectangle of the texture in its atlas page (the whole page otherwise).
+		uint32 X = 0;
+		uint32 Y = 0;
+		uint32 Width = 0;
+		uint32 Height = 0;
+
+		// uv' = uv * Scale + Offset maps the texture's UVs into the page.
+		float ScaleU = 1.0f;
+		float ScaleV = 1.0f;
+		float OffsetU = 0.0f;
+		float OffsetV = 0.0f;
+	};
+
+	// atlasBorder is rounded up to whole blocks for each format.
+	explicit TexturePacker(uint32 maxAtlasSize = 1024, uint32 maxAtlasTileSize = 64,
+		uint32 maxArraySize = 2048, uint32 atlasBorder = 8);
+
+	// Returns the id used for the texture by GetPlacement().
+	uint32 Add(const TextureDesc& desc);
+
+	// Computes the pages.  Call again after adding more textures.
+	void Build();
+
+	uint32 NumTextures()const;
+	const std::vector<Page>& GetPages()const;
+	const Placement& GetPlacement(uint32 texture)const;
+
+private:
+	void BuildAtlases(const std::vector<uint32>& textures);
+	void BuildArrays(const std::vector<uint32>& textures);
+
+	uint32 AtlasBorder(uint32 blockSize)const;
+
+	void AddPage(PageType type, const std::vector<uint32>& textures,
+		uint32 width, uint32 height, uint32 mipLevels);
+
+private:
+	uint32 mMaxAtlasSize = 0;
+	uint32 mMaxAtlasTileSize = 0;
+	uint32 mMaxArraySize = 0;
+	uint32 mAtlasBorder = 0;
+
+	std::vector<TextureDesc> mTextures;
+	std::vector<Page> mPages;
+	std::vector<Placement> mPlacements;
+};
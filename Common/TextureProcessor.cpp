@@ -0,0 +1,174 @@
+//***************************************************************************************
+// TextureProcessor.cpp
+//***************************************************************************************
+
+#include "TextureProcessor.h"
+#include "BCEncoder.h"
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::uint8_t uint8;
+
+	enum class SourceFormat
+	{
+		Unsupported,
+		RGBA8,
+		BGRA8,
+		BC1,
+		BC3
+	};
+
+	SourceFormat GetSourceFormat(DXGI_FORMAT format, bool& srgb)
+	{
+		srgb = format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+			format == DXGI_FORMAT_BC1_UNORM_SRGB || format == DXGI_FORMAT_BC3_UNORM_SRGB;
+
+		switch(format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			return SourceFormat::RGBA8;
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+			return SourceFormat::BGRA8;
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			return SourceFormat::BC1;
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			return SourceFormat::BC3;
+		default:
+			return SourceFormat::Unsupported;
+		}
+	}
+
+	UINT64 AlignUp(UINT64 value, UINT64 alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	void AppendRows(std::vector<uint8>& storage, const uint8* src, UINT64 rowPitch, UINT64 rowBytes, UINT numRows)
+	{
+		for(UINT row = 0; row < numRows; ++row)
+			storage.insert(storage.end(), src + row * rowPitch, src + row * rowPitch + rowBytes);
+	}
+}
+
+bool TextureProcessor::Process(DDSTextureData12& data, std::vector<std::uint8_t>& storage, const Options& options)
+{
+	if(data.Desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || data.Desc.DepthOrArraySize != 1 ||
+	   data.IsCubeMap || data.Subresources.size() != data.Desc.MipLevels)
+		return false;
+
+	bool srgb = false;
+	SourceFormat source = GetSourceFormat(data.Desc.Format, srgb);
+	if(source == SourceFormat::Unsupported)
+		return false;
+
+	const UINT width = (UINT)data.Desc.Width;
+	const UINT height = data.Desc.Height;
+	const bool sourceCompressed = source == SourceFormat::BC1 || source == SourceFormat::BC3;
+
+	if(!options.GenerateMips || data.Desc.MipLevels != 1 || MipGenerator::NumMipLevels(width, height) == 1)
+		return false;
+
+	BCEncoder::Format bcFormat = source == SourceFormat::BC1 ? BCEncoder::Format::BC1 : BCEncoder::Format::BC3;
+
+	// Texels of the top level to filter.  The mip generator filters the channels
+	// independently, so BGRA8 needs no swizzle.
+	const D3D12_SUBRESOURCE_DATA& top = data.Subresources[0];
+	const uint8* topPixels = static_cast<const uint8*>(top.pData);
+	UINT topRowPitch = (UINT)top.RowPitch;
+
+	std::vector<uint8> topTexels;
+	if(sourceCompressed)
+	{
+		topTexels = BCEncoder::Decompress(bcFormat, topPixels, width, height);
+		topPixels = topTexels.data();
+		topRowPitch = width * 4;
+	}
+
+	MipGenerator mips(1);
+	mips.Generate(srgb ? MipGenerator::Format::RGBA8_SRGB : MipGenerator::Format::RGBA8,
+		topPixels, width, height, topRowPitch, options.Filter, options.AddressMode);
+
+	const UINT numLevels = mips.NumLevels();
+	const UINT block = sourceCompressed ? 4 : 1;
+	const UINT64 bytesPerBlock = sourceCompressed ? BCEncoder::BlockBytes(bcFormat) : 4;
+
+	BCEncoder encoder(1);
+	std::vector<size_t> storageOffsets(numLevels);
+	storage.clear();
+
+	for(UINT m = 0; m < numLevels; ++m)
+	{
+		storageOffsets[m] = storage.size();
+
+		const MipGenerator::Level& level = mips.GetLevel(m);
+		BCEncoder::Image image;
+		image.Pixels = mips.GetLevelData(m);
+		image.Width = level.Width;
+		image.Height = level.Height;
+		image.RowPitch = level.RowPitch;
+
+		if(!sourceCompressed)
+		{
+			AppendRows(storage, image.Pixels, image.RowPitch, (UINT64)image.Width * 4, image.Height);
+		}
+		else if(m == 0)
+		{
+			// Keep the original blocks rather than encoding the decoded ones again.
+			AppendRows(storage, static_cast<const uint8*>(top.pData), top.RowPitch,
+				(width + 3) / 4 * bytesPerBlock, (height + 3) / 4);
+		}
+		else
+		{
+			std::vector<uint8> blocks = encoder.Compress(bcFormat, image);
+			storage.insert(storage.end(), blocks.begin(), blocks.end());
+		}
+	}
+
+	// Describe the tightly packed levels, and their aligned layout in the upload buffer.
+	const DXGI_FORMAT outFormat = data.Desc.Format;
+	data.Desc.MipLevels = (UINT16)numLevels;
+	data.Subresources.resize(numLevels);
+	data.Footprints.resize(numLevels);
+	data.NumRows.resize(numLevels);
+	data.RowSizesInBytes.resize(numLevels);
+
+	UINT64 uploadOffset = 0;
+	for(UINT m = 0; m < numLevels; ++m)
+	{
+		UINT w = std::max(width >> m, 1u);
+		UINT h = std::max(height >> m, 1u);
+		UINT numRows = (h + block - 1) / block;
+		UINT64 rowBytes = (w + block - 1) / block * bytesPerBlock;
+
+		uploadOffset = AlignUp(uploadOffset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = data.Footprints[m];
+		layout.Offset = uploadOffset;
+		layout.Footprint.Format = outFormat;
+		layout.Footprint.Width = (w + block - 1) / block * block;
+		layout.Footprint.Height = numRows * block;
+		layout.Footprint.Depth = 1;
+		layout.Footprint.RowPitch = (UINT)AlignUp(rowBytes, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
+		data.NumRows[m] = numRows;
+		data.RowSizesInBytes[m] = rowBytes;
+		data.Subresources[m].pData = storage.data() + storageOffsets[m];
+		data.Subresources[m].RowPitch = (LONG_PTR)rowBytes;
+		data.Subresources[m].SlicePitch = (LONG_PTR)(rowBytes * numRows);
+
+		uploadOffset += UINT64(layout.Footprint.RowPitch) * numRows;
+	}
+	data.UploadBufferSize = uploadOffset;
+
+	// Nothing points into the file any more.
+	data.File.Close();
+
+	return true;
+}
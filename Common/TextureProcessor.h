@@ -0,0 +1,44 @@
+//***************************************************************************************
+// TextureProcessor.h
+//
+// CPU processing of a parsed DDS texture between LoadDDSTextureDataFromFile12 and the
+// upload, run by AsyncTextureLoader on its worker threads: textures stored with a
+// single mip level get their mip chain (MipGenerator.h).  BC1 and BC3 textures are
+// decoded, filtered and the new levels encoded back to the same format; the top
+// level keeps the original blocks.
+//
+// Block compressing uncompressed textures is left to the offline "bcbake" step of
+// Tests/Benchmarks, which writes the result as a DDS file, rather than paid again at
+// every launch.
+//
+// Only 2D textures with one slice are processed; cube maps, arrays and other formats
+// are left as they are.  A processed texture no longer points into the file mapping:
+// its subresources point into the storage vector, which must outlive the upload.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSTextureLoader.h"
+#include "MipGenerator.h"
+#include <cstdint>
+#include <vector>
+
+class TextureProcessor
+{
+public:
+	struct Options
+	{
+		bool GenerateMips = true;
+
+		MipGenerator::Filter Filter = MipGenerator::Filter::Kaiser;
+
+		// The demos sample with wrap addressing, so the mips filter across the edges.
+		MipGenerator::AddressMode AddressMode = MipGenerator::AddressMode::Wrap;
+	};
+
+	// Returns false, leaving data untouched, if there is nothing to do for the texture.
+	// Runs on the calling thread only, since the loader already spreads textures over
+	// its threads.
+	static bool Process(DirectX::DDSTextureData12& data, std::vector<std::uint8_t>& storage,
+		const Options& options);
+};
@@ -0,0 +1,292 @@
+//***************************************************************************************
+// TextureStreamingDevice.cpp
+//***************************************************************************************
+
+#include "TextureStreamingDevice.h"
+
+using Microsoft::WRL::ComPtr;
+
+TextureStreamingDevice::TextureStreamingDevice(ID3D12Device* device, ID3D12DescriptorHeap* srvHeap,
+	UINT srvDescriptorSize, UploadRing* uploadRing) :
+	md3dDevice(device),
+	mSrvHeap(srvHeap),
+	mSrvDescriptorSize(srvDescriptorSize),
+	mUploadRing(uploadRing)
+{
+}
+
+UINT TextureStreamingDevice::AddTexture(ID3D12GraphicsCommandList* cmdList,
+	std::unique_ptr<DirectX::DDSTextureData12> data, UINT firstMip,
+	UINT srvHeapIndex0, UINT srvHeapIndex1)
+{
+	// Streaming uploads one subresource at a time from the precomputed footprints,
+	// which planar formats do not have.
+	if(data->Footprints.empty())
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+
+	UINT texture = (UINT)mTextures.size();
+	mTextures.emplace_back();
+
+	StreamedTexture& t = mTextures.back();
+	t.Data = std::move(data);
+	t.FirstMip = NumMips(t);
+	t.SrvHeapIndex[0] = srvHeapIndex0;
+	t.SrvHeapIndex[1] = srvHeapIndex1;
+
+	// Reallocate flips to the other slot, so the first view lands in slot 0.
+	t.CurrSrv = 1;
+
+	mCmdList = cmdList;
+	Reallocate(t, std::min(firstMip, MaxFirstMip(texture)));
+
+	return texture;
+}
+
+std::vector<MipStreamer::uint64> TextureStreamingDevice::MipSizes(UINT texture)const
+{
+	const StreamedTexture& t = mTextures[texture];
+	const UINT numMips = NumMips(t);
+
+	std::vector<MipStreamer::uint64> sizes(numMips, 0);
+	for(UINT slice = 0; slice < NumSlices(t); ++slice)
+	{
+		for(UINT mip = 0; mip < numMips; ++mip)
+		{
+			UINT index = D3D12CalcSubresource(mip, slice, 0, numMips, NumSlices(t));
+			sizes[mip] += UINT64(t.Data->Subresources[index].SlicePitch) * t.Data->Footprints[index].Footprint.Depth;
+		}
+	}
+
+	return sizes;
+}
+
+UINT TextureStreamingDevice::MaxFirstMip(UINT texture)const
+{
+	const StreamedTexture& t = mTextures[texture];
+	const D3D12_RESOURCE_DESC& desc = t.Data->Desc;
+
+	// The footprint of a mip is padded to whole blocks; the mip can only be the top
+	// of a resource if no padding was needed.
+	for(UINT mip = NumMips(t) - 1; mip > 0; --mip)
+	{
+		const D3D12_SUBRESOURCE_FOOTPRINT& footprint = t.Data->Footprints[mip].Footprint;
+
+		UINT64 width = std::max<UINT64>(desc.Width >> mip, 1);
+		UINT height = std::max<UINT>(desc.Height >> mip, 1);
+		if(footprint.Width == width && footprint.Height == height)
+			return mip;
+	}
+
+	return 0;
+}
+
+void TextureStreamingDevice::SetCommandList(ID3D12GraphicsCommandList* cmdList)
+{
+	mCmdList = cmdList;
+}
+
+void TextureStreamingDevice::SetResidentMips(MipStreamer::uint32 texture, MipStreamer::uint32 firstMip)
+{
+	assert(mCmdList != nullptr);
+
+	StreamedTexture& t = mTextures[texture];
+	firstMip = std::min<UINT>(firstMip, MaxFirstMip(texture));
+
+	Retired retired;
+	retired.FenceValue = 0;
+	retired.Texture = texture;
+
+	if(firstMip != t.FirstMip)
+		retired.Resource = Reallocate(t, firstMip);
+
+	// Reported back to the streamer once the frame's fence passes, even if nothing
+	// had to change.
+	mCurrFrameRetired.push_back(retired);
+}
+
+UINT TextureStreamingDevice::SrvHeapIndex(UINT texture)const
+{
+	const StreamedTexture& t = mTextures[texture];
+	return t.SrvHeapIndex[t.CurrSrv];
+}
+
+ID3D12Resource* TextureStreamingDevice::Resource(UINT texture)const
+{
+	return mTextures[texture].Resource.Get();
+}
+
+UINT TextureStreamingDevice::FirstMip(UINT texture)const
+{
+	return mTextures[texture].FirstMip;
+}
+
+void TextureStreamingDevice::FinishFrame(UINT64 fenceValue)
+{
+	for(auto& retired : mCurrFrameRetired)
+	{
+		retired.FenceValue = fenceValue;
+		mRetired.push_back(retired);
+	}
+	mCurrFrameRetired.clear();
+}
+
+void TextureStreamingDevice::ReleaseCompleted(UINT64 completedFenceValue, MipStreamer& streamer)
+{
+	while(!mRetired.empty() && mRetired.front().FenceValue <= completedFenceValue)
+	{
+		UINT texture = mRetired.front().Texture;
+		mRetired.pop_front();
+
+		streamer.OnResidencyChanged(texture, mTextures[texture].FirstMip);
+	}
+}
+
+UINT TextureStreamingDevice::NumMips(const StreamedTexture& t)const
+{
+	return t.Data->Desc.MipLevels;
+}
+
+UINT TextureStreamingDevice::NumSlices(const StreamedTexture& t)const
+{
+	if(t.Data->Desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+		return 1;
+
+	return t.Data->Desc.DepthOrArraySize;
+}
+
+ComPtr<ID3D12Resource> TextureStreamingDevice::Reallocate(StreamedTexture& t, UINT firstMip)
+{
+	const D3D12_RESOURCE_DESC& fullDesc = t.Data->Desc;
+	const UINT numMips = NumMips(t);
+	const UINT numSlices = NumSlices(t);
+
+	D3D12_RESOURCE_DESC texDesc = fullDesc;
+	texDesc.Width = std::max<UINT64>(fullDesc.Width >> firstMip, 1);
+	texDesc.Height = std::max<UINT>(fullDesc.Height >> firstMip, 1);
+	if(fullDesc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+		texDesc.DepthOrArraySize = (UINT16)std::max(fullDesc.DepthOrArraySize >> firstMip, 1);
+	texDesc.MipLevels = (UINT16)(numMips - firstMip);
+
+	ComPtr<ID3D12Resource> resource;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&texDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&resource)));
+
+	// The old resource is retired after this, so it is left in the copy source state.
+	if(t.Resource != nullptr)
+	{
+		mCmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(t.Resource.Get(),
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE));
+	}
+
+	for(UINT slice = 0; slice < numSlices; ++slice)
+	{
+		for(UINT mip = firstMip; mip < numMips; ++mip)
+		{
+			UINT dstIndex = D3D12CalcSubresource(mip - firstMip, slice, 0, texDesc.MipLevels, numSlices);
+			CD3DX12_TEXTURE_COPY_LOCATION dst(resource.Get(), dstIndex);
+
+			if(t.Resource != nullptr && mip >= t.FirstMip)
+			{
+				// Already resident; copy on the GPU.
+				UINT srcIndex = D3D12CalcSubresource(mip - t.FirstMip, slice, 0, numMips - t.FirstMip, numSlices);
+				CD3DX12_TEXTURE_COPY_LOCATION src(t.Resource.Get(), srcIndex);
+				mCmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+				continue;
+			}
+
+			// Stream in from the file mapping.
+			UINT index = D3D12CalcSubresource(mip, slice, 0, numMips, numSlices);
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout = t.Data->Footprints[index];
+			UINT numRows = t.Data->NumRows[index];
+			UINT64 byteSize = UINT64(layout.Footprint.RowPitch) * numRows * layout.Footprint.Depth;
+
+			UploadRing::Allocation alloc = mUploadRing->Allocate(byteSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+			D3D12_MEMCPY_DEST dest = { alloc.CpuAddress, layout.Footprint.RowPitch, SIZE_T(layout.Footprint.RowPitch) * numRows };
+			MemcpySubresource(&dest, &t.Data->Subresources[index], (SIZE_T)t.Data->RowSizesInBytes[index],
+				numRows, layout.Footprint.Depth);
+
+			layout.Offset = alloc.Offset;
+			CD3DX12_TEXTURE_COPY_LOCATION src(alloc.Resource, layout);
+			mCmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		}
+	}
+
+	mCmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resource.Get(),
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	ComPtr<ID3D12Resource> old = t.Resource;
+	t.Resource = resource;
+	t.FirstMip = firstMip;
+
+	t.CurrSrv ^= 1;
+	CreateSrv(t, t.SrvHeapIndex[t.CurrSrv]);
+
+	return old;
+}
+
+void TextureStreamingDevice::CreateSrv(const StreamedTexture& t, UINT heapIndex)
+{
+	const D3D12_RESOURCE_DESC texDesc = t.Resource->GetDesc();
+	const UINT numSlices = NumSlices(t);
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = texDesc.Format;
+
+	switch(texDesc.Dimension)
+	{
+	case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+		if(numSlices > 1)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1DARRAY;
+			srvDesc.Texture1DArray.MipLevels = texDesc.MipLevels;
+			srvDesc.Texture1DArray.ArraySize = numSlices;
+		}
+		else
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
+			srvDesc.Texture1D.MipLevels = texDesc.MipLevels;
+		}
+		break;
+
+	case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+		if(t.Data->IsCubeMap && numSlices > 6)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBEARRAY;
+			srvDesc.TextureCubeArray.MipLevels = texDesc.MipLevels;
+			srvDesc.TextureCubeArray.NumCubes = numSlices / 6;
+		}
+		else if(t.Data->IsCubeMap)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+			srvDesc.TextureCube.MipLevels = texDesc.MipLevels;
+		}
+		else if(numSlices > 1)
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+			srvDesc.Texture2DArray.MipLevels = texDesc.MipLevels;
+			srvDesc.Texture2DArray.ArraySize = numSlices;
+		}
+		else
+		{
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MipLevels = texDesc.MipLevels;
+		}
+		break;
+
+	case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+		srvDesc.Texture3D.MipLevels = texDesc.MipLevels;
+		break;
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvHeap->GetCPUDescriptorHandleForHeapStart());
+	hDescriptor.Offset(heapIndex, mSrvDescriptorSize);
+	md3dDevice->CreateShaderResourceView(t.Resource.Get(), &srvDesc, hDescriptor);
+}
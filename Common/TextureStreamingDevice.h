@@ -0,0 +1,103 @@
+//***************************************************************************************
+// TextureStreamingDevice.h
+//
+// Direct3D 12 backend of MipStreamer.  A texture only holds its resident mips; a
+// residency change creates a new resource with the new mip range, copies the mips
+// both resources share on the GPU, uploads the missing ones from the parsed DDS file
+// (through an UploadRing) and retires the old resource once the GPU is done with it.
+//
+// Each texture owns two SRV slots that are used alternately.  The new view goes in
+// the slot frames in flight are not reading, and no further change is made until
+// the fence of the frame that recorded it has passed, so a descriptor is never
+// rewritten while the GPU may read it.  Bind SrvHeapIndex() every frame.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "MipStreamer.h"
+#include "UploadRing.h"
+#include <deque>
+
+class TextureStreamingDevice : public MipStreamer::Device
+{
+public:
+	TextureStreamingDevice(ID3D12Device* device, ID3D12DescriptorHeap* srvHeap,
+		UINT srvDescriptorSize, UploadRing* uploadRing);
+	TextureStreamingDevice(const TextureStreamingDevice& rhs) = delete;
+	TextureStreamingDevice& operator=(const TextureStreamingDevice& rhs) = delete;
+
+	// Creates the texture with mips [firstMip, MipLevels) resident and writes its view
+	// to srvHeapIndex0.  data must stay alive (it maps the file) while the texture
+	// streams.  Returns the texture id, which is also its MipStreamer id when the
+	// textures are added to both in the same order.
+	UINT AddTexture(ID3D12GraphicsCommandList* cmdList,
+		std::unique_ptr<DirectX::DDSTextureData12> data, UINT firstMip,
+		UINT srvHeapIndex0, UINT srvHeapIndex1);
+
+	// Sizes in bytes of the mips of a texture (all faces/slices), for MipStreamer::AddTexture.
+	std::vector<MipStreamer::uint64> MipSizes(UINT texture)const;
+
+	// Coarsest mip that can be the top of the texture; block compressed textures
+	// need a top mip that is a whole number of blocks.
+	UINT MaxFirstMip(UINT texture)const;
+
+	// Command list residency changes are recorded into; it must execute before any
+	// draw that uses the new SrvHeapIndex().
+	void SetCommandList(ID3D12GraphicsCommandList* cmdList);
+
+	virtual void SetResidentMips(MipStreamer::uint32 texture, MipStreamer::uint32 firstMip)override;
+
+	UINT SrvHeapIndex(UINT texture)const;
+	ID3D12Resource* Resource(UINT texture)const;
+
+	// Finest resident mip, in the mip numbering of the whole file.
+	UINT FirstMip(UINT texture)const;
+
+	// Changes recorded since the last call complete once fenceValue does.
+	void FinishFrame(UINT64 fenceValue);
+
+	// Releases the retired resources and reports the completed changes to streamer.
+	void ReleaseCompleted(UINT64 completedFenceValue, MipStreamer& streamer);
+
+private:
+	struct StreamedTexture
+	{
+		std::unique_ptr<DirectX::DDSTextureData12> Data;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		UINT FirstMip = 0;
+
+		UINT SrvHeapIndex[2] = { 0, 0 };
+		UINT CurrSrv = 0;
+
+		UINT64 PendingFence = 0;
+	};
+
+	struct Retired
+	{
+		UINT64 FenceValue;
+		UINT Texture;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+	};
+
+	UINT NumMips(const StreamedTexture& t)const;
+	UINT NumSlices(const StreamedTexture& t)const;
+
+	// Returns the replaced resource, which the GPU may still be using.
+	Microsoft::WRL::ComPtr<ID3D12Resource> Reallocate(StreamedTexture& t, UINT firstMip);
+	void CreateSrv(const StreamedTexture& t, UINT heapIndex);
+
+private:
+	ID3D12Device* md3dDevice = nullptr;
+	ID3D12DescriptorHeap* mSrvHeap = nullptr;
+	UINT mSrvDescriptorSize = 0;
+	UploadRing* mUploadRing = nullptr;
+
+	ID3D12GraphicsCommandList* mCmdList = nullptr;
+
+	std::vector<StreamedTexture> mTextures;
+
+	// Changes recorded this frame, then waiting for their fence.
+	std::vector<Retired> mCurrFrameRetired;
+	std::deque<Retired> mRetired;
+};
@@ -0,0 +1,121 @@
+//***************************************************************************************
+// TransformStore.cpp
+//***************************************************************************************
+
+#include "TransformStore.h"
+
+using namespace DirectX;
+
+UINT TransformStore::Add(const XMFLOAT4X4& world)
+{
+	UINT index = (UINT)mWorld.size();
+
+	mWorld.push_back(world);
+	mInvWorld.push_back(MathHelper::Identity4x4());
+	mInvWorldTranspose.push_back(MathHelper::Identity4x4());
+	mVersion.push_back(0);
+	mDirty.push_back(false);
+
+	UpdateDerived(index);
+
+	return index;
+}
+
+void TransformStore::Reserve(UINT count)
+{
+	mWorld.reserve(count);
+	mInvWorld.reserve(count);
+	mInvWorldTranspose.reserve(count);
+	mVersion.reserve(count);
+	mDirty.reserve(count);
+}
+
+void TransformStore::Clear()
+{
+	mWorld.clear();
+	mInvWorld.clear();
+	mInvWorldTranspose.clear();
+	mVersion.clear();
+	mDirtyList.clear();
+	mDirty.clear();
+}
+
+UINT TransformStore::Size()const
+{
+	return (UINT)mWorld.size();
+}
+
+void TransformStore::SetWorld(UINT index, const XMFLOAT4X4& world)
+{
+	assert(index < mWorld.size());
+
+	mWorld[index] = world;
+	mVersion[index]++;
+
+	if(!mDirty[index])
+	{
+		mDirty[index] = true;
+		mDirtyList.push_back(index);
+	}
+}
+
+void TransformStore::SetWorld(UINT index, FXMMATRIX world)
+{
+	XMFLOAT4X4 W;
+	XMStoreFloat4x4(&W, world);
+	SetWorld(index, W);
+}
+
+void TransformStore::Update()
+{
+	for(UINT index : mDirtyList)
+	{
+		UpdateDerived(index);
+		mDirty[index] = false;
+	}
+
+	mDirtyList.clear();
+}
+
+bool TransformStore::IsDirty(UINT index)const
+{
+	return mDirty[index];
+}
+
+UINT TransformStore::Version(UINT index)const
+{
+	return mVersion[index];
+}
+
+const XMFLOAT4X4& TransformStore::World4x4f(UINT index)const
+{
+	return mWorld[index];
+}
+
+XMMATRIX TransformStore::GetWorld(UINT index)const
+{
+	return XMLoadFloat4x4(&mWorld[index]);
+}
+
+XMMATRIX TransformStore::GetInvWorld(UINT index)const
+{
+	assert(!mDirty[index]);
+	return XMLoadFloat4x4(&mInvWorld[index]);
+}
+
+XMMATRIX TransformStore::GetInvWorldTranspose(UINT index)const
+{
+	assert(!mDirty[index]);
+	return XMLoadFloat4x4(&mInvWorldTranspose[index]);
+}
+
+void TransformStore::UpdateDerived(UINT index)
+{
+	XMMATRIX W = XMLoadFloat4x4(&mWorld[index]);
+
+	XMMATRIX invWorldTranspose;
+	XMMATRIX invWorld = MathHelper::AffineInverse(W, &invWorldTranspose);
+
+	XMStoreFloat4x4(&mInvWorld[index], invWorld);
+	XMStoreFloat4x4(&mInvWorldTranspose[index], invWorldTranspose);
+}
@@ -0,0 +1,63 @@
+//***************************************************************************************
+// TransformStore.h
+//
+// Keeps the world matrix of a set of objects together with the derived inverse-world
+// and inverse-transpose matrices.  World matrices rarely change, so the derived matrices
+// are only recomputed (with the affine fast inverse) for objects that were dirtied,
+// instead of calling XMMatrixInverse for every object every frame.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+
+class TransformStore
+{
+public:
+	TransformStore() = default;
+	TransformStore(const TransformStore& rhs) = delete;
+	TransformStore& operator=(const TransformStore& rhs) = delete;
+
+	// Adds a new object and returns its index into the store.
+	UINT Add(const DirectX::XMFLOAT4X4& world = MathHelper::Identity4x4());
+
+	void Reserve(UINT count);
+	void Clear();
+
+	UINT Size()const;
+
+	// Setting the world matrix bumps the version and marks the derived matrices dirty.
+	void SetWorld(UINT index, const DirectX::XMFLOAT4X4& world);
+	void SetWorld(UINT index, DirectX::FXMMATRIX world);
+
+	// Recompute the derived matrices of every dirty object.  Call once per frame
+	// after all SetWorld calls and before the derived matrices are read.
+	void Update();
+
+	bool IsDirty(UINT index)const;
+
+	// Incremented each time the world matrix of the object changes, so clients can
+	// tell whether data they cached from this transform (e.g. a local-space frustum)
+	// is stale.
+	UINT Version(UINT index)const;
+
+	const DirectX::XMFLOAT4X4& World4x4f(UINT index)const;
+
+	// The derived matrices are only valid when the object is not dirty.
+	DirectX::XMMATRIX GetWorld(UINT index)const;
+	DirectX::XMMATRIX GetInvWorld(UINT index)const;
+	DirectX::XMMATRIX GetInvWorldTranspose(UINT index)const;
+
+private:
+	void UpdateDerived(UINT index);
+
+private:
+	std::vector<DirectX::XMFLOAT4X4> mWorld;
+	std::vector<DirectX::XMFLOAT4X4> mInvWorld;
+	std::vector<DirectX::XMFLOAT4X4> mInvWorldTranspose;
+	std::vector<UINT> mVersion;
+
+	// Indices of the objects whose derived matrices are stale.
+	std::vector<UINT> mDirtyList;
+	std::vector<bool> mDirty;
+};
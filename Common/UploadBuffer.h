@@ -1,6 +1,7 @@
 #pragma once
 
 #include "d3dUtil.h"
+#include "WriteCombinedCopy.h"
 
 template<typename T>
 class UploadBuffer
@@ -55,6 +56,50 @@ public:
         memcpy(&mMappedData[elementIndex*mElementByteSize], &data, sizeof(T));
     }
 
+    // Size of one element in the buffer; constant buffer elements are padded to a
+    // multiple of 256 bytes.
+    UINT ElementByteSize()const
+    {
+        return mElementByteSize;
+    }
+
+    // Copies count consecutive elements starting at firstElement from data laid out
+    // like the buffer, ElementByteSize() bytes apart, as one contiguous write.
+    // Building a run of constant buffer elements at that stride lets the whole run
+    // go out in one copy instead of one per padded element.
+    void CopyPaddedRange(int firstElement, const void* data, int count)
+    {
+        CopyToWriteCombined(&mMappedData[firstElement*mElementByteSize], data, count*mElementByteSize);
+    }
+
+    // Same as the CopyData above, with non-temporal stores that write whole cache lines
+    // (see WriteCombinedCopy.h).  Use it for large per-frame updates such as instance
+    // data and dynamic vertex buffers.  Constant buffer elements are zero padded to a
+    // multiple of 64 bytes so their lines are written in full as well.
+    void CopyRange(int firstElement, const T* data, int count)
+    {
+        if(mElementByteSize == sizeof(T))
+        {
+            CopyToWriteCombined(&mMappedData[firstElement*mElementByteSize], data, count*sizeof(T));
+        }
+        else
+        {
+            const UINT paddedSize = (sizeof(T) + 63) & ~63;
+
+            // Padded copy of one element; constant buffer elements are 256 byte aligned.
+            alignas(16) BYTE element[paddedSize];
+            memset(element + sizeof(T), 0, paddedSize - sizeof(T));
+
+            // One fence for the whole range rather than one per element.
+            for(int i = 0; i < count; ++i)
+            {
+                memcpy(element, &data[i], sizeof(T));
+                StreamToWriteCombined(&mMappedData[(firstElement + i)*mElementByteSize], element, paddedSize);
+            }
+            FenceWriteCombined();
+        }
+    }
+
 private:
     Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
     BYTE* mMappedData = nullptr;
@@ -0,0 +1,148 @@
+//***************************************************************************************
+// UploadRing.cpp
+//***************************************************************************************
+
+#include "UploadRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+UploadRing::UploadRing(ID3D12Device* device, UINT64 capacity) :
+	md3dDevice(device),
+	mAllocator(capacity)
+{
+	ThrowIfFailed(device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(capacity),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&mBuffer)));
+
+	ThrowIfFailed(mBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mMappedData)));
+}
+
+UploadRing::~UploadRing()
+{
+	if(mBuffer != nullptr)
+		mBuffer->Unmap(0, nullptr);
+
+	mMappedData = nullptr;
+}
+
+UploadRing::Allocation UploadRing::Allocate(UINT64 size, UINT64 alignment)
+{
+	Allocation alloc;
+
+	UINT64 offset = mAllocator.Allocate(size, alignment);
+	if(offset != RingAllocator::InvalidOffset)
+	{
+		alloc.Resource = mBuffer.Get();
+		alloc.Offset = offset;
+		alloc.CpuAddress = mMappedData + offset;
+		alloc.GpuAddress = mBuffer->GetGPUVirtualAddress() + offset;
+		return alloc;
+	}
+
+	// The ring is full (or too small); give this upload its own resource.
+	ComPtr<ID3D12Resource> resource;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(size),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&resource)));
+
+	// Committed resources are 64KB aligned, which covers any upload alignment.  The
+	// resource stays mapped until it is released.
+	ThrowIfFailed(resource->Map(0, nullptr, reinterpret_cast<void**>(&alloc.CpuAddress)));
+
+	alloc.Resource = resource.Get();
+	alloc.Offset = 0;
+	alloc.GpuAddress = resource->GetGPUVirtualAddress();
+
+	KeepAlive(resource);
+
+	return alloc;
+}
+
+ComPtr<ID3D12Resource> UploadRing::CreateDefaultBuffer(
+	ID3D12GraphicsCommandList* cmdList,
+	const void* initData,
+	UINT64 byteSize)
+{
+	ComPtr<ID3D12Resource> defaultBuffer;
+
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(byteSize),
+		D3D12_RESOURCE_STATE_COMMON,
+		nullptr,
+		IID_PPV_ARGS(defaultBuffer.GetAddressOf())));
+
+	Allocation alloc = Allocate(byteSize, 4);
+	memcpy(alloc.CpuAddress, initData, (size_t)byteSize);
+
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
+		D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+	cmdList->CopyBufferRegion(defaultBuffer.Get(), 0, alloc.Resource, alloc.Offset, byteSize);
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(),
+		D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+	return defaultBuffer;
+}
+
+ComPtr<ID3D12Resource> UploadRing::CreateTexture(
+	ID3D12GraphicsCommandList* cmdList,
+	const DirectX::DDSTextureData12& data)
+{
+	ComPtr<ID3D12Resource> texture;
+
+	// Planar formats have no precomputed footprints; use a dedicated upload heap.
+	if(data.Footprints.empty())
+	{
+		ComPtr<ID3D12Resource> uploadHeap;
+		ThrowIfFailed(DirectX::CreateDDSTextureFromData12(md3dDevice, cmdList, data, texture, uploadHeap));
+		KeepAlive(uploadHeap);
+		return texture;
+	}
+
+	Allocation alloc = Allocate(data.UploadBufferSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	ThrowIfFailed(DirectX::CreateDDSTextureFromData12(md3dDevice, cmdList, data, texture,
+		alloc.Resource, alloc.Offset));
+
+	return texture;
+}
+
+void UploadRing::FinishFrame(UINT64 fenceValue)
+{
+	mAllocator.FinishFrame(fenceValue);
+
+	for(auto& resource : mCurrFrameResources)
+		mPendingResources.push_back({ fenceValue, resource });
+	mCurrFrameResources.clear();
+}
+
+void UploadRing::ReleaseCompleted(UINT64 completedFenceValue)
+{
+	mAllocator.ReleaseCompleted(completedFenceValue);
+
+	while(!mPendingResources.empty() && mPendingResources.front().FenceValue <= completedFenceValue)
+		mPendingResources.pop_front();
+}
+
+UINT64 UploadRing::Capacity()const
+{
+	return mAllocator.Capacity();
+}
+
+UINT64 UploadRing::UsedSize()const
+{
+	return mAllocator.UsedSize();
+}
+
+void UploadRing::KeepAlive(ComPtr<ID3D12Resource> resource)
+{
+	mCurrFrameResources.push_back(resource);
+}
@@ -0,0 +1,83 @@
+//***************************************************************************************
+// UploadRing.h
+//
+// One persistently mapped upload heap shared by all buffer and texture uploads, in
+// place of a committed upload resource per buffer/texture (VertexBufferUploader,
+// Texture::UploadHeap).  Space is sub-allocated with a RingAllocator and reclaimed
+// once the fence value passed to FinishFrame completes:
+//
+//   geo->VertexBufferGPU = uploadRing.CreateDefaultBuffer(cmdList, vertices, vbByteSize);
+//   ...
+//   mCommandQueue->Signal(mFence.Get(), ++mCurrentFence);
+//   uploadRing.FinishFrame(mCurrentFence);
+//   ...
+//   uploadRing.ReleaseCompleted(mFence->GetCompletedValue());
+//
+// Uploads that do not fit in the free part of the ring get a dedicated upload
+// resource, which is released the same way.
+//***************************************************************************************
+
+#pragma once
+
+#include "d3dUtil.h"
+#include "RingAllocator.h"
+#include <deque>
+
+class UploadRing
+{
+public:
+	struct Allocation
+	{
+		ID3D12Resource* Resource = nullptr;
+		UINT64 Offset = 0;
+		BYTE* CpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+	};
+
+	UploadRing(ID3D12Device* device, UINT64 capacity);
+	UploadRing(const UploadRing& rhs) = delete;
+	UploadRing& operator=(const UploadRing& rhs) = delete;
+	~UploadRing();
+
+	// alignment must be a power of two, e.g. D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+	// for texture data.  Never fails; falls back to a dedicated resource.
+	Allocation Allocate(UINT64 size, UINT64 alignment);
+
+	// Same as d3dUtil::CreateDefaultBuffer, but stages the data in the ring.
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateDefaultBuffer(
+		ID3D12GraphicsCommandList* cmdList,
+		const void* initData,
+		UINT64 byteSize);
+
+	// Same as DirectX::CreateDDSTextureFromData12, but stages the data in the ring.
+	Microsoft::WRL::ComPtr<ID3D12Resource> CreateTexture(
+		ID3D12GraphicsCommandList* cmdList,
+		const DirectX::DDSTextureData12& data);
+
+	// Uploads recorded since the last call are reclaimed once fenceValue completes.
+	void FinishFrame(UINT64 fenceValue);
+	void ReleaseCompleted(UINT64 completedFenceValue);
+
+	UINT64 Capacity()const;
+	UINT64 UsedSize()const;
+
+private:
+	void KeepAlive(Microsoft::WRL::ComPtr<ID3D12Resource> resource);
+
+private:
+	ID3D12Device* md3dDevice = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> mBuffer;
+	BYTE* mMappedData = nullptr;
+
+	RingAllocator mAllocator;
+
+	// Dedicated upload resources that must live until a fence passes.
+	struct PendingResource
+	{
+		UINT64 FenceValue;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+	};
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mCurrFrameResources;
+	std::deque<PendingResource> mPendingResources;
+};
@@ -0,0 +1,86 @@
+//***************************************************************************************
+// WriteCombinedCopy.h
+//
+// Copies into write-combined memory, such as a mapped upload heap, with non-temporal
+// 16 byte stores issued four at a time, so every 64 byte cache line is written in
+// full and leaves the write-combining buffers in one burst instead of being read
+// into the cache or flushed in pieces.  Only the unaligned head and tail of the
+// destination use ordinary stores.
+//
+// A loop writing many pieces calls StreamToWriteCombined for each and
+// FenceWriteCombined once at the end; CopyToWriteCombined does both for one piece.
+//
+// Never read from the destination; reads from write-combined memory are uncached.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WRITE_COMBINED_COPY_SSE2 1
+#endif
+
+// Leaves the streaming stores unordered; call FenceWriteCombined before the GPU reads.
+inline void StreamToWriteCombined(void* dst, const void* src, std::size_t byteSize)
+{
+#if defined(WRITE_COMBINED_COPY_SSE2)
+	std::uint8_t* d = static_cast<std::uint8_t*>(dst);
+	const std::uint8_t* s = static_cast<const std::uint8_t*>(src);
+
+	// Ordinary stores up to the first 16 byte boundary of the destination.
+	std::size_t head = (16 - (reinterpret_cast<std::uintptr_t>(d) & 15)) & 15;
+	if(head > byteSize)
+		head = byteSize;
+	std::memcpy(d, s, head);
+	d += head;
+	s += head;
+	byteSize -= head;
+
+	// Whole 64 byte lines.
+	while(byteSize >= 64)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+		__m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d), a);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 16), b);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 32), c);
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d + 48), e);
+		d += 64;
+		s += 64;
+		byteSize -= 64;
+	}
+
+	while(byteSize >= 16)
+	{
+		_mm_stream_si128(reinterpret_cast<__m128i*>(d),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+		d += 16;
+		s += 16;
+		byteSize -= 16;
+	}
+
+	std::memcpy(d, s, byteSize);
+#else
+	std::memcpy(dst, src, byteSize);
+#endif
+}
+
+// Makes the streaming stores visible before the GPU is told to read them.
+inline void FenceWriteCombined()
+{
+#if defined(WRITE_COMBINED_COPY_SSE2)
+	_mm_sfence();
+#endif
+}
+
+inline void CopyToWriteCombined(void* dst, const void* src, std::size_t byteSize)
+{
+	StreamToWriteCombined(dst, src, byteSize);
+	FenceWriteCombined();
+}
@@ -4,6 +4,7 @@
 
 #include "d3dApp.h"
 #include <WindowsX.h>
+#include <shellapi.h>
 
 using Microsoft::WRL::ComPtr;
 using namespace std;
@@ -17,6 +18,27 @@ MainWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     return D3DApp::GetApp()->MsgProc(hwnd, msg, wParam, lParam);
 }
 
+namespace
+{
+	HeadlessRunner::InputEvent MouseEvent(HeadlessRunner::InputEvent::Type type, WPARAM wParam, LPARAM lParam)
+	{
+		HeadlessRunner::InputEvent event;
+		event.Kind = type;
+		event.X = GET_X_LPARAM(lParam);
+		event.Y = GET_Y_LPARAM(lParam);
+		event.Buttons = (HeadlessRunner::uint32)wParam;
+		return event;
+	}
+
+	HeadlessRunner::InputEvent KeyEvent(HeadlessRunner::InputEvent::Type type, WPARAM wParam)
+	{
+		HeadlessRunner::InputEvent event;
+		event.Kind = type;
+		event.Key = (HeadlessRunner::uint32)wParam;
+		return event;
+	}
+}
+
 D3DApp* D3DApp::mApp = nullptr;
 D3DApp* D3DApp::GetApp()
 {
@@ -29,12 +51,18 @@ D3DApp::D3DApp(HINSTANCE hInstance)
     // Only one D3DApp can be constructed.
     assert(mApp == nullptr);
     mApp = this;
+
+	ParseCommandLine();
 }
 
 D3DApp::~D3DApp()
 {
-	if(md3dDevice != nullptr)
+	// Initialization may have thrown before the queue or the fence wrapper existed.
+	if(md3dDevice != nullptr && mCommandQueue != nullptr && mGpuFence != nullptr)
 		FlushCommandQueue();
+
+	if(mPsoCache != nullptr)
+		mPsoCache->Save();
 }
 
 HINSTANCE D3DApp::AppInst()const
@@ -69,8 +97,89 @@ void D3DApp::Set4xMsaaState(bool value)
     }
 }
 
+bool D3DApp::IsHeadless()const
+{
+	return mHeadless;
+}
+
+bool D3DApp::IsKeyDown(int vkeyCode)const
+{
+	if(mHeadlessRunner != nullptr)
+		return mHeadlessRunner->IsKeyDown((HeadlessRunner::uint32)vkeyCode);
+
+	if(mRecording != nullptr)
+		return vkeyCode >= 0 && vkeyCode < (int)mRecordedKeys.size() && mRecordedKeys[vkeyCode];
+
+	return d3dUtil::IsKeyDown(vkeyCode);
+}
+
+void D3DApp::OnInput(const HeadlessRunner::InputEvent& event)
+{
+	switch(event.Kind)
+	{
+	case HeadlessRunner::InputEvent::Type::MouseDown:
+		OnMouseDown(event.Buttons, event.X, event.Y);
+		break;
+	case HeadlessRunner::InputEvent::Type::MouseUp:
+		OnMouseUp(event.Buttons, event.X, event.Y);
+		break;
+	case HeadlessRunner::InputEvent::Type::MouseMove:
+		OnMouseMove(event.Buttons, event.X, event.Y);
+		break;
+	default:
+		// Keys are polled with IsKeyDown.
+		break;
+	}
+}
+
+bool D3DApp::EndFrame(const GameTimer& gt)
+{
+	if(mHeadless)
+		return true;
+
+	// Keep the window responsive; MsgProc ignores the live input.
+	MSG msg = {0};
+	while(PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
+	{
+		if(msg.message == WM_QUIT)
+			return false;
+
+		TranslateMessage(&msg);
+		DispatchMessage(&msg);
+	}
+
+	PROFILE_SCOPE(mProfiler, "Draw");
+	Draw(gt);
+	return true;
+}
+
+bool D3DApp::FilterInput(const HeadlessRunner::InputEvent& event)
+{
+	if(mHeadless || mReplay)
+		return false;
+
+	if(mRecording != nullptr)
+	{
+		bool keyDown = event.Kind == HeadlessRunner::InputEvent::Type::KeyDown;
+		if(keyDown || event.Kind == HeadlessRunner::InputEvent::Type::KeyUp)
+		{
+			// Skip auto-repeat and keys the key table does not cover.
+			if(event.Key >= mRecordedKeys.size() || mRecordedKeys[event.Key] == keyDown)
+				return true;
+			mRecordedKeys[event.Key] = keyDown;
+		}
+
+		mRecording->AddEvent(event);
+	}
+
+	return true;
+}
+
 int D3DApp::Run()
 {
+	if(mHeadless || mReplay)
+		return RunScripted();
+
 	MSG msg = {0};
  
 	mTimer.Reset();
@@ -90,9 +199,20 @@ int D3DApp::Run()
 
 			if( !mAppPaused )
 			{
+				if(mRecording != nullptr)
+					mRecording->AddFrame(mTimer.DeltaTimeNs());
+
+				mProfiler.BeginFrame();
 				CalculateFrameStats();
-				Update(mTimer);	
-                Draw(mTimer);
+				{
+					PROFILE_SCOPE(mProfiler, "Update");
+					Update(mTimer);
+				}
+				{
+					PROFILE_SCOPE(mProfiler, "Draw");
+					Draw(mTimer);
+				}
+				mProfiler.EndFrame();
 			}
 			else
 			{
@@ -101,6 +221,12 @@ int D3DApp::Run()
         }
     }
 
+	if(mRecording != nullptr)
+	{
+		std::ofstream file(mRecordingFile, std::ios::binary);
+		mRecording->Save(file);
+	}
+
 	return (int)msg.wParam;
 }
 
@@ -242,16 +368,19 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	// WM_ACTIVATE is sent when the window is activated or deactivated.  
 	// We pause the game when the window is deactivated and unpause it 
 	// when it becomes active.  
+	// A scripted run only advances by its time steps, so its timer never pauses.
 	case WM_ACTIVATE:
 		if( LOWORD(wParam) == WA_INACTIVE )
 		{
 			mAppPaused = true;
-			mTimer.Stop();
+			if(!mHeadless && !mReplay)
+				mTimer.Stop();
 		}
 		else
 		{
 			mAppPaused = false;
-			mTimer.Start();
+			if(!mHeadless && !mReplay)
+				mTimer.Start();
 		}
 		return 0;
 
@@ -316,7 +445,8 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	case WM_ENTERSIZEMOVE:
 		mAppPaused = true;
 		mResizing  = true;
-		mTimer.Stop();
+		if(!mHeadless && !mReplay)
+			mTimer.Stop();
 		return 0;
 
 	// WM_EXITSIZEMOVE is sent when the user releases the resize bars.
@@ -324,7 +454,8 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	case WM_EXITSIZEMOVE:
 		mAppPaused = false;
 		mResizing  = false;
-		mTimer.Start();
+		if(!mHeadless && !mReplay)
+			mTimer.Start();
 		OnResize();
 		return 0;
  
@@ -348,23 +479,32 @@ LRESULT D3DApp::MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	case WM_LBUTTONDOWN:
 	case WM_MBUTTONDOWN:
 	case WM_RBUTTONDOWN:
-		OnMouseDown(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		if(FilterInput(MouseEvent(HeadlessRunner::InputEvent::Type::MouseDown, wParam, lParam)))
+			OnMouseDown(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
 		return 0;
 	case WM_LBUTTONUP:
 	case WM_MBUTTONUP:
 	case WM_RBUTTONUP:
-		OnMouseUp(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		if(FilterInput(MouseEvent(HeadlessRunner::InputEvent::Type::MouseUp, wParam, lParam)))
+			OnMouseUp(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
 		return 0;
 	case WM_MOUSEMOVE:
-		OnMouseMove(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		if(FilterInput(MouseEvent(HeadlessRunner::InputEvent::Type::MouseMove, wParam, lParam)))
+			OnMouseMove(wParam, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
+		return 0;
+	case WM_KEYDOWN:
+		FilterInput(KeyEvent(HeadlessRunner::InputEvent::Type::KeyDown, wParam));
 		return 0;
     case WM_KEYUP:
+        FilterInput(KeyEvent(HeadlessRunner::InputEvent::Type::KeyUp, wParam));
         if(wParam == VK_ESCAPE)
         {
             PostQuitMessage(0);
         }
         else if((int)wParam == VK_F2)
             Set4xMsaaState(!m4xMsaaState);
+        else if((int)wParam == VK_F3)
+            WriteProfile();
 
         return 0;
 	}
@@ -406,7 +546,7 @@ bool D3DApp::InitMainWindow()
 		return false;
 	}
 
-	ShowWindow(mhMainWnd, SW_SHOW);
+	ShowWindow(mhMainWnd, mHeadless ? SW_HIDE : SW_SHOW);
 	UpdateWindow(mhMainWnd);
 
 	return true;
@@ -425,8 +565,9 @@ bool D3DApp::InitDirect3D()
 
 	ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&mdxgiFactory)));
 
-	// Try to create hardware device.
-	HRESULT hardwareResult = D3D12CreateDevice(
+	// Try to create hardware device.  Headless runs never draw, so they use WARP and
+	// do not need a GPU.
+	HRESULT hardwareResult = mHeadless ? E_FAIL : D3D12CreateDevice(
 		nullptr,             // default adapter
 		D3D_FEATURE_LEVEL_11_0,
 		IID_PPV_ARGS(&md3dDevice));
@@ -445,6 +586,10 @@ bool D3DApp::InitDirect3D()
 
 	ThrowIfFailed(md3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE,
 		IID_PPV_ARGS(&mFence)));
+	mGpuFence = std::make_unique<GpuFence>(mFence.Get());
+
+	// Relative to the working directory, like the ShaderCache.
+	mPsoCache = std::make_unique<PipelineStateCache>(md3dDevice.Get(), L"PipelineCache.bin");
 
 	mRtvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 	mDsvDescriptorSize = md3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
@@ -542,17 +687,12 @@ void D3DApp::FlushCommandQueue()
     ThrowIfFailed(mCommandQueue->Signal(mFence.Get(), mCurrentFence));
 
 	// Wait until the GPU has completed commands up to this fence point.
-    if(mFence->GetCompletedValue() < mCurrentFence)
-	{
-		HANDLE eventHandle = CreateEventEx(nullptr, false, false, EVENT_ALL_ACCESS);
-
-        // Fire event when GPU hits current fence.  
-        ThrowIfFailed(mFence->SetEventOnCompletion(mCurrentFence, eventHandle));
+	WaitForFence(mCurrentFence);
+}
 
-        // Wait until the GPU hits current fence event is fired.
-		WaitForSingleObject(eventHandle, INFINITE);
-        CloseHandle(eventHandle);
-	}
+void D3DApp::WaitForFence(UINT64 fenceValue)
+{
+	mGpuFence->Wait(fenceValue);
 }
 
 ID3D12Resource* D3DApp::CurrentBackBuffer()const
@@ -593,9 +733,13 @@ void D3DApp::CalculateFrameStats()
         wstring fpsStr = to_wstring(fps);
         wstring mspfStr = to_wstring(mspf);
 
+        // The average hides spikes, so show the 99th percentile of the last frames too.
+        wstring p99Str = to_wstring(mTimer.GetFrameTimeStats().P99Ms);
+
         wstring windowText = mMainWndCaption +
             L"    fps: " + fpsStr +
-            L"   mspf: " + mspfStr;
+            L"   mspf: " + mspfStr +
+            L"   p99: " + p99Str;
 
         SetWindowText(mhMainWnd, windowText.c_str());
 		
@@ -605,6 +749,135 @@ void D3DApp::CalculateFrameStats()
 	}
 }
 
+void D3DApp::WriteProfile()
+{
+	std::ofstream trace("Profile.json");
+	mProfiler.WriteChromeTrace(trace);
+
+	std::ostringstream summary;
+	mProfiler.WriteSummary(summary);
+	std::ofstream summaryFile("ProfileSummary.txt");
+	summaryFile << summary.str();
+
+	OutputDebugStringA(summary.str().c_str());
+}
+
+void D3DApp::ParseCommandLine()
+{
+	int argc = 0;
+	LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+	if(argv == nullptr)
+		return;
+
+	auto load = [](const wstring& filename, const char* what, std::ios::openmode mode, auto loadFunc)
+	{
+		std::ifstream file(filename, std::ios::in | mode);
+		std::string error;
+		if(!file)
+			error = "cannot open file";
+		else if(loadFunc(file, &error))
+			return;
+
+		std::string message = std::string(what) + " " + std::string(filename.begin(), filename.end()) + ": " + error;
+		MessageBoxA(nullptr, message.c_str(), "Command line", MB_OK);
+	};
+
+	bool seeded = false;
+	unsigned int seed = 0;
+	wstring replayFile;
+
+	for(int i = 1; i + 1 < argc; i += 2)
+	{
+		wstring option = argv[i];
+		wstring value = argv[i + 1];
+
+		if(option == L"-headless")
+		{
+			mHeadless = true;
+			mHeadlessSettings.NumFrames = (HeadlessRunner::uint32)_wtoi(value.c_str());
+		}
+		else if(option == L"-dt")
+			mHeadlessSettings.FixedDeltaSeconds = _wtof(value.c_str());
+		else if(option == L"-deltas")
+		{
+			load(value, "-deltas", std::ios::in, [this](std::istream& in, std::string* error)
+			{
+				return HeadlessRunner::LoadDeltas(in, mHeadlessSettings.RecordedDeltas, error);
+			});
+		}
+		else if(option == L"-input")
+		{
+			load(value, "-input", std::ios::in, [this](std::istream& in, std::string* error)
+			{
+				return HeadlessRunner::LoadInputScript(in, mHeadlessSettings.Input, error);
+			});
+		}
+		else if(option == L"-record")
+		{
+			mRecording = std::make_unique<ReplayLog>();
+			mRecordingFile = value;
+			mRecordedKeys.assign(256, false);
+		}
+		else if(option == L"-replay")
+			replayFile = value;
+		else if(option == L"-seed")
+		{
+			seeded = true;
+			seed = (unsigned int)_wtoi(value.c_str());
+		}
+		else
+			--i;
+	}
+
+	LocalFree(argv);
+
+	if(!replayFile.empty())
+	{
+		// The log decides the frames, time steps and input; nothing is recorded.
+		ReplayLog log;
+		load(replayFile, "-replay", std::ios::binary, [&log](std::istream& in, std::string* error)
+		{
+			return log.Load(in, error);
+		});
+
+		mReplay = true;
+		mRecording = nullptr;
+		mHeadlessSettings = log.ToSettings();
+		seeded = true;
+		seed = log.Seed;
+	}
+	else if(mRecording != nullptr)
+	{
+		if(!seeded)
+			seed = GetTickCount();
+		seeded = true;
+		mRecording->Seed = seed;
+	}
+
+	// Before Initialize, which may already draw random numbers.
+	if(seeded)
+		MathHelper::SeedRand(seed);
+}
+
+int D3DApp::RunScripted()
+{
+	mHeadlessRunner = std::make_unique<HeadlessRunner>(mHeadlessSettings);
+	// The runner ticks mTimer, which the demos also read outside of Update, e.g. in
+	// UpdateWaves.
+	HeadlessRunner::Results results = mHeadlessRunner->Run(*this, mTimer, &mProfiler);
+
+	std::ostringstream ss;
+	HeadlessRunner::WriteResults(ss, results);
+	std::ofstream resultsFile(mHeadless ? "HeadlessResults.txt" : "ReplayResults.txt");
+	resultsFile << ss.str();
+	OutputDebugStringA(ss.str().c_str());
+
+	WriteProfile();
+
+	mHeadlessRunner = nullptr;
+	return 0;
+}
+
 void D3DApp::LogAdapters()
 {
     UINT i = 0;
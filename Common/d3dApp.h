@@ -11,13 +11,31 @@
 
 #include "d3dUtil.h"
 #include "GameTimer.h"
+#include "HeadlessRunner.h"
+#include "ReplayLog.h"
+#include "GpuFence.h"
+#include "PipelineStateCache.h"
+#include "Profiler.h"
 
 // Link necessary d3d12 libraries.
 #pragma comment(lib,"d3dcompiler.lib")
 #pragma comment(lib, "D3D12.lib")
 #pragma comment(lib, "dxgi.lib")
-
-class D3DApp
+#pragma comment(lib, "shell32.lib")
+
+// Started with -headless <frames>, an app creates its device and resources as usual,
+// then runs Update only for that many frames, without showing the window or drawing,
+// and writes the times to HeadlessResults.txt and Profile.json.  Other options:
+//
+//   -dt <seconds>    fixed time step, 1/60 by default
+//   -deltas <file>   time step of each frame, one per line (HeadlessRunner::LoadDeltas)
+//   -input <file>    input script (HeadlessRunner::LoadInputScript)
+//
+// For runs that can be compared across builds, a windowed run started with
+// -record <file> saves its time steps, input and random seed (see ReplayLog.h), and
+// -replay <file> runs exactly those frames again, in the window or with -headless,
+// whose frame count it then ignores.  -seed <n> seeds MathHelper::RandF/Rand.
+class D3DApp : public HeadlessRunner::Client
 {
 protected:
 
@@ -38,6 +56,7 @@ public:
     void Set4xMsaaState(bool value);
 
 	int Run();
+	bool IsHeadless()const;
  
     virtual bool Initialize();
     virtual LRESULT MsgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -53,6 +72,15 @@ protected:
 	virtual void OnMouseUp(WPARAM btnState, int x, int y)  { }
 	virtual void OnMouseMove(WPARAM btnState, int x, int y){ }
 
+	// Use instead of GetAsyncKeyState, so headless runs can script the keyboard.
+	bool IsKeyDown(int vkeyCode)const;
+
+	// Forwards the scripted mouse events of a headless run to the handlers above.
+	virtual void OnInput(const HeadlessRunner::InputEvent& event) override;
+
+	// Draws the frames of a replay in the window.
+	virtual bool EndFrame(const GameTimer& gt) override;
+
 protected:
 
 	bool InitMainWindow();
@@ -62,12 +90,28 @@ protected:
 
 	void FlushCommandQueue();
 
+	// Blocks until the GPU has completed commands up to fenceValue.
+	void WaitForFence(UINT64 fenceValue);
+
 	ID3D12Resource* CurrentBackBuffer()const;
 	D3D12_CPU_DESCRIPTOR_HANDLE CurrentBackBufferView()const;
 	D3D12_CPU_DESCRIPTOR_HANDLE DepthStencilView()const;
 
 	void CalculateFrameStats();
 
+	void ParseCommandLine();
+
+	// Runs the frames of mHeadlessSettings: headless, or drawn for a replay.
+	int RunScripted();
+
+	// Records live input while recording.  Returns false if the input must be
+	// ignored because a replay drives the input.
+	bool FilterInput(const HeadlessRunner::InputEvent& event);
+
+	// Writes the profile of the last frames to Profile.json (Chrome trace) and
+	// ProfileSummary.txt.
+	void WriteProfile();
+
     void LogAdapters();
     void LogAdapterOutputs(IDXGIAdapter* adapter);
     void LogOutputDisplayModes(IDXGIOutput* output, DXGI_FORMAT format);
@@ -90,6 +134,20 @@ protected:
 
 	// Used to keep track of the delta-time and game time (4.4).
 	GameTimer mTimer;
+
+	// Markers of the last frames; Run times Update and Draw, F3 writes them out.
+	Profiler mProfiler;
+
+	bool mHeadless = false;
+	HeadlessRunner::Settings mHeadlessSettings;
+	std::unique_ptr<HeadlessRunner> mHeadlessRunner;
+
+	bool mReplay = false;
+	std::unique_ptr<ReplayLog> mRecording;
+	std::wstring mRecordingFile;
+
+	// Key state while recording, from the same messages the log records.
+	std::vector<bool> mRecordedKeys;
 	
     Microsoft::WRL::ComPtr<IDXGIFactory4> mdxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain> mSwapChain;
@@ -97,6 +155,12 @@ protected:
 
     Microsoft::WRL::ComPtr<ID3D12Fence> mFence;
     UINT64 mCurrentFence = 0;
+
+	// Waits on mFence, with one event reused by every wait.
+	std::unique_ptr<GpuFence> mGpuFence;
+
+	// Shared by every PSO of the demo, and saved to PipelineCache.bin on exit.
+	std::unique_ptr<PipelineStateCache> mPsoCache;
 	
     Microsoft::WRL::ComPtr<ID3D12CommandQueue> mCommandQueue;
     Microsoft::WRL::ComPtr<ID3D12CommandAllocator> mDirectCmdListAlloc;
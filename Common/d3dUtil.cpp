@@ -87,7 +87,61 @@ Microsoft::WRL::ComPtr<ID3D12Resource> d3dUtil::CreateDefaultBuffer(
     return defaultBuffer;
 }
 
-ComPtr<ID3DBlob> d3dUtil::CompileShader(
+namespace
+{
+	// Compiles with D3DCompileFromFile for the ShaderCache.
+	class D3DShaderCompiler : public ShaderCache::Compiler
+	{
+	public:
+		virtual std::string Version()const override
+		{
+			return "D3DCompiler_" + std::to_string(D3D_COMPILER_VERSION);
+		}
+
+		virtual ShaderCache::ByteCode Compile(const ShaderCache::Request& request) override
+		{
+			std::vector<D3D_SHADER_MACRO> defines;
+			for(const auto& define : request.Defines)
+				defines.push_back({ define.Name.c_str(), define.Value.c_str() });
+			defines.push_back({ nullptr, nullptr });
+
+			HRESULT hr = S_OK;
+
+			ComPtr<ID3DBlob> byteCode = nullptr;
+			ComPtr<ID3DBlob> errors;
+			hr = D3DCompileFromFile(AnsiToWString(request.Filename).c_str(), defines.data(),
+				D3D_COMPILE_STANDARD_FILE_INCLUDE, request.EntryPoint.c_str(), request.Target.c_str(),
+				request.Flags, 0, &byteCode, &errors);
+
+			if(errors != nullptr)
+				OutputDebugStringA((char*)errors->GetBufferPointer());
+
+			ThrowIfFailed(hr);
+
+			const std::uint8_t* data = (const std::uint8_t*)byteCode->GetBufferPointer();
+			return ShaderCache::ByteCode(data, data + byteCode->GetBufferSize());
+		}
+	};
+
+	std::string WideToAnsiString(const std::wstring& str)
+	{
+		char buffer[512];
+		WideCharToMultiByte(CP_ACP, 0, str.c_str(), -1, buffer, 512, nullptr, nullptr);
+		return std::string(buffer);
+	}
+}
+
+ShaderCache& d3dUtil::GetShaderCache()
+{
+	// Relative to the working directory, like the shader paths the demos pass in.
+	static D3DShaderCompiler compiler;
+	static ShaderCache cache(&compiler,
+		CreateDirectoryA("ShaderCache", nullptr) || GetLastError() == ERROR_ALREADY_EXISTS ?
+		"ShaderCache" : "");
+	return cache;
+}
+
+ShaderCache::Request d3dUtil::MakeShaderRequest(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
 	const std::string& entrypoint,
@@ -98,17 +152,29 @@ ComPtr<ID3DBlob> d3dUtil::CompileShader(
 	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
 #endif
 
-	HRESULT hr = S_OK;
+	ShaderCache::Request request;
+	request.Filename = WideToAnsiString(filename);
+	for(const D3D_SHADER_MACRO* define = defines; define != nullptr && define->Name != nullptr; ++define)
+		request.Defines.push_back({ define->Name, define->Definition != nullptr ? define->Definition : "" });
+	request.EntryPoint = entrypoint;
+	request.Target = target;
+	request.Flags = compileFlags;
 
-	ComPtr<ID3DBlob> byteCode = nullptr;
-	ComPtr<ID3DBlob> errors;
-	hr = D3DCompileFromFile(filename.c_str(), defines, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-		entrypoint.c_str(), target.c_str(), compileFlags, 0, &byteCode, &errors);
+	return request;
+}
 
-	if(errors != nullptr)
-		OutputDebugStringA((char*)errors->GetBufferPointer());
+ComPtr<ID3DBlob> d3dUtil::CompileShader(
+	const std::wstring& filename,
+	const D3D_SHADER_MACRO* defines,
+	const std::string& entrypoint,
+	const std::string& target)
+{
+	// Compiles the shader only if its bytecode is not cached already.
+	auto cached = GetShaderCache().Get(MakeShaderRequest(filename, defines, entrypoint, target));
 
-	ThrowIfFailed(hr);
+	ComPtr<ID3DBlob> byteCode = nullptr;
+	ThrowIfFailed(D3DCreateBlob(cached->size(), byteCode.GetAddressOf()));
+	memcpy(byteCode->GetBufferPointer(), cached->data(), cached->size());
 
 	return byteCode;
 }
@@ -28,6 +28,7 @@
 #include "d3dx12.h"
 #include "DDSTextureLoader.h"
 #include "MathHelper.h"
+#include "ShaderCache.h"
 
 extern const int gNumFrameResources;
 
@@ -121,11 +122,28 @@ public:
         UINT64 byteSize,
         Microsoft::WRL::ComPtr<ID3D12Resource>& uploadBuffer);
 
+	// Returns the bytecode from the shader cache, and compiles the shader only if it or
+	// one of the files it includes changed since it was cached.
 	static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(
 		const std::wstring& filename,
 		const D3D_SHADER_MACRO* defines,
 		const std::string& entrypoint,
 		const std::string& target);
+
+	// The cache CompileShader uses; its entries are kept in the ShaderCache directory.
+	static ShaderCache& GetShaderCache();
+
+	// What CompileShader asks the cache for, e.g. to compile on a ShaderBuildGraph.
+	static ShaderCache::Request MakeShaderRequest(
+		const std::wstring& filename,
+		const D3D_SHADER_MACRO* defines,
+		const std::string& entrypoint,
+		const std::string& target);
+
+	static D3D12_SHADER_BYTECODE ToShaderBytecode(const ShaderCache::ByteCode& byteCode)
+	{
+		return { byteCode.data(), byteCode.size() };
+	}
 };
 
 class DxException
@@ -247,6 +265,9 @@ struct Material
 	// Index into SRV heap for diffuse texture.
 	int DiffuseSrvHeapIndex = -1;
 
+	// Array slice of the diffuse texture, for textures packed into a Texture2DArray.
+	int DiffuseSrvSlice = 0;
+
 	// Index into SRV heap for normal texture.
 	int NormalSrvHeapIndex = -1;
 
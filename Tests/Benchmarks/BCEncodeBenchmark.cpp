@@ -0,0 +1,228 @@
+//***************************************************************************************
+// BCEncodeBenchmark.cpp
+//
+// Compresses the top level of the uncompressed textures in ../../Textures to each
+// format BCEncoder writes, on 1 to maxThreads threads.  Reports the throughput in
+// megapixels per second and the PSNR of the decoded blocks against the source, over
+// the channels the format stores (RGB for BC1, RG for BC5).
+//
+// BCBake is the offline ingest step built on the same encoder: it compresses every
+// mip of a RGBA8 or BGRA8 DDS file, building the mip chain first if the file has only
+// one level, and writes the result with BCEncoder::WriteDDS.
+//***************************************************************************************
+
+#include "Benchmarks.h"
+#include "BCEncoder.h"
+#include "DDSTextureLoader.h"
+#include "MipGenerator.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+	struct SourceImage
+	{
+		std::string Name;
+		std::vector<std::uint8_t> Pixels;
+		BCEncoder::Image Image;
+	};
+
+	void LoadFile(const wchar_t* filename, const std::string& name, DirectX::DDSTextureData12& data)
+	{
+		if(FAILED(DirectX::LoadDDSTextureDataFromFile12(filename, data)))
+			throw std::runtime_error("failed to load " + name);
+	}
+
+	// Tightly packed RGBA8 copy of a mip of a RGBA8 or BGRA8 texture.
+	SourceImage GetImage(const DirectX::DDSTextureData12& data, UINT mip, const std::string& name)
+	{
+		DXGI_FORMAT format = data.Desc.Format;
+		bool bgra = format == DXGI_FORMAT_B8G8R8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+		if(!bgra && format != DXGI_FORMAT_R8G8B8A8_UNORM && format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+			throw std::runtime_error(name + " is not a RGBA8 or BGRA8 texture");
+
+		SourceImage source;
+		source.Name = name;
+		source.Image.Width = std::max((BCEncoder::uint32)data.Desc.Width >> mip, 1u);
+		source.Image.Height = std::max(data.Desc.Height >> mip, 1u);
+		source.Image.RowPitch = source.Image.Width * 4;
+		source.Pixels.resize((size_t)source.Image.RowPitch * source.Image.Height);
+
+		const D3D12_SUBRESOURCE_DATA& level = data.Subresources[mip];
+		for(UINT y = 0; y < source.Image.Height; ++y)
+		{
+			const UINT8* src = static_cast<const UINT8*>(level.pData) + y * level.RowPitch;
+			UINT8* dst = source.Pixels.data() + y * source.Image.RowPitch;
+			for(UINT x = 0; x < source.Image.Width; ++x)
+			{
+				dst[4*x + 0] = src[4*x + (bgra ? 2 : 0)];
+				dst[4*x + 1] = src[4*x + 1];
+				dst[4*x + 2] = src[4*x + (bgra ? 0 : 2)];
+				dst[4*x + 3] = src[4*x + 3];
+			}
+		}
+
+		source.Image.Pixels = source.Pixels.data();
+		return source;
+	}
+
+	// Tightly packed RGBA8 copy of the top level of a RGBA8 or BGRA8 texture.
+	SourceImage LoadImage(const wchar_t* filename, const char* name)
+	{
+		DirectX::DDSTextureData12 data;
+		LoadFile(filename, name, data);
+		return GetImage(data, 0, name);
+	}
+
+	struct FormatInfo
+	{
+		BCEncoder::Format Format;
+		const char* Name;
+		BCEncoder::uint32 NumChannels;
+	};
+
+	const FormatInfo gFormats[] =
+	{
+		{ BCEncoder::Format::BC1, "BC1", 3 },
+		{ BCEncoder::Format::BC3, "BC3", 4 },
+		{ BCEncoder::Format::BC5, "BC5", 2 },
+		{ BCEncoder::Format::BC7, "BC7", 4 },
+	};
+}
+
+int BCEncodeBenchmark(int argc, char* argv[])
+{
+	int maxThreads = Bench::IntArg(argc, argv, 0, (int)std::thread::hardware_concurrency());
+	int repeats = Bench::IntArg(argc, argv, 1, 5);
+
+	std::vector<SourceImage> sources;
+	sources.push_back(LoadImage(L"../../Textures/bricks_nmap.dds", "bricks_nmap"));
+	sources.push_back(LoadImage(L"../../Textures/bricks2_nmap.dds", "bricks2_nmap"));
+	sources.push_back(LoadImage(L"../../Textures/tile_nmap.dds", "tile_nmap"));
+	sources.push_back(LoadImage(L"../../Textures/treeArray2.dds", "treeArray2"));
+
+	double numPixels = 0.0;
+	for(const SourceImage& source : sources)
+		numPixels += (double)source.Image.Width * source.Image.Height;
+
+	std::printf("%u images, %.2f MPixel, median of %d runs\n",
+		(unsigned)sources.size(), numPixels / 1e6, repeats);
+
+	for(const FormatInfo& format : gFormats)
+	{
+		std::printf("\n%s", format.Name);
+		for(const SourceImage& source : sources)
+		{
+			std::vector<std::uint8_t> blocks = BCEncoder(1).Compress(format.Format, source.Image);
+			std::vector<std::uint8_t> decoded = BCEncoder::Decompress(format.Format, blocks.data(),
+				source.Image.Width, source.Image.Height);
+
+			BCEncoder::Image decodedImage = source.Image;
+			decodedImage.Pixels = decoded.data();
+
+			std::printf("  %s %.2f dB", source.Name.c_str(),
+				BCEncoder::ComputePSNR(source.Image, decodedImage, format.NumChannels));
+		}
+		std::printf("\nthreads        ms   MPixel/s   speedup\n");
+
+		double oneThreadMs = 0.0;
+		for(int numThreads = 1; numThreads <= std::max(maxThreads, 1); ++numThreads)
+		{
+			BCEncoder encoder((BCEncoder::uint32)numThreads);
+			double ms = Bench::MedianMs(repeats, [&]()
+			{
+				for(const SourceImage& source : sources)
+					encoder.Compress(format.Format, source.Image);
+			});
+
+			if(numThreads == 1)
+				oneThreadMs = ms;
+
+			std::printf("%7d %9.3f %10.2f %8.2fx\n", numThreads, ms,
+				numPixels / 1e6 / (ms / 1000.0), oneThreadMs / ms);
+		}
+	}
+
+	return 0;
+}
+
+int BCBake(int argc, char* argv[])
+{
+	if(argc < 3)
+		throw std::runtime_error("expected <input.dds> <output.dds> <bc1|bc3|bc5|bc7>");
+
+	const FormatInfo* format = nullptr;
+	for(const FormatInfo& f : gFormats)
+	{
+		if(_stricmp(argv[2], f.Name) == 0)
+			format = &f;
+	}
+	if(format == nullptr)
+		throw std::runtime_error(std::string("unknown format ") + argv[2]);
+
+	std::wstring inputName(argv[0], argv[0] + std::strlen(argv[0]));
+	DirectX::DDSTextureData12 data;
+	LoadFile(inputName.c_str(), argv[0], data);
+
+	// WriteDDS writes the UNORM formats only.
+	if(data.Desc.Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || data.Desc.Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+		throw std::runtime_error(std::string(argv[0]) + " is sRGB");
+	if(data.Desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || data.Desc.DepthOrArraySize != 1 || data.IsCubeMap)
+		throw std::runtime_error(std::string(argv[0]) + " is not a single 2D texture");
+
+	std::vector<SourceImage> levels;
+	for(UINT m = 0; m < data.Desc.MipLevels; ++m)
+		levels.push_back(GetImage(data, m, argv[0]));
+
+	if(levels.size() == 1)
+	{
+		const SourceImage& top = levels[0];
+		MipGenerator mips;
+		mips.Generate(MipGenerator::Format::RGBA8, top.Image.Pixels, top.Image.Width, top.Image.Height,
+			top.Image.RowPitch, MipGenerator::Filter::Kaiser, MipGenerator::AddressMode::Wrap);
+
+		for(MipGenerator::uint32 m = 1; m < mips.NumLevels(); ++m)
+		{
+			const MipGenerator::Level& level = mips.GetLevel(m);
+			SourceImage source;
+			source.Name = levels[0].Name;
+			source.Pixels.assign(mips.GetLevelData(m), mips.GetLevelData(m) + (size_t)level.RowPitch * level.Height);
+			source.Image.Pixels = source.Pixels.data();
+			source.Image.Width = level.Width;
+			source.Image.Height = level.Height;
+			source.Image.RowPitch = level.RowPitch;
+			levels.push_back(std::move(source));
+		}
+	}
+
+	BCEncoder encoder;
+	std::vector<std::vector<std::uint8_t>> blocks;
+	double start = Bench::NowMs();
+	for(const SourceImage& level : levels)
+		blocks.push_back(encoder.Compress(format->Format, level.Image));
+	double ms = Bench::NowMs() - start;
+
+	std::vector<std::uint8_t> decoded = BCEncoder::Decompress(format->Format, blocks[0].data(),
+		levels[0].Image.Width, levels[0].Image.Height);
+	BCEncoder::Image decodedImage = levels[0].Image;
+	decodedImage.Pixels = decoded.data();
+
+	std::vector<std::uint8_t> file = BCEncoder::WriteDDS(format->Format,
+		levels[0].Image.Width, levels[0].Image.Height, blocks);
+
+	std::ofstream out(argv[1], std::ios::binary);
+	out.write(reinterpret_cast<const char*>(file.data()), (std::streamsize)file.size());
+	if(!out)
+		throw std::runtime_error(std::string("failed to write ") + argv[1]);
+
+	std::printf("%s: %ux%u, %u mips, %s, %.2f dB, %.3f ms on %u threads, %u bytes\n", argv[1],
+		levels[0].Image.Width, levels[0].Image.Height, (unsigned)levels.size(), format->Name,
+		BCEncoder::ComputePSNR(levels[0].Image, decodedImage, format->NumChannels), ms,
+		encoder.NumThreads(), (unsigned)file.size());
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+//***************************************************************************************
+// Benchmarks.h
+//
+// Entry points of the benchmarks Main.cpp dispatches to, and the timing helpers they
+// share.  Each benchmark receives the arguments after its name and returns the
+// process exit code.  BCBake is not a benchmark but the offline texture compression
+// step, which shares the encoder and the command line.
+//***************************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+int BCBake(int argc, char* argv[]);
+int BCEncodeBenchmark(int argc, char* argv[]);
+int TextureLoadBenchmark(int argc, char* argv[]);
+int UploadWriteBenchmark(int argc, char* argv[]);
+
+namespace Bench
+{
+	// Argument i as a positive integer, or fallback if it is missing or malformed.
+	inline int IntArg(int argc, char* argv[], int i, int fallback)
+	{
+		int value = i < argc ? std::atoi(argv[i]) : 0;
+		return value > 0 ? value : fallback;
+	}
+
+	inline double NowMs()
+	{
+		return std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Runs func repeats times and returns the median time in milliseconds, which is
+	// less sensitive than the mean to the odd descheduled run.
+	template<typename Func>
+	double MedianMs(int repeats, Func func)
+	{
+		std::vector<double> times;
+		for(int i = 0; i < repeats; ++i)
+		{
+			double start = NowMs();
+			func();
+			times.push_back(NowMs() - start);
+		}
+
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	}
+}
@@ -0,0 +1,59 @@
+//***************************************************************************************
+// Main.cpp
+//
+// Console benchmarks for the Common/ loaders, encoders and upload paths.  Run with
+// the name of a benchmark and its arguments, from this directory so ../../Textures
+// resolves:
+//
+//   Benchmarks bcbake <input.dds> <output.dds> <bc1|bc3|bc5|bc7>
+//   Benchmarks bcencode [maxThreads] [repeats]
+//   Benchmarks textureload [maxThreads] [repeats]
+//   Benchmarks uploadwrite [megabytes] [repeats]
+//***************************************************************************************
+
+#include "Benchmarks.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+	struct Benchmark
+	{
+		const char* Name;
+		const char* Usage;
+		int (*Run)(int argc, char* argv[]);
+	};
+
+	const Benchmark gBenchmarks[] =
+	{
+		{ "bcbake", "<input.dds> <output.dds> <bc1|bc3|bc5|bc7>", BCBake },
+		{ "bcencode", "[maxThreads] [repeats]", BCEncodeBenchmark },
+		{ "textureload", "[maxThreads] [repeats]", TextureLoadBenchmark },
+		{ "uploadwrite", "[megabytes] [repeats]", UploadWriteBenchmark },
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	for(const Benchmark& benchmark : gBenchmarks)
+	{
+		if(argc < 2 || std::strcmp(argv[1], benchmark.Name) != 0)
+			continue;
+
+		try
+		{
+			return benchmark.Run(argc - 2, argv + 2);
+		}
+		catch(const std::exception& e)
+		{
+			std::printf("%s failed: %s\n", benchmark.Name, e.what());
+			return 1;
+		}
+	}
+
+	std::printf("usage:\n");
+	for(const Benchmark& benchmark : gBenchmarks)
+		std::printf("  Benchmarks %s %s\n", benchmark.Name, benchmark.Usage);
+	return 1;
+}
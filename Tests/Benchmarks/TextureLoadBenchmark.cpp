@@ -0,0 +1,114 @@
+//***************************************************************************************
+// TextureLoadBenchmark.cpp
+//
+// Loads every DDS file in ../../Textures with AsyncTextureLoader on 1 to maxThreads
+// worker threads.  Each job maps and parses the file, then reads one byte of every
+// page of its subresources, which is the I/O the upload copy would otherwise fault in
+// on the main thread.  A first untimed pass warms the file cache, so the times are
+// those of a second launch of a demo rather than of a cold disk.
+//***************************************************************************************
+
+#include "Benchmarks.h"
+#include "AsyncTextureLoader.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+
+// Visual Studio 2015 only has the Filesystem TS version.
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+namespace
+{
+	const char* TextureDir = "../../Textures";
+
+	// The .dds files of TextureDir, sorted so that every run loads them in one order.
+	std::vector<std::wstring> FindTextures()
+	{
+		std::vector<std::wstring> filenames;
+
+		std::error_code error;
+		for(fs::directory_iterator it(TextureDir, error), end; !error && it != end; it.increment(error))
+		{
+			fs::path extension = it->path().extension();
+			if(fs::is_regular_file(it->status()) && (extension == ".dds" || extension == ".DDS"))
+				filenames.push_back(it->path().wstring());
+		}
+
+		std::sort(filenames.begin(), filenames.end());
+		return filenames;
+	}
+
+	// Loads every file and returns the number of bytes of pixel data read.
+	size_t LoadAll(AsyncTextureLoader& loader, const std::vector<std::wstring>& filenames)
+	{
+		std::atomic<size_t> numBytes(0);
+
+		for(const auto& filename : filenames)
+		{
+			loader.Load(filename, [&numBytes](AsyncTextureLoader::LoadResult& result)
+			{
+				if(FAILED(result.Status))
+					throw std::runtime_error("failed to load a texture");
+
+				volatile UINT8 sink = 0;
+				size_t fileBytes = 0;
+				for(const auto& subresource : result.Data->Subresources)
+				{
+					const UINT8* data = static_cast<const UINT8*>(subresource.pData);
+					size_t size = (size_t)subresource.SlicePitch;
+					for(size_t i = 0; i < size; i += 4096)
+						sink += data[i];
+					fileBytes += size;
+				}
+
+				numBytes += fileBytes;
+			});
+		}
+
+		// Rethrows the failure of any job.
+		loader.Wait();
+		return numBytes;
+	}
+}
+
+int TextureLoadBenchmark(int argc, char* argv[])
+{
+	int maxThreads = Bench::IntArg(argc, argv, 0, (int)std::thread::hardware_concurrency());
+	int repeats = Bench::IntArg(argc, argv, 1, 9);
+
+	std::vector<std::wstring> filenames = FindTextures();
+	if(filenames.empty())
+	{
+		std::printf("no DDS files in ../../Textures\n");
+		return 1;
+	}
+
+	AsyncTextureLoader warmup(1);
+	size_t numBytes = LoadAll(warmup, filenames);
+
+	std::printf("%u files, %.1f MB of pixel data, median of %d runs\n",
+		(unsigned)filenames.size(), numBytes / (1024.0 * 1024.0), repeats);
+	std::printf("threads        ms      MB/s   speedup\n");
+
+	double oneThreadMs = 0.0;
+	for(int numThreads = 1; numThreads <= std::max(maxThreads, 1); ++numThreads)
+	{
+		AsyncTextureLoader loader((UINT)numThreads);
+		double ms = Bench::MedianMs(repeats, [&]() { LoadAll(loader, filenames); });
+
+		if(numThreads == 1)
+			oneThreadMs = ms;
+
+		std::printf("%7d %9.3f %9.1f %8.2fx\n", numThreads, ms,
+			numBytes / (1024.0 * 1024.0) / (ms / 1000.0), oneThreadMs / ms);
+	}
+
+	return 0;
+}
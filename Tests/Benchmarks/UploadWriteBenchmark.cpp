@@ -0,0 +1,136 @@
+//***************************************************************************************
+// UploadWriteBenchmark.cpp
+//
+// Compares the ways UploadBuffer writes into mapped memory.  The destination is
+// committed with PAGE_WRITECOMBINE, which gives it the same write-combined caching as
+// a mapped upload heap without needing a device:
+//
+//   - 28 byte vertices, one memcpy per element (CopyData) against one
+//     CopyToWriteCombined for the whole array (CopyRange on a packed buffer).
+//   - Constant buffer elements 256 bytes apart, one memcpy per element against the
+//     padded streaming copy of CopyRange, with an sfence per element and with a
+//     single sfence after the loop.
+//***************************************************************************************
+
+#include "Benchmarks.h"
+#include "WriteCombinedCopy.h"
+#include <windows.h>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	struct Vertex
+	{
+		float Pos[3];
+		float Normal[3];
+		float TexC;
+	};
+
+	struct ObjectConstants
+	{
+		float World[16];
+		float TexTransform[16];
+		UINT MaterialIndex;
+		UINT Pad[3];
+	};
+
+	const size_t ConstantBufferStride = 256;
+
+	class WriteCombinedMemory
+	{
+	public:
+		explicit WriteCombinedMemory(size_t byteSize)
+		{
+			mData = static_cast<BYTE*>(VirtualAlloc(nullptr, byteSize, MEM_COMMIT | MEM_RESERVE,
+				PAGE_READWRITE | PAGE_WRITECOMBINE));
+			if(mData == nullptr)
+				throw std::runtime_error("VirtualAlloc failed");
+		}
+		WriteCombinedMemory(const WriteCombinedMemory& rhs) = delete;
+		WriteCombinedMemory& operator=(const WriteCombinedMemory& rhs) = delete;
+
+		~WriteCombinedMemory()
+		{
+			VirtualFree(mData, 0, MEM_RELEASE);
+		}
+
+		BYTE* Data()const { return mData; }
+
+	private:
+		BYTE* mData = nullptr;
+	};
+
+	template<typename Func>
+	void Report(const char* name, int repeats, size_t numBytes, Func func)
+	{
+		double ms = Bench::MedianMs(repeats, func);
+		std::printf("%-34s %9.3f %9.2f\n", name, ms, numBytes / (1024.0 * 1024.0 * 1024.0) / (ms / 1000.0));
+	}
+}
+
+int UploadWriteBenchmark(int argc, char* argv[])
+{
+	int megabytes = Bench::IntArg(argc, argv, 0, 32);
+	int repeats = Bench::IntArg(argc, argv, 1, 9);
+
+	const size_t numVertices = (size_t)megabytes * 1024 * 1024 / sizeof(Vertex);
+	const size_t numObjects = (size_t)megabytes * 1024 * 1024 / ConstantBufferStride;
+
+	std::vector<Vertex> vertices(numVertices);
+	for(size_t i = 0; i < numVertices; ++i)
+		vertices[i] = { { (float)i, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, 0.5f };
+
+	std::vector<ObjectConstants> objects(numObjects);
+	for(size_t i = 0; i < numObjects; ++i)
+		objects[i].MaterialIndex = (UINT)i;
+
+	WriteCombinedMemory vertexBuffer(numVertices * sizeof(Vertex));
+	WriteCombinedMemory constantBuffer(numObjects * ConstantBufferStride);
+
+	std::printf("%d MB per copy, median of %d runs\n", megabytes, repeats);
+	std::printf("%-34s %9s %9s\n", "strategy", "ms", "GB/s");
+
+	const size_t vertexBytes = numVertices * sizeof(Vertex);
+	Report("vertices, memcpy per element", repeats, vertexBytes, [&]()
+	{
+		for(size_t i = 0; i < numVertices; ++i)
+			std::memcpy(vertexBuffer.Data() + i * sizeof(Vertex), &vertices[i], sizeof(Vertex));
+	});
+	Report("vertices, one streaming copy", repeats, vertexBytes, [&]()
+	{
+		CopyToWriteCombined(vertexBuffer.Data(), vertices.data(), vertexBytes);
+	});
+
+	// Same padding as UploadBuffer::CopyRange.
+	const size_t paddedSize = (sizeof(ObjectConstants) + 63) & ~63;
+	alignas(16) BYTE element[paddedSize];
+	std::memset(element + sizeof(ObjectConstants), 0, paddedSize - sizeof(ObjectConstants));
+
+	const size_t objectBytes = numObjects * sizeof(ObjectConstants);
+	Report("constants, memcpy per element", repeats, objectBytes, [&]()
+	{
+		for(size_t i = 0; i < numObjects; ++i)
+			std::memcpy(constantBuffer.Data() + i * ConstantBufferStride, &objects[i], sizeof(ObjectConstants));
+	});
+	Report("constants, streaming, fence each", repeats, objectBytes, [&]()
+	{
+		for(size_t i = 0; i < numObjects; ++i)
+		{
+			std::memcpy(element, &objects[i], sizeof(ObjectConstants));
+			CopyToWriteCombined(constantBuffer.Data() + i * ConstantBufferStride, element, paddedSize);
+		}
+	});
+	Report("constants, streaming, one fence", repeats, objectBytes, [&]()
+	{
+		for(size_t i = 0; i < numObjects; ++i)
+		{
+			std::memcpy(element, &objects[i], sizeof(ObjectConstants));
+			StreamToWriteCombined(constantBuffer.Data() + i * ConstantBufferStride, element, paddedSize);
+		}
+		FenceWriteCombined();
+	});
+
+	return 0;
+}
@@ -0,0 +1,179 @@
+//***************************************************************************************
+// BCEncoderTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "BCEncoder.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	typedef std::vector<BCEncoder::uint8> Bytes;
+
+	// Smooth gradients in every channel plus some noise, like a photographed texture.
+	Bytes MakePixels(BCEncoder::uint32 width, BCEncoder::uint32 height, unsigned seed = 7)
+	{
+		std::mt19937 random(seed);
+		Bytes pixels((size_t)width * height * 4);
+		for(BCEncoder::uint32 y = 0; y < height; ++y)
+		{
+			for(BCEncoder::uint32 x = 0; x < width; ++x)
+			{
+				const int base[4] = { (int)(x * 3), (int)(y * 3), (int)((x + y) * 2), 255 - (int)(x + y) };
+				for(int c = 0; c < 4; ++c)
+				{
+					int v = base[c] + (int)(random() % 9) - 4;
+					pixels[((size_t)y * width + x) * 4 + c] = (BCEncoder::uint8)(v < 0 ? 0 : (v > 255 ? 255 : v));
+				}
+			}
+		}
+		return pixels;
+	}
+
+	BCEncoder::Image MakeImage(const Bytes& pixels, BCEncoder::uint32 width, BCEncoder::uint32 height)
+	{
+		BCEncoder::Image image;
+		image.Pixels = pixels.data();
+		image.Width = width;
+		image.Height = height;
+		image.RowPitch = width * 4;
+		return image;
+	}
+
+	BCEncoder::uint32 ReadDword(const Bytes& file, size_t index)
+	{
+		BCEncoder::uint32 value = 0;
+		for(int b = 0; b < 4; ++b)
+			value |= (BCEncoder::uint32)file[index * 4 + b] << (8 * b);
+		return value;
+	}
+
+	struct FormatCase
+	{
+		BCEncoder::Format Format;
+		BCEncoder::uint32 NumChannels;
+		double MinPSNR;
+	};
+}
+
+TEST(BCEncoder_RoundTripsAboveAQualityFloor)
+{
+	const BCEncoder::uint32 width = 64;
+	const BCEncoder::uint32 height = 64;
+	Bytes pixels = MakePixels(width, height);
+	BCEncoder::Image image = MakeImage(pixels, width, height);
+
+	// PSNR over the channels each format stores.
+	const FormatCase cases[] =
+	{
+		{ BCEncoder::Format::BC1, 3, 36.0 },
+		{ BCEncoder::Format::BC3, 4, 37.0 },
+		{ BCEncoder::Format::BC5, 2, 48.0 },
+		{ BCEncoder::Format::BC7, 4, 38.0 },
+	};
+
+	for(const FormatCase& c : cases)
+	{
+		Bytes blocks = BCEncoder(1).Compress(c.Format, image);
+		CHECK(blocks.size() == BCEncoder::CompressedSize(c.Format, width, height));
+		CHECK(blocks.size() == (size_t)(width / 4) * (height / 4) * BCEncoder::BlockBytes(c.Format));
+
+		Bytes decoded = BCEncoder::Decompress(c.Format, blocks.data(), width, height);
+		CHECK(decoded.size() == pixels.size());
+		CHECK(BCEncoder::ComputePSNR(image, MakeImage(decoded, width, height), c.NumChannels) > c.MinPSNR);
+
+		// The threads split the block rows, so the output does not depend on them.
+		CHECK(BCEncoder(3).Compress(c.Format, image) == blocks);
+	}
+
+	// BC5 only stores red and green.
+	Bytes bc5 = BCEncoder(1).Compress(BCEncoder::Format::BC5, image);
+	Bytes decoded = BCEncoder::Decompress(BCEncoder::Format::BC5, bc5.data(), width, height);
+	CHECK(decoded[2] == 0 && decoded[3] == 255);
+
+	// Identical images compare as infinitely good.
+	CHECK(BCEncoder::ComputePSNR(image, image) > 1e300);
+}
+
+TEST(BCEncoder_PadsEdgeBlocksWithTheLastRowAndColumn)
+{
+	const BCEncoder::uint32 width = 6;
+	const BCEncoder::uint32 height = 5;
+	Bytes pixels = MakePixels(width, height, 11);
+
+	// The same image padded to whole blocks by hand.
+	Bytes padded(8 * 8 * 4);
+	for(BCEncoder::uint32 y = 0; y < 8; ++y)
+	{
+		for(BCEncoder::uint32 x = 0; x < 8; ++x)
+		{
+			BCEncoder::uint32 sx = x < width ? x : width - 1;
+			BCEncoder::uint32 sy = y < height ? y : height - 1;
+			std::memcpy(&padded[(y * 8 + x) * 4], &pixels[(sy * width + sx) * 4], 4);
+		}
+	}
+
+	for(BCEncoder::Format format : { BCEncoder::Format::BC1, BCEncoder::Format::BC3,
+		BCEncoder::Format::BC5, BCEncoder::Format::BC7 })
+	{
+		Bytes blocks = BCEncoder(1).Compress(format, MakeImage(pixels, width, height));
+		CHECK(blocks.size() == 4 * BCEncoder::BlockBytes(format));
+		CHECK(blocks == BCEncoder(1).Compress(format, MakeImage(padded, 8, 8)));
+
+		// Decoding crops the padding again.
+		Bytes decoded = BCEncoder::Decompress(format, blocks.data(), width, height);
+		Bytes decodedPadded = BCEncoder::Decompress(format, blocks.data(), 8, 8);
+		CHECK(decoded.size() == (size_t)width * height * 4);
+		CHECK(std::memcmp(&decoded[(4 * width + 5) * 4], &decodedPadded[(4 * 8 + 5) * 4], 4) == 0);
+	}
+
+	// A row pitch wider than the row is honoured.
+	Bytes wide(width * 2 * height * 4, 0);
+	for(BCEncoder::uint32 y = 0; y < height; ++y)
+		std::memcpy(&wide[y * width * 2 * 4], &pixels[y * width * 4], width * 4);
+	BCEncoder::Image wideImage = MakeImage(wide, width, height);
+	wideImage.RowPitch = width * 2 * 4;
+	CHECK(BCEncoder(1).Compress(BCEncoder::Format::BC7, wideImage) ==
+		BCEncoder(1).Compress(BCEncoder::Format::BC7, MakeImage(pixels, width, height)));
+}
+
+TEST(BCEncoder_WritesADX10DDSFile)
+{
+	// An 8x4 BC7 texture with its three mips.
+	std::vector<Bytes> mips = { Bytes(32, 1), Bytes(16, 2), Bytes(16, 3) };
+	Bytes file = BCEncoder::WriteDDS(BCEncoder::Format::BC7, 8, 4, mips);
+
+	// Magic, DDS_HEADER and DDS_HEADER_DXT10, then the mips.
+	CHECK(file.size() == 4 + 124 + 20 + 64);
+	CHECK(ReadDword(file, 0) == 0x20534444);             // "DDS "
+	CHECK(ReadDword(file, 1) == 124);                    // dwSize
+	CHECK(ReadDword(file, 2) == 0xA1007);                // CAPS | HEIGHT | WIDTH | PIXELFORMAT | MIPMAPCOUNT | LINEARSIZE
+	CHECK(ReadDword(file, 3) == 4);                      // dwHeight
+	CHECK(ReadDword(file, 4) == 8);                      // dwWidth
+	CHECK(ReadDword(file, 5) == 32);                     // dwPitchOrLinearSize
+	CHECK(ReadDword(file, 7) == 3);                      // dwMipMapCount
+	CHECK(ReadDword(file, 19) == 32);                    // ddspf.dwSize
+	CHECK(ReadDword(file, 20) == 0x4);                   // ddspf.dwFlags = DDPF_FOURCC
+	CHECK(std::memcmp(&file[21 * 4], "DX10", 4) == 0);   // ddspf.dwFourCC
+	CHECK(ReadDword(file, 27) == 0x401008);              // TEXTURE | COMPLEX | MIPMAP
+	CHECK(ReadDword(file, 32) == 98);                    // DXGI_FORMAT_BC7_UNORM
+	CHECK(ReadDword(file, 33) == 3);                     // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+	CHECK(ReadDword(file, 34) == 0);                     // miscFlag
+	CHECK(ReadDword(file, 35) == 1);                     // arraySize
+	CHECK(ReadDword(file, 36) == 0);                     // miscFlags2
+
+	CHECK(file[148] == 1 && file[148 + 31] == 1);
+	CHECK(file[180] == 2 && file[196] == 3 && file.back() == 3);
+
+	// A single level has no mip flags.
+	Bytes single = BCEncoder::WriteDDS(BCEncoder::Format::BC1, 4, 4, { Bytes(8, 0) });
+	CHECK(single.size() == 148 + 8);
+	CHECK(ReadDword(single, 2) == 0x81007);
+	CHECK(ReadDword(single, 7) == 1);
+	CHECK(ReadDword(single, 27) == 0x1000);
+	CHECK(ReadDword(single, 32) == 71);                  // DXGI_FORMAT_BC1_UNORM
+	CHECK(BCEncoder::DxgiFormat(BCEncoder::Format::BC3) == 77);
+	CHECK(BCEncoder::DxgiFormat(BCEncoder::Format::BC5) == 83);
+}
@@ -0,0 +1,57 @@
+//***************************************************************************************
+// Check.h
+//
+// A minimal test harness for the Common/ classes that do not need a device.  Each
+// test is a function declared with TEST, which registers it with Main.cpp; CHECK
+// records a failure with its file and line and lets the test go on:
+//
+//   TEST(RingAllocator_WrapsAround)
+//   {
+//       RingAllocator ring(1000);
+//       CHECK(ring.Allocate(600) == 0);
+//   }
+//
+// Running CommonTests runs every test, or only those whose name starts with the
+// first argument, and returns the number of failed tests.
+//***************************************************************************************
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Check
+{
+	typedef void (*TestFunc)();
+
+	struct TestCase
+	{
+		const char* Name;
+		TestFunc Func;
+	};
+
+	std::vector<TestCase>& Tests();
+
+	// Records a failed CHECK of the running test.
+	void Fail(const char* file, int line, const std::string& expr);
+
+	struct Registrar
+	{
+		Registrar(const char* name, TestFunc func)
+		{
+			Tests().push_back({ name, func });
+		}
+	};
+}
+
+#define TEST(name)                                                    \
+	static void name();                                               \
+	static Check::Registrar name##Registrar(#name, name);             \
+	static void name()
+
+#define CHECK(expr)                                                   \
+	do                                                                \
+	{                                                                 \
+		if(!(expr))                                                   \
+			Check::Fail(__FILE__, __LINE__, #expr);                   \
+	} while(0)
@@ -0,0 +1,196 @@
+//***************************************************************************************
+// CommandStateCacheTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "CommandStateCache.h"
+#include "DrawList.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Stand-ins for the D3D12 types, with the fields CommandStateCache reads.
+	struct FakePso { int Id; };
+	struct VertexBufferView { std::uint64_t BufferLocation; std::uint32_t SizeInBytes, StrideInBytes; };
+	struct IndexBufferView { std::uint64_t BufferLocation; std::uint32_t SizeInBytes; int Format; };
+	struct DescriptorHandle { std::uint64_t ptr; };
+	enum Topology { TriangleList = 4, TriangleStrip = 5 };
+
+	// Records what is bound, and checks every draw against what the item expected.
+	struct RecordingCommandList
+	{
+		const FakePso* Pso = nullptr;
+		VertexBufferView Vertices = {};
+		IndexBufferView Indices = {};
+		int BoundTopology = 0;
+		std::uint64_t RootArgs[4] = {};
+
+		int NumBinds = 0;
+		int NumDraws = 0;
+
+		void SetPipelineState(const FakePso* pso) { Pso = pso; NumBinds++; }
+		void IASetVertexBuffers(std::uint32_t, std::uint32_t, const VertexBufferView* vbv) { Vertices = *vbv; NumBinds++; }
+		void IASetIndexBuffer(const IndexBufferView* ibv) { Indices = *ibv; NumBinds++; }
+		void IASetPrimitiveTopology(Topology topology) { BoundTopology = topology; NumBinds++; }
+		void SetGraphicsRootConstantBufferView(std::uint32_t i, std::uint64_t address) { RootArgs[i] = address; NumBinds++; }
+		void SetGraphicsRootShaderResourceView(std::uint32_t i, std::uint64_t address) { RootArgs[i] = address; NumBinds++; }
+		void SetGraphicsRootDescriptorTable(std::uint32_t i, DescriptorHandle handle) { RootArgs[i] = handle.ptr; NumBinds++; }
+		void DrawIndexedInstanced(std::uint32_t, std::uint32_t, std::uint32_t, std::int32_t, std::uint32_t) { NumDraws++; }
+	};
+
+	struct Item
+	{
+		int Pso;
+		int Material;
+		int Geometry;
+		float Depth;
+	};
+
+	struct Scene
+	{
+		FakePso Psos[3] = { { 0 }, { 1 }, { 2 } };
+		std::vector<Item> Items;
+
+		Scene()
+		{
+			std::mt19937 random(5);
+			for(int i = 0; i < 200; ++i)
+				Items.push_back({ (int)(random() % 3), (int)(random() % 5), (int)(random() % 4), (random() % 1000) / 1000.0f });
+		}
+
+		static VertexBufferView Vertices(int geometry) { return { 0x10000u*(geometry + 1), 4096, 32 }; }
+		static IndexBufferView Indices(int geometry) { return { 0x90000u*(geometry + 1), 1024, 42 }; }
+		static std::uint64_t MaterialAddress(int material) { return 0x1000000u + 256u*material; }
+		static DescriptorHandle Texture(int material) { return { 0x5000u + 32u*(material % 2) }; }
+
+		// Draws the items in the given order and checks that each draw sees its state.
+		bool Draw(const std::vector<std::uint32_t>& order, RecordingCommandList& cmdList,
+			CommandStateCache<RecordingCommandList>& state)
+		{
+			bool allCorrect = true;
+			for(std::uint32_t i : order)
+			{
+				const Item& item = Items[i];
+				state.SetPipelineState(&Psos[item.Pso]);
+				state.SetVertexBuffer(Vertices(item.Geometry));
+				state.SetIndexBuffer(Indices(item.Geometry));
+				state.SetPrimitiveTopology(item.Geometry == 3 ? TriangleStrip : TriangleList);
+				state.SetGraphicsRootConstantBufferView(0, 0x2000000u + 256u*i);
+				state.SetGraphicsRootConstantBufferView(1, MaterialAddress(item.Material));
+				state.SetGraphicsRootDescriptorTable(2, Texture(item.Material));
+				state.DrawIndexedInstanced(36, 1, 0, 0, 0);
+
+				allCorrect = allCorrect &&
+					cmdList.Pso == &Psos[item.Pso] &&
+					cmdList.Vertices.BufferLocation == Vertices(item.Geometry).BufferLocation &&
+					cmdList.Indices.BufferLocation == Indices(item.Geometry).BufferLocation &&
+					cmdList.BoundTopology == (item.Geometry == 3 ? TriangleStrip : TriangleList) &&
+					cmdList.RootArgs[0] == 0x2000000u + 256u*i &&
+					cmdList.RootArgs[1] == MaterialAddress(item.Material) &&
+					cmdList.RootArgs[2] == Texture(item.Material).ptr;
+			}
+			return allCorrect;
+		}
+	};
+
+	// Number of times the value changes along the order, the first bind included.
+	template<typename Fn>
+	int NumChanges(const std::vector<std::uint32_t>& order, Fn value)
+	{
+		int changes = 0;
+		for(size_t k = 0; k < order.size(); ++k)
+		{
+			if(k == 0 || value(order[k]) != value(order[k - 1]))
+				changes++;
+		}
+		return changes;
+	}
+}
+
+TEST(CommandStateCache_SkipsRedundantBindsAfterSortingByKey)
+{
+	Scene scene;
+
+	DrawList list;
+	for(std::uint32_t i = 0; i < scene.Items.size(); ++i)
+	{
+		const Item& item = scene.Items[i];
+		list.Add(DrawList::MakeKey(0, item.Pso, item.Material, item.Geometry, item.Depth), i);
+	}
+	list.Sort();
+
+	std::vector<std::uint32_t> sorted;
+	for(const DrawList::Entry& entry : list.Entries())
+		sorted.push_back(entry.Item);
+
+	RecordingCommandList cmdList;
+	CommandStateCache<RecordingCommandList> state(&cmdList);
+	CHECK(scene.Draw(sorted, cmdList, state));
+
+	// Exactly one bind per change of value along the sorted order.
+	const auto& items = scene.Items;
+	int psoBinds = NumChanges(sorted, [&](std::uint32_t i) { return items[i].Pso; });
+	int geometryBinds = NumChanges(sorted, [&](std::uint32_t i) { return items[i].Geometry; });
+	int topologyBinds = NumChanges(sorted, [&](std::uint32_t i) { return items[i].Geometry == 3; });
+	int materialBinds = NumChanges(sorted, [&](std::uint32_t i) { return items[i].Material; });
+	int textureBinds = NumChanges(sorted, [&](std::uint32_t i) { return items[i].Material % 2; });
+	int objectBinds = (int)sorted.size();
+
+	CHECK(psoBinds == 3);
+	CHECK(cmdList.NumBinds == psoBinds + 2*geometryBinds + topologyBinds + materialBinds + textureBinds + objectBinds);
+	CHECK((int)state.NumIssued() == cmdList.NumBinds);
+	CHECK((int)(state.NumIssued() + state.NumSkipped()) == 7*objectBinds);
+	CHECK(cmdList.NumDraws == objectBinds);
+	CHECK((int)state.NumDraws() == objectBinds);
+
+	// Unsorted, the same draws need many more binds.
+	std::vector<std::uint32_t> unsorted;
+	for(std::uint32_t i = 0; i < scene.Items.size(); ++i)
+		unsorted.push_back(i);
+
+	RecordingCommandList unsortedList;
+	CommandStateCache<RecordingCommandList> unsortedState(&unsortedList);
+	CHECK(scene.Draw(unsorted, unsortedList, unsortedState));
+	CHECK(unsortedList.NumBinds > cmdList.NumBinds + objectBinds);
+}
+
+TEST(CommandStateCache_InvalidateRebindsEverything)
+{
+	Scene scene;
+	RecordingCommandList cmdList;
+	CommandStateCache<RecordingCommandList> state(&cmdList);
+
+	std::vector<std::uint32_t> first = { 0 };
+	CHECK(scene.Draw(first, cmdList, state));
+	CHECK(cmdList.NumBinds == 7);
+
+	// Drawing the same item again binds nothing.
+	CHECK(scene.Draw(first, cmdList, state));
+	CHECK(cmdList.NumBinds == 7);
+	CHECK(state.NumSkipped() == 7);
+
+	// E.g. the root signature changed behind the cache's back.
+	cmdList.Pso = nullptr;
+	state.Invalidate();
+	CHECK(scene.Draw(first, cmdList, state));
+	CHECK(cmdList.NumBinds == 14);
+}
+
+TEST(CommandStateCache_ComparesTheWholeView)
+{
+	RecordingCommandList cmdList;
+	CommandStateCache<RecordingCommandList> state(&cmdList);
+
+	// Same buffer, different stride or size: both are real changes.
+	state.SetVertexBuffer(VertexBufferView{ 0x1000, 4096, 32 });
+	state.SetVertexBuffer(VertexBufferView{ 0x1000, 4096, 16 });
+	state.SetVertexBuffer(VertexBufferView{ 0x1000, 2048, 16 });
+	state.SetVertexBuffer(VertexBufferView{ 0x1000, 2048, 16 });
+	CHECK(cmdList.NumBinds == 3);
+
+	state.SetIndexBuffer(IndexBufferView{ 0x2000, 1024, 42 });
+	state.SetIndexBuffer(IndexBufferView{ 0x2000, 1024, 57 });
+	CHECK(cmdList.NumBinds == 5);
+	CHECK(cmdList.Indices.Format == 57);
+}
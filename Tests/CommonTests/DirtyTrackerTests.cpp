@@ -0,0 +1,97 @@
+//***************************************************************************************
+// DirtyTrackerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "DirtyTracker.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+	typedef std::vector<std::pair<unsigned int, unsigned int>> Ranges;
+
+	Ranges Consume(DirtyTracker& tracker, int frameIndex)
+	{
+		Ranges ranges;
+		tracker.ConsumeDirtyRanges(frameIndex, [&](unsigned int first, unsigned int count)
+		{
+			ranges.push_back({ first, count });
+		});
+		return ranges;
+	}
+}
+
+TEST(DirtyTracker_NewElementsAreDirtyInEveryFrameResource)
+{
+	DirtyTracker tracker(3, 5);
+	for(int frame = 0; frame < 3; ++frame)
+		CHECK(tracker.DirtyCount(frame) == 5);
+
+	CHECK((Consume(tracker, 1) == Ranges{ { 0, 5 } }));
+	CHECK(tracker.DirtyCount(0) == 5);
+	CHECK(tracker.DirtyCount(1) == 0);
+	CHECK(tracker.DirtyCount(2) == 5);
+	CHECK(Consume(tracker, 1).empty());
+}
+
+TEST(DirtyTracker_ChangesReachEachFrameResourceOnce)
+{
+	DirtyTracker tracker(3, 10);
+	for(int frame = 0; frame < 3; ++frame)
+		Consume(tracker, frame);
+
+	// Marking twice before a frame resource is written queues the element once.
+	tracker.MarkDirty(4);
+	tracker.MarkDirty(4);
+	for(int frame = 0; frame < 3; ++frame)
+	{
+		CHECK(tracker.DirtyCount(frame) == 1);
+		CHECK(tracker.IsDirty(frame, 4));
+	}
+
+	// Cycle through the frame resources: each sees the change exactly once.
+	for(int frame = 0; frame < 3; ++frame)
+	{
+		CHECK((Consume(tracker, frame) == Ranges{ { 4, 1 } }));
+		CHECK(!tracker.IsDirty(frame, 4));
+	}
+	for(int frame = 0; frame < 3; ++frame)
+		CHECK(tracker.DirtyCount(frame) == 0);
+}
+
+TEST(DirtyTracker_CoalescesConsecutiveElementsIntoRuns)
+{
+	DirtyTracker tracker(2, 20);
+	Consume(tracker, 0);
+	Consume(tracker, 1);
+
+	for(unsigned int i : { 9u, 3u, 4u, 15u, 5u, 10u, 19u })
+		tracker.MarkDirty(i);
+
+	CHECK((Consume(tracker, 0) == Ranges{ { 3, 3 }, { 9, 2 }, { 15, 1 }, { 19, 1 } }));
+
+	// Frame 1 still has all of them, plus one marked since.
+	tracker.MarkDirty(6);
+	CHECK((Consume(tracker, 1) == Ranges{ { 3, 4 }, { 9, 2 }, { 15, 1 }, { 19, 1 } }));
+	CHECK((Consume(tracker, 0) == Ranges{ { 6, 1 } }));
+}
+
+TEST(DirtyTracker_ResizeDropsRemovedAndMarksAddedElements)
+{
+	DirtyTracker tracker(2, 4);
+	Consume(tracker, 0);
+	tracker.MarkDirty(3);
+
+	tracker.Resize(3);
+	CHECK(tracker.ElementCount() == 3);
+	CHECK(tracker.DirtyCount(0) == 0);
+	CHECK((Consume(tracker, 1) == Ranges{ { 0, 3 } }));
+
+	tracker.Resize(6);
+	CHECK((Consume(tracker, 0) == Ranges{ { 3, 3 } }));
+
+	tracker.MarkAllDirty();
+	CHECK(tracker.DirtyCount(0) == 6);
+	CHECK(tracker.DirtyCount(1) == 6);
+}
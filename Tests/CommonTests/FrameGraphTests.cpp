@@ -0,0 +1,148 @@
+//***************************************************************************************
+// FrameGraphTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "FrameGraph.h"
+#include <sstream>
+
+namespace
+{
+	// The D3D12_RESOURCE_STATES values the graph below uses.
+	const FrameGraph::State Present = 0x0;
+	const FrameGraph::State RenderTarget = 0x4;
+	const FrameGraph::State DepthWrite = 0x10;
+	const FrameGraph::State DepthRead = 0x20;
+	const FrameGraph::State NonPixelShaderResource = 0x40;
+	const FrameGraph::State PixelShaderResource = 0x80;
+
+	std::string StateName(FrameGraph::State state)
+	{
+		switch(state)
+		{
+		case Present: return "PRESENT";
+		case RenderTarget: return "RT";
+		case DepthWrite: return "DEPTH_WRITE";
+		case DepthRead: return "DEPTH_READ";
+		case PixelShaderResource: return "PS_RESOURCE";
+		case PixelShaderResource | NonPixelShaderResource: return "SHADER_RESOURCE";
+		default: return std::to_string(state);
+		}
+	}
+
+	// A chain A -> B -> C -> back buffer, with a debug pass nothing reads.
+	struct ChainGraph
+	{
+		FrameGraph Graph;
+		FrameGraph::ResourceId BackBuffer, Depth, A, B, C, Unused;
+		FrameGraph::PassId WriteA, AToB, BToC, Debug, Final;
+
+		ChainGraph()
+		{
+			BackBuffer = Graph.Import("backBuffer", Present);
+			Graph.MarkOutput(BackBuffer);
+			Depth = Graph.Import("depth", DepthWrite);
+			A = Graph.CreateTransient("A", 1000, 256);
+			B = Graph.CreateTransient("B", 1000, 256);
+			C = Graph.CreateTransient("C", 500, 512);
+			Unused = Graph.CreateTransient("U", 100, 256);
+
+			WriteA = Graph.AddPass("writeA");
+			Graph.Write(WriteA, A, RenderTarget);
+
+			AToB = Graph.AddPass("AtoB");
+			Graph.Read(AToB, A, PixelShaderResource);
+			Graph.Write(AToB, B, RenderTarget);
+
+			BToC = Graph.AddPass("BtoC");
+			Graph.Read(BToC, B, PixelShaderResource);
+			Graph.Read(BToC, B, NonPixelShaderResource);
+			Graph.Write(BToC, C, RenderTarget);
+			Graph.Read(BToC, Depth, DepthRead);
+
+			Debug = Graph.AddPass("debugU");
+			Graph.Write(Debug, Unused, RenderTarget);
+
+			Final = Graph.AddPass("final");
+			Graph.Read(Final, C, PixelShaderResource);
+			Graph.Write(Final, BackBuffer, RenderTarget);
+			Graph.Write(Final, Depth, DepthWrite);
+
+			Graph.Compile();
+		}
+	};
+}
+
+TEST(FrameGraph_CullsPassesNothingReads)
+{
+	ChainGraph chain;
+	CHECK(chain.Graph.IsCulled(chain.Debug));
+	CHECK(!chain.Graph.IsUsed(chain.Unused));
+	CHECK(chain.Graph.LivePasses().size() == 4);
+}
+
+TEST(FrameGraph_AliasesTransientsWithDisjointLifetimes)
+{
+	ChainGraph chain;
+	const FrameGraph& graph = chain.Graph;
+
+	// A lives in passes 0-1, B in 1-2 and C in 2-4: only A and C can share memory.
+	CHECK(graph.HeapOffset(chain.A) != graph.HeapOffset(chain.B));
+	CHECK(graph.HeapOffset(chain.A) == graph.HeapOffset(chain.C));
+	CHECK(graph.HeapSize() == 2024);
+	CHECK(graph.HeapAlignment() == 512);
+
+	// Combined read states of one pass.
+	CHECK(graph.StartState(chain.B) == (PixelShaderResource | NonPixelShaderResource));
+}
+
+TEST(FrameGraph_DumpWritesTheSchedule)
+{
+	ChainGraph chain;
+	std::ostringstream out;
+	chain.Graph.Dump(out, StateName);
+
+	CHECK(out.str() ==
+		"FrameGraph: 4 of 5 passes, heap 2024 bytes\n"
+		"  pass 0 writeA\n"
+		"    before: alias C -> A\n"
+		"    before: A PS_RESOURCE -> RT\n"
+		"  pass 1 AtoB\n"
+		"    before: A RT -> PS_RESOURCE\n"
+		"    before: B SHADER_RESOURCE -> RT\n"
+		"  pass 2 BtoC\n"
+		"    before: alias A -> C\n"
+		"    before: B RT -> SHADER_RESOURCE\n"
+		"    before: C PS_RESOURCE -> RT\n"
+		"    before: depth DEPTH_WRITE -> DEPTH_READ\n"
+		"  pass 3 debugU (culled)\n"
+		"  pass 4 final\n"
+		"    before: C RT -> PS_RESOURCE\n"
+		"    before: backBuffer PRESENT -> RT\n"
+		"    before: depth DEPTH_READ -> DEPTH_WRITE\n"
+		"    after: backBuffer RT -> PRESENT\n"
+		"  transient A offset 0 size 1000 passes 0-1\n"
+		"  transient B offset 1024 size 1000 passes 1-2\n"
+		"  transient C offset 0 size 500 passes 2-4\n"
+		"  transient U unused\n");
+}
+
+TEST(FrameGraph_DumpPrintsStatesInHexByDefault)
+{
+	ChainGraph chain;
+	std::ostringstream out;
+	chain.Graph.Dump(out);
+
+	CHECK(out.str().find("    before: B 0xc0 -> 0x4\n") != std::string::npos);
+	CHECK(out.str().find("    after: backBuffer 0x4 -> 0x0\n") != std::string::npos);
+}
+
+TEST(FrameGraph_DumpsAnEmptyGraph)
+{
+	FrameGraph graph;
+	graph.Compile();
+
+	std::ostringstream out;
+	graph.Dump(out);
+	CHECK(out.str() == "FrameGraph: 0 of 0 passes, heap 0 bytes\n");
+}
@@ -0,0 +1,92 @@
+//***************************************************************************************
+// FramePacerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "FramePacer.h"
+#include "MockFence.h"
+
+namespace
+{
+	// Records and submits one frame the way the demos do.
+	FramePacer::uint32 RunFrame(FramePacer& pacer, MockFence& fence, FramePacer::uint64& currentFence)
+	{
+		FramePacer::uint32 index = pacer.BeginFrame();
+		fence.Signal(++currentFence);
+		pacer.EndFrame(currentFence);
+		return index;
+	}
+}
+
+TEST(FramePacer_CyclesThroughFrameResources)
+{
+	MockFence fence;
+	FramePacer pacer(&fence, 3);
+	FramePacer::uint64 currentFence = 0;
+
+	CHECK(RunFrame(pacer, fence, currentFence) == 0);
+	CHECK(RunFrame(pacer, fence, currentFence) == 1);
+	CHECK(RunFrame(pacer, fence, currentFence) == 2);
+	CHECK(fence.NumBlockingWaits() == 0);
+	CHECK(pacer.GetStats().NumFrames == 3);
+}
+
+TEST(FramePacer_WaitsOnlyWhenTheGpuFallsBehind)
+{
+	MockFence fence;
+	FramePacer pacer(&fence, 3);
+	FramePacer::uint64 currentFence = 0;
+
+	for(int i = 0; i < 3; ++i)
+		RunFrame(pacer, fence, currentFence);
+
+	// The fourth frame reuses frame resource 0, which frame 1 still holds.
+	CHECK(RunFrame(pacer, fence, currentFence) == 0);
+	CHECK(fence.NumBlockingWaits() == 1);
+	CHECK(fence.GetCompletedValue() == 1);
+	CHECK(pacer.GetStats().NumWaits == 1);
+
+	// A GPU that keeps up never blocks the CPU.
+	fence.Complete(currentFence);
+	RunFrame(pacer, fence, currentFence);
+	CHECK(fence.NumBlockingWaits() == 1);
+	CHECK(pacer.GetStats().LastWaitMs == 0.0);
+}
+
+TEST(FramePacer_WaitIdleCompletesEverySubmittedFrame)
+{
+	MockFence fence;
+	FramePacer pacer(&fence, 2);
+	FramePacer::uint64 currentFence = 0;
+
+	pacer.WaitIdle();
+	CHECK(fence.NumBlockingWaits() == 0);
+
+	RunFrame(pacer, fence, currentFence);
+	RunFrame(pacer, fence, currentFence);
+	pacer.WaitIdle();
+	CHECK(fence.NumPending() == 0);
+	CHECK(fence.GetCompletedValue() == currentFence);
+}
+
+TEST(FramePacer_SetFramesInFlightDrainsAndRestarts)
+{
+	MockFence fence;
+	FramePacer pacer(&fence, 3);
+	FramePacer::uint64 currentFence = 0;
+
+	RunFrame(pacer, fence, currentFence);
+	RunFrame(pacer, fence, currentFence);
+
+	pacer.SetFramesInFlight(2);
+	CHECK(fence.NumPending() == 0);
+	CHECK(pacer.FramesInFlight() == 2);
+	CHECK(RunFrame(pacer, fence, currentFence) == 0);
+	CHECK(RunFrame(pacer, fence, currentFence) == 1);
+
+	// Frame resource 0 was last used by frame 3, after the resize.
+	pacer.ResetStats();
+	CHECK(RunFrame(pacer, fence, currentFence) == 0);
+	CHECK(pacer.GetStats().NumWaits == 1);
+	CHECK(fence.GetCompletedValue() == 3);
+}
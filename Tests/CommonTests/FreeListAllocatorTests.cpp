@@ -0,0 +1,113 @@
+//***************************************************************************************
+// FreeListAllocatorTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "FreeListAllocator.h"
+#include <random>
+#include <utility>
+#include <vector>
+
+TEST(FreeListAllocator_TakesTheFirstRangeThatFits)
+{
+	FreeListAllocator allocator(100);
+	FreeListAllocator::uint32 a = allocator.Allocate(10);
+	FreeListAllocator::uint32 b = allocator.Allocate(20);
+	FreeListAllocator::uint32 c = allocator.Allocate(30);
+	CHECK(a == 0 && b == 10 && c == 30);
+	CHECK(allocator.UsedSize() == 60);
+
+	allocator.Free(b, 20);
+	CHECK(allocator.NumFreeRanges() == 2);
+	CHECK(allocator.Allocate(15) == 10);
+	CHECK(allocator.Allocate(101) == FreeListAllocator::InvalidOffset);
+}
+
+TEST(FreeListAllocator_MergesNeighbors)
+{
+	FreeListAllocator allocator(100);
+	FreeListAllocator::uint32 a = allocator.Allocate(10);
+	FreeListAllocator::uint32 b = allocator.Allocate(20);
+	FreeListAllocator::uint32 c = allocator.Allocate(30);
+
+	allocator.Free(a, 10);
+	allocator.Free(c, 30);
+	CHECK(allocator.NumFreeRanges() == 2);
+
+	// Freeing the middle range joins all three with the tail.
+	allocator.Free(b, 20);
+	CHECK(allocator.NumFreeRanges() == 1);
+	CHECK(allocator.LargestFreeRange() == 100);
+}
+
+TEST(FreeListAllocator_FencedFreesWaitForTheirFence)
+{
+	FreeListAllocator allocator(100);
+	FreeListAllocator::uint32 a = allocator.Allocate(40);
+	FreeListAllocator::uint32 b = allocator.Allocate(40);
+
+	allocator.Free(a, 40, 5);
+	allocator.Free(b, 40, 6);
+	CHECK(allocator.UsedSize() == 80);
+	CHECK(allocator.Allocate(40) == FreeListAllocator::InvalidOffset);
+
+	allocator.ReleaseCompleted(4);
+	CHECK(allocator.UsedSize() == 80);
+	allocator.ReleaseCompleted(5);
+	CHECK(allocator.UsedSize() == 40);
+	allocator.ReleaseCompleted(6);
+	CHECK(allocator.UsedSize() == 0);
+	CHECK(allocator.LargestFreeRange() == 100);
+}
+
+TEST(FreeListAllocator_ResetDropsPendingFrees)
+{
+	FreeListAllocator allocator(100);
+	allocator.Free(allocator.Allocate(50), 50, 1);
+
+	allocator.Reset(200);
+	CHECK(allocator.Capacity() == 200);
+	CHECK(allocator.UsedSize() == 0);
+
+	// The dropped free must not come back and corrupt the new free list.
+	allocator.ReleaseCompleted(1);
+	CHECK(allocator.NumFreeRanges() == 1);
+	CHECK(allocator.LargestFreeRange() == 200);
+}
+
+TEST(FreeListAllocator_RandomAllocationsNeverOverlap)
+{
+	std::mt19937 random(1);
+	std::vector<std::pair<FreeListAllocator::uint32, FreeListAllocator::uint32>> live;
+	FreeListAllocator allocator(1000);
+
+	bool overlapped = false;
+	for(int i = 0; i < 20000; ++i)
+	{
+		if(random() % 2 == 0 && !live.empty())
+		{
+			size_t k = random() % live.size();
+			allocator.Free(live[k].first, live[k].second);
+			live.erase(live.begin() + k);
+			continue;
+		}
+
+		FreeListAllocator::uint32 size = 1 + random() % 20;
+		FreeListAllocator::uint32 offset = allocator.Allocate(size);
+		if(offset == FreeListAllocator::InvalidOffset)
+			continue;
+
+		for(const auto& range : live)
+		{
+			if(offset < range.first + range.second && range.first < offset + size)
+				overlapped = true;
+		}
+		live.push_back({ offset, size });
+	}
+	CHECK(!overlapped);
+
+	for(const auto& range : live)
+		allocator.Free(range.first, range.second);
+	CHECK(allocator.UsedSize() == 0);
+	CHECK(allocator.NumFreeRanges() == 1);
+}
@@ -0,0 +1,141 @@
+//***************************************************************************************
+// GameTimerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "GameTimer.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	const std::int64_t Ms = 1000000;
+
+	bool Near(double a, double b)
+	{
+		return std::fabs(a - b) <= 1e-6 * std::fabs(b);
+	}
+}
+
+TEST(GameTimer_TicksByAGivenDelta)
+{
+	GameTimer timer;
+	timer.Reset();
+	CHECK(timer.TotalTimeNs() == 0);
+
+	timer.Tick(16 * Ms);
+	timer.Tick(17 * Ms);
+	CHECK(timer.DeltaTimeNs() == 17 * Ms);
+	CHECK(timer.TotalTimeNs() == 33 * Ms);
+	CHECK(timer.DeltaTime() == (float)(17 * Ms / 1e9));
+
+	// Time does not run backwards.
+	timer.Tick(-5 * Ms);
+	CHECK(timer.DeltaTimeNs() == 0);
+	CHECK(timer.TotalTimeNs() == 33 * Ms);
+
+	// A stopped timer ticks by nothing and records nothing.
+	timer.Stop();
+	timer.Tick(16 * Ms);
+	CHECK(timer.DeltaTimeNs() == 0);
+	CHECK(timer.GetFrameTimeStats().Count == 3);
+}
+
+TEST(GameTimer_ComputesFrameTimePercentiles)
+{
+	GameTimer timer;
+	timer.SetHistorySize(100);
+	timer.Reset();
+	CHECK(timer.GetFrameTimeStats().Count == 0);
+
+	for(std::int64_t i = 1; i <= 100; ++i)
+		timer.Tick(i * Ms);
+
+	GameTimer::FrameTimeStats stats = timer.GetFrameTimeStats();
+	CHECK(stats.Count == 100);
+	CHECK(stats.MinMs == 1.0 && stats.MaxMs == 100.0);
+	CHECK(Near(stats.MeanMs, 50.5));
+	CHECK(stats.P50Ms == 50.0);
+	CHECK(stats.P95Ms == 95.0);
+	CHECK(stats.P99Ms == 99.0);
+
+	// The ring keeps the last 100 frames: 21 to 100 and twenty long ones.
+	for(int i = 0; i < 20; ++i)
+		timer.Tick(200 * Ms);
+
+	stats = timer.GetFrameTimeStats();
+	CHECK(stats.Count == 100);
+	CHECK(stats.MinMs == 21.0 && stats.MaxMs == 200.0);
+	CHECK(stats.P50Ms == 70.0);
+	CHECK(stats.P95Ms == 200.0);
+}
+
+TEST(GameTimer_BucketsFrameTimes)
+{
+	GameTimer timer;
+	timer.Reset();
+	for(std::int64_t ms : { 1, 5, 9, 10, 15, 40, 1000 })
+		timer.Tick(ms * Ms);
+
+	// 10 ms starts the second bucket, and the last bucket takes every longer frame.
+	CHECK((timer.FrameTimeHistogram(10.0, 3) == std::vector<std::uint32_t>{ 3, 2, 2 }));
+	CHECK((timer.FrameTimeHistogram(50.0, 2) == std::vector<std::uint32_t>{ 6, 1 }));
+	CHECK((timer.FrameTimeHistogram(10.0, 1) == std::vector<std::uint32_t>{ 7 }));
+
+	CHECK(timer.FrameTimeHistogram(10.0, 0).empty());
+	CHECK((timer.FrameTimeHistogram(0.0, 2) == std::vector<std::uint32_t>{ 0, 0 }));
+}
+
+TEST(GameTimer_SmoothsTheDelta)
+{
+	GameTimer timer;
+	timer.Reset();
+
+	// Off, the smoothed delta is the delta.
+	timer.Tick(10 * Ms);
+	CHECK(timer.SmoothedDeltaTime() == timer.DeltaTime());
+
+	// The first frame seeds the average, each next one moves it halfway.
+	timer.SetSmoothing(0.5f);
+	timer.Tick(10 * Ms);
+	CHECK(Near(timer.SmoothedDeltaTime(), 0.010));
+	timer.Tick(20 * Ms);
+	CHECK(Near(timer.SmoothedDeltaTime(), 0.015));
+	timer.Tick(20 * Ms);
+	CHECK(Near(timer.SmoothedDeltaTime(), 0.0175));
+	CHECK(timer.DeltaTime() == (float)(20 * Ms / 1e9));
+
+	// A weight of 1 follows the delta; out of range weights are clamped.
+	timer.SetSmoothing(4.0f);
+	timer.Tick(30 * Ms);
+	timer.Tick(8 * Ms);
+	CHECK(Near(timer.SmoothedDeltaTime(), 0.008));
+
+	timer.SetSmoothing(0.0f);
+	timer.Tick(12 * Ms);
+	CHECK(timer.SmoothedDeltaTime() == timer.DeltaTime());
+}
+
+TEST(GameTimer_ResetClearsTheHistory)
+{
+	GameTimer timer;
+	timer.Reset();
+	for(int i = 0; i < 10; ++i)
+		timer.Tick(500 * Ms);
+
+	// E.g. the frames spent loading.
+	timer.Reset();
+	CHECK(timer.GetFrameTimeStats().Count == 0);
+	CHECK((timer.FrameTimeHistogram(10.0, 2) == std::vector<std::uint32_t>{ 0, 0 }));
+	CHECK(timer.TotalTimeNs() == 0);
+
+	timer.Tick(16 * Ms);
+	GameTimer::FrameTimeStats stats = timer.GetFrameTimeStats();
+	CHECK(stats.Count == 1);
+	CHECK(stats.MaxMs == 16.0);
+
+	// So does a new history size.
+	timer.SetHistorySize(4);
+	CHECK(timer.GetFrameTimeStats().Count == 0);
+}
@@ -0,0 +1,228 @@
+//***************************************************************************************
+// HeadlessRunnerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "HeadlessRunner.h"
+#include "Profiler.h"
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	typedef HeadlessRunner::InputEvent InputEvent;
+
+	// Logs what the runner calls, in order, and stops the run after StopAfter frames.
+	struct RecordingClient : public HeadlessRunner::Client
+	{
+		HeadlessRunner* Runner = nullptr;
+		const GameTimer* Timer = nullptr;
+		HeadlessRunner::uint32 StopAfter = ~0u;
+
+		std::vector<std::string> Calls;
+		std::vector<std::int64_t> Deltas;
+		std::vector<bool> KeyW;
+		bool SawOwnTimer = true;
+
+		void OnInput(const InputEvent& event)override
+		{
+			Calls.push_back("input " + std::to_string(event.Frame) + " " + std::to_string((int)event.Kind));
+		}
+
+		void Update(const GameTimer& gt)override
+		{
+			Calls.push_back("update " + std::to_string(Runner->CurrentFrame()));
+			Deltas.push_back(gt.DeltaTimeNs());
+			KeyW.push_back(Runner->IsKeyDown('W'));
+			SawOwnTimer = SawOwnTimer && &gt == Timer;
+		}
+
+		bool EndFrame(const GameTimer& /*gt*/)override
+		{
+			return Runner->CurrentFrame() + 1 < StopAfter;
+		}
+	};
+
+	InputEvent Event(HeadlessRunner::uint32 frame, InputEvent::Type kind, HeadlessRunner::uint32 key = 0)
+	{
+		InputEvent event;
+		event.Frame = frame;
+		event.Kind = kind;
+		event.Key = key;
+		return event;
+	}
+
+	std::string Call(const char* what, int frame, InputEvent::Type kind)
+	{
+		return std::string(what) + " " + std::to_string(frame) + " " + std::to_string((int)kind);
+	}
+
+	std::string ScriptError(const std::string& script)
+	{
+		std::istringstream in(script);
+		std::vector<InputEvent> events;
+		std::string error;
+		return HeadlessRunner::LoadInputScript(in, events, &error) ? "" : error;
+	}
+
+	std::string DeltasError(const std::string& text)
+	{
+		std::istringstream in(text);
+		std::vector<double> deltas;
+		std::string error;
+		return HeadlessRunner::LoadDeltas(in, deltas, &error) ? "" : error;
+	}
+}
+
+TEST(HeadlessRunner_TicksTheClientTimerByRoundedSteps)
+{
+	HeadlessRunner::Settings settings;
+	settings.NumFrames = 5;
+	settings.FixedDeltaSeconds = 0.02;
+	settings.RecordedDeltas = { 0.01, 1.0 / 60.0, 1.5e-9 };
+
+	HeadlessRunner runner(settings);
+	GameTimer timer;
+	RecordingClient client;
+	client.Runner = &runner;
+	client.Timer = &timer;
+
+	HeadlessRunner::Results results = runner.Run(client, timer);
+
+	// Recorded steps first, rounded to whole nanoseconds, then the fixed one.
+	CHECK((client.Deltas == std::vector<std::int64_t>{ 10000000, 16666667, 2, 20000000, 20000000 }));
+	CHECK(client.SawOwnTimer);
+	CHECK(timer.TotalTimeNs() == 66666669);
+	CHECK(results.NumFrames == 5);
+	CHECK(results.SimulatedSeconds == 66666669 / 1e9);
+	CHECK(results.MinMs <= results.P50Ms && results.P50Ms <= results.MaxMs);
+
+	// A second run starts the timer over.
+	RecordingClient again;
+	again.Runner = &runner;
+	again.Timer = &timer;
+	runner.Run(again, timer);
+	CHECK(again.Deltas == client.Deltas);
+	CHECK(timer.TotalTimeNs() == 66666669);
+}
+
+TEST(HeadlessRunner_DeliversInputBeforeTheFramesUpdate)
+{
+	HeadlessRunner::Settings settings;
+	settings.NumFrames = 5;
+
+	// Out of order on purpose; events of the same frame keep their order.
+	settings.Input =
+	{
+		Event(2, InputEvent::Type::KeyDown, 'W'),
+		Event(4, InputEvent::Type::KeyUp, 'W'),
+		Event(0, InputEvent::Type::MouseDown),
+		Event(2, InputEvent::Type::MouseMove),
+		Event(7, InputEvent::Type::KeyDown, 'W'),
+	};
+
+	HeadlessRunner runner(settings);
+	GameTimer timer;
+	RecordingClient client;
+	client.Runner = &runner;
+	client.Timer = &timer;
+	runner.Run(client, timer);
+
+	const std::vector<std::string> expected =
+	{
+		Call("input", 0, InputEvent::Type::MouseDown),
+		"update 0",
+		"update 1",
+		Call("input", 2, InputEvent::Type::KeyDown),
+		Call("input", 2, InputEvent::Type::MouseMove),
+		"update 2",
+		"update 3",
+		Call("input", 4, InputEvent::Type::KeyUp),
+		"update 4",
+	};
+	CHECK(client.Calls == expected);
+	CHECK((client.KeyW == std::vector<bool>{ false, false, true, true, false }));
+
+	// The key state only covers what has been delivered; frame 7 is past the end.
+	CHECK(!runner.IsKeyDown('W'));
+	CHECK(!runner.IsKeyDown(1000));
+}
+
+TEST(HeadlessRunner_StopsWhenEndFrameSaysSo)
+{
+	HeadlessRunner::Settings settings;
+	settings.NumFrames = 10;
+	settings.FixedDeltaSeconds = 0.5;
+
+	HeadlessRunner runner(settings);
+	GameTimer timer;
+	RecordingClient client;
+	client.Runner = &runner;
+	client.Timer = &timer;
+	client.StopAfter = 3;
+
+	Profiler profiler;
+	HeadlessRunner::Results results = runner.Run(client, timer, &profiler);
+	CHECK(results.NumFrames == 3);
+	CHECK(results.SimulatedSeconds == 1.5);
+	CHECK(client.Deltas.size() == 3);
+
+	// Every frame is a complete profiler frame with its Update marker.
+	CHECK(profiler.NumFrames() == 3);
+	std::vector<Profiler::Stat> stats = profiler.Summarize();
+	bool foundUpdate = false;
+	for(const Profiler::Stat& stat : stats)
+	{
+		if(stat.Name == "Update")
+		{
+			foundUpdate = true;
+			CHECK(stat.Count == 3);
+		}
+	}
+	CHECK(foundUpdate);
+}
+
+TEST(HeadlessRunner_LoadsInputScripts)
+{
+	std::istringstream in(
+		"# frame event ...\n"
+		"\n"
+		"10 keydown w      # letters are upper cased\n"
+		"3 mousedown 100 -20 1\n"
+		"10 keyup '1'\n"
+		"12 keydown 38\n"
+		"3 mousemove 5 6 0\n");
+
+	std::vector<InputEvent> events;
+	CHECK(HeadlessRunner::LoadInputScript(in, events));
+	CHECK(events.size() == 5);
+
+	// Sorted by frame, file order within a frame.
+	CHECK(events[0].Frame == 3 && events[0].Kind == InputEvent::Type::MouseDown);
+	CHECK(events[0].X == 100 && events[0].Y == -20 && events[0].Buttons == 1);
+	CHECK(events[1].Frame == 3 && events[1].Kind == InputEvent::Type::MouseMove);
+	CHECK(events[2].Kind == InputEvent::Type::KeyDown && events[2].Key == 'W');
+	CHECK(events[3].Kind == InputEvent::Type::KeyUp && events[3].Key == '1');
+	CHECK(events[4].Frame == 12 && events[4].Key == 38);
+
+	CHECK(ScriptError("1 keydown W\nkeydown W\n") == "line 2: expected a frame number");
+	CHECK(ScriptError("3\n") == "line 1: expected an event type");
+	CHECK(ScriptError("3 jump\n") == "line 1: unknown event type jump");
+	CHECK(ScriptError("3 mousedown 1 2\n") == "line 1: expected <x> <y> <buttons>");
+	CHECK(ScriptError("3 keydown\n") == "line 1: expected a key");
+	CHECK(ScriptError("3 keydown 300\n") == "line 1: expected a key");
+	CHECK(ScriptError("\n\n3 keyup W W\n") == "line 3: unexpected W");
+}
+
+TEST(HeadlessRunner_LoadsDeltas)
+{
+	std::istringstream in("0.016\n# a comment\n\n0.033  \n0\n");
+	std::vector<double> deltas;
+	CHECK(HeadlessRunner::LoadDeltas(in, deltas));
+	CHECK((deltas == std::vector<double>{ 0.016, 0.033, 0.0 }));
+
+	CHECK(DeltasError("0.016\nfast\n") == "line 2: expected a time step in seconds");
+	CHECK(DeltasError("0.016\n-0.01\n") == "line 2: negative time step");
+}
@@ -0,0 +1,162 @@
+//***************************************************************************************
+// InstanceBatcherTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "InstanceBatcher.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Stand in for MeshGeometry and ID3D12PipelineState; only their addresses are used.
+	int gBox, gSphere, gOpaquePso, gAlphaPso;
+
+	InstanceBatcher::Key MakeKey(const void* geometry, const void* pso, InstanceBatcher::uint32 indexCount = 36)
+	{
+		InstanceBatcher::Key key;
+		key.Geometry = geometry;
+		key.State = pso;
+		key.Topology = 4;
+		key.IndexCount = indexCount;
+		return key;
+	}
+
+	typedef std::vector<std::pair<InstanceBatcher::uint32, InstanceBatcher::uint32>> Runs;
+
+	Runs Consume(InstanceSlotTracker& tracker, int frameIndex, const std::vector<InstanceSlotTracker::uint32>& slotItems)
+	{
+		Runs runs;
+		tracker.ConsumeStaleRuns(frameIndex, slotItems, [&](InstanceSlotTracker::uint32 first, InstanceSlotTracker::uint32 count)
+		{
+			runs.push_back({ first, count });
+		});
+		return runs;
+	}
+}
+
+TEST(InstanceBatcher_GroupsItemsByGeometryAndState)
+{
+	InstanceBatcher batcher;
+	batcher.Add(MakeKey(&gBox, &gOpaquePso), 10);
+	batcher.Add(MakeKey(&gSphere, &gOpaquePso), 11);
+	batcher.Add(MakeKey(&gBox, &gOpaquePso), 12);
+	batcher.Add(MakeKey(&gBox, &gAlphaPso), 13);
+	batcher.Add(MakeKey(&gSphere, &gOpaquePso), 14);
+	batcher.Add(MakeKey(&gBox, &gOpaquePso), 15);
+	batcher.Build();
+
+	// Batches in the order of their first item, items in insertion order.
+	const auto& batches = batcher.Batches();
+	CHECK(batches.size() == 3);
+	CHECK(batches[0].BatchKey.Geometry == &gBox && batches[0].BatchKey.State == &gOpaquePso);
+	CHECK(batches[1].BatchKey.Geometry == &gSphere);
+	CHECK(batches[2].BatchKey.State == &gAlphaPso);
+
+	CHECK(batches[0].FirstInstance == 0 && batches[0].InstanceCount == 3);
+	CHECK(batches[1].FirstInstance == 3 && batches[1].InstanceCount == 2);
+	CHECK(batches[2].FirstInstance == 5 && batches[2].InstanceCount == 1);
+
+	CHECK((batcher.InstanceItems() == std::vector<InstanceBatcher::uint32>{ 10, 12, 15, 11, 14, 13 }));
+	CHECK(batcher.NumItems() == 6);
+}
+
+TEST(InstanceBatcher_SplitsBatchesOnAnyBindDifference)
+{
+	InstanceBatcher batcher;
+	InstanceBatcher::Key key = MakeKey(&gBox, &gOpaquePso);
+	batcher.Add(key, 0);
+
+	// Each of these needs a different bind or draw argument, so a batch of its own.
+	InstanceBatcher::Key otherSubmesh = MakeKey(&gBox, &gOpaquePso, 24);
+	batcher.Add(otherSubmesh, 1);
+
+	InstanceBatcher::Key otherStart = key;
+	otherStart.StartIndexLocation = 36;
+	batcher.Add(otherStart, 2);
+
+	InstanceBatcher::Key otherBase = key;
+	otherBase.BaseVertexLocation = -8;
+	batcher.Add(otherBase, 3);
+
+	InstanceBatcher::Key otherTopology = key;
+	otherTopology.Topology = 5;
+	batcher.Add(otherTopology, 4);
+
+	InstanceBatcher::Key otherLayer = key;
+	otherLayer.Layer = 1;
+	batcher.Add(otherLayer, 5);
+
+	batcher.Add(key, 6);
+	batcher.Build();
+
+	CHECK(batcher.Batches().size() == 6);
+	CHECK(batcher.Batches()[0].InstanceCount == 2);
+	for(size_t i = 1; i < batcher.Batches().size(); ++i)
+		CHECK(batcher.Batches()[i].InstanceCount == 1);
+
+	// Clear starts over.
+	batcher.Clear();
+	batcher.Add(key, 7);
+	batcher.Build();
+	CHECK(batcher.Batches().size() == 1);
+	CHECK((batcher.InstanceItems() == std::vector<InstanceBatcher::uint32>{ 7 }));
+}
+
+TEST(InstanceSlotTracker_WritesEachFrameResourceOnceForAStillScene)
+{
+	InstanceSlotTracker tracker(2, 6);
+	std::vector<InstanceSlotTracker::uint32> slots = { 3, 1, 4, 0, 5 };
+
+	CHECK((Consume(tracker, 0, slots) == Runs{ { 0, 5 } }));
+	CHECK((Consume(tracker, 1, slots) == Runs{ { 0, 5 } }));
+
+	for(int frame = 0; frame < 4; ++frame)
+		CHECK(Consume(tracker, frame % 2, slots).empty());
+}
+
+TEST(InstanceSlotTracker_RewritesOnlyMovedAndChangedSlots)
+{
+	InstanceSlotTracker tracker(2, 8);
+	std::vector<InstanceSlotTracker::uint32> slots = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	Consume(tracker, 0, slots);
+	Consume(tracker, 1, slots);
+
+	// The depth order changes: items 1 and 2 swap, and 6 moves to the front.
+	std::vector<InstanceSlotTracker::uint32> reordered = { 6, 0, 2, 1, 3, 4, 5, 7 };
+	CHECK((Consume(tracker, 0, reordered) == Runs{ { 0, 2 }, { 3, 4 } }));
+
+	std::vector<InstanceSlotTracker::uint32> swapped = { 0, 2, 1, 3, 4, 5, 6, 7 };
+	CHECK((Consume(tracker, 1, swapped) == Runs{ { 1, 2 } }));
+
+	// Item 4 changes: each frame resource rewrites its slot once.
+	tracker.MarkDirty(4);
+	CHECK((Consume(tracker, 0, reordered) == Runs{ { 5, 1 } }));
+	CHECK((Consume(tracker, 1, swapped) == Runs{ { 4, 1 } }));
+	CHECK(Consume(tracker, 0, reordered).empty());
+	CHECK(Consume(tracker, 1, swapped).empty());
+
+	// Two separate changes give two runs.
+	tracker.MarkDirty(0);
+	tracker.MarkDirty(7);
+	CHECK((Consume(tracker, 1, swapped) == Runs{ { 0, 1 }, { 7, 1 } }));
+}
+
+TEST(InstanceSlotTracker_HandlesAGrowingAndShrinkingInstanceCount)
+{
+	InstanceSlotTracker tracker(1, 4);
+	CHECK((Consume(tracker, 0, { 0, 1 }) == Runs{ { 0, 2 } }));
+
+	// New slots are always written.
+	CHECK((Consume(tracker, 0, { 0, 1, 2, 3 }) == Runs{ { 2, 2 } }));
+
+	// Dropped slots are forgotten, so they are written again when they come back.
+	CHECK(Consume(tracker, 0, { 0, 1 }).empty());
+	CHECK((Consume(tracker, 0, { 0, 1, 2 }) == Runs{ { 2, 1 } }));
+
+	// Items added later are written when they first get a slot.
+	tracker.Resize(5);
+	CHECK(tracker.ItemCount() == 5);
+	CHECK((Consume(tracker, 0, { 0, 1, 2, 4 }) == Runs{ { 3, 1 } }));
+	CHECK(Consume(tracker, 0, { 0, 1, 2, 4 }).empty());
+}
@@ -0,0 +1,64 @@
+//***************************************************************************************
+// Main.cpp
+//
+// Runs the Common/ tests.  The tests only use the D3D-free sources, so besides the
+// Visual Studio project they build with any C++14 compiler:
+//
+//   g++ -std=c++14 -pthread -I../../Common *.cpp <the Common/*.cpp files listed in
+//       CommonTests.vcxproj> -o CommonTests
+//***************************************************************************************
+
+#include "Check.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace
+{
+	int gNumFailures = 0;
+}
+
+std::vector<Check::TestCase>& Check::Tests()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+void Check::Fail(const char* file, int line, const std::string& expr)
+{
+	std::printf("  %s(%d): CHECK(%s) failed\n", file, line, expr.c_str());
+	++gNumFailures;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* filter = argc > 1 ? argv[1] : "";
+
+	int numRun = 0;
+	int numFailed = 0;
+	for(const Check::TestCase& test : Check::Tests())
+	{
+		if(std::strncmp(test.Name, filter, std::strlen(filter)) != 0)
+			continue;
+
+		std::printf("%s\n", test.Name);
+
+		int failuresBefore = gNumFailures;
+		try
+		{
+			test.Func();
+		}
+		catch(const std::exception& e)
+		{
+			std::printf("  threw %s\n", e.what());
+			++gNumFailures;
+		}
+
+		++numRun;
+		if(gNumFailures != failuresBefore)
+			++numFailed;
+	}
+
+	std::printf("%d of %d tests passed\n", numRun - numFailed, numRun);
+	return numFailed;
+}
@@ -0,0 +1,62 @@
+//***************************************************************************************
+// MappedFileTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <fstream>
+
+TEST(MappedFile_MapsWholeFile)
+{
+	{
+		std::ofstream out("MappedFileTest.bin", std::ios::binary);
+		out << "DDS contents";
+	}
+
+	MappedFile file;
+	CHECK(file.Open(L"MappedFileTest.bin"));
+	CHECK(file.Size() == 12);
+	CHECK(file.IsOpen() && std::string((const char*)file.Data(), file.Size()) == "DDS contents");
+
+	file.Close();
+	CHECK(!file.IsOpen());
+	std::remove("MappedFileTest.bin");
+}
+
+TEST(MappedFile_FailsOnMissingFile)
+{
+	MappedFile file;
+	CHECK(!file.Open(L"MappedFileTestMissing.bin"));
+	CHECK(file.LastError() != 0);
+}
+
+TEST(MappedFile_OpensNonAsciiPath)
+{
+	// Opening must not depend on the C locale, which only converts ASCII.
+	const wchar_t* name = L"MappedFileTest_caf\u00e9_\u6728.bin";
+	const char* nameUtf8 = "MappedFileTest_caf\xc3\xa9_\xe6\x9c\xa8.bin";
+
+#ifdef _WIN32
+	std::FILE* out = _wfopen(name, L"wb");
+#else
+	std::FILE* out = std::fopen(nameUtf8, "wb");
+#endif
+	CHECK(out != nullptr);
+	if(out == nullptr)
+		return;
+	std::fputs("x", out);
+	std::fclose(out);
+
+	MappedFile file;
+	CHECK(file.Open(name));
+	CHECK(file.Size() == 1);
+	file.Close();
+
+#ifdef _WIN32
+	_wremove(name);
+#else
+	std::remove(nameUtf8);
+#endif
+	(void)nameUtf8;
+}
@@ -0,0 +1,88 @@
+//***************************************************************************************
+// MipGeneratorTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+	std::vector<std::uint8_t> Checkerboard(MipGenerator::uint32 width, MipGenerator::uint32 height)
+	{
+		std::vector<std::uint8_t> pixels(width * height * 4);
+		for(MipGenerator::uint32 y = 0; y < height; ++y)
+		{
+			for(MipGenerator::uint32 x = 0; x < width; ++x)
+			{
+				std::uint8_t value = ((x ^ y) & 1) ? 255 : 0;
+				std::uint8_t* texel = &pixels[(y * width + x) * 4];
+				texel[0] = texel[1] = texel[2] = value;
+				texel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+}
+
+TEST(MipGenerator_BuildsChainDownToOneTexel)
+{
+	CHECK(MipGenerator::NumMipLevels(256, 64) == 9);
+	CHECK(MipGenerator::NumMipLevels(1, 1) == 1);
+
+	std::vector<std::uint8_t> pixels = Checkerboard(16, 8);
+	MipGenerator mips(1);
+	mips.Generate(MipGenerator::Format::RGBA8, pixels.data(), 16, 8, 16 * 4);
+
+	CHECK(mips.NumLevels() == 5);
+	CHECK(mips.GetLevel(1).Width == 8 && mips.GetLevel(1).Height == 4);
+	CHECK(mips.GetLevel(4).Width == 1 && mips.GetLevel(4).Height == 1);
+	CHECK(std::equal(pixels.begin(), pixels.end(), mips.GetLevelData(0)));
+}
+
+TEST(MipGenerator_BoxAveragesLinearTexels)
+{
+	std::vector<std::uint8_t> pixels = Checkerboard(4, 4);
+	MipGenerator mips(1);
+	mips.Generate(MipGenerator::Format::RGBA8, pixels.data(), 4, 4, 4 * 4);
+
+	const std::uint8_t* level1 = mips.GetLevelData(1);
+	for(int i = 0; i < 4; ++i)
+	{
+		CHECK(std::abs(level1[i * 4] - 128) <= 1);
+		CHECK(level1[i * 4 + 3] == 255);
+	}
+}
+
+TEST(MipGenerator_FiltersSrgbInLinearSpace)
+{
+	// Half white, half black is 0.5 in linear light, which is about 188 in sRGB.
+	std::vector<std::uint8_t> pixels = Checkerboard(4, 4);
+	MipGenerator mips(1);
+	mips.Generate(MipGenerator::Format::RGBA8_SRGB, pixels.data(), 4, 4, 4 * 4);
+
+	CHECK(std::abs(mips.GetLevelData(1)[0] - 188) <= 1);
+}
+
+TEST(MipGenerator_ThreadsMatchSingleThread)
+{
+	std::vector<std::uint8_t> pixels(64 * 32 * 4);
+	for(size_t i = 0; i < pixels.size(); ++i)
+		pixels[i] = (std::uint8_t)(i * 7 + i / 64);
+
+	MipGenerator one(1);
+	MipGenerator four(4);
+	one.Generate(MipGenerator::Format::RGBA8, pixels.data(), 64, 32, 64 * 4,
+		MipGenerator::Filter::Kaiser, MipGenerator::AddressMode::Wrap);
+	four.Generate(MipGenerator::Format::RGBA8, pixels.data(), 64, 32, 64 * 4,
+		MipGenerator::Filter::Kaiser, MipGenerator::AddressMode::Wrap);
+
+	CHECK(one.NumLevels() == four.NumLevels());
+	for(MipGenerator::uint32 m = 0; m < one.NumLevels(); ++m)
+	{
+		const MipGenerator::Level& level = one.GetLevel(m);
+		size_t size = (size_t)level.RowPitch * level.Height;
+		CHECK(std::equal(one.GetLevelData(m), one.GetLevelData(m) + size, four.GetLevelData(m)));
+	}
+}
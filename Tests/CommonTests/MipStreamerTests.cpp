@@ -0,0 +1,293 @@
+//***************************************************************************************
+// MipStreamerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "MipStreamer.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+	typedef std::vector<std::pair<MipStreamer::uint32, MipStreamer::uint32>> Calls;
+
+	// Records the SetResidentMips calls.  With CompleteAtOnce the residency changes
+	// right away, as it does when the device reallocates synchronously; otherwise the
+	// test completes the calls with Complete.
+	class RecordingDevice : public MipStreamer::Device
+	{
+	public:
+		MipStreamer* Streamer = nullptr;
+		bool CompleteAtOnce = true;
+		Calls Issued;
+		Calls InFlight;
+
+		void SetResidentMips(MipStreamer::uint32 texture, MipStreamer::uint32 firstMip)override
+		{
+			Issued.push_back({ texture, firstMip });
+			if(CompleteAtOnce)
+				Streamer->OnResidencyChanged(texture, firstMip);
+			else
+				InFlight.push_back({ texture, firstMip });
+		}
+
+		void Complete()
+		{
+			Calls calls;
+			calls.swap(InFlight);
+			for(auto& call : calls)
+				Streamer->OnResidencyChanged(call.first, call.second);
+		}
+
+		Calls TakeIssued()
+		{
+			Calls calls;
+			calls.swap(Issued);
+			return calls;
+		}
+	};
+
+	// Five mips of 256, 64, 16, 4 and 1 bytes; only the coarsest is resident at first.
+	const std::vector<MipStreamer::uint64> MipSizes = { 256, 64, 16, 4, 1 };
+
+	struct Fixture
+	{
+		RecordingDevice Device;
+		MipStreamer Streamer;
+
+		Fixture(MipStreamer::uint64 budgetBytes, MipStreamer::uint32 maxRequestsPerUpdate = 4) :
+			Streamer(&Device, budgetBytes, maxRequestsPerUpdate)
+		{
+			Device.Streamer = &Streamer;
+		}
+
+		// Requests mip over successive frames until it is resident.
+		void StreamIn(MipStreamer::uint32 texture, MipStreamer::uint32 mip, MipStreamer::uint64& frame)
+		{
+			while(Streamer.ResidentFirstMip(texture) > mip)
+			{
+				Streamer.RequestMip(texture, mip);
+				Streamer.Update(++frame);
+			}
+		}
+	};
+}
+
+TEST(MipStreamer_StreamsInOneMipPerUpdate)
+{
+	Fixture f(1000);
+	MipStreamer::uint32 tex = f.Streamer.AddTexture(MipSizes, 1);
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 4);
+	CHECK(f.Streamer.CommittedBytes() == 1);
+
+	for(MipStreamer::uint32 frame = 1; frame <= 4; ++frame)
+	{
+		f.Streamer.RequestMip(tex, 0);
+		f.Streamer.Update(frame);
+		CHECK((f.Device.TakeIssued() == Calls{ { tex, 4 - frame } }));
+	}
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 0);
+	CHECK(f.Streamer.CommittedBytes() == 341);
+
+	// Nothing left to do.
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(5);
+	CHECK(f.Device.Issued.empty());
+	CHECK(f.Streamer.GetStats().NumLoads == 4);
+}
+
+TEST(MipStreamer_ServesTheBiggestShortfallFirst)
+{
+	Fixture f(1000, 1);
+	MipStreamer::uint32 small = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 big = f.Streamer.AddTexture(MipSizes, 1);
+
+	// small is one mip short, big four.
+	f.Streamer.RequestMip(small, 3);
+	f.Streamer.RequestMip(big, 0);
+	f.Streamer.Update(1);
+	CHECK((f.Device.TakeIssued() == Calls{ { big, 3 } }));
+
+	// big is now three short and still goes first.
+	f.Streamer.RequestMip(small, 3);
+	f.Streamer.RequestMip(big, 0);
+	f.Streamer.Update(2);
+	CHECK((f.Device.TakeIssued() == Calls{ { big, 2 } }));
+}
+
+TEST(MipStreamer_IssuesAtMostMaxRequestsPerUpdate)
+{
+	Fixture f(1000, 2);
+	for(int i = 0; i < 3; ++i)
+		f.Streamer.AddTexture(MipSizes, 1);
+
+	for(MipStreamer::uint32 i = 0; i < 3; ++i)
+		f.Streamer.RequestMip(i, 0);
+	f.Streamer.Update(1);
+
+	// Equal shortfalls keep the texture order.
+	CHECK((f.Device.TakeIssued() == Calls{ { 0, 3 }, { 1, 3 } }));
+	CHECK(f.Streamer.GetStats().NumLoads == 2);
+	CHECK(f.Streamer.GetStats().NumDeferred == 0);
+
+	for(MipStreamer::uint32 i = 0; i < 3; ++i)
+		f.Streamer.RequestMip(i, 0);
+	f.Streamer.Update(2);
+	CHECK((f.Device.TakeIssued() == Calls{ { 2, 3 }, { 0, 2 } }));
+}
+
+TEST(MipStreamer_EvictsTheLeastRecentlyUsedTexturesFirst)
+{
+	// Room for the base mips and 20 more bytes.
+	Fixture f(23);
+	MipStreamer::uint32 a = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 b = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 c = f.Streamer.AddTexture(MipSizes, 1);
+
+	// a and b get 4 bytes of detail each, b used more recently.
+	MipStreamer::uint64 frame = 0;
+	f.StreamIn(a, 3, frame);
+	f.StreamIn(b, 3, frame);
+	f.Device.TakeIssued();
+	CHECK(f.Streamer.CommittedBytes() == 11);
+
+	// c's first mip still fits.
+	f.Streamer.RequestMip(c, 3);
+	f.Streamer.Update(++frame);
+	CHECK((f.Device.TakeIssued() == Calls{ { c, 3 } }));
+
+	// Its next one is 8 bytes over the budget.  b's detail is still requested and
+	// a's alone is not enough, so the load waits.
+	f.Streamer.RequestMip(c, 2);
+	f.Streamer.RequestMip(b, 3);
+	f.Streamer.Update(++frame);
+	CHECK(f.Streamer.GetStats().NumDeferred == 1);
+	CHECK(f.Device.TakeIssued().empty());
+
+	// Once b is unused too both go, a first.
+	f.Streamer.RequestMip(c, 2);
+	f.Streamer.Update(++frame);
+	CHECK((f.Device.TakeIssued() == Calls{ { a, 4 }, { b, 4 }, { c, 2 } }));
+	CHECK(f.Streamer.GetStats().NumEvictions == 2);
+	CHECK(f.Streamer.CommittedBytes() == 23);
+	CHECK(f.Streamer.ResidentFirstMip(a) == 4);
+	CHECK(f.Streamer.ResidentFirstMip(b) == 4);
+	CHECK(f.Streamer.ResidentFirstMip(c) == 2);
+}
+
+TEST(MipStreamer_EvictsOnlyAsMuchAsNeeded)
+{
+	Fixture f(45);
+	MipStreamer::uint32 a = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 b = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 c = f.Streamer.AddTexture(MipSizes, 1);
+
+	MipStreamer::uint64 frame = 0;
+	f.StreamIn(b, 2, frame);
+	f.StreamIn(a, 2, frame);
+	f.Device.TakeIssued();
+	CHECK(f.Streamer.CommittedBytes() == 43);
+
+	// Freeing b, the least recently used, makes enough room for c's 4 bytes.
+	f.Streamer.RequestMip(c, 3);
+	f.Streamer.Update(++frame);
+	CHECK((f.Device.TakeIssued() == Calls{ { b, 4 }, { c, 3 } }));
+	CHECK(f.Streamer.ResidentFirstMip(a) == 2);
+	CHECK(f.Streamer.CommittedBytes() == 27);
+}
+
+TEST(MipStreamer_DefersLoadsThatEvictionCannotMakeRoomFor)
+{
+	Fixture f(10);
+	MipStreamer::uint32 a = f.Streamer.AddTexture(MipSizes, 1);
+	MipStreamer::uint32 b = f.Streamer.AddTexture(MipSizes, 1);
+
+	MipStreamer::uint64 frame = 0;
+	f.StreamIn(a, 3, frame);
+	f.Device.TakeIssued();
+
+	f.StreamIn(b, 3, frame);
+	f.Device.TakeIssued();
+	CHECK(f.Streamer.CommittedBytes() == 10);
+
+	// b's 16 byte mip does not fit even without a's detail, so a keeps it.
+	f.Streamer.RequestMip(b, 2);
+	f.Streamer.Update(++frame);
+	CHECK(f.Device.Issued.empty());
+	CHECK(f.Streamer.GetStats().NumDeferred == 1);
+	CHECK(f.Streamer.GetStats().NumEvictions == 0);
+	CHECK(f.Streamer.ResidentFirstMip(a) == 3);
+
+	// Once the budget grows it loads.
+	f.Streamer.SetBudgetBytes(26);
+	f.Streamer.RequestMip(b, 2);
+	f.Streamer.Update(++frame);
+	CHECK((f.Device.TakeIssued() == Calls{ { b, 2 } }));
+}
+
+TEST(MipStreamer_DoesNotReissueWhilePending)
+{
+	Fixture f(1000);
+	f.Device.CompleteAtOnce = false;
+	MipStreamer::uint32 tex = f.Streamer.AddTexture(MipSizes, 1);
+
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(1);
+	CHECK((f.Device.TakeIssued() == Calls{ { tex, 3 } }));
+	CHECK(f.Streamer.IsPending(tex));
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 4);
+
+	// The bytes count as soon as the load is issued.
+	CHECK(f.Streamer.CommittedBytes() == 5);
+
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(2);
+	CHECK(f.Device.Issued.empty());
+
+	f.Device.Complete();
+	CHECK(!f.Streamer.IsPending(tex));
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 3);
+
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(3);
+	CHECK((f.Device.TakeIssued() == Calls{ { tex, 2 } }));
+}
+
+TEST(MipStreamer_OnResidencyChangedCorrectsCommittedBytes)
+{
+	Fixture f(1000);
+	f.Device.CompleteAtOnce = false;
+	MipStreamer::uint32 tex = f.Streamer.AddTexture(MipSizes, 2);
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 3);
+	CHECK(f.Streamer.CommittedBytes() == 5);
+
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(1);
+	CHECK((f.Device.TakeIssued() == Calls{ { tex, 2 } }));
+	CHECK(f.Streamer.CommittedBytes() == 21);
+
+	// The device could not load the mip and kept what was there.
+	f.Device.InFlight.clear();
+	f.Streamer.OnResidencyChanged(tex, 3);
+	CHECK(!f.Streamer.IsPending(tex));
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 3);
+	CHECK(f.Streamer.CommittedBytes() == 5);
+
+	// Or it loaded more than it was asked for.
+	f.Streamer.RequestMip(tex, 0);
+	f.Streamer.Update(2);
+	f.Device.InFlight.clear();
+	f.Streamer.OnResidencyChanged(tex, 1);
+	CHECK(f.Streamer.ResidentFirstMip(tex) == 1);
+	CHECK(f.Streamer.CommittedBytes() == 85);
+}
+
+TEST(MipStreamer_ComputesTheRequestedMip)
+{
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 1024.0f) == 0);
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 512.0f) == 0);
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 256.0f) == 1);
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 200.0f) == 1);
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 1.0f) == 9);
+	CHECK(MipStreamer::ComputeRequestedMip(512.0f, 0.0f) == ~0u);
+}
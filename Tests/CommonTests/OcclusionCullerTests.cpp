@@ -0,0 +1,183 @@
+//***************************************************************************************
+// OcclusionCullerTests.cpp
+//
+// OcclusionCuller only uses the DirectXMath storage types, so on other platforms than
+// Windows the DirectXMath headers need to be on the include path.
+//***************************************************************************************
+
+#include "Check.h"
+#include "OcclusionCuller.h"
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	const float Near = 1.0f;
+	const float Far = 100.0f;
+
+	XMFLOAT4X4 Translation(float x, float y, float z)
+	{
+		return XMFLOAT4X4(
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			x, y, z, 1.0f);
+	}
+
+	// Camera at the origin looking down +z, with a 90 degree vertical field of view
+	// and the 2:1 aspect ratio of the default depth buffer.
+	XMFLOAT4X4 ViewProj()
+	{
+		const float yScale = 1.0f;
+		const float xScale = yScale / 2.0f;
+		const float range = Far / (Far - Near);
+		return XMFLOAT4X4(
+			xScale, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			0.0f, 0.0f, -Near*range, 0.0f);
+	}
+
+	// A wall 6x6 units wide at z = 10.
+	void DrawWall(OcclusionCuller& culler)
+	{
+		culler.BeginFrame(ViewProj());
+		culler.RasterizeOccluderBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(3.0f, 3.0f, 0.5f), Translation(0.0f, 0.0f, 10.0f));
+		culler.BuildHiZ();
+	}
+
+	// The 12 triangles of the box [center - extents, center + extents], appended.
+	void AppendBox(std::vector<XMFLOAT3>& vertices, std::vector<OcclusionCuller::uint32>& indices,
+		const XMFLOAT3& center, const XMFLOAT3& extents)
+	{
+		OcclusionCuller::uint32 first = (OcclusionCuller::uint32)vertices.size();
+		for(int i = 0; i < 8; ++i)
+		{
+			vertices.push_back(XMFLOAT3(
+				center.x + ((i & 1) ? extents.x : -extents.x),
+				center.y + ((i & 2) ? extents.y : -extents.y),
+				center.z + ((i & 4) ? extents.z : -extents.z)));
+		}
+
+		const OcclusionCuller::uint32 faces[36] =
+		{
+			0, 1, 3,  0, 3, 2,
+			4, 6, 7,  4, 7, 5,
+			0, 4, 5,  0, 5, 1,
+			2, 3, 7,  2, 7, 6,
+			0, 2, 6,  0, 6, 4,
+			1, 5, 7,  1, 7, 3
+		};
+		for(OcclusionCuller::uint32 index : faces)
+			indices.push_back(first + index);
+	}
+}
+
+TEST(OcclusionCuller_HidesBoxesFullyBehindAnOccluder)
+{
+	OcclusionCuller culler;
+	DrawWall(culler);
+	CHECK(culler.NumOccluderTriangles() > 0);
+
+	const XMFLOAT3 center(0.0f, 0.0f, 0.0f);
+	const XMFLOAT3 extents(1.0f, 1.0f, 1.0f);
+	CHECK(!culler.IsVisible(center, extents, Translation(0.0f, 0.0f, 20.0f)));
+	CHECK(!culler.IsVisible(center, extents, Translation(1.0f, -1.0f, 50.0f)));
+
+	// In front of the wall.
+	CHECK(culler.IsVisible(center, extents, Translation(0.0f, 0.0f, 5.0f)));
+
+	CHECK(culler.NumTested() == 3);
+	CHECK(culler.NumOccluded() == 2);
+}
+
+TEST(OcclusionCuller_KeepsPartiallyOccludedBoxes)
+{
+	OcclusionCuller culler;
+	DrawWall(culler);
+
+	// Straddles the edge of the wall.
+	const XMFLOAT3 center(0.0f, 0.0f, 0.0f);
+	const XMFLOAT3 extents(1.0f, 1.0f, 1.0f);
+	CHECK(culler.IsVisible(center, extents, Translation(6.0f, 0.0f, 20.0f)));
+	CHECK(culler.IsVisible(center, extents, Translation(0.0f, 6.0f, 20.0f)));
+
+	// Next to the wall, and partly in front of it.
+	CHECK(culler.IsVisible(center, extents, Translation(12.0f, 0.0f, 20.0f)));
+	CHECK(culler.IsVisible(center, XMFLOAT3(1.0f, 1.0f, 6.0f), Translation(0.0f, 0.0f, 15.0f)));
+}
+
+TEST(OcclusionCuller_TreatsTheNearPlaneConservatively)
+{
+	OcclusionCuller culler;
+	DrawWall(culler);
+
+	// A box crossing the near plane is assumed visible.
+	CHECK(culler.IsVisible(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), Translation(0.0f, 0.0f, 0.5f)));
+
+	// Occluder triangles crossing the near plane are dropped, so a slanted quad with
+	// its lower edge behind the camera hides nothing.
+	const XMFLOAT3 quad[4] =
+	{
+		XMFLOAT3(-50.0f, -50.0f, 0.5f), XMFLOAT3(50.0f, -50.0f, 0.5f),
+		XMFLOAT3(50.0f, 50.0f, 5.0f), XMFLOAT3(-50.0f, 50.0f, 5.0f)
+	};
+	const OcclusionCuller::uint32 indices[6] = { 0, 1, 2, 0, 2, 3 };
+	culler.BeginFrame(ViewProj());
+	culler.RasterizeOccluder(quad, sizeof(XMFLOAT3), indices, 6, Translation(0.0f, 0.0f, 0.0f));
+	culler.BuildHiZ();
+	CHECK(culler.NumOccluderTriangles() == 0);
+	CHECK(culler.IsVisible(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f), Translation(0.0f, 0.0f, 20.0f)));
+}
+
+TEST(OcclusionCuller_HiZKeepsTheFarthestDepth)
+{
+	OcclusionCuller culler;
+	DrawWall(culler);
+
+	// The wall covers the center of the screen but not all of it.
+	const OcclusionCuller::uint32 top = culler.MipCount() - 1;
+	CHECK(culler.Depth(top)[0] == 1.0f);
+
+	const float* depth = culler.Depth(0);
+	float center = depth[(culler.Height() / 2)*culler.Width() + culler.Width() / 2];
+	CHECK(center > 0.0f && center < 1.0f);
+	CHECK(depth[0] == 1.0f);
+}
+
+TEST(OcclusionCuller_InteriorBoxLiesInsideTheMesh)
+{
+	std::vector<XMFLOAT3> vertices;
+	std::vector<OcclusionCuller::uint32> indices;
+	AppendBox(vertices, indices, XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(2.0f, 2.0f, 2.0f));
+
+	XMFLOAT3 center, extents;
+	CHECK(OcclusionCuller::ComputeInteriorBox(vertices.data(), sizeof(XMFLOAT3), (OcclusionCuller::uint32)vertices.size(),
+		indices.data(), (OcclusionCuller::uint32)indices.size(), center, extents, 16));
+	CHECK(std::fabs(center.x) < 1e-4f && std::fabs(center.y) < 1e-4f && std::fabs(center.z) < 1e-4f);
+	CHECK(extents.x > 1.5f && extents.x < 2.0f);
+
+	// A hollow cube: the box must stay in the wall and out of the hole.
+	AppendBox(vertices, indices, XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 1.0f, 1.0f));
+	CHECK(OcclusionCuller::ComputeInteriorBox(vertices.data(), sizeof(XMFLOAT3), (OcclusionCuller::uint32)vertices.size(),
+		indices.data(), (OcclusionCuller::uint32)indices.size(), center, extents, 16));
+
+	const float c[3] = { center.x, center.y, center.z };
+	const float e[3] = { extents.x, extents.y, extents.z };
+	bool insideOuter = true;
+	bool overlapsHole = true;
+	for(int a = 0; a < 3; ++a)
+	{
+		insideOuter = insideOuter && c[a] - e[a] >= -2.0f && c[a] + e[a] <= 2.0f;
+		overlapsHole = overlapsHole && c[a] - e[a] < 1.0f && c[a] + e[a] > -1.0f;
+	}
+	CHECK(insideOuter);
+	CHECK(!overlapsHole);
+	CHECK(e[0] > 0.0f && e[1] > 0.0f && e[2] > 0.0f);
+
+	// A flat mesh has no inside.
+	const XMFLOAT3 flat[3] = { XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(1.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 1.0f, 0.0f) };
+	const OcclusionCuller::uint32 triangle[3] = { 0, 1, 2 };
+	CHECK(!OcclusionCuller::ComputeInteriorBox(flat, sizeof(XMFLOAT3), 3, triangle, 3, center, extents));
+}
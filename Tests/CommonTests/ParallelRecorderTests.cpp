@@ -0,0 +1,141 @@
+//***************************************************************************************
+// ParallelRecorderTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "ParallelRecorder.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+	// Stands in for an ID3D12GraphicsCommandList and the per thread allocator it
+	// records into.
+	struct FakeCommandList
+	{
+		std::vector<std::string> Commands;
+	};
+
+	struct FakeAllocator
+	{
+		std::atomic<int> NumUsers{ 0 };
+		std::atomic<bool> SharedByTwoLists{ false };
+	};
+
+	// Indices of the passes in the submission order.
+	std::vector<int> Positions(const std::vector<ParallelRecorder::PassId>& order)
+	{
+		std::vector<int> positions(order.size());
+		for(size_t i = 0; i < order.size(); ++i)
+			positions[order[i]] = (int)i;
+		return positions;
+	}
+}
+
+TEST(ParallelRecorder_SubmitsDependenciesFirst)
+{
+	ParallelRecorder recorder(4);
+	ParallelRecorder::PassId main = recorder.AddPass("main", [](ParallelRecorder::uint32) { });
+	ParallelRecorder::PassId shadow = recorder.AddPass("shadow", [](ParallelRecorder::uint32) { });
+	ParallelRecorder::PassId normals = recorder.AddPass("normals", [](ParallelRecorder::uint32) { });
+	ParallelRecorder::PassId ssao = recorder.AddPass("ssao", [](ParallelRecorder::uint32) { });
+	ParallelRecorder::PassId ui = recorder.AddPass("ui", [](ParallelRecorder::uint32) { });
+
+	recorder.AddDependency(main, shadow);
+	recorder.AddDependency(ssao, normals);
+	recorder.AddDependency(main, ssao);
+
+	std::vector<int> positions = Positions(recorder.Record());
+	CHECK(positions[shadow] < positions[main]);
+	CHECK(positions[normals] < positions[ssao]);
+	CHECK(positions[ssao] < positions[main]);
+
+	// Unconstrained passes keep the order they were added in.
+	CHECK(positions[main] < positions[ui]);
+	CHECK(recorder.PassName(ssao) == "ssao");
+}
+
+TEST(ParallelRecorder_RejectsCycles)
+{
+	ParallelRecorder recorder(2);
+	ParallelRecorder::PassId a = recorder.AddPass("a", [](ParallelRecorder::uint32) { });
+	ParallelRecorder::PassId b = recorder.AddPass("b", [](ParallelRecorder::uint32) { });
+	recorder.AddDependency(b, a);
+
+	bool threw = false;
+	try
+	{
+		recorder.AddDependency(a, b);
+	}
+	catch(const std::logic_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+
+	// The rejected dependency is not kept.
+	CHECK(recorder.Record().size() == 2);
+}
+
+TEST(ParallelRecorder_RecordsEveryPassEachFrameOnePerThread)
+{
+	const ParallelRecorder::uint32 numThreads = 4;
+	ParallelRecorder recorder(numThreads);
+
+	std::vector<FakeCommandList> lists(6);
+	std::vector<FakeAllocator> allocators(numThreads);
+	for(size_t i = 0; i < lists.size(); ++i)
+	{
+		recorder.AddPass("pass" + std::to_string(i), [&, i](ParallelRecorder::uint32 thread)
+		{
+			FakeAllocator& allocator = allocators[thread];
+			if(allocator.NumUsers++ != 0)
+				allocator.SharedByTwoLists = true;
+
+			lists[i].Commands.push_back("draw");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+			allocator.NumUsers--;
+		});
+	}
+
+	for(int frame = 0; frame < 20; ++frame)
+		recorder.Record();
+
+	for(const FakeCommandList& list : lists)
+		CHECK(list.Commands.size() == 20);
+	for(const FakeAllocator& allocator : allocators)
+		CHECK(!allocator.SharedByTwoLists);
+}
+
+TEST(ParallelRecorder_RethrowsAfterTheOtherPassesFinish)
+{
+	ParallelRecorder recorder(2);
+	recorder.AddPass("broken", [](ParallelRecorder::uint32) { throw std::runtime_error("device removed"); });
+
+	int numRecorded = 0;
+	recorder.AddPass("ok", [&](ParallelRecorder::uint32) { numRecorded++; });
+
+	for(int frame = 1; frame <= 2; ++frame)
+	{
+		bool threw = false;
+		try
+		{
+			recorder.Record();
+		}
+		catch(const std::runtime_error&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+		CHECK(numRecorded == frame);
+	}
+}
+
+TEST(ParallelRecorder_RecordsNothingWithoutPasses)
+{
+	ParallelRecorder recorder(3);
+	CHECK(recorder.Record().empty());
+	CHECK(recorder.NumThreads() == 3);
+}
@@ -0,0 +1,134 @@
+//***************************************************************************************
+// PipelineStateHashTests.cpp
+//
+// PipelineStateHash only reads fields by name, so these structs with the fields of
+// the D3D12 descriptions stand in for them.
+//***************************************************************************************
+
+#include "Check.h"
+#include "PipelineStateHash.h"
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct ShaderBytecode { const void* pShaderBytecode; std::size_t BytecodeLength; };
+	struct SoDeclarationEntry { unsigned Stream; const char* SemanticName; unsigned SemanticIndex; unsigned char StartComponent, ComponentCount, OutputSlot; };
+	struct StreamOutputDesc { const SoDeclarationEntry* pSODeclaration; unsigned NumEntries; const unsigned* pBufferStrides; unsigned NumStrides; unsigned RasterizedStream; };
+	struct RenderTargetBlendDesc { int BlendEnable, LogicOpEnable, SrcBlend, DestBlend, BlendOp, SrcBlendAlpha, DestBlendAlpha, BlendOpAlpha, LogicOp; unsigned char RenderTargetWriteMask; };
+	struct BlendDesc { int AlphaToCoverageEnable, IndependentBlendEnable; RenderTargetBlendDesc RenderTarget[8]; };
+	struct RasterizerDesc { int FillMode, CullMode, FrontCounterClockwise, DepthBias; float DepthBiasClamp, SlopeScaledDepthBias; int DepthClipEnable, MultisampleEnable, AntialiasedLineEnable; unsigned ForcedSampleCount; int ConservativeRaster; };
+	struct DepthStencilOpDesc { int StencilFailOp, StencilDepthFailOp, StencilPassOp, StencilFunc; };
+	struct DepthStencilDesc { int DepthEnable, DepthWriteMask, DepthFunc, StencilEnable; unsigned char StencilReadMask, StencilWriteMask; DepthStencilOpDesc FrontFace, BackFace; };
+	struct InputElementDesc { const char* SemanticName; unsigned SemanticIndex; int Format; unsigned InputSlot, AlignedByteOffset; int InputSlotClass; unsigned InstanceDataStepRate; };
+	struct InputLayoutDesc { const InputElementDesc* pInputElementDescs; unsigned NumElements; };
+	struct DxgiSampleDesc { unsigned Count, Quality; };
+	struct CachedPipelineState { const void* pCachedBlob; std::size_t CachedBlobSizeInBytes; };
+
+	struct GraphicsDesc
+	{
+		void* pRootSignature;
+		ShaderBytecode VS, PS, DS, HS, GS;
+		StreamOutputDesc StreamOutput;
+		BlendDesc BlendState;
+		unsigned SampleMask;
+		RasterizerDesc RasterizerState;
+		DepthStencilDesc DepthStencilState;
+		InputLayoutDesc InputLayout;
+		int IBStripCutValue, PrimitiveTopologyType;
+		unsigned NumRenderTargets;
+		int RTVFormats[8];
+		int DSVFormat;
+		DxgiSampleDesc SampleDesc;
+		unsigned NodeMask;
+		CachedPipelineState CachedPSO;
+		int Flags;
+	};
+
+	struct ComputeDesc
+	{
+		void* pRootSignature;
+		ShaderBytecode CS;
+		unsigned NodeMask;
+		CachedPipelineState CachedPSO;
+		int Flags;
+	};
+
+	struct Fixture
+	{
+		std::vector<char> VS = std::vector<char>(100, 'v');
+		std::vector<char> PS = std::vector<char>(50, 'p');
+		std::string Position = "POSITION";
+		InputElementDesc Element;
+		GraphicsDesc Desc;
+
+		Fixture()
+		{
+			Element = { Position.c_str(), 0, 6, 0, 0, 0, 0 };
+
+			Desc.pRootSignature = nullptr;
+			Desc.VS = { VS.data(), VS.size() };
+			Desc.PS = { PS.data(), PS.size() };
+			Desc.DS = Desc.HS = Desc.GS = { nullptr, 0 };
+			Desc.StreamOutput = { nullptr, 0, nullptr, 0, 0 };
+			Desc.BlendState = {};
+			Desc.SampleMask = 0xffffffff;
+			Desc.RasterizerState = {};
+			Desc.DepthStencilState = {};
+			Desc.InputLayout = { &Element, 1 };
+			Desc.IBStripCutValue = 0;
+			Desc.PrimitiveTopologyType = 3;
+			Desc.NumRenderTargets = 1;
+			for(int& format : Desc.RTVFormats)
+				format = 0;
+			Desc.RTVFormats[0] = 28;
+			Desc.DSVFormat = 45;
+			Desc.SampleDesc = { 1, 0 };
+			Desc.NodeMask = 0;
+			Desc.CachedPSO = { nullptr, 0 };
+			Desc.Flags = 0;
+		}
+	};
+}
+
+TEST(PipelineStateHash_HashesContentNotPointers)
+{
+	Fixture a;
+	Fixture b;
+	CHECK(a.Desc.VS.pShaderBytecode != b.Desc.VS.pShaderBytecode);
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) == PipelineStateHash::Graphics(b.Desc, 1));
+
+	b.VS[5] = 'x';
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) != PipelineStateHash::Graphics(b.Desc, 1));
+}
+
+TEST(PipelineStateHash_IgnoresStateThePipelineIgnores)
+{
+	Fixture a;
+	Fixture b;
+	b.Desc.RTVFormats[3] = 5;
+	b.Desc.BlendState.RenderTarget[2].BlendEnable = 1;
+	b.Desc.DepthStencilState.FrontFace.StencilFunc = 3;
+	b.Desc.CachedPSO = { &b, 4 };
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) == PipelineStateHash::Graphics(b.Desc, 1));
+
+	// The same fields count once they are used.
+	b.Desc.BlendState.IndependentBlendEnable = 1;
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) != PipelineStateHash::Graphics(b.Desc, 1));
+}
+
+TEST(PipelineStateHash_SeparatesStatesAndRootSignatures)
+{
+	Fixture a;
+	Fixture b;
+	b.Desc.RasterizerState.CullMode = 1;
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) != PipelineStateHash::Graphics(b.Desc, 1));
+	CHECK(PipelineStateHash::Graphics(a.Desc, 1) != PipelineStateHash::Graphics(a.Desc, 2));
+
+	ComputeDesc compute = { nullptr, { a.VS.data(), a.VS.size() }, 0, { nullptr, 0 }, 0 };
+	ComputeDesc copy = compute;
+	std::vector<char> csCopy = a.VS;
+	copy.CS = { csCopy.data(), csCopy.size() };
+	CHECK(PipelineStateHash::Compute(compute, 1) == PipelineStateHash::Compute(copy, 1));
+	CHECK(PipelineStateHash::Compute(compute, 1) != PipelineStateHash::Graphics(a.Desc, 1));
+}
@@ -0,0 +1,180 @@
+//***************************************************************************************
+// PipelineStateTableTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "PipelineStateTable.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	// Stands in for an ID3D12PipelineState.
+	struct FakePso
+	{
+		int Id = 0;
+	};
+
+	typedef PipelineStateTable<std::shared_ptr<FakePso>> Table;
+
+	// Creates a PSO the way PipelineStateCache does: from the stored blob if there is
+	// one, else from scratch, returning a new blob.
+	struct FakeDevice
+	{
+		std::atomic<int> NumCreated{ 0 };
+		std::atomic<int> NumFromBlob{ 0 };
+		bool RejectBlobs = false;
+
+		Table::Created Create(const Table::Blob* stored)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+			Table::Created created;
+			created.Object = std::make_shared<FakePso>();
+			created.FromBlob = stored != nullptr && !RejectBlobs;
+			if(created.FromBlob)
+			{
+				NumFromBlob++;
+			}
+			else
+			{
+				created.Object->Id = ++NumCreated;
+				created.NewBlob = { 'P', 'S', 'O', (std::uint8_t)created.Object->Id };
+			}
+			return created;
+		}
+	};
+}
+
+TEST(PipelineStateTable_SharesOneObjectPerKey)
+{
+	Table table;
+	FakeDevice device;
+	auto create = [&](const Table::Blob* stored) { return device.Create(stored); };
+
+	std::vector<std::shared_ptr<FakePso>> results(8);
+	std::vector<std::thread> threads;
+	for(int i = 0; i < 8; ++i)
+		threads.emplace_back([&, i]() { results[i] = table.Get(42, true, create); });
+	for(auto& t : threads)
+		t.join();
+
+	CHECK(device.NumCreated == 1);
+	for(const auto& result : results)
+		CHECK(result == results[0]);
+
+	CHECK(table.Get(43, true, create) != results[0]);
+
+	Table::Stats stats = table.GetStats();
+	CHECK(stats.Requests == 9);
+	CHECK(stats.Created == 2);
+	CHECK(stats.Shared == 7);
+}
+
+TEST(PipelineStateTable_FailedCreateIsRetried)
+{
+	Table table;
+	int numCalls = 0;
+
+	bool threw = false;
+	try
+	{
+		table.Get(1, true, [&](const Table::Blob*) -> Table::Created
+		{
+			numCalls++;
+			throw std::runtime_error("E_INVALIDARG");
+		});
+	}
+	catch(const std::runtime_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+
+	auto pso = table.Get(1, true, [&](const Table::Blob*)
+	{
+		numCalls++;
+		Table::Created created;
+		created.Object = std::make_shared<FakePso>();
+		return created;
+	});
+	CHECK(pso != nullptr);
+	CHECK(numCalls == 2);
+}
+
+TEST(PipelineStateTable_StoredBlobsSurviveARoundTrip)
+{
+	FakeDevice device;
+	auto create = [&](const Table::Blob* stored) { return device.Create(stored); };
+
+	std::stringstream file;
+	{
+		Table table;
+		table.Get(1, true, create);
+		table.Get(2, true, create);
+
+		// Not persistent, e.g. an unregistered root signature: no blob.
+		table.Get(3, false, create);
+		CHECK(table.NumBlobs() == 2);
+		CHECK(table.IsDirty());
+
+		Table::uint64 version = 0;
+		CHECK(table.Write(file, version));
+		table.MarkSaved(version);
+		CHECK(!table.IsDirty());
+	}
+
+	Table table;
+	CHECK(table.Read(file));
+	CHECK(table.NumBlobs() == 2);
+	CHECK(!table.IsDirty());
+
+	table.Get(1, true, create);
+	table.Get(3, true, create);
+	CHECK(device.NumFromBlob == 1);
+	CHECK(table.GetStats().FromDisk == 1);
+	CHECK(table.IsDirty());
+}
+
+TEST(PipelineStateTable_RejectedBlobIsReplaced)
+{
+	FakeDevice device;
+	auto create = [&](const Table::Blob* stored) { return device.Create(stored); };
+
+	Table table;
+	table.Get(1, true, create);
+	Table::uint64 version = 0;
+	std::stringstream file;
+	table.Write(file, version);
+	table.MarkSaved(version);
+
+	// A new driver rejects the stored blob; the table stores the recompiled one.
+	table.Clear();
+	device.RejectBlobs = true;
+	CHECK(table.Get(1, true, create)->Id == 2);
+	CHECK(table.IsDirty());
+}
+
+TEST(PipelineStateTable_ReadRejectsCorruptData)
+{
+	Table table;
+	std::stringstream garbage("not a pipeline cache");
+	CHECK(!table.Read(garbage));
+	CHECK(table.NumBlobs() == 0);
+
+	// One entry whose size is far past the end of the data.
+	std::stringstream truncated;
+	const Table::uint32 header[2] = { 0x314f5350, 1 };
+	const Table::uint64 key = 7;
+	const Table::uint32 size = 0xffffffff;
+	truncated.write((const char*)header, sizeof(header));
+	truncated.write((const char*)&key, sizeof(key));
+	truncated.write((const char*)&size, sizeof(size));
+	truncated.write("blob", 4);
+	CHECK(!table.Read(truncated));
+	CHECK(table.NumBlobs() == 0);
+}
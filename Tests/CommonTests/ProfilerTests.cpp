@@ -0,0 +1,203 @@
+//***************************************************************************************
+// ProfilerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const Profiler::uint64 Ms = 1000000;
+
+	Profiler::Event MakeEvent(const char* name, Profiler::uint64 startNs, Profiler::uint64 endNs,
+		Profiler::Track kind = Profiler::Track::Cpu)
+	{
+		Profiler::Event event;
+		event.Name = name;
+		event.Kind = kind;
+		event.StartNs = startNs;
+		event.EndNs = endNs;
+		return event;
+	}
+
+	const Profiler::Stat* FindStat(const std::vector<Profiler::Stat>& stats, const std::string& name,
+		Profiler::Track kind = Profiler::Track::Cpu)
+	{
+		for(const Profiler::Stat& stat : stats)
+		{
+			if(stat.Name == name && stat.Kind == kind)
+				return &stat;
+		}
+		return nullptr;
+	}
+
+	bool Contains(const std::string& s, const std::string& part)
+	{
+		return s.find(part) != std::string::npos;
+	}
+}
+
+TEST(Profiler_SummarizesCompleteFrames)
+{
+	Profiler profiler(200);
+
+	// "Work" takes 1 to 100 ms, one frame each.
+	for(Profiler::uint64 i = 1; i <= 100; ++i)
+	{
+		Profiler::uint64 frame = profiler.BeginFrame();
+		profiler.AddEvent(frame, MakeEvent("Work", 0, i * Ms));
+		if(i == 10)
+			profiler.AddEvent(frame, MakeEvent("Work", 0, 200 * Ms, Profiler::Track::Gpu));
+		profiler.EndFrame();
+	}
+
+	// A frame still being recorded does not count.
+	profiler.AddEvent(profiler.BeginFrame(), MakeEvent("Work", 0, 1000 * Ms));
+	CHECK(profiler.NumFrames() == 100);
+
+	std::vector<Profiler::Stat> stats = profiler.Summarize();
+	CHECK(stats.size() == 3);
+
+	// Largest total first; the frames themselves took next to no time.
+	CHECK(stats[0].Name == "Work" && stats[0].Kind == Profiler::Track::Cpu);
+	CHECK(stats[1].Name == "Work" && stats[1].Kind == Profiler::Track::Gpu);
+	CHECK(stats[2].Name == "Frame");
+	CHECK(stats[2].Count == 100);
+
+	// Nearest rank percentiles.
+	const Profiler::Stat& work = stats[0];
+	CHECK(work.Count == 100);
+	CHECK(work.MeanMs == 50.5);
+	CHECK(work.P50Ms == 50.0);
+	CHECK(work.P95Ms == 95.0);
+	CHECK(work.P99Ms == 99.0);
+	CHECK(work.MaxMs == 100.0);
+
+	const Profiler::Stat* gpu = FindStat(stats, "Work", Profiler::Track::Gpu);
+	CHECK(gpu != nullptr && gpu->Count == 1 && gpu->P50Ms == 200.0 && gpu->P99Ms == 200.0);
+}
+
+TEST(Profiler_OverwritesTheOldestFrames)
+{
+	Profiler profiler(4);
+	for(Profiler::uint64 i = 1; i <= 6; ++i)
+	{
+		Profiler::uint64 frame = profiler.BeginFrame();
+		CHECK(frame == i);
+		profiler.AddEvent(frame, MakeEvent("Work", 0, i * Ms));
+		profiler.EndFrame();
+	}
+	CHECK(profiler.CurrentFrame() == 6);
+	CHECK(profiler.NumFrames() == 4);
+
+	// Frames 3 to 6 are kept.
+	std::vector<Profiler::Stat> stats = profiler.Summarize();
+	const Profiler::Stat* work = FindStat(stats, "Work");
+	CHECK(work != nullptr && work->Count == 4);
+	CHECK(work->MaxMs == 6.0 && work->P50Ms == 4.0);
+
+	// Late GPU events land in their frame while it is in the ring, and are ignored
+	// once it has been overwritten.
+	profiler.AddEvent(5, MakeEvent("Draw", 0, Ms, Profiler::Track::Gpu));
+	profiler.AddEvent(2, MakeEvent("Draw", 0, Ms, Profiler::Track::Gpu));
+	stats = profiler.Summarize();
+	const Profiler::Stat* draw = FindStat(stats, "Draw", Profiler::Track::Gpu);
+	CHECK(draw != nullptr && draw->Count == 1);
+	CHECK(profiler.NumDroppedEvents() == 0);
+}
+
+TEST(Profiler_CountsDroppedEvents)
+{
+	Profiler profiler(2, 3);
+	Profiler::uint64 frame = profiler.BeginFrame();
+	for(int i = 0; i < 5; ++i)
+		profiler.AddEvent(frame, MakeEvent("Work", 0, Ms));
+
+	// Events outside of any frame are not kept, but not dropped either.
+	profiler.AddEvent(0, MakeEvent("Work", 0, Ms));
+	profiler.EndFrame();
+
+	CHECK(profiler.NumDroppedEvents() == 2);
+	CHECK(FindStat(profiler.Summarize(), "Work")->Count == 3);
+
+	std::ostringstream summary;
+	profiler.WriteSummary(summary);
+	CHECK(Contains(summary.str(), "2 events dropped"));
+
+	// The next frame in the ring has room again.
+	frame = profiler.BeginFrame();
+	profiler.AddEvent(frame, MakeEvent("Work", 0, Ms));
+	profiler.EndFrame();
+	CHECK(profiler.NumDroppedEvents() == 2);
+}
+
+TEST(Profiler_NestsScopesAndCanBeDisabled)
+{
+	Profiler profiler;
+	profiler.BeginFrame();
+	{
+		PROFILE_SCOPE(profiler, "Outer");
+		{
+			PROFILE_SCOPE(profiler, "Inner");
+		}
+	}
+	profiler.EndFrame();
+
+	std::ostringstream trace;
+	profiler.WriteChromeTrace(trace);
+	CHECK(Contains(trace.str(), "\"name\":\"Outer\""));
+	CHECK(Contains(trace.str(), "\"depth\":0"));
+	CHECK(Contains(trace.str(), "\"depth\":1"));
+
+	profiler.SetEnabled(false);
+	profiler.BeginFrame();
+	{
+		PROFILE_SCOPE(profiler, "Hidden");
+	}
+	profiler.EndFrame();
+	CHECK(FindStat(profiler.Summarize(), "Hidden") == nullptr);
+	CHECK(FindStat(profiler.Summarize(), "Outer")->Count == 1);
+}
+
+TEST(Profiler_WritesAChromeTrace)
+{
+	Profiler profiler;
+	Profiler::uint64 frame = profiler.BeginFrame();
+
+	Profiler::Event cpu = MakeEvent(profiler.Intern("Say \"hi\"\\\n"), 1500, 4000);
+	cpu.Thread = 2;
+	cpu.Depth = 1;
+	profiler.AddEvent(frame, cpu);
+	profiler.AddEvent(frame, MakeEvent("Shadow", 2000, 3000, Profiler::Track::Gpu));
+	profiler.EndFrame();
+
+	// The second frame is still being recorded.
+	profiler.AddEvent(profiler.BeginFrame(), MakeEvent("Pending", 5000, 6000));
+
+	std::ostringstream out;
+	profiler.WriteChromeTrace(out);
+	const std::string trace = out.str();
+
+	const std::string head = "{\"traceEvents\":[\n";
+	const std::string tail = "\n],\"displayTimeUnit\":\"ms\"}\n";
+	CHECK(trace.compare(0, head.size(), head) == 0);
+	CHECK(trace.size() > tail.size() && trace.compare(trace.size() - tail.size(), tail.size(), tail) == 0);
+	CHECK(std::count(trace.begin(), trace.end(), '{') == std::count(trace.begin(), trace.end(), '}'));
+	CHECK(std::count(trace.begin(), trace.end(), '[') == 1 && std::count(trace.begin(), trace.end(), ']') == 1);
+
+	// Names are escaped, times are in microseconds, and CPU threads follow the frame row.
+	CHECK(Contains(trace, "{\"name\":\"Say \\\"hi\\\"\\\\\\u000a\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":3,"
+		"\"ts\":1.500,\"dur\":2.500,\"args\":{\"frame\":1,\"depth\":1}}"));
+	CHECK(Contains(trace, "{\"name\":\"Shadow\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":2,\"tid\":0,"
+		"\"ts\":2.000,\"dur\":1.000,\"args\":{\"frame\":1,\"depth\":0}}"));
+	CHECK(Contains(trace, "{\"name\":\"Frame 1\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0,"));
+	CHECK(Contains(trace, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":3,\"args\":{\"name\":\"Thread 2\"}}"));
+
+	// Frames not yet ended are left out.
+	CHECK(!Contains(trace, "Pending"));
+	CHECK(!Contains(trace, "Frame 2"));
+}
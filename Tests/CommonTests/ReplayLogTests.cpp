@@ -0,0 +1,209 @@
+//***************************************************************************************
+// ReplayLogTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "ReplayLog.h"
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	typedef ReplayLog::InputEvent InputEvent;
+
+	InputEvent Mouse(InputEvent::Type kind, int x, int y, ReplayLog::uint32 buttons)
+	{
+		InputEvent event;
+		event.Kind = kind;
+		event.X = x;
+		event.Y = y;
+		event.Buttons = buttons;
+		return event;
+	}
+
+	InputEvent Key(InputEvent::Type kind, ReplayLog::uint32 key)
+	{
+		InputEvent event;
+		event.Kind = kind;
+		event.Key = key;
+		return event;
+	}
+
+	bool SameEvent(const InputEvent& a, const InputEvent& b)
+	{
+		return a.Frame == b.Frame && a.Kind == b.Kind && a.X == b.X && a.Y == b.Y &&
+			a.Buttons == b.Buttons && a.Key == b.Key;
+	}
+
+	std::string Saved(const ReplayLog& log)
+	{
+		std::ostringstream out(std::ios::binary);
+		log.Save(out);
+		return out.str();
+	}
+
+	std::string LoadError(const std::string& bytes)
+	{
+		std::istringstream in(bytes, std::ios::binary);
+		ReplayLog log;
+		std::string error;
+		return log.Load(in, &error) ? "" : error;
+	}
+
+	// Records the time step every Update sees.
+	struct DeltaClient : public HeadlessRunner::Client
+	{
+		std::vector<ReplayLog::int64> DeltasNs;
+		std::vector<float> DeltaTimes;
+
+		void Update(const GameTimer& gt)override
+		{
+			DeltasNs.push_back(gt.DeltaTimeNs());
+			DeltaTimes.push_back(gt.DeltaTime());
+		}
+	};
+}
+
+TEST(ReplayLog_AssignsEventsToTheNextFrame)
+{
+	ReplayLog log;
+	log.AddEvent(Key(InputEvent::Type::KeyDown, 'W'));
+	log.AddFrame(16000000);
+	log.AddFrame(17000000);
+	log.AddEvent(Mouse(InputEvent::Type::MouseMove, 3, 4, 0));
+	log.AddFrame(15000000);
+	CHECK(log.NumFrames() == 3);
+
+	// Events arrive between frames and are delivered before the next Update.
+	CHECK(log.Events.size() == 2);
+	CHECK(log.Events[0].Frame == 0 && log.Events[1].Frame == 2);
+
+	HeadlessRunner::Settings settings = log.ToSettings();
+	CHECK(settings.NumFrames == 3);
+	CHECK(settings.RecordedDeltas.size() == 3);
+	CHECK(settings.Input.size() == 2 && settings.Input[1].Frame == 2);
+
+	log.Clear();
+	CHECK(log.NumFrames() == 0 && log.Events.empty() && log.Seed == 0);
+}
+
+TEST(ReplayLog_RoundTripsThroughSaveAndLoad)
+{
+	ReplayLog log;
+	log.Seed = 0xdeadbeef;
+
+	// Steps that shrink as well as grow, and extreme coordinates, give negative
+	// differences of every size.
+	const ReplayLog::int64 deltas[] = { 16666667, 16666666, 33333333, 0, 1, 5000000000, 8000000 };
+	for(ReplayLog::int64 delta : deltas)
+		log.AddFrame(delta);
+
+	log.Events =
+	{
+		Mouse(InputEvent::Type::MouseDown, 400, 300, 1),
+		Mouse(InputEvent::Type::MouseMove, 398, 305, 1),
+		Mouse(InputEvent::Type::MouseMove, -20, -7, 1),
+		Key(InputEvent::Type::KeyDown, 38),
+		Mouse(InputEvent::Type::MouseUp, std::numeric_limits<int>::max(), std::numeric_limits<int>::min(), 0),
+		Mouse(InputEvent::Type::MouseMove, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), 2),
+		Key(InputEvent::Type::KeyUp, 255),
+	};
+	const ReplayLog::uint32 frames[] = { 0, 0, 1, 3, 3, 6, 6 };
+	for(size_t i = 0; i < log.Events.size(); ++i)
+		log.Events[i].Frame = frames[i];
+
+	std::istringstream in(Saved(log), std::ios::binary);
+	ReplayLog loaded;
+	loaded.Seed = 1;
+	loaded.AddFrame(1);
+	std::string error;
+	CHECK(loaded.Load(in, &error));
+	CHECK(error.empty());
+
+	CHECK(loaded.Seed == log.Seed);
+	CHECK(loaded.DeltasNs == log.DeltasNs);
+	CHECK(loaded.Events.size() == log.Events.size());
+	for(size_t i = 0; i < log.Events.size() && i < loaded.Events.size(); ++i)
+		CHECK(SameEvent(loaded.Events[i], log.Events[i]));
+
+	// A steady frame rate costs a byte per frame: the magic, four header varints, the
+	// first step, then a zero difference for each other frame.
+	ReplayLog steady;
+	for(int i = 0; i < 100; ++i)
+		steady.AddFrame(16666667);
+	CHECK(Saved(steady).size() == 4 + 4 + 4 + 99);
+}
+
+TEST(ReplayLog_RejectsTruncatedAndMalformedStreams)
+{
+	ReplayLog log;
+	log.Seed = 7;
+	log.AddEvent(Key(InputEvent::Type::KeyDown, 'A'));
+	log.AddFrame(16666667);
+	log.AddEvent(Mouse(InputEvent::Type::MouseMove, -300, 200, 1));
+	log.AddFrame(16666667);
+	const std::string bytes = Saved(log);
+
+	// Every strict prefix is an error, never a shorter log.
+	for(size_t size = 0; size < bytes.size(); ++size)
+		CHECK(!LoadError(bytes.substr(0, size)).empty());
+	CHECK(LoadError(bytes).empty());
+
+	// Magic, version 1, seed, 2 frames, 2 events, then the frames and events.
+	CHECK(LoadError(bytes.substr(0, 3)) == "not a replay log");
+	CHECK(LoadError("RPLX" + bytes.substr(4)) == "not a replay log");
+	CHECK(LoadError(bytes.substr(0, 4)) == "unsupported replay log version");
+	CHECK(LoadError("RPLY\x02" + bytes.substr(5)) == "unsupported replay log version");
+	CHECK(LoadError(bytes.substr(0, 7)) == "truncated header");
+	CHECK(LoadError(bytes.substr(0, 9)) == "truncated frame times");
+	CHECK(LoadError(bytes.substr(0, bytes.size() - 1)) == "truncated events");
+
+	// One key event in frame 0 whose type is valid, out of range or missing.
+	const std::string header("RPLY\x01\x00\x00\x01", 8);
+	CHECK(LoadError(header + std::string("\x00\x03\x41", 3)).empty());
+	CHECK(LoadError(header + std::string("\x00\x05\x41", 3)) == "bad event type");
+	CHECK(LoadError(header + std::string("\x00\xff\x41", 3)) == "bad event type");
+	CHECK(LoadError(header + std::string("\x00", 1)) == "truncated events");
+
+	// A varint longer than 64 bits.
+	CHECK(LoadError(std::string("RPLY\x01", 5) + std::string(10, '\x80') + '\x01') == "truncated header");
+}
+
+TEST(ReplayLog_ReplaysTheRecordedStepsExactly)
+{
+	// Steps as a windowed run might record them, up to a stall of several seconds.
+	std::mt19937 random(3);
+	ReplayLog log;
+	for(int i = 0; i < 2000; ++i)
+		log.AddFrame(i % 500 == 7 ? 4000000000 + random() : 1 + random() % 50000000);
+
+	std::stringstream file(std::ios::in | std::ios::out | std::ios::binary);
+	log.Save(file);
+	ReplayLog loaded;
+	CHECK(loaded.Load(file));
+
+	// The recording's own timer, ticked by the same steps.
+	GameTimer recorded;
+	recorded.Reset();
+	std::vector<float> recordedTimes;
+	for(ReplayLog::int64 ns : log.DeltasNs)
+	{
+		recorded.Tick(ns);
+		recordedTimes.push_back(recorded.DeltaTime());
+	}
+
+	HeadlessRunner runner(loaded.ToSettings());
+	GameTimer timer;
+	DeltaClient client;
+	HeadlessRunner::Results results = runner.Run(client, timer);
+
+	CHECK(results.NumFrames == 2000);
+	CHECK(client.DeltasNs == log.DeltasNs);
+	CHECK(client.DeltaTimes == recordedTimes);
+	CHECK(timer.TotalTimeNs() == recorded.TotalTimeNs());
+	CHECK(timer.TotalTime() == recorded.TotalTime());
+}
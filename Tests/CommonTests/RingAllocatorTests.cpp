@@ -0,0 +1,78 @@
+//***************************************************************************************
+// RingAllocatorTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "RingAllocator.h"
+
+TEST(RingAllocator_AllocatesInOrder)
+{
+	RingAllocator ring(1000);
+	CHECK(ring.Allocate(100) == 0);
+	CHECK(ring.Allocate(100, 256) == 256);
+	CHECK(ring.UsedSize() == 356);
+	CHECK(ring.Allocate(1001) == RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocator_ReleasesFinishedFrames)
+{
+	RingAllocator ring(1000);
+	ring.Allocate(300);
+	ring.FinishFrame(1);
+	ring.Allocate(300);
+	ring.FinishFrame(2);
+
+	ring.ReleaseCompleted(0);
+	CHECK(ring.UsedSize() == 600);
+	ring.ReleaseCompleted(1);
+	CHECK(ring.UsedSize() == 300);
+	ring.ReleaseCompleted(2);
+	CHECK(ring.IsEmpty());
+}
+
+TEST(RingAllocator_WrapsAround)
+{
+	RingAllocator ring(1000);
+	ring.Allocate(400);
+	ring.FinishFrame(1);
+	ring.Allocate(400);
+	ring.FinishFrame(2);
+	ring.ReleaseCompleted(1);
+
+	// 200 bytes left at the end are skipped and count as used.
+	CHECK(ring.Allocate(300) == 0);
+	CHECK(ring.UsedSize() == 900);
+	CHECK(ring.Allocate(200) == RingAllocator::InvalidOffset);
+
+	ring.FinishFrame(3);
+	ring.ReleaseCompleted(3);
+	CHECK(ring.IsEmpty());
+}
+
+TEST(RingAllocator_IdleFramesDoNotHoldBackRelease)
+{
+	RingAllocator ring(1000);
+	CHECK(ring.Allocate(600) == 0);
+	ring.FinishFrame(1);
+
+	// Frames that allocate nothing, with the GPU two frames behind.
+	for(RingAllocator::uint64 fence = 2; fence < 20; ++fence)
+	{
+		ring.FinishFrame(fence);
+		ring.ReleaseCompleted(fence - 2);
+	}
+
+	CHECK(ring.IsEmpty());
+	CHECK(ring.Allocate(600) != RingAllocator::InvalidOffset);
+}
+
+TEST(RingAllocator_IdleFrameKeepsEarlierFence)
+{
+	RingAllocator ring(1000);
+	ring.Allocate(100);
+	ring.FinishFrame(1);
+	ring.FinishFrame(2);
+
+	ring.ReleaseCompleted(1);
+	CHECK(ring.IsEmpty());
+}
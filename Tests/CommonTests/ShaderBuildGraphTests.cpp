@@ -0,0 +1,150 @@
+//***************************************************************************************
+// ShaderBuildGraphTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "ShaderBuildGraph.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+	// Returns the entry point as the bytecode, fails on the entry point "Broken", and
+	// records how many compiles ran at the same time.
+	class StubCompiler : public ShaderCache::Compiler
+	{
+	public:
+		virtual std::string Version()const override
+		{
+			return "stub 1";
+		}
+
+		virtual ShaderCache::ByteCode Compile(const ShaderCache::Request& request) override
+		{
+			NumCompiles++;
+			int active = ++mNumActive;
+			int peak = PeakActive;
+			while(active > peak && !PeakActive.compare_exchange_weak(peak, active))
+			{
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			mNumActive--;
+
+			if(request.EntryPoint == "Broken")
+				throw std::runtime_error("compile error");
+
+			return ShaderCache::ByteCode(request.EntryPoint.begin(), request.EntryPoint.end());
+		}
+
+		std::atomic<int> NumCompiles{ 0 };
+		std::atomic<int> PeakActive{ 0 };
+
+	private:
+		std::atomic<int> mNumActive{ 0 };
+	};
+
+	// The file does not exist; the stub never reads it and the key hashes it as empty.
+	ShaderCache::Request MakeRequest(const std::string& entryPoint)
+	{
+		ShaderCache::Request request;
+		request.Filename = "ShaderBuildGraphTest.hlsl";
+		request.EntryPoint = entryPoint;
+		request.Target = "vs_5_0";
+		return request;
+	}
+}
+
+TEST(ShaderBuildGraph_CompilesInParallel)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderBuildGraph build(&cache, 4);
+
+	for(int i = 0; i < 8; ++i)
+		build.AddShader("shader" + std::to_string(i), MakeRequest("E" + std::to_string(i)));
+	build.Wait();
+
+	CHECK(compiler.NumCompiles == 8);
+	CHECK(compiler.PeakActive > 1 && compiler.PeakActive <= 4);
+	CHECK(*build.GetShader("shader3").get() == ShaderCache::ByteCode({ 'E', '3' }));
+}
+
+TEST(ShaderBuildGraph_IdenticalRequestsShareACompile)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderBuildGraph build(&cache, 2);
+
+	build.AddShader("standardVS", MakeRequest("VS"));
+	build.AddShader("skyVS", MakeRequest("VS"));
+	build.Wait();
+
+	CHECK(build.NumShaders() == 2);
+	CHECK(build.NumCompiles() == 1);
+	CHECK(compiler.NumCompiles == 1);
+	CHECK(build.GetShader("standardVS").get() == build.GetShader("skyVS").get());
+}
+
+TEST(ShaderBuildGraph_TasksRunAfterTheirShaders)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderBuildGraph build(&cache, 4);
+
+	build.AddShader("VS", MakeRequest("VS"));
+	build.AddShader("PS", MakeRequest("PS"));
+
+	std::atomic<int> numReady(0);
+	std::atomic<int> numRun(0);
+	build.AddTask({ "VS", "PS" }, [&]()
+	{
+		auto vs = build.GetShader("VS");
+		auto ps = build.GetShader("PS");
+		if(vs.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+		   ps.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			numReady++;
+		numRun++;
+	});
+	build.Wait();
+
+	// A task added after its shaders finished runs as well.
+	build.AddTask({ "VS" }, [&]() { numRun++; });
+	build.Wait();
+
+	CHECK(numReady == 1);
+	CHECK(numRun == 2);
+}
+
+TEST(ShaderBuildGraph_FailureSkipsDependentsAndIsRethrown)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderBuildGraph build(&cache, 2);
+
+	build.AddShader("VS", MakeRequest("VS"));
+	build.AddShader("PS", MakeRequest("Broken"));
+
+	bool ranBroken = false;
+	bool ranOther = false;
+	build.AddTask({ "VS", "PS" }, [&]() { ranBroken = true; });
+	build.AddTask({ "VS" }, [&]() { ranOther = true; });
+
+	bool threw = false;
+	try
+	{
+		build.Wait();
+	}
+	catch(const std::runtime_error&)
+	{
+		threw = true;
+	}
+
+	CHECK(threw);
+	CHECK(!ranBroken);
+	CHECK(ranOther);
+
+	// The error is reported once.
+	build.Wait();
+}
@@ -0,0 +1,201 @@
+//***************************************************************************************
+// ShaderCacheTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "ShaderCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	// Returns the entry point as the bytecode, and fails on the entry point "Broken".
+	class StubCompiler : public ShaderCache::Compiler
+	{
+	public:
+		virtual std::string Version()const override
+		{
+			return "stub 1";
+		}
+
+		virtual ShaderCache::ByteCode Compile(const ShaderCache::Request& request) override
+		{
+			NumCompiles++;
+
+			// Long enough for concurrent requests to arrive during the compile.
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+			if(request.EntryPoint == "Broken")
+				throw std::runtime_error("compile error");
+
+			return ShaderCache::ByteCode(request.EntryPoint.begin(), request.EntryPoint.end());
+		}
+
+		std::atomic<int> NumCompiles{ 0 };
+	};
+
+	ShaderCache::Request MakeRequest()
+	{
+		{
+			std::ofstream source("ShaderCacheTest.hlsl");
+			source << "#include \"ShaderCacheTestCommon.hlsl\"\nfloat4 VS() : SV_Position { return 0; }\n";
+			std::ofstream common("ShaderCacheTestCommon.hlsl");
+			common << "// common\n";
+		}
+
+		ShaderCache::Request request;
+		request.Filename = "ShaderCacheTest.hlsl";
+		request.EntryPoint = "VS";
+		request.Target = "vs_5_0";
+		return request;
+	}
+
+	std::string EntryPath(const ShaderCache& cache, const ShaderCache::Request& request)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.cso", (unsigned long long)cache.ComputeKey(request));
+		return std::string("./") + name;
+	}
+
+	void RemoveSources()
+	{
+		std::remove("ShaderCacheTest.hlsl");
+		std::remove("ShaderCacheTestCommon.hlsl");
+	}
+}
+
+TEST(ShaderCache_ConcurrentRequestsCompileOnce)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderCache::Request request = MakeRequest();
+
+	std::atomic<int> numCorrect(0);
+	std::vector<std::thread> threads;
+	for(int i = 0; i < 8; ++i)
+	{
+		threads.emplace_back([&]()
+		{
+			if(cache.Get(request)->size() == 2)
+				numCorrect++;
+		});
+	}
+	for(auto& t : threads)
+		t.join();
+
+	CHECK(numCorrect == 8);
+	CHECK(compiler.NumCompiles == 1);
+	CHECK(cache.GetStats().MemoryHits == 7);
+	RemoveSources();
+}
+
+TEST(ShaderCache_KeyTracksIncludesAndDefines)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderCache::Request request = MakeRequest();
+
+	ShaderCache::uint64 key = cache.ComputeKey(request);
+	CHECK(cache.ComputeKey(request) == key);
+
+	ShaderCache::Request fog = request;
+	fog.Defines.push_back({ "FOG", "1" });
+	CHECK(cache.ComputeKey(fog) != key);
+
+	std::ofstream("ShaderCacheTestCommon.hlsl") << "// edited\n";
+	CHECK(cache.ComputeKey(request) != key);
+	RemoveSources();
+}
+
+TEST(ShaderCache_ReadsEntriesWrittenByAnotherCache)
+{
+	StubCompiler compiler;
+	ShaderCache::Request request = MakeRequest();
+	{
+		ShaderCache cache(&compiler, ".");
+		cache.Get(request);
+	}
+
+	ShaderCache cache(&compiler, ".");
+	CHECK(*cache.Get(request) == ShaderCache::ByteCode({ 'V', 'S' }));
+	CHECK(compiler.NumCompiles == 1);
+	CHECK(cache.GetStats().DiskHits == 1);
+
+	cache.Clear();
+	CHECK(!std::ifstream(EntryPath(cache, request)));
+	RemoveSources();
+}
+
+TEST(ShaderCache_FailedCompileIsRetried)
+{
+	StubCompiler compiler;
+	ShaderCache cache(&compiler, "");
+	ShaderCache::Request request = MakeRequest();
+	request.EntryPoint = "Broken";
+
+	for(int i = 0; i < 2; ++i)
+	{
+		bool threw = false;
+		try
+		{
+			cache.Get(request);
+		}
+		catch(const std::runtime_error&)
+		{
+			threw = true;
+		}
+		CHECK(threw);
+	}
+	CHECK(compiler.NumCompiles == 2);
+	RemoveSources();
+}
+
+TEST(ShaderCache_CorruptEntryIsRecompiled)
+{
+	StubCompiler compiler;
+	ShaderCache::Request request = MakeRequest();
+	ShaderCache cache(&compiler, ".");
+	cache.Get(request);
+
+	// Flip a byte of the bytecode, after the 24 byte header.
+	{
+		std::fstream entry(EntryPath(cache, request), std::ios::in | std::ios::out | std::ios::binary);
+		entry.seekp(24);
+		entry.put('X');
+	}
+
+	ShaderCache reader(&compiler, ".");
+	CHECK(reader.Get(request)->size() == 2);
+	CHECK(compiler.NumCompiles == 2);
+	CHECK(reader.GetStats().DiskHits == 0);
+
+	reader.Clear();
+	RemoveSources();
+}
+
+TEST(ShaderCache_CorruptSizeIsAMiss)
+{
+	StubCompiler compiler;
+	ShaderCache::Request request = MakeRequest();
+	ShaderCache cache(&compiler, ".");
+	cache.Get(request);
+
+	// A size far past the end of the file must not reach the allocation.
+	{
+		std::fstream entry(EntryPath(cache, request), std::ios::in | std::ios::out | std::ios::binary);
+		entry.seekp(4);
+		const char size[4] = { '\xff', '\xff', '\xff', '\xff' };
+		entry.write(size, sizeof(size));
+	}
+
+	ShaderCache reader(&compiler, ".");
+	CHECK(reader.Get(request)->size() == 2);
+	CHECK(compiler.NumCompiles == 2);
+
+	reader.Clear();
+	RemoveSources();
+}
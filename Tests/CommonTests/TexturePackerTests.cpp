@@ -0,0 +1,177 @@
+//***************************************************************************************
+// TexturePackerTests.cpp
+//***************************************************************************************
+
+#include "Check.h"
+#include "TexturePacker.h"
+
+namespace
+{
+	const TexturePacker::uint32 Rgba8 = 28; // DXGI_FORMAT_R8G8B8A8_UNORM
+	const TexturePacker::uint32 Bc1 = 71;   // DXGI_FORMAT_BC1_UNORM
+
+	TexturePacker::TextureDesc Desc(TexturePacker::uint32 format, TexturePacker::uint32 width,
+		TexturePacker::uint32 height, TexturePacker::uint32 mipLevels, bool allowAtlas = true)
+	{
+		TexturePacker::TextureDesc desc;
+		desc.Format = format;
+		desc.Width = width;
+		desc.Height = height;
+		desc.MipLevels = mipLevels;
+		desc.BlockSize = format == Bc1 ? 4 : 1;
+		desc.AllowAtlas = allowAtlas;
+		return desc;
+	}
+
+	// True if the tiles of an atlas page and their gutters are inside the page and
+	// do not overlap.
+	bool TilesAreDisjoint(const TexturePacker& packer, const TexturePacker::Page& page)
+	{
+		for(size_t a = 0; a < page.Textures.size(); ++a)
+		{
+			const TexturePacker::Placement& p = packer.GetPlacement(page.Textures[a]);
+			if(p.X < page.Border || p.Y < page.Border ||
+			   p.X + p.Width + page.Border > page.Width || p.Y + p.Height + page.Border > page.Height)
+				return false;
+
+			for(size_t b = 0; b < a; ++b)
+			{
+				const TexturePacker::Placement& q = packer.GetPlacement(page.Textures[b]);
+				bool apart =
+					p.X + p.Width + page.Border <= q.X - page.Border || q.X + q.Width + page.Border <= p.X - page.Border ||
+					p.Y + p.Height + page.Border <= q.Y - page.Border || q.Y + q.Height + page.Border <= p.Y - page.Border;
+				if(!apart)
+					return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(TexturePacker_GroupsMatchingTexturesIntoArrays)
+{
+	TexturePacker packer(1024, 64, 2);
+	TexturePacker::uint32 a = packer.Add(Desc(Rgba8, 256, 256, 9));
+	TexturePacker::uint32 b = packer.Add(Desc(Rgba8, 256, 256, 9));
+	TexturePacker::uint32 fewerMips = packer.Add(Desc(Rgba8, 256, 256, 8));
+	TexturePacker::uint32 otherFormat = packer.Add(Desc(Bc1, 256, 256, 9));
+	TexturePacker::uint32 c = packer.Add(Desc(Rgba8, 256, 256, 9));
+	TexturePacker::uint32 tiling0 = packer.Add(Desc(Rgba8, 32, 32, 6, false));
+	TexturePacker::uint32 tiling1 = packer.Add(Desc(Rgba8, 32, 32, 6, false));
+	TexturePacker::uint32 loneSmall = packer.Add(Desc(Bc1, 16, 16, 5));
+	packer.Build();
+
+	const auto& pages = packer.GetPages();
+	CHECK(pages.size() == 6);
+
+	// The array is full after two slices, so c starts a page of its own.  The
+	// textures that differ in anything else each stay single.
+	CHECK(pages[0].Type == TexturePacker::PageType::Array);
+	CHECK((pages[0].Textures == std::vector<TexturePacker::uint32>{ a, b }));
+	CHECK(pages[0].Width == 256 && pages[0].Height == 256 && pages[0].MipLevels == 9);
+	CHECK(packer.GetPlacement(b).Page == 0 && packer.GetPlacement(b).Slice == 1);
+
+	CHECK(pages[1].Type == TexturePacker::PageType::Single);
+	CHECK((pages[1].Textures == std::vector<TexturePacker::uint32>{ c }));
+	CHECK((pages[2].Textures == std::vector<TexturePacker::uint32>{ fewerMips }));
+	CHECK((pages[3].Textures == std::vector<TexturePacker::uint32>{ otherFormat }));
+
+	// Small textures that may not go into an atlas can still share an array, and a
+	// lone small texture stays as it is.
+	CHECK(pages[4].Type == TexturePacker::PageType::Array);
+	CHECK((pages[4].Textures == std::vector<TexturePacker::uint32>{ tiling0, tiling1 }));
+	CHECK(pages[5].Type == TexturePacker::PageType::Single);
+	CHECK(packer.GetPlacement(loneSmall).Page == 5);
+
+	// Whole page textures are not remapped.
+	const TexturePacker::Placement& p = packer.GetPlacement(c);
+	CHECK(p.Page == 1 && p.Slice == 0);
+	CHECK(p.ScaleU == 1.0f && p.ScaleV == 1.0f && p.OffsetU == 0.0f && p.OffsetV == 0.0f);
+}
+
+TEST(TexturePacker_PlacesAtlasTilesWithAGutter)
+{
+	TexturePacker packer(256, 64, 2048, 4);
+	TexturePacker::uint32 big = packer.Add(Desc(Rgba8, 64, 64, 7));
+	TexturePacker::uint32 wide = packer.Add(Desc(Rgba8, 32, 16, 6));
+	TexturePacker::uint32 square = packer.Add(Desc(Rgba8, 32, 32, 6));
+	TexturePacker::uint32 tiny = packer.Add(Desc(Rgba8, 8, 8, 4));
+	packer.Build();
+
+	const auto& pages = packer.GetPages();
+	CHECK(pages.size() == 1);
+	const TexturePacker::Page& page = pages[0];
+	CHECK(page.Type == TexturePacker::PageType::Atlas);
+	CHECK(page.Width == 256 && page.Height == 256);
+	CHECK(page.Border == 4);
+
+	// Cells of 128, 64, 64 and 16 texels (tile plus gutter, rounded up), largest first.
+	CHECK(packer.GetPlacement(big).X == 4 && packer.GetPlacement(big).Y == 4);
+	CHECK(packer.GetPlacement(wide).X == 132 && packer.GetPlacement(wide).Y == 4);
+	CHECK(packer.GetPlacement(square).X == 196 && packer.GetPlacement(square).Y == 4);
+	CHECK(packer.GetPlacement(tiny).X == 4 && packer.GetPlacement(tiny).Y == 132);
+	CHECK(TilesAreDisjoint(packer, page));
+
+	// uv * Scale + Offset maps [0,1] onto the tile's texels.
+	for(TexturePacker::uint32 i : page.Textures)
+	{
+		const TexturePacker::Placement& p = packer.GetPlacement(i);
+		CHECK(p.Page == 0);
+		CHECK(p.OffsetU * page.Width == (float)p.X);
+		CHECK(p.OffsetV * page.Height == (float)p.Y);
+		CHECK((p.ScaleU + p.OffsetU) * page.Width == (float)(p.X + p.Width));
+		CHECK((p.ScaleV + p.OffsetV) * page.Height == (float)(p.Y + p.Height));
+	}
+
+	// The 4 texel gutter halves exactly twice.
+	CHECK(page.MipLevels == 3);
+}
+
+TEST(TexturePacker_ClampsAtlasMipsToExactHalving)
+{
+	// 48 texels halve exactly down to 3: five mips out of the six in the file.
+	TexturePacker packer(1024, 64, 2048, 0);
+	TexturePacker::uint32 odd = packer.Add(Desc(Rgba8, 48, 48, 6));
+	packer.Add(Desc(Rgba8, 32, 32, 6));
+	packer.Build();
+
+	const TexturePacker::Page& page = packer.GetPages()[0];
+	CHECK(page.Type == TexturePacker::PageType::Atlas);
+	CHECK(page.Border == 0);
+	CHECK(page.MipLevels == 5);
+
+	// In every kept mip the remap still lands on whole texels.
+	const TexturePacker::Placement& p = packer.GetPlacement(odd);
+	for(TexturePacker::uint32 m = 0; m < page.MipLevels; ++m)
+	{
+		TexturePacker::uint32 width = page.Width >> m;
+		CHECK(p.ScaleU * width == (float)(p.Width >> m));
+		CHECK(p.OffsetU * width == (float)(p.X >> m));
+		CHECK((p.Width >> m) << m == p.Width);
+		CHECK((p.X >> m) << m == p.X);
+	}
+
+	// Block compressed tiles keep the mips with whole blocks: 16 texels are four
+	// blocks, then two, then one, but an 8 texel gutter is only two blocks, then one.
+	TexturePacker bcPacker(1024, 64, 2048, 8);
+	bcPacker.Add(Desc(Bc1, 16, 16, 5));
+	bcPacker.Add(Desc(Bc1, 16, 16, 5));
+	bcPacker.Build();
+	CHECK(bcPacker.GetPages()[0].MipLevels == 2);
+	CHECK(TilesAreDisjoint(bcPacker, bcPacker.GetPages()[0]));
+
+	// The gutter is rounded up to whole blocks.
+	TexturePacker roundedPacker(1024, 64, 2048, 2);
+	roundedPacker.Add(Desc(Bc1, 16, 16, 5));
+	roundedPacker.Add(Desc(Bc1, 16, 16, 5));
+	roundedPacker.Build();
+	CHECK(roundedPacker.GetPages()[0].Border == 4);
+	CHECK(roundedPacker.GetPages()[0].MipLevels == 1);
+
+	// A tile that is not a whole number of blocks only keeps its top mip.
+	TexturePacker partialPacker(1024, 64, 2048, 0);
+	partialPacker.Add(Desc(Bc1, 16, 16, 5));
+	partialPacker.Add(Desc(Bc1, 20, 16, 5));
+	partialPacker.Build();
+	CHECK(partialPacker.GetPages()[0].MipLevels == 1);
+}